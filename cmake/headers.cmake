@@ -11,9 +11,15 @@ set(llfio_HEADERS
   "include/llfio/v2.0/algorithm/clone.hpp"
   "include/llfio/v2.0/algorithm/contents.hpp"
   "include/llfio/v2.0/algorithm/difference.hpp"
+  "include/llfio/v2.0/algorithm/handle_adapter/block_cache.hpp"
   "include/llfio/v2.0/algorithm/handle_adapter/cached_parent.hpp"
+  "include/llfio/v2.0/algorithm/handle_adapter/checksum.hpp"
   "include/llfio/v2.0/algorithm/handle_adapter/combining.hpp"
+  "include/llfio/v2.0/algorithm/handle_adapter/striped.hpp"
   "include/llfio/v2.0/algorithm/handle_adapter/xor.hpp"
+  "include/llfio/v2.0/algorithm/lazy_map.hpp"
+  "include/llfio/v2.0/algorithm/parallel_for.hpp"
+  "include/llfio/v2.0/algorithm/process_sampler.hpp"
   "include/llfio/v2.0/algorithm/reduce.hpp"
   "include/llfio/v2.0/algorithm/shared_fs_mutex/atomic_append.hpp"
   "include/llfio/v2.0/algorithm/shared_fs_mutex/base.hpp"
@@ -21,18 +27,24 @@ set(llfio_HEADERS
   "include/llfio/v2.0/algorithm/shared_fs_mutex/lock_files.hpp"
   "include/llfio/v2.0/algorithm/shared_fs_mutex/memory_map.hpp"
   "include/llfio/v2.0/algorithm/shared_fs_mutex/safe_byte_ranges.hpp"
+  "include/llfio/v2.0/algorithm/shared_map_registry.hpp"
   "include/llfio/v2.0/algorithm/summarize.hpp"
+  "include/llfio/v2.0/algorithm/trace_recorder.hpp"
   "include/llfio/v2.0/algorithm/traverse.hpp"
   "include/llfio/v2.0/algorithm/trivial_vector.hpp"
   "include/llfio/v2.0/config.hpp"
   "include/llfio/v2.0/deadline.h"
+  "include/llfio/v2.0/detail/impl/block_cache.ipp"
   "include/llfio/v2.0/detail/impl/cached_parent_handle_adapter.ipp"
   "include/llfio/v2.0/detail/impl/clone.ipp"
   "include/llfio/v2.0/detail/impl/config.ipp"
+  "include/llfio/v2.0/detail/impl/directory_handle.ipp"
   "include/llfio/v2.0/detail/impl/dynamic_thread_pool_group.ipp"
   "include/llfio/v2.0/detail/impl/fast_random_file_handle.ipp"
   "include/llfio/v2.0/detail/impl/io_multiplexer.ipp"
+  "include/llfio/v2.0/detail/impl/lazy_map.ipp"
   "include/llfio/v2.0/detail/impl/map_handle.ipp"
+  "include/llfio/v2.0/detail/impl/mapped_file_handle.ipp"
   "include/llfio/v2.0/detail/impl/path_discovery.ipp"
   "include/llfio/v2.0/detail/impl/path_view.ipp"
   "include/llfio/v2.0/detail/impl/posix/directory_handle.ipp"
@@ -58,6 +70,7 @@ set(llfio_HEADERS
   "include/llfio/v2.0/detail/impl/safe_byte_ranges.ipp"
   "include/llfio/v2.0/detail/impl/storage_profile.ipp"
   "include/llfio/v2.0/detail/impl/test/null_multiplexer.ipp"
+  "include/llfio/v2.0/detail/impl/tracing.ipp"
   "include/llfio/v2.0/detail/impl/traverse.ipp"
   "include/llfio/v2.0/detail/impl/windows/directory_handle.ipp"
   "include/llfio/v2.0/detail/impl/windows/file_handle.ipp"
@@ -104,6 +117,7 @@ set(llfio_HEADERS
   "include/llfio/v2.0/status_code.hpp"
   "include/llfio/v2.0/storage_profile.hpp"
   "include/llfio/v2.0/symlink_handle.hpp"
+  "include/llfio/v2.0/tracing.hpp"
   "include/llfio/v2.0/utils.hpp"
   "include/llfio/version.hpp"
 )
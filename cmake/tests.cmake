@@ -3,37 +3,48 @@ set(llfio_TESTS
   "test/test_kernel_decl.hpp"
   "test/tests/clone_extents.cpp"
   "test/tests/current_path.cpp"
+  "test/tests/directory_handle_buffer_pool.cpp"
   "test/tests/directory_handle_create_close/kernel_directory_handle.cpp.hpp"
   "test/tests/directory_handle_create_close/runner.cpp"
   "test/tests/directory_handle_enumerate/kernel_directory_handle_enumerate.cpp.hpp"
   "test/tests/directory_handle_enumerate/runner.cpp"
+  "test/tests/directory_handle_glob.cpp"
+  "test/tests/directory_handle_metadata.cpp"
   "test/tests/dynamic_thread_pool_group.cpp"
   "test/tests/fast_random_file_handle.cpp"
   "test/tests/file_handle_create_close/kernel_file_handle.cpp.hpp"
   "test/tests/file_handle_create_close/runner.cpp"
   "test/tests/file_handle_lock_unlock.cpp"
+  "test/tests/handle_adapter_block_cache.cpp"
+  "test/tests/handle_adapter_checksum.cpp"
+  "test/tests/handle_adapter_striped.cpp"
   "test/tests/handle_adapter_xor.cpp"
   "test/tests/issue0009.cpp"
   "test/tests/issue0027.cpp"
   "test/tests/issue0028.cpp"
   "test/tests/issue0073.cpp"
   "test/tests/large_pages.cpp"
+  "test/tests/lazy_map.cpp"
   "test/tests/map_handle_cache.cpp"
   "test/tests/map_handle_create_close/kernel_map_handle.cpp.hpp"
   "test/tests/map_handle_create_close/runner.cpp"
   "test/tests/mapped.cpp"
   "test/tests/mapped_file_handle.cpp"
+  "test/tests/parallel_for.cpp"
   "test/tests/path_discovery.cpp"
   "test/tests/path_view.cpp"
   "test/tests/pipe_handle.cpp"
   "test/tests/process_handle.cpp"
+  "test/tests/process_sampler.cpp"
   "test/tests/reduce.cpp"
   "test/tests/section_handle_create_close/kernel_section_handle.cpp.hpp"
   "test/tests/section_handle_create_close/runner.cpp"
   "test/tests/shared_fs_mutex.cpp"
+  "test/tests/shared_map_registry.cpp"
   "test/tests/statfs.cpp"
   "test/tests/symlink_handle_create_close/kernel_symlink_handle.cpp.hpp"
   "test/tests/symlink_handle_create_close/runner.cpp"
+  "test/tests/tracing.cpp"
   "test/tests/traverse.cpp"
   "test/tests/trivial_vector.cpp"
   "test/tests/utils.cpp"
@@ -0,0 +1,476 @@
+/* A read-through block cache handle adapter
+(C) 2026 agent <agent@local> (2 commits)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#ifndef LLFIO_ALGORITHM_HANDLE_ADAPTER_BLOCK_CACHE_H
+#define LLFIO_ALGORITHM_HANDLE_ADAPTER_BLOCK_CACHE_H
+
+#include "combining.hpp"
+
+#include <memory>  // for unique_ptr
+#include <vector>
+
+//! \file handle_adapter/block_cache.hpp Provides `block_cache_handle_adapter`.
+
+LLFIO_V2_NAMESPACE_EXPORT_BEGIN
+
+namespace algorithm
+{
+  //! \brief Statistics about a block cache.
+  struct block_cache_statistics
+  {
+    uint64_t hits{0};           //!< Blocks found in the cache.
+    uint64_t misses{0};         //!< Blocks not found in the cache.
+    uint64_t insertions{0};     //!< Blocks added to the cache.
+    uint64_t evictions{0};      //!< Blocks evicted from the cache to make room.
+    uint64_t invalidations{0};  //!< Blocks dropped from the cache due to writes, truncations or zeroing.
+    uint64_t bypasses{0};       //!< Blocks read without caching because no slot was free.
+  };
+
+  namespace detail
+  {
+    // Walks a scatter list, copying bytes into it
+    struct block_cache_scatter_cursor
+    {
+      io_handle::buffer_type *buffers{nullptr};
+      size_t count{0}, idx{0}, offset{0}, copied{0};
+
+      block_cache_scatter_cursor(io_handle::buffer_type *_buffers, size_t _count) noexcept
+          : buffers(_buffers)
+          , count(_count)
+      {
+      }
+      void copy_in(const byte *src, size_t bytes) noexcept
+      {
+        while(bytes > 0 && idx < count)
+        {
+          const size_t tocopy = std::min(bytes, buffers[idx].size() - offset);
+          memcpy(buffers[idx].data() + offset, src, tocopy);
+          src += tocopy;
+          bytes -= tocopy;
+          offset += tocopy;
+          copied += tocopy;
+          if(offset == buffers[idx].size())
+          {
+            idx++;
+            offset = 0;
+          }
+        }
+      }
+    };
+
+    /* A fixed capacity cache of equally sized blocks living in a single kernel allocated arena,
+    split into lock striped shards each running S3-FIFO eviction over its own slots.
+    */
+    class LLFIO_DECL block_cache
+    {
+    public:
+      using extent_type = io_handle::extent_type;
+
+    private:
+      struct _shard;
+      map_handle _arena;
+      size_t _blocksize{0}, _slots{0};
+      std::unique_ptr<_shard[]> _shards;
+      size_t _shardcount{0};
+
+      LLFIO_HEADERS_ONLY_MEMFUNC_SPEC _shard &_shard_for(extent_type block) const noexcept;
+
+    public:
+      LLFIO_HEADERS_ONLY_MEMFUNC_SPEC block_cache(size_t capacity, size_t blocksize, size_t shards);
+      block_cache(const block_cache &) = delete;
+      block_cache(block_cache &&) = delete;
+      block_cache &operator=(const block_cache &) = delete;
+      block_cache &operator=(block_cache &&) = delete;
+      LLFIO_HEADERS_ONLY_MEMFUNC_SPEC ~block_cache();
+
+      size_t block_size() const noexcept { return _blocksize; }
+      size_t capacity() const noexcept { return _slots * _blocksize; }
+
+      // True if the block is resident. Does not count as a hit.
+      LLFIO_HEADERS_ONLY_MEMFUNC_SPEC bool contains(extent_type block) const noexcept;
+      // If the block is resident, copies [offset, offset + bytes) of it into out and returns true.
+      LLFIO_HEADERS_ONLY_MEMFUNC_SPEC bool lookup(extent_type block, size_t offset, size_t bytes, block_cache_scatter_cursor &out) noexcept;
+      // Counts a miss and reserves a slot into which the block can be read, returning null if none could be freed.
+      LLFIO_HEADERS_ONLY_MEMFUNC_SPEC byte *reserve(extent_type block) noexcept;
+      // Makes a reserved slot resident, unless it was invalidated or another reservation of the block was first.
+      LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void publish(extent_type block, byte *slot) noexcept;
+      // Returns a reserved slot without making it resident.
+      LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void release(extent_type block, byte *slot) noexcept;
+      // Replaces [offset, offset + bytes) of the block if it is resident, and causes any in flight reservation of it to not be published.
+      LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void update(extent_type block, size_t offset, const byte *data, size_t bytes) noexcept;
+      // Drops the block if it is resident, and causes any in flight reservation of it to not be published.
+      LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void invalidate(extent_type block) noexcept;
+      // Drops all blocks from block onwards.
+      LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void invalidate_from(extent_type block) noexcept;
+
+      LLFIO_HEADERS_ONLY_MEMFUNC_SPEC block_cache_statistics statistics() const noexcept;
+      LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void reset_statistics() noexcept;
+      LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void note_bypass(extent_type block) noexcept;
+    };
+
+    template <class Target, class Source> struct block_cache_handle_adapter_op
+    {
+      static_assert(std::is_void<Source>::value, "block_cache_handle_adapter takes no second handle");
+      static_assert(std::is_base_of<file_handle, Target>::value, "block_cache_handle_adapter requires a file handle");
+
+      using buffer_type = typename Target::buffer_type;
+      using const_buffer_type = typename Target::const_buffer_type;
+      using const_buffers_type = typename Target::const_buffers_type;
+
+      // The default read() and write() are replaced in override_, so these are never called
+      static result<buffer_type> do_read(buffer_type out, buffer_type t, buffer_type /*unused*/) noexcept
+      {
+        if(t.size() < out.size())
+        {
+          out = buffer_type(out.data(), t.size());
+        }
+        memcpy(out.data(), t.data(), out.size());
+        return out;
+      }
+      static result<const_buffer_type> do_write(buffer_type t, buffer_type /*unused*/, const_buffer_type in) noexcept
+      {
+        memcpy(t.data(), in.data(), in.size());
+        return const_buffer_type(t.data(), in.size());
+      }
+      static result<const_buffers_type> adjust_written_buffers(const_buffers_type out, const_buffer_type /*unused*/, const_buffer_type /*unused*/) noexcept { return out; }
+
+      template <class Base> struct override_ : public Base
+      {
+        using path_type = typename Base::path_type;
+        using extent_type = typename Base::extent_type;
+        using size_type = typename Base::size_type;
+        using mode = typename Base::mode;
+        using creation = typename Base::creation;
+        using caching = typename Base::caching;
+        using flag = typename Base::flag;
+        using buffer_type = typename Base::buffer_type;
+        using const_buffer_type = typename Base::const_buffer_type;
+        using buffers_type = typename Base::buffers_type;
+        using const_buffers_type = typename Base::const_buffers_type;
+        template <class T> using io_request = typename Base::template io_request<T>;
+        template <class T> using io_result = typename Base::template io_result<T>;
+
+      protected:
+        std::unique_ptr<block_cache> _cache;
+
+        // Reads blocks [firstblock, firstblock + count) from the target into the cache, copying what
+        // intersects [offset, end) into out. Returns false if the end of the file was reached.
+        result<bool> _fill(extent_type firstblock, size_t count, extent_type offset, extent_type end, block_cache_scatter_cursor &out, deadline d) noexcept
+        {
+          const extent_type bs = _cache->block_size();
+          auto *slots = (buffer_type *) alloca(count * sizeof(buffer_type));
+          size_t reserved = 0;
+          for(; reserved < count; reserved++)
+          {
+            byte *p = _cache->reserve(firstblock + reserved);
+            if(p == nullptr)
+            {
+              break;
+            }
+            new(&slots[reserved]) buffer_type(p, (size_t) bs);
+          }
+          map_handle bypassh;
+          if(reserved == 0)
+          {
+            // Every slot is in flight elsewhere, so read this block into temporary memory instead
+            OUTCOME_TRY(auto &&mh, map_handle::map((size_type) bs));
+            bypassh = std::move(mh);
+            new(&slots[0]) buffer_type(bypassh.address(), (size_t) bs);
+            _cache->note_bypass(firstblock);
+            count = 1;
+          }
+          else
+          {
+            count = reserved;
+          }
+          // The target may replace the buffers in the request, so keep our own copy of the slots
+          auto *original = (buffer_type *) alloca(count * sizeof(buffer_type));
+          memcpy(original, slots, count * sizeof(buffer_type));
+          auto release_slots = make_scope_exit([&]() noexcept {
+            if(!bypassh.is_valid())
+            {
+              for(size_t n = 0; n < count; n++)
+              {
+                if(original[n].data() != nullptr)
+                {
+                  _cache->release(firstblock + n, original[n].data());
+                }
+              }
+            }
+          });
+          // Slots are block aligned, so this read meets any O_DIRECT alignment requirements
+          io_request<buffers_type> req({slots, count}, firstblock * bs);
+          OUTCOME_TRY(auto &&filled, this->_target->read(req, d));
+          // Some targets e.g. mapped_file_handle return their own buffers, so gather into the slots
+          size_t bytesread = 0;
+          {
+            size_t n = 0, o = 0;
+            for(const auto &b : filled)
+            {
+              const byte *src = b.data();
+              size_t remaining = b.size();
+              bytesread += remaining;
+              while(remaining > 0 && n < count)
+              {
+                const size_t tocopy = std::min(remaining, original[n].size() - o);
+                if(src != original[n].data() + o)
+                {
+                  memcpy(original[n].data() + o, src, tocopy);
+                }
+                src += tocopy;
+                remaining -= tocopy;
+                o += tocopy;
+                if(o == original[n].size())
+                {
+                  n++;
+                  o = 0;
+                }
+              }
+            }
+          }
+          for(size_t n = 0; n < count; n++)
+          {
+            const extent_type blockoffset = (firstblock + n) * bs;
+            const size_t valid = (bytesread > n * bs) ? (size_t) std::min(bs, (extent_type)(bytesread - n * bs)) : 0;
+            const extent_type from = std::max(offset, blockoffset), to = std::min(end, blockoffset + valid);
+            if(to > from)
+            {
+              out.copy_in(original[n].data() + (from - blockoffset), (size_t)(to - from));
+            }
+            if(valid == bs && !bypassh.is_valid())
+            {
+              // Only whole blocks are ever cached, a partial block at the end of the file is not
+              _cache->publish(firstblock + n, original[n].data());
+              original[n] = buffer_type();
+            }
+            if(valid < bs)
+            {
+              return false;
+            }
+          }
+          return true;
+        }
+
+      public:
+        override_() = default;
+        template <class A, class B>
+        override_(A *a, B *b, mode _mode, flag flags, io_multiplexer *ctx, size_t capacity = 64 * 1024 * 1024, size_t blocksize = 4096, size_t shards = 16)
+            : Base(a, b, _mode, flags, ctx)
+            , _cache(std::make_unique<block_cache>(capacity, blocksize, shards))
+        {
+        }
+
+        //! \brief The size of each cached block.
+        size_t block_size() const noexcept { return _cache ? _cache->block_size() : 0; }
+        //! \brief The number of bytes the cache can hold. Zero if the cache's memory could not be allocated.
+        size_t cache_capacity() const noexcept { return _cache ? _cache->capacity() : 0; }
+        //! \brief The statistics of the cache since construction or the last `reset_statistics()`.
+        block_cache_statistics statistics() const noexcept { return _cache ? _cache->statistics() : block_cache_statistics{}; }
+        //! \brief Resets the statistics of the cache to zero.
+        void reset_statistics() noexcept
+        {
+          if(_cache)
+          {
+            _cache->reset_statistics();
+          }
+        }
+        //! \brief Drops any cached blocks intersecting the extent. Use this after modifying the target without going through this adapter.
+        void invalidate(file_handle::extent_pair extent = {0, (extent_type) -1}) noexcept
+        {
+          if(!_cache || _cache->capacity() == 0 || extent.length == 0)
+          {
+            return;
+          }
+          const extent_type bs = _cache->block_size(), firstblock = extent.offset / bs;
+          if(extent.length >= (extent_type) -1 - extent.offset)
+          {
+            _cache->invalidate_from(firstblock);
+            return;
+          }
+          const extent_type lastblock = (extent.offset + extent.length + bs - 1) / bs;
+          if(lastblock - firstblock > _cache->capacity() / bs)
+          {
+            _cache->invalidate_from(firstblock);
+            return;
+          }
+          for(extent_type block = firstblock; block < lastblock; block++)
+          {
+            _cache->invalidate(block);
+          }
+        }
+
+        //! \brief Truncates the target, dropping any cached blocks beyond the new size.
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> truncate(extent_type newsize) noexcept override
+        {
+          OUTCOME_TRY(auto &&ret, this->_target->truncate(newsize));
+          if(_cache)
+          {
+            _cache->invalidate_from(newsize / _cache->block_size());
+          }
+          return ret;
+        }
+        //! \brief Zeroes the extent in the target, dropping any cached blocks intersecting it.
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> zero(file_handle::extent_pair extent, deadline d = deadline()) noexcept override
+        {
+          auto ret = this->_target->zero(extent, d);
+          invalidate(extent);
+          return ret;
+        }
+
+        //! \brief Returns the valid extents of the target.
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<std::vector<file_handle::extent_pair>> extents() const noexcept override { return this->_target->extents(); }
+
+      protected:
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<buffers_type> _do_read(io_request<buffers_type> reqs, deadline d = deadline()) noexcept override
+        {
+          if(!_cache || _cache->capacity() == 0)
+          {
+            return this->_target->read(reqs, d);
+          }
+          size_type bytes = 0;
+          for(const auto &b : reqs.buffers)
+          {
+            bytes += b.size();
+          }
+          const extent_type bs = _cache->block_size(), end = reqs.offset + bytes;
+          // Misses are read in runs limited by the target's scatter limit and a fraction of the cache
+          size_t maxrun = this->_target->max_buffers();
+          if(maxrun == 0 || maxrun > 64)
+          {
+            maxrun = 64;
+          }
+          maxrun = std::max((size_t) 1, std::min(maxrun, _cache->capacity() / (size_t) bs / 8));
+          block_cache_scatter_cursor out(reqs.buffers.data(), reqs.buffers.size());
+          extent_type block = reqs.offset / bs;
+          const extent_type lastblock = (end + bs - 1) / bs;
+          while(block < lastblock)
+          {
+            const extent_type blockoffset = block * bs;
+            const extent_type from = std::max(reqs.offset, blockoffset), to = std::min(end, blockoffset + bs);
+            if(_cache->lookup(block, (size_t)(from - blockoffset), (size_t)(to - from), out))
+            {
+              block++;
+              continue;
+            }
+            // Gather the run of consecutive missing blocks
+            size_t run = 1;
+            while(run < maxrun && block + run < lastblock && !_cache->contains(block + run))
+            {
+              run++;
+            }
+            OUTCOME_TRY(auto &&more, _fill(block, run, reqs.offset, end, out, d));
+            if(!more)
+            {
+              break;
+            }
+            // If some of the run was bypassed, resume from where the copy got to
+            block = (reqs.offset + out.copied) / bs;
+          }
+          // Shrink the buffers to what was filled
+          size_t copied = out.copied;
+          for(auto &b : reqs.buffers)
+          {
+            const size_t len = std::min(b.size(), copied);
+            b = buffer_type(b.data(), len);
+            copied -= len;
+          }
+          return std::move(reqs.buffers);
+        }
+
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<const_buffers_type> _do_write(io_request<const_buffers_type> reqs, deadline d = deadline()) noexcept override
+        {
+          const extent_type offset = reqs.offset;
+          OUTCOME_TRY(auto &&written, this->_target->write(reqs, d));
+          if(!_cache || _cache->capacity() == 0)
+          {
+            return std::move(written);
+          }
+          const extent_type bs = _cache->block_size();
+          extent_type pos = offset;
+          for(const auto &b : written)
+          {
+            if(b.size() == 0)
+            {
+              continue;
+            }
+            // Cached blocks this buffer intersects are updated in place
+            const extent_type end = pos + b.size();
+            for(extent_type block = pos / bs; block < (end + bs - 1) / bs; block++)
+            {
+              const extent_type blockoffset = block * bs;
+              const extent_type from = std::max(pos, blockoffset), to = std::min(end, blockoffset + bs);
+              _cache->update(block, (size_t)(from - blockoffset), b.data() + (from - pos), (size_t)(to - from));
+            }
+            pos = end;
+          }
+          return std::move(written);
+        }
+      };
+    };
+  }  // namespace detail
+
+  /*! \brief A handle adapter keeping a userspace cache of recently read blocks of a target file handle.
+  \tparam Target The type of the target handle, which must be a `file_handle`.
+  \tparam Source Must be `void`.
+
+  This is intended for use with targets opened with `caching::none`, which bypass the kernel page
+  cache, where a small hot block cache with a policy you control is still wanted. Cached blocks
+  live in a single `map_handle` allocated arena, so every cache slot is aligned to the block size.
+  The block size (default 4Kb, rounded up to a power of two of at least 4Kb), capacity (default
+  64Mb) and number of lock stripes (default 16) are extra constructor arguments.
+
+  Blocks are distributed over the lock stripes by block number, so concurrent readers of
+  different blocks rarely contend. Each stripe evicts using S3-FIFO: newly read blocks enter a
+  small FIFO of about a tenth of the stripe, and are only promoted into the main FIFO if read again
+  before reaching its head. Blocks evicted from the small FIFO are remembered in a ghost FIFO, and
+  are admitted straight into the main FIFO if read again soon. This makes the cache resistant to
+  large sequential scans flushing out the hot set.
+
+  Reads copy what is cached, and read each run of missing blocks with a single scatter read
+  directly into reserved cache slots at block aligned offsets, so misses meet O_DIRECT alignment
+  requirements whatever the alignment of the caller's buffers. Only whole blocks are cached, a
+  partial block at the end of the file is read through every time. Writes are written through
+  directly to the target using the caller's buffers, and then update any cached blocks they
+  intersect. `truncate()` and `zero()` drop the affected
+  blocks. If the target is modified other than through this adapter, call `invalidate()`.
+
+  If the memory for the cache cannot be allocated, all i/o passes straight through.
+  */
+  template <class Target, class Source = void> using block_cache_handle_adapter = combining_handle_adapter<detail::block_cache_handle_adapter_op, Target, Source>;
+
+  // BEGIN make_free_functions.py
+
+  // END make_free_functions.py
+
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
+
+#if LLFIO_HEADERS_ONLY == 1 && !defined(DOXYGEN_SHOULD_SKIP_THIS)
+#define LLFIO_INCLUDED_BY_HEADER 1
+#include "../../detail/impl/block_cache.ipp"
+#undef LLFIO_INCLUDED_BY_HEADER
+#endif
+
+#endif
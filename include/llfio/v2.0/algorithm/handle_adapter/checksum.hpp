@@ -0,0 +1,692 @@
+/* A handle which maintains per-block checksums of another handle
+(C) 2026 agent <agent@local> (3 commits)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#ifndef LLFIO_ALGORITHM_HANDLE_ADAPTER_CHECKSUM_H
+#define LLFIO_ALGORITHM_HANDLE_ADAPTER_CHECKSUM_H
+
+#include "combining.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <nmmintrin.h>  // for _mm_crc32_*
+#ifdef _MSC_VER
+#include <intrin.h>  // for __cpuid
+#endif
+#define LLFIO_CRC32C_HAVE_SSE42 1
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>  // for __crc32c*
+#define LLFIO_CRC32C_HAVE_ARM_CRC32 1
+#endif
+
+//! \file handle_adapter/checksum.hpp Provides `checksum_handle_adapter`.
+
+LLFIO_V2_NAMESPACE_EXPORT_BEGIN
+
+namespace algorithm
+{
+  namespace detail
+  {
+    // Castagnoli polynomial, reflected
+    static constexpr uint32_t crc32c_polynomial = 0x82f63b78;
+
+    // Slicing-by-8 tables for the software fallback
+    struct crc32c_tables
+    {
+      uint32_t table[8][256];
+      crc32c_tables() noexcept
+      {
+        for(uint32_t n = 0; n < 256; n++)
+        {
+          uint32_t crc = n;
+          for(int k = 0; k < 8; k++)
+          {
+            crc = (crc & 1) ? ((crc >> 1) ^ crc32c_polynomial) : (crc >> 1);
+          }
+          table[0][n] = crc;
+        }
+        for(uint32_t n = 0; n < 256; n++)
+        {
+          for(size_t k = 1; k < 8; k++)
+          {
+            table[k][n] = (table[k - 1][n] >> 8) ^ table[0][table[k - 1][n] & 0xff];
+          }
+        }
+      }
+      static const crc32c_tables &get() noexcept
+      {
+        static const crc32c_tables v;
+        return v;
+      }
+    };
+    inline uint32_t crc32c_software(uint32_t crc, const byte *data, size_t bytes) noexcept
+    {
+      const auto &t = crc32c_tables::get().table;
+      auto *p = reinterpret_cast<const uint8_t *>(data);
+      crc = ~crc;
+      while(bytes > 0 && ((uintptr_t) p & 7) != 0)
+      {
+        crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xff];
+        bytes--;
+      }
+      while(bytes >= 8)
+      {
+        // Little endian assembly of the next eight bytes so this works on any host
+        const uint32_t lo = crc ^ ((uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24));
+        crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^ t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^ t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+        p += 8;
+        bytes -= 8;
+      }
+      while(bytes > 0)
+      {
+        crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xff];
+        bytes--;
+      }
+      return ~crc;
+    }
+#if LLFIO_CRC32C_HAVE_SSE42
+#if defined(__GNUC__) || defined(__clang__)
+    __attribute__((target("sse4.2")))
+#endif
+    inline uint32_t
+    crc32c_sse42(uint32_t crc, const byte *data, size_t bytes) noexcept
+    {
+      auto *p = reinterpret_cast<const uint8_t *>(data);
+      crc = ~crc;
+      while(bytes > 0 && ((uintptr_t) p & 7) != 0)
+      {
+        crc = _mm_crc32_u8(crc, *p++);
+        bytes--;
+      }
+#if defined(__x86_64__) || defined(_M_X64)
+      uint64_t crc64 = crc;
+      while(bytes >= 32)
+      {
+        uint64_t v[4];
+        memcpy(v, p, 32);
+        crc64 = _mm_crc32_u64(crc64, v[0]);
+        crc64 = _mm_crc32_u64(crc64, v[1]);
+        crc64 = _mm_crc32_u64(crc64, v[2]);
+        crc64 = _mm_crc32_u64(crc64, v[3]);
+        p += 32;
+        bytes -= 32;
+      }
+      while(bytes >= 8)
+      {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        crc64 = _mm_crc32_u64(crc64, v);
+        p += 8;
+        bytes -= 8;
+      }
+      crc = (uint32_t) crc64;
+#endif
+      while(bytes >= 4)
+      {
+        uint32_t v;
+        memcpy(&v, p, 4);
+        crc = _mm_crc32_u32(crc, v);
+        p += 4;
+        bytes -= 4;
+      }
+      while(bytes > 0)
+      {
+        crc = _mm_crc32_u8(crc, *p++);
+        bytes--;
+      }
+      return ~crc;
+    }
+    inline bool crc32c_have_sse42() noexcept
+    {
+      static const bool v = []() -> bool {
+#ifdef _MSC_VER
+        int cpuInfo[4];
+        __cpuid(cpuInfo, 1);
+        return (cpuInfo[2] & (1 << 20)) != 0;
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("sse4.2") != 0;
+#endif
+      }();
+      return v;
+    }
+#elif LLFIO_CRC32C_HAVE_ARM_CRC32
+    inline uint32_t crc32c_arm(uint32_t crc, const byte *data, size_t bytes) noexcept
+    {
+      auto *p = reinterpret_cast<const uint8_t *>(data);
+      crc = ~crc;
+      while(bytes > 0 && ((uintptr_t) p & 7) != 0)
+      {
+        crc = __crc32cb(crc, *p++);
+        bytes--;
+      }
+      while(bytes >= 8)
+      {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        crc = __crc32cd(crc, v);
+        p += 8;
+        bytes -= 8;
+      }
+      while(bytes > 0)
+      {
+        crc = __crc32cb(crc, *p++);
+        bytes--;
+      }
+      return ~crc;
+    }
+#endif
+  }  // namespace detail
+
+  /*! \brief Continues a CRC32C (Castagnoli) checksum `crc` over `bytes` of `data`, returning
+  the new checksum. Pass zero as `crc` to begin a new checksum.
+
+  Uses the SSE4.2 `crc32` instruction on x86 if the CPU has it (detected at runtime), the ARMv8
+  CRC32 extension on ARM if the compiler targets it, else a slicing-by-8 table implementation.
+  */
+  inline uint32_t crc32c(uint32_t crc, const byte *data, size_t bytes) noexcept
+  {
+#if LLFIO_CRC32C_HAVE_SSE42
+    if(detail::crc32c_have_sse42())
+    {
+      return detail::crc32c_sse42(crc, data, bytes);
+    }
+#elif LLFIO_CRC32C_HAVE_ARM_CRC32
+    return detail::crc32c_arm(crc, data, bytes);
+#endif
+    return detail::crc32c_software(crc, data, bytes);
+  }
+
+  namespace detail
+  {
+    // Continues a CRC32C over `bytes` of all bits zero
+    inline uint32_t crc32c_zeros(uint32_t crc, size_t bytes) noexcept
+    {
+      static const byte zeros[4096]{};
+      while(bytes > 0)
+      {
+        const size_t togo = (bytes < sizeof(zeros)) ? bytes : sizeof(zeros);
+        crc = crc32c(crc, zeros, togo);
+        bytes -= togo;
+      }
+      return crc;
+    }
+
+    // Accumulates a CRC32C per block across a sequence of scatter-gather buffers. Any
+    // trailing partial block is checksummed as if padded with zeros to the block size.
+    class crc32c_block_stream
+    {
+      size_t _blocksize{0}, _inblock{0};
+      uint32_t _crc{0};
+
+    public:
+      explicit crc32c_block_stream(size_t blocksize)
+          : _blocksize(blocksize)
+      {
+      }
+      // Calls f(crc) for every block completed
+      template <class F> result<void> feed(const byte *data, size_t bytes, F &&f) noexcept
+      {
+        while(bytes > 0)
+        {
+          const size_t togo = (bytes < _blocksize - _inblock) ? bytes : (_blocksize - _inblock);
+          _crc = crc32c(_crc, data, togo);
+          data += togo;
+          bytes -= togo;
+          _inblock += togo;
+          if(_inblock == _blocksize)
+          {
+            OUTCOME_TRY(f(_crc));
+            _crc = 0;
+            _inblock = 0;
+          }
+        }
+        return success();
+      }
+      // Calls f(crc) for any trailing partial block
+      template <class F> result<void> finish(F &&f) noexcept
+      {
+        if(_inblock > 0)
+        {
+          OUTCOME_TRY(f(crc32c_zeros(_crc, _blocksize - _inblock)));
+          _crc = 0;
+          _inblock = 0;
+        }
+        return success();
+      }
+    };
+
+    template <class T> inline size_t buffers_bytes(const T &buffers) noexcept
+    {
+      size_t ret = 0;
+      for(const auto &b : buffers)
+      {
+        ret += b.size();
+      }
+      return ret;
+    }
+    inline uint32_t checksum_load(const byte *p) noexcept
+    {
+      auto *_p = reinterpret_cast<const uint8_t *>(p);
+      return (uint32_t) _p[0] | ((uint32_t) _p[1] << 8) | ((uint32_t) _p[2] << 16) | ((uint32_t) _p[3] << 24);
+    }
+    inline void checksum_store(byte *p, uint32_t v) noexcept
+    {
+      auto *_p = reinterpret_cast<uint8_t *>(p);
+      _p[0] = (uint8_t) v;
+      _p[1] = (uint8_t) (v >> 8);
+      _p[2] = (uint8_t) (v >> 16);
+      _p[3] = (uint8_t) (v >> 24);
+    }
+
+    template <class Target, class Source> struct checksum_handle_adapter_op
+    {
+      static_assert(!std::is_void<Source>::value, "A second handle to store the checksums into is required with checksum_handle_adapter");
+      static_assert(std::is_base_of<file_handle, Target>::value && std::is_base_of<file_handle, Source>::value, "checksum_handle_adapter requires both handles to be file handles");
+
+      using buffer_type = typename Target::buffer_type;
+      using const_buffer_type = typename Target::const_buffer_type;
+      using const_buffers_type = typename Target::const_buffers_type;
+
+      // The default read() and write() are replaced in override_, so these are never called
+      static result<buffer_type> do_read(buffer_type out, buffer_type t, buffer_type /*unused*/) noexcept
+      {
+        if(t.size() < out.size())
+        {
+          out = buffer_type(out.data(), t.size());
+        }
+        memcpy(out.data(), t.data(), out.size());
+        return out;
+      }
+      static result<const_buffer_type> do_write(buffer_type t, buffer_type /*unused*/, const_buffer_type in) noexcept
+      {
+        memcpy(t.data(), in.data(), in.size());
+        return const_buffer_type(t.data(), in.size());
+      }
+      static result<const_buffers_type> adjust_written_buffers(const_buffers_type out, const_buffer_type /*unused*/, const_buffer_type /*unused*/) noexcept { return out; }
+
+      template <class Base> struct override_ : public Base
+      {
+        using path_type = typename Base::path_type;
+        using extent_type = typename Base::extent_type;
+        using size_type = typename Base::size_type;
+        using mode = typename Base::mode;
+        using creation = typename Base::creation;
+        using caching = typename Base::caching;
+        using flag = typename Base::flag;
+        using buffer_type = typename Base::buffer_type;
+        using const_buffer_type = typename Base::const_buffer_type;
+        using buffers_type = typename Base::buffers_type;
+        using const_buffers_type = typename Base::const_buffers_type;
+        template <class T> using io_request = typename Base::template io_request<T>;
+        template <class T> using io_result = typename Base::template io_result<T>;
+
+        //! The size of one stored checksum.
+        static constexpr size_t checksum_size = sizeof(uint32_t);
+
+      protected:
+        size_t _blocksize{4096};
+
+        // Temporary memory, on the stack if not more than a page, else from the kernel
+        struct _temp_memory
+        {
+          map_handle mh;
+          byte *p{nullptr};
+        };
+        static result<void> _allocate_temp(_temp_memory &out, size_t bytes, byte *stack) noexcept
+        {
+          if(stack != nullptr)
+          {
+            out.p = (byte *) (((uintptr_t) stack + 63) & ~63);
+            return success();
+          }
+          OUTCOME_TRY(auto &&mh, map_handle::map(bytes));
+          out.mh = std::move(mh);
+          out.p = out.mh.address();
+          return success();
+        }
+
+        // Writes the checksums for the blocks from firstblock, extending the checksums handle if necessary
+        result<void> _write_checksums(extent_type firstblock, const byte *checksums, size_t count, deadline d) noexcept
+        {
+          const_buffer_type b(checksums, count * checksum_size);
+          OUTCOME_TRY(auto &&written, this->_source->write({{&b, 1}, firstblock * checksum_size}, d));
+          const size_t bytes = buffers_bytes(written);
+          if(bytes < b.size())
+          {
+            // Some handles e.g. mapped_file_handle do not auto-extend on write
+            OUTCOME_TRY(this->_source->truncate((firstblock + count) * checksum_size));
+            b = const_buffer_type(checksums + bytes, b.size() - bytes);
+            OUTCOME_TRY(auto &&written2, this->_source->write({{&b, 1}, firstblock * checksum_size + bytes}, d));
+            if(buffers_bytes(written2) < b.size())
+            {
+              return errc::no_space_on_device;
+            }
+          }
+          return success();
+        }
+
+        // Verifies a stored checksum against a calculated one. Blocks never written have a stored checksum of zero.
+        result<void> _verify(uint32_t stored, uint32_t calculated) const noexcept
+        {
+          if(stored == calculated)
+          {
+            return success();
+          }
+          if(stored == 0 && calculated == crc32c_zeros(0, _blocksize))
+          {
+            return success();
+          }
+          return errc::illegal_byte_sequence;
+        }
+
+      public:
+        override_() = default;
+        template <class A, class B>
+        override_(A *a, B *b, mode _mode, flag flags, io_multiplexer *ctx, size_t blocksize = 4096)
+            : Base(a, b, _mode, flags, ctx)
+            , _blocksize((blocksize == 0) ? 4096 : blocksize)
+        {
+        }
+
+        //! \brief The number of bytes covered by each checksum.
+        size_t block_size() const noexcept { return _blocksize; }
+
+        /*! \brief Recalculates and stores the checksums for all blocks intersecting the extent,
+        without verifying what was stored previously. Use this to adopt existing data, or after
+        modifying the target handle without going through this adapter.
+        */
+        result<void> rebuild_checksums(file_handle::extent_pair extent = {0, (extent_type) -1}, deadline d = deadline()) noexcept
+        {
+          OUTCOME_TRY(auto &&maxextent, this->_target->maximum_extent());
+          if(extent.offset >= maxextent)
+          {
+            return success();
+          }
+          if(extent.length > maxextent - extent.offset)
+          {
+            extent.length = maxextent - extent.offset;
+          }
+          const extent_type bs = _blocksize;
+          const extent_type firstblock = extent.offset / bs, lastblock = (extent.offset + extent.length + bs - 1) / bs;
+          // Process up to a megabyte or one block at a time, whichever is bigger
+          const extent_type blocksperchunk = (bs >= 1024 * 1024) ? 1 : ((1024 * 1024) / bs);
+          OUTCOME_TRY(auto &&mh, map_handle::map(utils::round_up_to_page_size((size_t)(blocksperchunk * bs + blocksperchunk * checksum_size), utils::page_size())));
+          byte *checksums = mh.address() + blocksperchunk * bs;
+          for(extent_type block = firstblock; block < lastblock; block += blocksperchunk)
+          {
+            const size_t blocks = (size_t) std::min(blocksperchunk, lastblock - block);
+            buffer_type b(mh.address(), blocks * bs);
+            OUTCOME_TRY(auto &&filled, this->_target->read({{&b, 1}, block * bs}, d));
+            size_t count = 0;
+            crc32c_block_stream s(bs);
+            auto store = [&](uint32_t crc) -> result<void> {
+              checksum_store(checksums + count++ * checksum_size, crc);
+              return success();
+            };
+            for(auto &i : filled)
+            {
+              OUTCOME_TRY(s.feed(i.data(), i.size(), store));
+            }
+            OUTCOME_TRY(s.finish(store));
+            OUTCOME_TRY(_write_checksums(block, checksums, count, d));
+            if(count < blocks)
+            {
+              break;
+            }
+          }
+          return success();
+        }
+
+        //! \brief Return the maximum extent of the target handle.
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> maximum_extent() const noexcept override { return this->_target->maximum_extent(); }
+        //! \brief Truncate the target handle, and resize the checksums to match.
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> truncate(extent_type newsize) noexcept override
+        {
+          OUTCOME_TRY(auto &&ret, this->_target->truncate(newsize));
+          const extent_type bs = _blocksize;
+          OUTCOME_TRY(this->_source->truncate((newsize + bs - 1) / bs * checksum_size));
+          if(newsize % bs != 0)
+          {
+            // Any content after newsize in the final block is now gone
+            OUTCOME_TRY(rebuild_checksums({newsize - 1, 1}));
+          }
+          return ret;
+        }
+        //! \brief Return the valid extents of the target handle.
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<std::vector<file_handle::extent_pair>> extents() const noexcept override { return this->_target->extents(); }
+        //! \brief Punches a hole in the target handle, and updates the checksums to match.
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> zero(file_handle::extent_pair extent, deadline d = deadline()) noexcept override
+        {
+          OUTCOME_TRY(auto &&ret, this->_target->zero(extent, d));
+          OUTCOME_TRY(rebuild_checksums(extent, d));
+          return ret;
+        }
+
+      protected:
+        //! \brief Return the target's maximum buffers, less two for the partial block at either end.
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC size_t _do_max_buffers() const noexcept override
+        {
+          auto r = this->_target->max_buffers();
+          return (r > 3) ? (r - 2) : 1;
+        }
+
+        /*! Read the checksums for all blocks intersecting the request, then read the request
+        plus any partial blocks at either end in a single scatter read from the target, verifying
+        checksums across the scatter buffers as they are walked. Fails with
+        `errc::illegal_byte_sequence` if any block does not match its checksum.
+        */
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<buffers_type> _do_read(io_request<buffers_type> reqs, deadline d = deadline()) noexcept override
+        {
+          size_type bytes = 0;
+          for(const auto &b : reqs.buffers)
+          {
+            bytes += b.size();
+          }
+          if(bytes == 0)
+          {
+            return this->_target->read(reqs, d);
+          }
+          const extent_type bs = _blocksize;
+          const extent_type firstblock = reqs.offset / bs, lastblock = (reqs.offset + bytes + bs - 1) / bs;
+          const size_t head = (size_t)(reqs.offset - firstblock * bs), tail = (size_t)(lastblock * bs - (reqs.offset + bytes));
+          const size_t blocks = (size_t)(lastblock - firstblock);
+          const size_t tempbytes = head + tail + blocks * checksum_size;
+          _temp_memory temp;
+          OUTCOME_TRY(_allocate_temp(temp, tempbytes, (tempbytes <= utils::page_size()) ? (byte *) alloca(tempbytes + 64) : nullptr));
+
+          // Fetch the stored checksums
+          buffer_type csb(temp.p + head + tail, blocks * checksum_size);
+          OUTCOME_TRY(auto &&csread, this->_source->read({{&csb, 1}, firstblock * checksum_size}, d));
+          const size_t storedcount = buffers_bytes(csread) / checksum_size;
+          const byte *stored = csread.empty() ? csb.data() : csread[0].data();
+
+          // Scatter read the partial head block, the request and the partial tail block
+          auto *scatter = (buffer_type *) alloca(sizeof(buffer_type) * (reqs.buffers.size() + 2));
+          size_t count = 0;
+          if(head > 0)
+          {
+            scatter[count++] = buffer_type(temp.p, head);
+          }
+          for(auto &b : reqs.buffers)
+          {
+            scatter[count++] = b;
+          }
+          if(tail > 0)
+          {
+            scatter[count++] = buffer_type(temp.p + head, tail);
+          }
+          OUTCOME_TRY(auto &&filled, this->_target->read({{scatter, count}, firstblock * bs}, d));
+
+          // Verify
+          size_t block = 0;
+          crc32c_block_stream s(bs);
+          auto verify = [&](uint32_t crc) -> result<void> {
+            const uint32_t expected = (block < storedcount) ? checksum_load(stored + block * checksum_size) : 0;
+            block++;
+            return _verify(expected, crc);
+          };
+          for(auto &b : filled)
+          {
+            OUTCOME_TRY(s.feed(b.data(), b.size(), verify));
+          }
+          OUTCOME_TRY(s.finish(verify));
+
+          // Return the buffers of the request, which on a short read are fewer and the last shorter
+          const size_t skip = (head > 0);
+          if(skip && (filled.empty() || filled[0].size() < head))
+          {
+            return buffers_type{reqs.buffers.data(), 0};
+          }
+          for(size_t n = 0; n < reqs.buffers.size(); n++)
+          {
+            if(n + skip >= filled.size())
+            {
+              reqs.buffers = {reqs.buffers.data(), n};
+              break;
+            }
+            const size_t requested = reqs.buffers[n].size();
+            reqs.buffers[n] = filled[n + skip];
+            if(reqs.buffers[n].size() < requested)
+            {
+              reqs.buffers = {reqs.buffers.data(), n + 1};
+              break;
+            }
+          }
+          return std::move(reqs.buffers);
+        }
+
+        /*! Read and verify any partial blocks at either end of the request, write the request
+        to the target, then calculate and write the checksums of every block touched.
+        */
+        LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<const_buffers_type> _do_write(io_request<const_buffers_type> reqs, deadline d = deadline()) noexcept override
+        {
+          size_type bytes = 0;
+          for(const auto &b : reqs.buffers)
+          {
+            bytes += b.size();
+          }
+          if(bytes == 0)
+          {
+            return this->_target->write(reqs, d);
+          }
+          const extent_type bs = _blocksize;
+          const extent_type firstblock = reqs.offset / bs, lastblock = (reqs.offset + bytes + bs - 1) / bs;
+          const size_t head = (size_t)(reqs.offset - firstblock * bs), tail = (size_t)(lastblock * bs - (reqs.offset + bytes));
+          const size_t blocks = (size_t)(lastblock - firstblock);
+          const bool readhead = (head > 0), readtail = (tail > 0) && (!readhead || blocks > 1);
+          const size_t tempbytes = (readhead + readtail) * bs + blocks * checksum_size;
+          _temp_memory temp;
+          OUTCOME_TRY(_allocate_temp(temp, tempbytes, (tempbytes <= utils::page_size()) ? (byte *) alloca(tempbytes + 64) : nullptr));
+          byte *headblock = temp.p, *tailblock = temp.p + readhead * bs, *checksums = temp.p + (readhead + readtail) * bs;
+
+          // Read and verify the existing content of partially overwritten blocks. Content
+          // beyond the end of the file is zero.
+          auto fetch_block = [&](byte *out, extent_type block) -> result<void> {
+            buffer_type b(out, bs);
+            OUTCOME_TRY(auto &&filled, _do_read({{&b, 1}, block * bs}, d));
+            const size_t valid = buffers_bytes(filled);
+            if(valid > 0 && filled[0].data() != out)
+            {
+              memmove(out, filled[0].data(), valid);
+            }
+            memset(out + valid, 0, bs - valid);
+            return success();
+          };
+          if(readhead)
+          {
+            OUTCOME_TRY(fetch_block(headblock, firstblock));
+          }
+          if(readtail)
+          {
+            OUTCOME_TRY(fetch_block(tailblock, lastblock - 1));
+          }
+          else if(readhead && blocks == 1)
+          {
+            tailblock = headblock;
+          }
+
+          OUTCOME_TRY(auto &&written, this->_target->write(reqs, d));
+          if(buffers_bytes(written) < bytes)
+          {
+            // Short write, so recalculate from what is now in the file
+            OUTCOME_TRY(rebuild_checksums({firstblock * bs, (lastblock - firstblock) * bs}, d));
+            return std::move(written);
+          }
+
+          // Calculate the new checksums
+          size_t count = 0;
+          crc32c_block_stream s(bs);
+          auto store = [&](uint32_t crc) -> result<void> {
+            checksum_store(checksums + count++ * checksum_size, crc);
+            return success();
+          };
+          OUTCOME_TRY(s.feed(headblock, head, store));
+          for(auto &b : reqs.buffers)
+          {
+            OUTCOME_TRY(s.feed(b.data(), b.size(), store));
+          }
+          OUTCOME_TRY(s.feed(tailblock + (bs - tail), tail, store));
+          OUTCOME_TRY(s.finish(store));
+          OUTCOME_TRY(_write_checksums(firstblock, checksums, count, d));
+          return std::move(written);
+        }
+      };
+    };
+  }  // namespace detail
+
+  /*! \brief A handle maintaining a CRC32C checksum per block of a target handle in a second handle.
+  \tparam Target The type of the target handle, which holds the data.
+  \tparam Source The type of the handle into which the checksums are stored, one `uint32_t` little
+  endian per block, the checksum for block `n` being at offset `n * 4`.
+
+  The block size defaults to 4Kb, and can be set as an extra constructor argument. A partial
+  final block is checksummed as if padded with zeros to the block size, so extending the target
+  does not invalidate its checksum. Every read
+  fetches the checksums of all blocks intersecting the request, and issues a single scatter read
+  to the target of the request plus the partial blocks at either end, verifying each block as the
+  scatter buffers are walked. There is no separate checksumming pass over the data. If a block
+  does not match its checksum, the read fails with `errc::illegal_byte_sequence`. A stored checksum
+  of zero means the block was never written, and matches a block of all bits zero.
+
+  Every write reads and verifies the partial blocks at either end of the request, writes the
+  request to the target, and then writes the new checksums of every block touched. The checksums
+  are written after the data, so a sudden power loss may leave a block which fails verification.
+  `truncate()` and `zero()` update the checksums to match. `rebuild_checksums()` can be used to
+  adopt existing data.
+
+  CRC32C is calculated using the SSE4.2 `crc32` instruction where available, else a table based
+  implementation. See `algorithm::crc32c()`.
+
+  \warning Concurrent overlapping writes to the same block will race on the checksum.
+  */
+  template <class Target, class Source> using checksum_handle_adapter = combining_handle_adapter<detail::checksum_handle_adapter_op, Target, Source>;
+
+  // BEGIN make_free_functions.py
+
+  // END make_free_functions.py
+
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
+
+#endif
@@ -83,7 +83,8 @@ namespace algorithm
 
     protected:
       static constexpr bool _have_source = !std::is_void<source_handle_type>::value;
-      using _source_handle_type = std::conditional_t<!_have_source, io_handle, source_handle_type>;
+      // If there is no source, pretend it is the same type as the target so the file_handle member functions compile
+      using _source_handle_type = std::conditional_t<!_have_source, target_handle_type, source_handle_type>;
 
       target_handle_type *_target{nullptr};
       _source_handle_type *_source{nullptr};
@@ -122,7 +123,7 @@ namespace algorithm
       {
       }
       combining_handle_adapter_base(target_handle_type *a, void *b, mode _mode, flag flags, io_multiplexer *ctx)
-          : Base(_native_handle(_mode), a->caching(), flags, ctx)
+          : Base(_native_handle(_mode), a->kernel_caching(), flags, ctx)
           , _target(a)
           , _source(reinterpret_cast<_source_handle_type *>(b))
       {
@@ -0,0 +1,661 @@
+/* A handle which stripes i/o across many other handles
+(C) 2026 agent <agent@local> (4 commits)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#ifndef LLFIO_ALGORITHM_HANDLE_ADAPTER_STRIPED_H
+#define LLFIO_ALGORITHM_HANDLE_ADAPTER_STRIPED_H
+
+#include "combining.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+//! \file handle_adapter/striped.hpp Provides `striped_handle_adapter`.
+
+LLFIO_V2_NAMESPACE_EXPORT_BEGIN
+
+namespace algorithm
+{
+  /*! \class striped_handle_adapter
+  \brief A handle presenting many member file handles as one, with consecutive stripes
+  of the logical file placed round robin onto each member in turn.
+  \tparam Member The type of the member handles.
+
+  Stripe `n` of the logical file, being the bytes `[n * stripe_size, (n + 1) * stripe_size)`,
+  lives in member `n % members` at offset `(n / members) * stripe_size`. This is the
+  traditional RAID0 layout.
+
+  Each `read()` or `write()` is split into one sub-request per member, each sub-request being
+  a single contiguous extent of that member with a scatter-gather list pointing straight into
+  the buffers supplied, so there is no copying of data. Members which have an i/o multiplexer set
+  have their sub-requests initiated concurrently through their multiplexer. Members without a
+  multiplexer are issued synchronously, concurrently if OpenMP is available,
+  `LLFIO_DISABLE_OPENMP` is not defined, and `flag::disable_parallelism` is not set.
+
+  If a request would require more scatter-gather buffers for any member than its `max_buffers()`,
+  the request is truncated at that point, and fewer bytes are transferred than requested. If a
+  member transfers fewer bytes than asked (e.g. its end of file was reached), the bytes transferred
+  reported are those contiguous from the start of the request.
+
+  Per member statistics of bytes transferred and time spent are kept, so imbalance between
+  the members can be seen. See `statistics()`.
+
+  Byte range locks are taken on the first member, using logical offsets. Barriers are applied
+  to the whole of every member. `extents()` is not supported.
+
+  Destroying the adapter does not destroy the member handles. Closing the adapter
+  does close the member handles.
+  */
+  template <class Member = file_handle> class striped_handle_adapter : public detail::file_handle_wrapper
+  {
+    static_assert(std::is_base_of<file_handle, Member>::value, "striped_handle_adapter requires member handles to be file handles");
+    using _base = detail::file_handle_wrapper;
+
+  public:
+    using path_type = io_handle::path_type;
+    using extent_type = io_handle::extent_type;
+    using size_type = io_handle::size_type;
+    using mode = io_handle::mode;
+    using creation = io_handle::creation;
+    using caching = io_handle::caching;
+    using flag = io_handle::flag;
+    using buffer_type = io_handle::buffer_type;
+    using const_buffer_type = io_handle::const_buffer_type;
+    using buffers_type = io_handle::buffers_type;
+    using const_buffers_type = io_handle::const_buffers_type;
+    template <class T> using io_request = io_handle::io_request<T>;
+    template <class T> using io_result = io_handle::io_result<T>;
+
+    using member_handle_type = Member;
+
+    //! \brief A snapshot of the i/o performed on one member of the stripe set.
+    struct member_statistics
+    {
+      uint64_t reads{0};                         //!< The number of read sub-requests issued
+      uint64_t writes{0};                        //!< The number of write sub-requests issued
+      uint64_t bytes_read{0};                    //!< The number of bytes read
+      uint64_t bytes_written{0};                 //!< The number of bytes written
+      std::chrono::nanoseconds read_time{0};   //!< Total time from issue to completion of reads
+      std::chrono::nanoseconds write_time{0};  //!< Total time from issue to completion of writes
+
+      //! Bytes per second read, during the time spent reading
+      double read_throughput() const noexcept { return (read_time.count() > 0) ? ((double) bytes_read * 1000000000.0 / (double) read_time.count()) : 0.0; }
+      //! Bytes per second written, during the time spent writing
+      double write_throughput() const noexcept { return (write_time.count() > 0) ? ((double) bytes_written * 1000000000.0 / (double) write_time.count()) : 0.0; }
+    };
+
+  protected:
+    struct _member
+    {
+      member_handle_type *h{nullptr};
+      std::atomic<uint64_t> reads{0}, writes{0}, bytes_read{0}, bytes_written{0}, read_ns{0}, write_ns{0};
+    };
+    std::unique_ptr<_member[]> _members;
+    size_t _count{0};
+    extent_type _stripe_size{65536};
+
+  private:
+    static constexpr native_handle_type _native_handle(mode _mode)
+    {
+      native_handle_type nativeh;
+      nativeh.behaviour |= native_handle_type::disposition::file;
+      nativeh.behaviour |= native_handle_type::disposition::seekable | native_handle_type::disposition::readable;
+      if(_mode == mode::write)
+      {
+        nativeh.behaviour |= native_handle_type::disposition::writable;
+      }
+      return nativeh;
+    }
+    static caching _combine_caching(span<member_handle_type *const> members)
+    {
+      if(members.empty())
+      {
+        return caching::none;
+      }
+      caching least = members[0]->kernel_caching();
+      for(auto *h : members)
+      {
+        if(h->kernel_caching() < least)
+        {
+          least = h->kernel_caching();
+        }
+      }
+      return least;
+    }
+
+    // The number of bytes of member m within the logical extent [0, x)
+    extent_type _member_bytes_before(size_t m, extent_type x) const noexcept
+    {
+      const extent_type round = _stripe_size * _count;
+      const extent_type rem = x % round, mstart = m * _stripe_size;
+      extent_type ret = (x / round) * _stripe_size;
+      if(rem > mstart)
+      {
+        ret += std::min(rem - mstart, _stripe_size);
+      }
+      return ret;
+    }
+    // The logical extent implied by member m having y bytes
+    extent_type _logical_extent(size_t m, extent_type y) const noexcept
+    {
+      if(y == 0)
+      {
+        return 0;
+      }
+      const extent_type stripe = (y - 1) / _stripe_size, offset = (y - 1) % _stripe_size;
+      return (stripe * _count + m) * _stripe_size + offset + 1;
+    }
+
+    static io_result<buffers_type> _sync_io(member_handle_type *h, io_request<buffers_type> req, deadline d) noexcept { return h->read(req, d); }
+    static io_result<const_buffers_type> _sync_io(member_handle_type *h, io_request<const_buffers_type> req, deadline d) noexcept { return h->write(req, d); }
+    static io_result<buffers_type> _completed(io_multiplexer::io_operation_state *state, buffers_type * /*unused*/) noexcept { return std::move(*state).get_completed_read(); }
+    static io_result<const_buffers_type> _completed(io_multiplexer::io_operation_state *state, const_buffers_type * /*unused*/) noexcept
+    {
+      return std::move(*state).get_completed_write_or_barrier();
+    }
+
+    // Per-member state of a striped i/o
+    template <class BuffersType> struct _subrequest
+    {
+      size_t first{0}, count{0}, cap{0};
+      extent_type offset{0};
+      io_multiplexer::io_operation_state *state{nullptr};
+      optional<io_result<BuffersType>> res;
+      std::chrono::steady_clock::time_point began, completed;
+    };
+    // A contiguous piece of the logical request living in a single stripe of one member
+    struct _piece
+    {
+      size_t member, buffer, bufferoffset, length;
+    };
+
+    template <class BuffersType> io_result<BuffersType> _do_striped_io(io_request<BuffersType> reqs, deadline d) noexcept
+    {
+      static constexpr bool is_write = std::is_same<BuffersType, const_buffers_type>::value;
+      using buffer_t = typename BuffersType::value_type;
+      if(_count == 0)
+      {
+        return errc::invalid_argument;
+      }
+      size_type bytes = 0;
+      for(const auto &b : reqs.buffers)
+      {
+        bytes += b.size();
+      }
+      if(bytes == 0)
+      {
+        return std::move(reqs.buffers);
+      }
+      const size_t maxpieces = reqs.buffers.size() + (size_t)((reqs.offset + bytes - 1) / _stripe_size - reqs.offset / _stripe_size + 1);
+      const size_t tempbytes = _count * sizeof(_subrequest<BuffersType>) + maxpieces * (sizeof(_piece) + sizeof(buffer_t)) + 64;
+      // If less than page size, use stack, else use free pages
+      byte *temp = (tempbytes <= utils::page_size()) ? (byte *) alloca(tempbytes) : nullptr;
+      map_handle temph;
+      if(temp == nullptr)
+      {
+        OUTCOME_TRY(auto &&_, map_handle::map(tempbytes));
+        temph = std::move(_);
+        temp = temph.address();
+      }
+      auto *subreqs = reinterpret_cast<_subrequest<BuffersType> *>(((uintptr_t) temp + 63) & ~63);
+      auto *pieces = reinterpret_cast<_piece *>(subreqs + _count);
+      auto *memberbuffers = reinterpret_cast<buffer_t *>(pieces + maxpieces);
+      for(size_t m = 0; m < _count; m++)
+      {
+        new(&subreqs[m]) _subrequest<BuffersType>;
+        subreqs[m].cap = _members[m].h->max_buffers();
+        subreqs[m].offset = _member_bytes_before(m, reqs.offset);
+      }
+      auto unconstruct = make_scope_exit([&]() noexcept {
+        for(size_t m = 0; m < _count; m++)
+        {
+          subreqs[m].~_subrequest();
+        }
+      });
+
+      // Split the request into pieces, each piece lying within a single stripe
+      size_t npieces = 0;
+      {
+        extent_type pos = reqs.offset;
+        bool capped = false;
+        for(size_t bi = 0; bi < reqs.buffers.size() && !capped; bi++)
+        {
+          const auto &b = reqs.buffers[bi];
+          size_t bo = 0;
+          while(bo < b.size())
+          {
+            const size_t m = (size_t)((pos / _stripe_size) % _count);
+            const size_t length = (size_t) std::min((extent_type)(b.size() - bo), _stripe_size - pos % _stripe_size);
+            auto &sr = subreqs[m];
+            if(sr.cap != 0 && sr.count == sr.cap)
+            {
+              capped = true;
+              break;
+            }
+            pieces[npieces++] = {m, bi, bo, length};
+            sr.count++;
+            pos += length;
+            bo += length;
+          }
+        }
+        size_t first = 0;
+        for(size_t m = 0; m < _count; m++)
+        {
+          subreqs[m].first = first;
+          first += subreqs[m].count;
+          subreqs[m].count = 0;
+        }
+        for(size_t n = 0; n < npieces; n++)
+        {
+          const auto &p = pieces[n];
+          auto &sr = subreqs[p.member];
+          memberbuffers[sr.first + sr.count++] = buffer_t(reqs.buffers[p.buffer].data() + p.bufferoffset, p.length);
+        }
+      }
+
+      // Initiate the sub-requests of all members with a multiplexer
+      bool haveasync = false;
+      for(size_t m = 0; m < _count; m++)
+      {
+        auto &sr = subreqs[m];
+        auto *ctx = _members[m].h->multiplexer();
+        if(sr.count > 0 && ctx != nullptr)
+        {
+          const auto state_reqs = ctx->io_state_requirements();
+          auto *storage = (byte *) alloca(state_reqs.first + state_reqs.second);
+          const auto diff = (uintptr_t) storage & (state_reqs.second - 1);
+          storage += state_reqs.second - diff;
+          sr.began = std::chrono::steady_clock::now();
+          sr.state = ctx->construct_and_init_io_operation({storage, state_reqs.first}, _members[m].h, nullptr, {}, d,
+                                                          io_request<BuffersType>({memberbuffers + sr.first, sr.count}, sr.offset));
+          haveasync = true;
+        }
+      }
+      optional<result<void>> failure;
+      if(haveasync)
+      {
+        for(size_t m = 0; m < _count; m++)
+        {
+          if(subreqs[m].state != nullptr)
+          {
+            auto r = _members[m].h->multiplexer()->flush_inited_io_operations();
+            if(!r && !failure)
+            {
+              failure = std::move(r);
+            }
+          }
+        }
+      }
+      // Completes any initiated sub-requests which have finished, returning a multiplexer with some yet to finish
+      auto reap = [&]() noexcept -> io_multiplexer * {
+        io_multiplexer *waiton = nullptr;
+        for(size_t m = 0; m < _count; m++)
+        {
+          auto &sr = subreqs[m];
+          if(sr.state != nullptr && !sr.res)
+          {
+            auto *ctx = _members[m].h->multiplexer();
+            if(is_finished(ctx->check_io_operation(sr.state)))
+            {
+              sr.res = _completed(sr.state, (BuffersType *) nullptr);
+              sr.completed = std::chrono::steady_clock::now();
+              sr.state->~io_operation_state();
+            }
+            else
+            {
+              waiton = ctx;
+            }
+          }
+        }
+        return waiton;
+      };
+      // Issue the sub-requests of all members without a multiplexer
+#if !defined(LLFIO_DISABLE_OPENMP) && defined(_OPENMP)
+      const bool parallel = (this->_flags & flag::disable_parallelism) == 0;
+#pragma omp parallel for if(parallel)
+#else
+      const bool parallel = false;
+#endif
+      for(size_t m = 0; m < _count; m++)
+      {
+        auto &sr = subreqs[m];
+        if(sr.count > 0 && sr.state == nullptr)
+        {
+          sr.began = std::chrono::steady_clock::now();
+          sr.res = _sync_io(_members[m].h, io_request<BuffersType>({memberbuffers + sr.first, sr.count}, sr.offset), d);
+          sr.completed = std::chrono::steady_clock::now();
+          if(haveasync && !parallel)
+          {
+            // Otherwise the times of initiated sub-requests would include the sub-requests issued after them
+            (void) reap();
+          }
+        }
+      }
+      // Reap the initiated sub-requests
+      if(haveasync)
+      {
+        LLFIO_DEADLINE_TO_SLEEP_INIT(d);
+        for(;;)
+        {
+          io_multiplexer *waiton = reap();
+          if(waiton == nullptr)
+          {
+            break;
+          }
+          deadline nd;
+          LLFIO_DEADLINE_TO_PARTIAL_DEADLINE(nd, d);
+          auto r = waiton->check_for_any_completed_io(nd);
+          if(!r)
+          {
+            // We cannot return until all initiated i/o has finished, so cancel it all
+            for(size_t m = 0; m < _count; m++)
+            {
+              auto &sr = subreqs[m];
+              if(sr.state != nullptr && !sr.res)
+              {
+                (void) _members[m].h->multiplexer()->cancel_io_operation(sr.state);
+              }
+            }
+          }
+        }
+      }
+
+      // Gather results, updating statistics
+      for(size_t m = 0; m < _count; m++)
+      {
+        auto &sr = subreqs[m];
+        if(sr.count == 0)
+        {
+          continue;
+        }
+        if(!*sr.res)
+        {
+          if(!failure)
+          {
+            failure = result<void>(std::move(*sr.res).error());
+          }
+          continue;
+        }
+        size_type transferred = 0;
+        auto &filled = sr.res->value();
+        for(size_t n = 0; n < filled.size(); n++)
+        {
+          auto *original = memberbuffers + sr.first + n;
+          if(!is_write && filled[n].size() > 0 && filled[n].data() != original->data())
+          {
+            // Some handles e.g. mapped_file_handle return their own buffers
+            memcpy((void *) original->data(), filled[n].data(), filled[n].size());
+          }
+          transferred += filled[n].size();
+          *original = buffer_t(original->data(), filled[n].size());
+        }
+        for(size_t n = filled.size(); n < sr.count; n++)
+        {
+          memberbuffers[sr.first + n] = buffer_t(memberbuffers[sr.first + n].data(), 0);
+        }
+        const auto ns = (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(sr.completed - sr.began).count();
+        auto &member = _members[m];
+        if(is_write)
+        {
+          member.writes.fetch_add(1, std::memory_order_relaxed);
+          member.bytes_written.fetch_add(transferred, std::memory_order_relaxed);
+          member.write_ns.fetch_add(ns, std::memory_order_relaxed);
+        }
+        else
+        {
+          member.reads.fetch_add(1, std::memory_order_relaxed);
+          member.bytes_read.fetch_add(transferred, std::memory_order_relaxed);
+          member.read_ns.fetch_add(ns, std::memory_order_relaxed);
+        }
+        sr.count = 0;  // reused below as a cursor
+      }
+      if(failure)
+      {
+        return std::move(*failure).error();
+      }
+
+      // The bytes transferred are those contiguous from the start of the request
+      for(auto &b : reqs.buffers)
+      {
+        b = buffer_t(b.data(), 0);
+      }
+      for(size_t n = 0; n < npieces; n++)
+      {
+        const auto &p = pieces[n];
+        auto &sr = subreqs[p.member];
+        const auto &mb = memberbuffers[sr.first + sr.count++];
+        auto &b = reqs.buffers[p.buffer];
+        b = buffer_t(b.data(), b.size() + mb.size());
+        if(mb.size() < p.length)
+        {
+          break;
+        }
+      }
+      return std::move(reqs.buffers);
+    }
+
+  public:
+    //! Default constructor
+    striped_handle_adapter() = default;
+    /*! Constructor
+    \param members The member handles, which must outlive the adapter.
+    \param stripe_size The number of bytes of each stripe.
+    \param _mode Whether the adapter is to be writable.
+    \param flags Flags for the adapter.
+    */
+    explicit striped_handle_adapter(span<member_handle_type *const> members, extent_type stripe_size = 65536, mode _mode = mode::write, flag flags = flag::none)
+        : _base(_native_handle(_mode), _combine_caching(members), flags, nullptr)
+        , _members(new _member[members.size()])
+        , _count(members.size())
+        , _stripe_size((stripe_size == 0) ? 65536 : stripe_size)
+    {
+      for(size_t n = 0; n < _count; n++)
+      {
+        _members[n].h = members[n];
+      }
+    }
+
+    //! Implicit move construction of striped_handle_adapter permitted
+    striped_handle_adapter(striped_handle_adapter &&o) noexcept
+        : _base(std::move(o))
+        , _members(std::move(o._members))
+        , _count(o._count)
+        , _stripe_size(o._stripe_size)
+    {
+      o._count = 0;
+    }
+    //! No copy construction (use `clone()`)
+    striped_handle_adapter(const striped_handle_adapter &) = delete;
+    //! Move assignment of striped_handle_adapter permitted
+    striped_handle_adapter &operator=(striped_handle_adapter &&o) noexcept
+    {
+      if(this == &o)
+      {
+        return *this;
+      }
+      this->~striped_handle_adapter();
+      new(this) striped_handle_adapter(std::move(o));
+      return *this;
+    }
+    //! No copy assignment
+    striped_handle_adapter &operator=(const striped_handle_adapter &) = delete;
+    //! Swap with another instance
+    LLFIO_MAKE_FREE_FUNCTION
+    void swap(striped_handle_adapter &o) noexcept
+    {
+      striped_handle_adapter temp(std::move(*this));
+      *this = std::move(o);
+      o = std::move(temp);
+    }
+
+    //! The number of member handles.
+    size_t members() const noexcept { return _count; }
+    //! The member handle at index `idx`.
+    member_handle_type *member(size_t idx) const noexcept { return _members[idx].h; }
+    //! The number of bytes of each stripe.
+    extent_type stripe_size() const noexcept { return _stripe_size; }
+
+    //! \brief Returns a snapshot of the i/o performed on the member at index `idx`.
+    member_statistics statistics(size_t idx) const noexcept
+    {
+      member_statistics ret;
+      const auto &member = _members[idx];
+      ret.reads = member.reads.load(std::memory_order_relaxed);
+      ret.writes = member.writes.load(std::memory_order_relaxed);
+      ret.bytes_read = member.bytes_read.load(std::memory_order_relaxed);
+      ret.bytes_written = member.bytes_written.load(std::memory_order_relaxed);
+      ret.read_time = std::chrono::nanoseconds(member.read_ns.load(std::memory_order_relaxed));
+      ret.write_time = std::chrono::nanoseconds(member.write_ns.load(std::memory_order_relaxed));
+      return ret;
+    }
+    //! \brief Resets the statistics of all members to zero.
+    void reset_statistics() noexcept
+    {
+      for(size_t n = 0; n < _count; n++)
+      {
+        auto &member = _members[n];
+        member.reads.store(0, std::memory_order_relaxed);
+        member.writes.store(0, std::memory_order_relaxed);
+        member.bytes_read.store(0, std::memory_order_relaxed);
+        member.bytes_written.store(0, std::memory_order_relaxed);
+        member.read_ns.store(0, std::memory_order_relaxed);
+        member.write_ns.store(0, std::memory_order_relaxed);
+      }
+    }
+
+    //! \brief Close all of the member handles.
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<void> close() noexcept override
+    {
+      for(size_t n = 0; n < _count; n++)
+      {
+        OUTCOME_TRY(_members[n].h->close());
+      }
+      return success();
+    }
+
+    //! \brief Lock the given logical extent in the first member.
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_guard> lock_file_range(extent_type offset, extent_type bytes, lock_kind kind, deadline d = deadline()) noexcept override
+    {
+      if(_count == 0)
+      {
+        return errc::invalid_argument;
+      }
+      OUTCOME_TRY(auto &&_, _members[0].h->lock_file_range(offset, bytes, kind, d));
+      _.release();
+      return _extent_guard(this, offset, bytes, kind);
+    }
+    //! \brief Unlock the given logical extent in the first member.
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC void unlock_file_range(extent_type offset, extent_type bytes) noexcept override
+    {
+      if(_count > 0)
+      {
+        _members[0].h->unlock_file_range(offset, bytes);
+      }
+    }
+
+    //! \brief Return the logical maximum extent implied by the maximum extents of the members.
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> maximum_extent() const noexcept override
+    {
+      extent_type ret = 0;
+      for(size_t n = 0; n < _count; n++)
+      {
+        OUTCOME_TRY(auto &&y, _members[n].h->maximum_extent());
+        ret = std::max(ret, _logical_extent(n, y));
+      }
+      return ret;
+    }
+    //! \brief Truncate each member to its portion of the new logical maximum extent.
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> truncate(extent_type newsize) noexcept override
+    {
+      for(size_t n = 0; n < _count; n++)
+      {
+        OUTCOME_TRY(_members[n].h->truncate(_member_bytes_before(n, newsize)));
+      }
+      return newsize;
+    }
+    //! \brief Always returns a failed matching `errc::operation_not_supported`.
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<std::vector<file_handle::extent_pair>> extents() const noexcept override { return errc::operation_not_supported; }
+    //! \brief Punches a hole in each member's portion of the logical extent.
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC result<extent_type> zero(file_handle::extent_pair extent, deadline d = deadline()) noexcept override
+    {
+      for(size_t n = 0; n < _count; n++)
+      {
+        const auto begin = _member_bytes_before(n, extent.offset), end = _member_bytes_before(n, extent.offset + extent.length);
+        if(end > begin)
+        {
+          OUTCOME_TRY(_members[n].h->zero({begin, end - begin}, d));
+        }
+      }
+      return extent.length;
+    }
+
+  protected:
+    struct _extent_guard : public extent_guard
+    {
+      friend class striped_handle_adapter;
+      _extent_guard() = default;
+      constexpr _extent_guard(file_handle *h, extent_type offset, extent_type length, lock_kind kind)
+          : extent_guard(h, offset, length, kind)
+      {
+      }
+    };
+
+    //! \brief Return the lowest of the members' maximum buffers
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC size_t _do_max_buffers() const noexcept override
+    {
+      size_t r = (size_t) -1;
+      for(size_t n = 0; n < _count; n++)
+      {
+        auto x = _members[n].h->max_buffers();
+        if(x != 0 && x < r)
+        {
+          r = x;
+        }
+      }
+      return (r == (size_t) -1) ? 0 : r;
+    }
+    //! Split the read into one sub-request per member, issue them concurrently, and wait for all to complete.
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<buffers_type> _do_read(io_request<buffers_type> reqs, deadline d = deadline()) noexcept override { return _do_striped_io(reqs, d); }
+    //! Split the write into one sub-request per member, issue them concurrently, and wait for all to complete.
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<const_buffers_type> _do_write(io_request<const_buffers_type> reqs, deadline d = deadline()) noexcept override { return _do_striped_io(reqs, d); }
+    //! Barrier the whole of every member.
+    LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<const_buffers_type> _do_barrier(io_request<const_buffers_type> reqs, barrier_kind kind, deadline d) noexcept override
+    {
+      for(size_t n = 0; n < _count; n++)
+      {
+        OUTCOME_TRY(_members[n].h->barrier({}, kind, d));
+      }
+      return std::move(reqs.buffers);
+    }
+  };
+
+  // BEGIN make_free_functions.py
+
+  // END make_free_functions.py
+
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
+
+#endif
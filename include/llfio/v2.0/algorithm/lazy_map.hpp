@@ -0,0 +1,143 @@
+/* Memory maps populated on demand from an i/o handle
+(C) 2026 agent <agent@local> (4 commits)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#ifndef LLFIO_ALGORITHM_LAZY_MAP_HPP
+#define LLFIO_ALGORITHM_LAZY_MAP_HPP
+
+#include "../map_handle.hpp"
+
+#include <memory>  // for unique_ptr
+
+//! \file lazy_map.hpp Provides `lazy_map`.
+
+LLFIO_V2_NAMESPACE_EXPORT_BEGIN
+
+namespace algorithm
+{
+  //! \brief How a `lazy_map` populates its pages.
+  struct lazy_map_config
+  {
+    //! Pages read from the source on the first fault in a region. Rounded up to at least one.
+    size_t readahead_pages{16};
+    //! Sequential faults double the read ahead, up to this many pages.
+    size_t max_readahead_pages{256};
+    //! Populate the remaining pages in order whilst no faults are pending.
+    bool background_populate{false};
+  };
+
+  //! \brief Statistics about a `lazy_map`.
+  struct lazy_map_statistics
+  {
+    uint64_t faults{0};            //!< Page faults serviced.
+    uint64_t pages_populated{0};   //!< Pages populated, by faults or in the background.
+    uint64_t background_pages{0};  //!< Pages populated in the background.
+    uint64_t bytes_read{0};        //!< Bytes read from the source.
+    uint64_t read_errors{0};       //!< Reads from the source which failed, see `lazy_map::error()`.
+  };
+
+  /*! \class lazy_map
+  \brief A memory map whose pages are populated on first access from an arbitrary `io_handle`,
+  rather than from the page cache of a file.
+
+  This suits restoring large snapshots which are compressed, encrypted or otherwise not directly
+  mappable, as the map is usable immediately and only the pages touched are ever read. A handler
+  thread services each page fault by reading the faulting page plus some pages after it from the
+  source, then atomically installing them. Sequential faults grow the read ahead window. After
+  population the pages are ordinary private anonymous memory, and writes to them are never
+  written back to the source. Pages discarded after population, for example with
+  `madvise(MADV_DONTNEED)`, are read again from the source when next accessed.
+
+  The source is only ever read from the handler thread, using `io_handle::read()` at the offset
+  given plus the offset within the map. Pages beyond the end of the source read as zero. If a read
+  from the source fails, the pages concerned read as zero, the failure is counted and the first
+  such failure is returned by `error()`, as the faulting thread cannot be told. If servicing
+  faults fails entirely, the map stops being lazy, its unpopulated pages read as zero, and
+  `error()` returns the failure.
+
+  Only implemented on Linux, using `userfaultfd()`, for which the process may need permission
+  (see `/proc/sys/vm/unprivileged_userfaultfd`). Other platforms return
+  `errc::operation_not_supported`.
+  */
+  class LLFIO_DECL lazy_map
+  {
+    struct _state_type;
+    std::unique_ptr<_state_type> _state;
+
+    explicit lazy_map(std::unique_ptr<_state_type> state) noexcept;
+
+  public:
+    using size_type = map_handle::size_type;
+    using extent_type = io_handle::extent_type;
+
+    //! Default constructor
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC lazy_map() noexcept;
+    lazy_map(const lazy_map &) = delete;
+    //! Move constructor
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC lazy_map(lazy_map &&o) noexcept;
+    lazy_map &operator=(const lazy_map &) = delete;
+    //! Move assignment
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC lazy_map &operator=(lazy_map &&o) noexcept;
+    //! Closes the map, if open
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC ~lazy_map();
+
+    /*! \brief Reserve `bytes` of memory whose pages will be read on demand from `source` starting
+    at `offset`.
+
+    `source` must outlive the returned object.
+
+    \errors Any of the values `userfaultfd()`, `ioctl()`, `eventfd()` or `map_handle::map()` can
+    return. `errc::operation_not_supported` on platforms other than Linux.
+    \mallocs Allocates the map state, a populated page bitmap, a staging map and a thread.
+    */
+    static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<lazy_map> map(io_handle &source, extent_type offset, size_type bytes, lazy_map_config config = {}) noexcept;
+
+    //! True if the map is open
+    bool is_valid() const noexcept { return !!_state; }
+    //! The address of the map
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC byte *address() const noexcept;
+    //! The length of the map, which is `bytes` rounded up to the page size
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC size_type length() const noexcept;
+    //! True if every page has been populated
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC bool is_fully_populated() const noexcept;
+    //! Statistics about population so far
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC lazy_map_statistics statistics() const noexcept;
+    //! The first failure to read from the source, if any
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<void> error() const noexcept;
+
+    /*! \brief Stop servicing faults and release the map. Pages not yet populated are lost. No
+    thread may be accessing the map.
+    */
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<void> close() noexcept;
+  };
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
+
+#if LLFIO_HEADERS_ONLY == 1 && !defined(DOXYGEN_SHOULD_SKIP_THIS)
+#define LLFIO_INCLUDED_BY_HEADER 1
+#include "../detail/impl/lazy_map.ipp"
+#undef LLFIO_INCLUDED_BY_HEADER
+#endif
+
+#endif
@@ -0,0 +1,303 @@
+/* Parallel for and reduce over a dynamic thread pool group
+(C) 2026 agent <agent@local> (4 commits)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#ifndef LLFIO_ALGORITHM_PARALLEL_FOR_HPP
+#define LLFIO_ALGORITHM_PARALLEL_FOR_HPP
+
+#include "../dynamic_thread_pool_group.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+//! \file parallel_for.hpp Provides `parallel_for()` and `parallel_reduce()` over a `dynamic_thread_pool_group`.
+
+LLFIO_V2_NAMESPACE_EXPORT_BEGIN
+
+namespace algorithm
+{
+  namespace detail
+  {
+    // When the grain is zero, chunks are sized to take about this long
+    static constexpr std::chrono::microseconds parallel_for_target_chunk_duration{100};
+
+    template <class F> inline result<void> parallel_for_invoke(std::true_type /*returns void*/, F &f, size_t begin, size_t end)
+    {
+      f(begin, end);
+      return success();
+    }
+    template <class F> inline result<void> parallel_for_invoke(std::false_type /*returns void*/, F &f, size_t begin, size_t end) { return f(begin, end); }
+
+    /* Each worker owns a subrange of the whole, from which it executes chunks.
+    When a worker runs dry, it takes the back half of the remaining subrange of
+    whichever worker has the most remaining. Ranges are therefore only split when
+    a worker would otherwise be idle (lazy binary splitting).
+    */
+    template <class T, class F> class parallel_chunks
+    {
+      // Each worker's hot state is kept in its own cache lines
+      struct alignas(64) worker final : public dynamic_thread_pool_group::work_item
+      {
+        parallel_chunks *parent{nullptr};
+        std::mutex lock;                  // taken to change begin and end
+        std::atomic<size_t> begin{0}, end{0};  // may be read without the lock
+        size_t chunk{1};
+        T accumulator;
+
+        worker(parallel_chunks *_parent, size_t _begin, size_t _end, const T &identity)
+            : parent(_parent)
+            , begin(_begin)
+            , end(_end)
+            , chunk(std::max(_parent->_grain, (size_t) 1))
+            , accumulator(identity)
+        {
+        }
+
+        virtual intptr_t next(deadline & /*unused*/) noexcept override
+        {
+          if(begin.load(std::memory_order_relaxed) < end.load(std::memory_order_relaxed))
+          {
+            return 1;
+          }
+          return parent->_steal(this) ? 1 : -1;
+        }
+        virtual result<void> operator()(intptr_t /*unused*/) noexcept override
+        {
+          size_t b, e;
+          {
+            std::lock_guard<std::mutex> g(lock);
+            b = begin.load(std::memory_order_relaxed);
+            e = end.load(std::memory_order_relaxed);
+            if(b < e && e - b > chunk)
+            {
+              e = b + chunk;
+            }
+            begin.store(e, std::memory_order_relaxed);
+          }
+          if(b >= e)
+          {
+            return success();
+          }
+          const auto began = (parent->_grain == 0) ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+          try
+          {
+            OUTCOME_TRY(parent->_f(b, e, accumulator));
+          }
+          catch(...)
+          {
+            return error_from_exception();
+          }
+          if(parent->_grain == 0)
+          {
+            const auto elapsed = std::chrono::steady_clock::now() - began;
+            // Only grow if this chunk was full sized, otherwise chunk could grow without bound
+            if(elapsed < parallel_for_target_chunk_duration / 2 && e - b == chunk)
+            {
+              chunk <<= 1;
+            }
+            else if(elapsed > parallel_for_target_chunk_duration * 2 && chunk > 1)
+            {
+              chunk >>= 1;
+            }
+          }
+          return success();
+        }
+      };
+
+      F &_f;
+      const size_t _grain;
+      std::vector<std::unique_ptr<worker>> _workers;
+
+      bool _steal(worker *thief) noexcept
+      {
+        const size_t minimum = std::max(_grain, (size_t) 1) * 2;
+        for(;;)
+        {
+          worker *victim = nullptr;
+          size_t most = 0;
+          for(auto &i : _workers)
+          {
+            auto &w = *i;
+            const auto b = w.begin.load(std::memory_order_relaxed), e = w.end.load(std::memory_order_relaxed);
+            if(&w != thief && b < e && e - b >= minimum && e - b > most)
+            {
+              victim = &w;
+              most = e - b;
+            }
+          }
+          if(victim == nullptr)
+          {
+            return false;
+          }
+          size_t b, e;
+          {
+            std::lock_guard<std::mutex> g(victim->lock);
+            b = victim->begin.load(std::memory_order_relaxed);
+            e = victim->end.load(std::memory_order_relaxed);
+            if(b >= e || e - b < minimum)
+            {
+              continue;  // it changed since we looked, try again
+            }
+            b += (e - b) / 2;
+            victim->end.store(b, std::memory_order_relaxed);
+          }
+          std::lock_guard<std::mutex> g(thief->lock);
+          thief->begin.store(b, std::memory_order_relaxed);
+          thief->end.store(e, std::memory_order_relaxed);
+          return true;
+        }
+      }
+
+    public:
+      parallel_chunks(F &f, size_t grain)
+          : _f(f)
+          , _grain(grain)
+      {
+      }
+
+      result<void> run(dynamic_thread_pool_group &group, size_t begin, size_t end, const T &identity) noexcept
+      {
+        if(begin >= end)
+        {
+          return success();
+        }
+        try
+        {
+          const size_t items = end - begin, grain = std::max(_grain, (size_t) 1);
+          const size_t count = std::max((size_t) 1, std::min((size_t) std::thread::hardware_concurrency(), (items + grain - 1) / grain));
+          std::vector<dynamic_thread_pool_group::work_item *> workitems(count);
+          _workers.reserve(count);
+          for(size_t n = 0; n < count; n++)
+          {
+            _workers.push_back(std::make_unique<worker>(this, begin + items * n / count, begin + items * (n + 1) / count, identity));
+            workitems[n] = _workers.back().get();
+          }
+          auto r = group.submit(workitems);
+          if(!r)
+          {
+            // Some may have been submitted
+            (void) group.stop();
+            (void) group.wait();
+            return r;
+          }
+          return group.wait();
+        }
+        catch(...)
+        {
+          return error_from_exception();
+        }
+      }
+
+      template <class R> T reduce(T ret, R &r)
+      {
+        for(auto &i : _workers)
+        {
+          ret = r(std::move(ret), std::move(i->accumulator));
+        }
+        return ret;
+      }
+    };
+    struct parallel_for_no_accumulator
+    {
+    };
+  }  // namespace detail
+
+  /*! \brief Calls `f(begin, end)` over non-overlapping chunks of `[begin, end)` from the threads
+  of `group`, returning when all have been called.
+
+  `f` may return `void`, or `result<void>`, or throw an exception. A failure or exception stops
+  the group, and is returned. Calling `group.stop()` from any thread, including from within `f`,
+  cancels the chunks not yet begun, and `errc::operation_canceled` is returned. `group` ought to
+  have no other work submitted to it, as this call waits until all work in `group` completes.
+
+  If `grain` is non-zero, chunks are `grain` items long, except possibly the last in any
+  subrange. If `grain` is zero, each thread adapts the length of its chunks until they take
+  about one hundred microseconds, which suits items of unknown or varying cost.
+
+  Initially the range is divided evenly between up to `std::thread::hardware_concurrency()`
+  work items. When a work item runs out of work, it takes the back half of the remaining range
+  of the work item with the most remaining, so uneven costs per item balance out, without
+  any splitting of ranges when costs are even.
+
+  \mallocs One allocation per work item, plus two for the lists of them.
+  */
+  template <class F> inline result<void> parallel_for(dynamic_thread_pool_group &group, size_t begin, size_t end, size_t grain, F &&f) noexcept
+  {
+    auto g = [&f](size_t b, size_t e, detail::parallel_for_no_accumulator & /*unused*/) -> result<void> {
+      return detail::parallel_for_invoke(std::is_void<decltype(f(b, e))>(), f, b, e);
+    };
+    detail::parallel_chunks<detail::parallel_for_no_accumulator, decltype(g)> chunks(g, grain);
+    return chunks.run(group, begin, end, {});
+  }
+  //! \overload Uses a new `dynamic_thread_pool_group`.
+  template <class F> inline result<void> parallel_for(size_t begin, size_t end, size_t grain, F &&f) noexcept
+  {
+    OUTCOME_TRY(auto &&group, make_dynamic_thread_pool_group());
+    return parallel_for(*group, begin, end, grain, static_cast<F &&>(f));
+  }
+
+  /*! \brief Calls `f(begin, end, accumulator)` over non-overlapping chunks of `[begin, end)` from the threads
+  of `group` as per `parallel_for()`, then returns `identity` combined with each accumulator in turn
+  using `reduce(T, T) -> T`.
+
+  Each work item has its own accumulator of type `T`, initialised to `identity`, and padded to
+  avoid false sharing with the others. As which items each accumulator sees depends on timing, `reduce`
+  ought to be associative and commutative, and note that floating point addition is neither.
+
+  \mallocs One allocation per work item, plus two for the lists of them.
+  */
+  template <class T, class F, class R>
+  inline result<T> parallel_reduce(dynamic_thread_pool_group &group, size_t begin, size_t end, size_t grain, T identity, F &&f, R &&reduce) noexcept
+  {
+    auto g = [&f](size_t b, size_t e, T &accumulator) -> result<void> {
+      auto h = [&](size_t b_, size_t e_) { return f(b_, e_, accumulator); };
+      return detail::parallel_for_invoke(std::is_void<decltype(f(b, e, accumulator))>(), h, b, e);
+    };
+    try
+    {
+      detail::parallel_chunks<T, decltype(g)> chunks(g, grain);
+      OUTCOME_TRY(chunks.run(group, begin, end, identity));
+      return chunks.reduce(std::move(identity), reduce);
+    }
+    catch(...)
+    {
+      return error_from_exception();
+    }
+  }
+  //! \overload Uses a new `dynamic_thread_pool_group`.
+  template <class T, class F, class R> inline result<T> parallel_reduce(size_t begin, size_t end, size_t grain, T identity, F &&f, R &&reduce) noexcept
+  {
+    OUTCOME_TRY(auto &&group, make_dynamic_thread_pool_group());
+    return parallel_reduce(*group, begin, end, grain, std::move(identity), static_cast<F &&>(f), static_cast<R &&>(reduce));
+  }
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
+
+#endif
@@ -0,0 +1,379 @@
+/* Samples process memory and CPU usage from a background thread
+(C) 2026 agent <agent@local> (2 commits)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#ifndef LLFIO_ALGORITHM_PROCESS_SAMPLER_HPP
+#define LLFIO_ALGORITHM_PROCESS_SAMPLER_HPP
+
+#include "../dynamic_thread_pool_group.hpp"
+#include "../map_handle.hpp"
+#include "../utils.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//! \file process_sampler.hpp Provides a background sampler of process memory and CPU usage.
+
+LLFIO_V2_NAMESPACE_EXPORT_BEGIN
+
+namespace algorithm
+{
+  /*! \struct process_sample
+  \brief A sample of process memory and CPU usage, of the map handle cache, and of the thread pool,
+  with the change since the previous sample.
+  */
+  struct process_sample
+  {
+    std::chrono::steady_clock::time_point when;  //!< When the sample was taken.
+    uint32_t phase{0};                           //!< The value last passed to `process_sampler::set_phase()`.
+    utils::process_memory_usage memory;          //!< Memory usage at the time.
+    utils::process_cpu_usage cpu;                //!< Cumulative CPU usage at the time.
+    map_handle::cache_statistics map_cache;      //!< The map handle cache at the time.
+    dynamic_thread_pool_group::pool_statistics thread_pool;  //!< The process wide thread pool at the time.
+
+    //! The change since the previous sample, all zero for the first sample.
+    struct delta_type
+    {
+      std::chrono::nanoseconds elapsed{0};
+      int64_t total_address_space_paged_in{0};
+      int64_t private_committed{0};
+      int64_t private_paged_in{0};
+      int64_t map_cache_bytes{0};
+      utils::process_cpu_usage cpu;
+    } delta;
+
+    //! The fraction of one CPU this process used since the previous sample.
+    double cpu_utilisation() const noexcept
+    {
+      return (delta.elapsed.count() <= 0) ? 0.0 : (double) (delta.cpu.process_ns_in_user_mode + delta.cpu.process_ns_in_kernel_mode) / (double) delta.elapsed.count();
+    }
+  };
+  static_assert(std::is_trivially_copyable<process_sample>::value, "process_sample is not trivially copyable!");
+
+  /*! \class process_sampler
+  \brief Samples process memory and CPU usage from a background thread into a fixed size ring,
+  so changes in resident memory can be correlated with i/o phases.
+
+  Each sample also records the state of the `map_handle` cache and the process wide dynamic
+  thread pool, so `summarise()` can attribute growth in resident memory to maps being
+  retained by the cache, or to periods when the thread pool had work pending. Call `set_phase()`
+  at the boundaries of your i/o phases to have the phase recorded into each sample.
+
+  Sampling memory usage is expensive on Linux, as `/proc` must be parsed. See
+  `utils::current_process_memory_usage()` for which fields cost what.
+  */
+  class process_sampler
+  {
+  public:
+    //! Percentiles of a sampled value
+    template <class T> struct percentiles
+    {
+      T min{0}, p50{0}, p90{0}, p99{0}, max{0};
+    };
+    //! A summary of the samples in the ring
+    struct summary_type
+    {
+      size_t samples{0};                    //!< The number of samples summarised.
+      std::chrono::nanoseconds elapsed{0};  //!< The time between the first and last samples.
+
+      percentiles<size_t> total_address_space_paged_in;  //!< Also known as resident set size.
+      percentiles<size_t> private_committed;
+      percentiles<double> cpu_utilisation;  //!< As fractions of one CPU.
+
+      double paged_in_rate{0};      //!< Bytes per second change in resident set size, from first to last sample.
+      int64_t paged_in_max_increase{0};  //!< The largest increase in resident set size between two samples.
+
+      int64_t paged_in_growth{0};  //!< The sum of every increase in resident set size between samples.
+      //! The portion of `paged_in_growth` matched by the map handle cache retaining more bytes.
+      int64_t paged_in_growth_map_cache{0};
+      //! The portion of `paged_in_growth` occurring whilst the thread pool had work pending.
+      int64_t paged_in_growth_thread_pool{0};
+    };
+
+  private:
+    struct _state_type
+    {
+      std::chrono::milliseconds interval;
+      utils::process_memory_usage::want want;
+      std::atomic<uint32_t> phase{0};
+      mutable std::mutex lock;
+      std::condition_variable changed;
+      bool stopping{false};
+      std::thread thread;
+      std::vector<process_sample> ring;
+      size_t head{0}, count{0};  // head is where the next sample goes
+      result<void> error{success()};
+
+      result<process_sample> sample_once() noexcept
+      {
+        process_sample ret;
+        ret.when = std::chrono::steady_clock::now();
+        ret.phase = phase.load(std::memory_order_relaxed);
+        OUTCOME_TRY(ret.memory, utils::current_process_memory_usage(want));
+        OUTCOME_TRY(ret.cpu, utils::current_process_cpu_usage());
+        ret.map_cache = map_handle::trim_cache();
+        ret.thread_pool = dynamic_thread_pool_group::statistics();
+        return ret;
+      }
+      void push(process_sample s) noexcept
+      {
+        if(count > 0)
+        {
+          const auto &prev = ring[(head + ring.size() - 1) % ring.size()];
+          s.delta.elapsed = s.when - prev.when;
+          s.delta.total_address_space_paged_in = (int64_t) s.memory.total_address_space_paged_in - (int64_t) prev.memory.total_address_space_paged_in;
+          s.delta.private_committed = (int64_t) s.memory.private_committed - (int64_t) prev.memory.private_committed;
+          s.delta.private_paged_in = (int64_t) s.memory.private_paged_in - (int64_t) prev.memory.private_paged_in;
+          s.delta.map_cache_bytes = (int64_t) s.map_cache.bytes_in_cache - (int64_t) prev.map_cache.bytes_in_cache;
+          s.delta.cpu = s.cpu - prev.cpu;
+        }
+        ring[head] = s;
+        head = (head + 1) % ring.size();
+        if(count < ring.size())
+        {
+          count++;
+        }
+      }
+      void run() noexcept
+      {
+        std::unique_lock<std::mutex> g(lock);
+        while(!stopping)
+        {
+          g.unlock();
+          auto s = sample_once();
+          g.lock();
+          if(!s)
+          {
+            error = std::move(s).as_failure();
+            return;
+          }
+          push(s.value());
+          changed.wait_for(g, interval, [this] { return stopping; });
+        }
+      }
+    };
+    std::unique_ptr<_state_type> _state;
+
+    explicit process_sampler(std::unique_ptr<_state_type> state)
+        : _state(std::move(state))
+    {
+    }
+
+  public:
+    //! Default constructor, not sampling
+    process_sampler() = default;
+    process_sampler(const process_sampler &) = delete;
+    process_sampler(process_sampler &&) = default;
+    process_sampler &operator=(const process_sampler &) = delete;
+    process_sampler &operator=(process_sampler &&o) noexcept
+    {
+      if(this == &o)
+      {
+        return *this;
+      }
+      this->~process_sampler();
+      new(this) process_sampler(std::move(o));
+      return *this;
+    }
+    //! Stops sampling, if sampling
+    ~process_sampler()
+    {
+      if(_state)
+      {
+        (void) stop();
+      }
+    }
+
+    /*! \brief Begin sampling every `interval`, retaining the most recent `capacity` samples.
+
+    The first sample is taken before returning, so errors such as an unsupported `want` are
+    reported immediately.
+
+    \errors Any of the values `utils::current_process_memory_usage()` and `utils::current_process_cpu_usage()`
+    can return.
+    \mallocs Allocates the ring and a thread.
+    */
+    static result<process_sampler> start(std::chrono::milliseconds interval = std::chrono::milliseconds(100), size_t capacity = 1024,
+                                         utils::process_memory_usage::want want = utils::process_memory_usage::want::this_process) noexcept
+    {
+      try
+      {
+        if(capacity == 0)
+        {
+          return errc::invalid_argument;
+        }
+        auto state = std::make_unique<_state_type>();
+        state->interval = interval;
+        state->want = want;
+        state->ring.resize(capacity);
+        OUTCOME_TRY(auto &&first, state->sample_once());
+        state->push(first);
+        auto *s = state.get();
+        state->thread = std::thread([s] {
+          {
+            std::unique_lock<std::mutex> g(s->lock);
+            s->changed.wait_for(g, s->interval, [s] { return s->stopping; });
+          }
+          s->run();
+        });
+        return process_sampler(std::move(state));
+      }
+      catch(...)
+      {
+        return error_from_exception();
+      }
+    }
+
+    //! True if sampling
+    bool is_sampling() const noexcept { return _state && _state->thread.joinable(); }
+
+    //! Sets the phase recorded into subsequent samples, returning the previous phase
+    uint32_t set_phase(uint32_t phase) noexcept { return _state ? _state->phase.exchange(phase, std::memory_order_relaxed) : 0; }
+
+    //! The number of samples currently in the ring
+    size_t size() const noexcept
+    {
+      if(!_state)
+      {
+        return 0;
+      }
+      std::lock_guard<std::mutex> g(_state->lock);
+      return _state->count;
+    }
+
+    /*! \brief Copies up to `out.size()` of the most recent samples into `out` oldest first,
+    returning the number copied.
+    */
+    size_t samples(span<process_sample> out) const noexcept
+    {
+      if(!_state)
+      {
+        return 0;
+      }
+      std::lock_guard<std::mutex> g(_state->lock);
+      const auto &ring = _state->ring;
+      const size_t tocopy = std::min(out.size(), _state->count);
+      const size_t begin = (_state->head + ring.size() - tocopy) % ring.size();
+      for(size_t n = 0; n < tocopy; n++)
+      {
+        out[n] = ring[(begin + n) % ring.size()];
+      }
+      return tocopy;
+    }
+
+    /*! \brief Summarises the samples currently in the ring.
+
+    \mallocs Copies the samples for sorting.
+    */
+    result<summary_type> summarise() const noexcept
+    {
+      try
+      {
+        summary_type ret;
+        std::vector<process_sample> ss(size());
+        ss.resize(samples(ss));
+        ret.samples = ss.size();
+        if(ss.empty())
+        {
+          return ret;
+        }
+        ret.elapsed = ss.back().when - ss.front().when;
+        if(ret.elapsed.count() > 0)
+        {
+          ret.paged_in_rate = (double) ((int64_t) ss.back().memory.total_address_space_paged_in - (int64_t) ss.front().memory.total_address_space_paged_in) *
+                              1000000000.0 / (double) ret.elapsed.count();
+        }
+        // The first sample's delta predates the window
+        for(size_t n = 1; n < ss.size(); n++)
+        {
+          const auto &d = ss[n].delta;
+          if(d.total_address_space_paged_in > 0)
+          {
+            ret.paged_in_max_increase = std::max(ret.paged_in_max_increase, d.total_address_space_paged_in);
+            ret.paged_in_growth += d.total_address_space_paged_in;
+            if(d.map_cache_bytes > 0)
+            {
+              ret.paged_in_growth_map_cache += std::min(d.total_address_space_paged_in, d.map_cache_bytes);
+            }
+            if(ss[n].thread_pool.work_items_pending > 0 || ss[n - 1].thread_pool.work_items_pending > 0)
+            {
+              ret.paged_in_growth_thread_pool += d.total_address_space_paged_in;
+            }
+          }
+        }
+        auto calc = [](auto &out, auto values) {
+          std::sort(values.begin(), values.end());
+          auto at = [&](double p) { return values[(size_t) (p * (double) (values.size() - 1))]; };
+          out.min = values.front();
+          out.p50 = at(0.5);
+          out.p90 = at(0.9);
+          out.p99 = at(0.99);
+          out.max = values.back();
+        };
+        std::vector<size_t> values(ss.size());
+        std::transform(ss.begin(), ss.end(), values.begin(), [](const process_sample &s) { return s.memory.total_address_space_paged_in; });
+        calc(ret.total_address_space_paged_in, values);
+        std::transform(ss.begin(), ss.end(), values.begin(), [](const process_sample &s) { return s.memory.private_committed; });
+        calc(ret.private_committed, std::move(values));
+        if(ss.size() > 1)
+        {
+          std::vector<double> cpu(ss.size() - 1);
+          std::transform(ss.begin() + 1, ss.end(), cpu.begin(), [](const process_sample &s) { return s.cpu_utilisation(); });
+          calc(ret.cpu_utilisation, std::move(cpu));
+        }
+        return ret;
+      }
+      catch(...)
+      {
+        return error_from_exception();
+      }
+    }
+
+    /*! \brief Stop sampling. The samples remain available. Returns any error which occurred
+    whilst sampling.
+    */
+    result<void> stop() noexcept
+    {
+      if(!_state || !_state->thread.joinable())
+      {
+        return success();
+      }
+      {
+        std::lock_guard<std::mutex> g(_state->lock);
+        _state->stopping = true;
+      }
+      _state->changed.notify_all();
+      _state->thread.join();
+      return std::move(_state->error);
+    }
+  };
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
+
+#endif
@@ -0,0 +1,456 @@
+/* A cross process registry of the addresses at which files are mapped
+(C) 2026 agent <agent@local> (5 commits)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#ifndef LLFIO_ALGORITHM_SHARED_MAP_REGISTRY_HPP
+#define LLFIO_ALGORITHM_SHARED_MAP_REGISTRY_HPP
+
+#include "../mapped_file_handle.hpp"
+#include "../stat.hpp"
+
+#include <memory>  // for unique_ptr
+#include <mutex>
+
+//! \file shared_map_registry.hpp Provides a cross process registry of file map addresses.
+
+LLFIO_V2_NAMESPACE_EXPORT_BEGIN
+
+namespace algorithm
+{
+  /*! \brief The header at the front of a shared map registry file, exactly 64 bytes.
+
+  It is followed by `capacity` instances of `shared_map_registry_entry`.
+  */
+  struct shared_map_registry_header
+  {
+    static constexpr uint64_t magic_value = 0x5047414d4f49464cULL;  // "LFIOMAPG" little endian
+    static constexpr uint32_t current_version = 1;
+
+    uint64_t magic{magic_value};
+    uint32_t version{current_version};
+    uint32_t capacity{0};  //!< The number of entries which follow.
+    uint64_t _reserved[6]{0, 0, 0, 0, 0, 0};
+  };
+  static_assert(sizeof(shared_map_registry_header) == 64, "shared_map_registry_header is not 64 bytes in size!");
+
+  //! \brief An entry in a shared map registry, exactly 64 bytes. Free entries have a zero `address`.
+  struct shared_map_registry_entry
+  {
+    static constexpr uint32_t flag_validated = 1;
+
+    uint64_t device;         //!< `stat_t::st_dev` of the backing file.
+    uint64_t inode;          //!< `stat_t::st_ino` of the backing file.
+    uint64_t offset;         //!< The offset into the backing file of the view.
+    uint64_t length;         //!< The number of bytes of the view.
+    uint64_t address;        //!< The page aligned address at which the view is mapped in every process able to.
+    uint64_t file_length;    //!< `stat_t::st_size` of the backing file when validated.
+    int64_t file_modified;  //!< `stat_t::st_mtim` of the backing file when validated, in nanoseconds since the epoch.
+    uint32_t flags;          //!< Bit 0 is set if the contents were validated.
+    uint32_t mappers;        //!< The number of views mapped at `address`. The entry is freed when this reaches zero.
+  };
+  static_assert(sizeof(shared_map_registry_entry) == 64, "shared_map_registry_entry is not 64 bytes in size!");
+
+  /*! \class shared_map_registry
+  \brief A registry kept in a small shared file of the addresses at which views of files are
+  mapped, so cooperating processes map the same file views at identical addresses.
+
+  Structures containing absolute pointers into a view are then usable by every process mapping
+  it, and the effort of validating a large file need only be spent by the first process mapping
+  it. This suits pre-fork worker models where many processes lazily map the same large read-only
+  data sets, as `section_handle::flag::singleton` only affects Windows, and even there each
+  process chooses its own addresses.
+
+  `map()` opens the file, looks up its device, inode, offset and length in the registry, and if
+  found maps the view at the registered address. If not found, the view is mapped wherever the
+  system chooses, and that address is registered. If the registered address is in use in this
+  process, the view is mapped elsewhere and `view::is_at_registered_address()` is false.
+  `mark_validated()` records the file's length and modification time, and later views of the
+  file report `view::is_validated()` for as long as those remain unchanged.
+
+  Each registration counts the views mapped at its address, and is freed when the last of those
+  is closed or destroyed. A process which exits without closing its views leaves its counts, and
+  so their registrations, in place until `forget()`. Views keep their registry open, so they may
+  outlive the `shared_map_registry` instance which mapped them.
+
+  The registry file is locked using `lock_file()` whilst it is searched or modified, which
+  excludes other open file descriptions of it. Each process must therefore `open()` the registry
+  itself, rather than use an instance inherited across `fork()`. Threads sharing an instance, or
+  its views, are excluded from one another by a mutex taken along with the file lock.
+  */
+  class shared_map_registry
+  {
+    // The open registry file, shared by an instance and its views
+    struct _registry_type
+    {
+      mapped_file_handle mh;
+      // Locks on the file do not exclude threads sharing its open file description
+      std::mutex lock;
+
+      explicit _registry_type(mapped_file_handle &&h)
+          : mh(std::move(h))
+      {
+      }
+    };
+    std::shared_ptr<_registry_type> _reg;
+
+    explicit shared_map_registry(std::shared_ptr<_registry_type> reg)
+        : _reg(std::move(reg))
+    {
+    }
+
+    static shared_map_registry_header *_header(const mapped_file_handle &mh) noexcept { return reinterpret_cast<shared_map_registry_header *>(mh.address()); }
+    static shared_map_registry_entry *_entries(const mapped_file_handle &mh) noexcept
+    {
+      return reinterpret_cast<shared_map_registry_entry *>(mh.address() + sizeof(shared_map_registry_header));
+    }
+    // The address of the start of the page into which the view is mapped
+    static uintptr_t _base(const map_handle &mh) noexcept
+    {
+#ifdef _WIN32
+      const uint64_t granularity = (mh.page_size() <= 65536) ? 65536 : mh.page_size();
+#else
+      const uint64_t granularity = mh.page_size();
+#endif
+      return reinterpret_cast<uintptr_t>(mh.address()) - (uintptr_t)(mh.offset() & (granularity - 1));
+    }
+    static int64_t _to_ns(std::chrono::system_clock::time_point tp) noexcept
+    {
+      return (int64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count();
+    }
+
+  public:
+    //! \brief A view of a file mapped via a `shared_map_registry`.
+    class view
+    {
+      friend class shared_map_registry;
+      struct _state_type
+      {
+        std::shared_ptr<_registry_type> registry;
+        file_handle fh;
+        section_handle sh;
+        map_handle mh;
+        stat_t st{nullptr};
+        uintptr_t base{0};
+        bool validated{false}, at_registered_address{false};
+      };
+      std::unique_ptr<_state_type> _state;
+
+    public:
+      //! Default constructor, not mapping anything
+      view() = default;
+      view(const view &) = delete;
+      view(view &&) = default;
+      view &operator=(const view &) = delete;
+      //! Move assignment, closing any existing view first
+      view &operator=(view &&o) noexcept
+      {
+        if(this != &o)
+        {
+          (void) close();
+          _state = std::move(o._state);
+        }
+        return *this;
+      }
+      //! Closes the view
+      ~view() { (void) close(); }
+
+      //! True if mapping something
+      bool is_valid() const noexcept { return !!_state; }
+      //! The address of the view
+      byte *address() const noexcept { return _state ? _state->mh.address() : nullptr; }
+      //! The bytes of the view which are valid to access
+      map_handle::size_type length() const noexcept { return _state ? _state->mh.length() : 0; }
+      //! The map of the view
+      map_handle &map() noexcept { return _state->mh; }
+      //! The backing file of the view
+      const file_handle &file() const noexcept { return _state->fh; }
+      //! True if a process has validated the contents of the file since it was last changed
+      bool is_validated() const noexcept { return _state && _state->validated; }
+      //! True if the view is at the address registered for it, as it is in all other processes able to
+      bool is_at_registered_address() const noexcept { return _state && _state->at_registered_address; }
+      //! Unmaps the view and closes the file, freeing its registration if it was the last view mapped at the registered address
+      result<void> close() noexcept
+      {
+        if(_state)
+        {
+          auto state = std::move(_state);
+          OUTCOME_TRY(state->mh.close());
+          OUTCOME_TRY(_release(*state));
+          OUTCOME_TRY(state->sh.close());
+          return state->fh.close();
+        }
+        return success();
+      }
+    };
+
+    //! Default constructor
+    shared_map_registry() = default;
+
+    /*! \brief Open the registry file at `path` relative to `base`, creating it with room for
+    `capacity` entries if it does not exist.
+
+    \errors `errc::invalid_argument` if the file exists but is not a registry of this version,
+    plus any of the values `mapped_file_handle::mapped_file()` and `truncate()` can return.
+    */
+    static result<shared_map_registry> open(const path_handle &base, mapped_file_handle::path_view_type path, uint32_t capacity = 1024) noexcept
+    {
+      const auto length = sizeof(shared_map_registry_header) + (size_t) capacity * sizeof(shared_map_registry_entry);
+      OUTCOME_TRY(auto &&mh_, mapped_file_handle::mapped_file(length, base, path, mapped_file_handle::mode::write, mapped_file_handle::creation::if_needed));
+      std::shared_ptr<_registry_type> ret;
+      try
+      {
+        ret = std::make_shared<_registry_type>(std::move(mh_));
+      }
+      catch(...)
+      {
+        return error_from_exception();
+      }
+      auto &mh = ret->mh;
+      {
+        OUTCOME_TRY(mh.lock_file());
+        auto unlock = make_scope_exit([&mh]() noexcept { mh.unlock_file(); });
+        OUTCOME_TRY(auto &&extent, mh.underlying_file_maximum_extent());
+        if(extent == 0)
+        {
+          OUTCOME_TRY(mh.truncate(length));
+          auto *header = new(mh.address()) shared_map_registry_header;
+          header->capacity = capacity;
+        }
+        else
+        {
+          auto *header = reinterpret_cast<const shared_map_registry_header *>(mh.address());
+          if(extent < sizeof(shared_map_registry_header) || header->magic != shared_map_registry_header::magic_value ||
+             header->version != shared_map_registry_header::current_version ||
+             extent < sizeof(shared_map_registry_header) + (uint64_t) header->capacity * sizeof(shared_map_registry_entry))
+          {
+            return errc::invalid_argument;
+          }
+          if(extent > mh.capacity())
+          {
+            OUTCOME_TRY(mh.reserve(extent));
+          }
+        }
+      }
+      return shared_map_registry(std::move(ret));
+    }
+
+    //! True if the registry is open
+    bool is_valid() const noexcept { return _reg && _reg->mh.is_valid(); }
+    //! The number of entries the registry can hold
+    uint32_t capacity() const noexcept { return is_valid() ? _header(_reg->mh)->capacity : 0; }
+
+    /*! \brief Map `bytes` (zero means all) of the file at `path` relative to `base` from `offset`,
+    at the address registered for that view if there is one, else registering the address chosen.
+
+    If the registry is full, the view is mapped but not registered. `flags` are as for
+    `map_handle::map()`, and also determine whether the file is opened for writing.
+
+    \errors Any of the values `file_handle::file()`, `section_handle::section()` and
+    `map_handle::map()` can return.
+    */
+    result<view> map(const path_handle &base, file_handle::path_view_type path, map_handle::size_type bytes = 0, map_handle::extent_type offset = 0,
+                     section_handle::flag flags = section_handle::flag::read) noexcept
+    {
+      try
+      {
+        if(!is_valid())
+        {
+          return errc::invalid_argument;
+        }
+        auto state = std::make_unique<view::_state_type>();
+        state->registry = _reg;
+        const bool writable = !!(flags & section_handle::flag::write);
+        OUTCOME_TRY(state->fh, file_handle::file(base, path, writable ? file_handle::mode::write : file_handle::mode::read));
+        OUTCOME_TRY(state->st.fill(state->fh, stat_t::want::dev | stat_t::want::ino | stat_t::want::size | stat_t::want::mtim));
+        OUTCOME_TRY(state->sh, section_handle::section(state->fh, 0, flags & section_handle::flag::readwrite));
+        if(bytes == 0)
+        {
+          bytes = (state->st.st_size > offset) ? (map_handle::size_type)(state->st.st_size - offset) : 0;
+        }
+        std::lock_guard<std::mutex> g(_reg->lock);
+        OUTCOME_TRY(_reg->mh.lock_file());
+        auto unlock = make_scope_exit([this]() noexcept { _reg->mh.unlock_file(); });
+        auto *entries = _entries(_reg->mh);
+        shared_map_registry_entry *entry = nullptr, *freeentry = nullptr;
+        for(uint32_t n = 0; n < _header(_reg->mh)->capacity; n++)
+        {
+          auto &e = entries[n];
+          if(e.address == 0)
+          {
+            if(freeentry == nullptr)
+            {
+              freeentry = &e;
+            }
+          }
+          else if(e.device == state->st.st_dev && e.inode == state->st.st_ino && e.offset == offset && e.length == bytes)
+          {
+            entry = &e;
+            break;
+          }
+        }
+        if(entry != nullptr)
+        {
+          auto mapped = map_handle::map(state->sh, bytes, offset, flags, reinterpret_cast<void *>(entry->address));
+          if(mapped)
+          {
+            state->mh = std::move(mapped).value();
+            state->base = (uintptr_t) entry->address;
+            state->at_registered_address = true;
+            entry->mappers++;
+          }
+          else if(mapped.error() == errc::address_in_use)
+          {
+            OUTCOME_TRY(state->mh, map_handle::map(state->sh, bytes, offset, flags));
+          }
+          else
+          {
+            return std::move(mapped).error();
+          }
+          state->validated = (entry->flags & shared_map_registry_entry::flag_validated) != 0 &&
+                             entry->file_length == (uint64_t) state->st.st_size && entry->file_modified == _to_ns(state->st.st_mtim);
+        }
+        else
+        {
+          OUTCOME_TRY(state->mh, map_handle::map(state->sh, bytes, offset, flags));
+          if(freeentry != nullptr)
+          {
+            freeentry->device = state->st.st_dev;
+            freeentry->inode = state->st.st_ino;
+            freeentry->offset = offset;
+            freeentry->length = bytes;
+            freeentry->file_length = 0;
+            freeentry->file_modified = 0;
+            freeentry->flags = 0;
+            freeentry->mappers = 1;
+            freeentry->address = state->base = _base(state->mh);
+            state->at_registered_address = true;
+          }
+        }
+        view ret;
+        ret._state = std::move(state);
+        return {std::move(ret)};
+      }
+      catch(...)
+      {
+        return error_from_exception();
+      }
+    }
+
+    /*! \brief Record in the registry that the contents of the file backing `v` are valid, until
+    its length or modification time changes. Does nothing if the view is not registered.
+    */
+    result<void> mark_validated(view &v) noexcept
+    {
+      if(!v.is_valid())
+      {
+        return errc::invalid_argument;
+      }
+      std::lock_guard<std::mutex> g(v._state->registry->lock);
+      OUTCOME_TRY(v._state->registry->mh.lock_file());
+      auto unlock = make_scope_exit([&v]() noexcept { v._state->registry->mh.unlock_file(); });
+      auto *e = _find(*v._state);
+      if(e != nullptr)
+      {
+        // The file may have been changed since it was mapped
+        stat_t st(nullptr);
+        OUTCOME_TRY(st.fill(v._state->fh, stat_t::want::size | stat_t::want::mtim));
+        e->file_length = st.st_size;
+        e->file_modified = _to_ns(st.st_mtim);
+        e->flags |= shared_map_registry_entry::flag_validated;
+      }
+      v._state->validated = true;
+      return success();
+    }
+
+    /*! \brief Remove the registration of the view `v`, such that the next process to map it
+    chooses a new address and must validate it afresh. The view remains mapped. This also removes
+    registrations left behind by processes which exited without closing their views.
+    */
+    result<void> forget(view &v) noexcept
+    {
+      if(!v.is_valid())
+      {
+        return errc::invalid_argument;
+      }
+      std::lock_guard<std::mutex> g(v._state->registry->lock);
+      OUTCOME_TRY(v._state->registry->mh.lock_file());
+      auto unlock = make_scope_exit([&v]() noexcept { v._state->registry->mh.unlock_file(); });
+      auto *e = _find(*v._state);
+      if(e != nullptr)
+      {
+        e->address = 0;
+        e->mappers = 0;
+      }
+      v._state->at_registered_address = false;
+      v._state->validated = false;
+      return success();
+    }
+
+  private:
+    // Must be called with the registry locked
+    static shared_map_registry_entry *_find(const view::_state_type &state) noexcept
+    {
+      if(!state.at_registered_address)
+      {
+        return nullptr;
+      }
+      auto *entries = _entries(state.registry->mh);
+      for(uint32_t n = 0; n < _header(state.registry->mh)->capacity; n++)
+      {
+        auto &e = entries[n];
+        if(e.address == state.base && e.device == state.st.st_dev && e.inode == state.st.st_ino)
+        {
+          return &e;
+        }
+      }
+      return nullptr;
+    }
+    // Drops the view's count of its registration, freeing the registration if it was the last
+    static result<void> _release(view::_state_type &state) noexcept
+    {
+      if(!state.at_registered_address)
+      {
+        return success();
+      }
+      std::lock_guard<std::mutex> g(state.registry->lock);
+      OUTCOME_TRY(state.registry->mh.lock_file());
+      auto unlock = make_scope_exit([&state]() noexcept { state.registry->mh.unlock_file(); });
+      auto *e = _find(state);
+      if(e != nullptr && (e->mappers <= 1))
+      {
+        e->address = 0;
+        e->mappers = 0;
+      }
+      else if(e != nullptr)
+      {
+        e->mappers--;
+      }
+      state.at_registered_address = false;
+      return success();
+    }
+  };
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
+
+#endif
@@ -0,0 +1,237 @@
+/* Drains binary trace events into a memory mapped file
+(C) 2026 agent <agent@local> (2 commits)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#ifndef LLFIO_ALGORITHM_TRACE_RECORDER_HPP
+#define LLFIO_ALGORITHM_TRACE_RECORDER_HPP
+
+#include "../mapped_file_handle.hpp"
+#include "../tracing.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+//! \file trace_recorder.hpp Provides a background drain of binary trace events into a file.
+
+LLFIO_V2_NAMESPACE_EXPORT_BEGIN
+
+namespace algorithm
+{
+  /*! \brief The header at the front of a binary trace file, exactly 64 bytes.
+
+  It is followed by `events` instances of `trace_event`, in per-thread order but with threads
+  arbitrarily interleaved. `programs/trace-decode` converts a trace file into text.
+  */
+  struct trace_file_header
+  {
+    static constexpr uint64_t magic_value = 0x4352544f49464c4cULL;  // "LLFIOTRC" little endian
+    static constexpr uint32_t current_version = 1;
+
+    uint64_t magic{magic_value};
+    uint32_t version{current_version};
+    uint32_t event_size{sizeof(trace_event)};
+    uint64_t steady_epoch{0};  //!< `tracing::now()` when recording began.
+    uint64_t system_epoch{0};  //!< Nanoseconds since 1970 UTC at the same moment as `steady_epoch`.
+    uint64_t events{0};        //!< The number of valid events which follow.
+    uint64_t dropped{0};       //!< The number of events which were dropped during recording.
+    uint64_t _reserved[2]{0, 0};
+  };
+  static_assert(sizeof(trace_file_header) == 64, "trace_file_header is not 64 bytes in size!");
+
+  /*! \class trace_recorder
+  \brief Enables binary event tracing, and drains the events recorded by all threads into a
+  memory mapped file from a background thread.
+
+  The file is grown in chunks as needed, and on `stop()` or destruction is truncated to exactly
+  the header plus the events recorded. The header's `events` count is kept current whilst
+  recording, so a trace file is decodable even if the process dies.
+
+  The background thread never records events of its own. Only one recorder should be running
+  at a time, as tracing is process wide.
+  */
+  class trace_recorder
+  {
+    struct _state_type
+    {
+      mapped_file_handle mh;
+      std::chrono::milliseconds interval;
+      std::mutex lock;
+      std::condition_variable changed;
+      bool stopping{false};
+      std::thread thread;
+      std::atomic<uint64_t> events{0};
+      size_t capacity{0};  // events which fit into the file at its current length
+      result<void> error{success()};
+
+      trace_file_header *header() noexcept { return reinterpret_cast<trace_file_header *>(mh.address()); }
+
+      // Returns true if more events may be waiting
+      result<bool> drain_once() noexcept
+      {
+        static constexpr size_t growth = 65536;  // 2Mb of events
+        auto count = events.load(std::memory_order_relaxed);
+        if(capacity - count < growth / 4)
+        {
+          const auto newcapacity = capacity + std::max(capacity, growth);
+          OUTCOME_TRY(mh.truncate(sizeof(trace_file_header) + newcapacity * sizeof(trace_event)));
+          capacity = newcapacity;
+        }
+        auto *out = reinterpret_cast<trace_event *>(mh.address() + sizeof(trace_file_header));
+        const auto space = (size_t)(capacity - count);
+        const auto drained = tracing::drain(out + count, space);
+        count += drained;
+        events.store(count, std::memory_order_relaxed);
+        header()->events = count;
+        header()->dropped = tracing::dropped();
+        return drained == space;
+      }
+      void run() noexcept
+      {
+        // Don't record the map changes made by growing the file
+        detail::trace_this_thread().finished = true;
+        std::unique_lock<std::mutex> g(lock);
+        while(!stopping)
+        {
+          changed.wait_for(g, interval);
+          g.unlock();
+          result<bool> r(true);
+          while(r && r.value())
+          {
+            r = drain_once();
+          }
+          g.lock();
+          if(!r)
+          {
+            error = std::move(r).as_failure();
+            return;
+          }
+        }
+      }
+    };
+    std::unique_ptr<_state_type> _state;
+
+    explicit trace_recorder(std::unique_ptr<_state_type> state)
+        : _state(std::move(state))
+    {
+    }
+
+  public:
+    //! Default constructor, not recording
+    trace_recorder() = default;
+    trace_recorder(const trace_recorder &) = delete;
+    trace_recorder(trace_recorder &&) = default;
+    trace_recorder &operator=(const trace_recorder &) = delete;
+    trace_recorder &operator=(trace_recorder &&o) noexcept
+    {
+      if(this == &o)
+      {
+        return *this;
+      }
+      this->~trace_recorder();
+      new(this) trace_recorder(std::move(o));
+      return *this;
+    }
+    //! Stops recording, if recording
+    ~trace_recorder()
+    {
+      if(_state)
+      {
+        (void) stop();
+      }
+    }
+
+    /*! \brief Create or truncate the file at `path` relative to `base`, enable tracing, and begin
+    draining events into it every `interval`.
+
+    \errors Any of the values `mapped_file_handle::mapped_file()` and `truncate()` can return.
+    \mallocs Allocates the recorder state and a thread.
+    */
+    static result<trace_recorder> start(const path_handle &base, mapped_file_handle::path_view_type path,
+                                        std::chrono::milliseconds interval = std::chrono::milliseconds(10)) noexcept
+    {
+      try
+      {
+        auto state = std::make_unique<_state_type>();
+        OUTCOME_TRY(state->mh, mapped_file_handle::mapped_file((mapped_file_handle::size_type) 1 << 30U, base, path, mapped_file_handle::mode::write,
+                                                               mapped_file_handle::creation::if_needed));
+        OUTCOME_TRY(state->mh.truncate(0));
+        OUTCOME_TRY(state->mh.truncate(sizeof(trace_file_header)));
+        state->interval = interval;
+        auto *header = new(state->mh.address()) trace_file_header;
+        header->steady_epoch = tracing::now();
+        header->system_epoch =
+        (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        tracing::enable(true);
+        auto *s = state.get();
+        state->thread = std::thread([s] { s->run(); });
+        return trace_recorder(std::move(state));
+      }
+      catch(...)
+      {
+        tracing::enable(false);
+        return error_from_exception();
+      }
+    }
+
+    //! True if recording
+    bool is_recording() const noexcept { return !!_state; }
+    //! The number of events written to the file so far
+    uint64_t events_recorded() const noexcept { return _state ? _state->events.load(std::memory_order_relaxed) : 0; }
+
+    /*! \brief Disable tracing, drain any remaining events, and truncate the file to its final size.
+    Returns any error which occurred whilst recording.
+    */
+    result<void> stop() noexcept
+    {
+      if(!_state)
+      {
+        return success();
+      }
+      auto state = std::move(_state);
+      tracing::enable(false);
+      {
+        std::lock_guard<std::mutex> g(state->lock);
+        state->stopping = true;
+      }
+      state->changed.notify_all();
+      state->thread.join();
+      OUTCOME_TRY(std::move(state->error));
+      result<bool> r(true);
+      while(r && r.value())
+      {
+        r = state->drain_once();
+      }
+      OUTCOME_TRY(std::move(r));
+      const auto count = state->events.load(std::memory_order_relaxed);
+      OUTCOME_TRY(state->mh.truncate(sizeof(trace_file_header) + count * sizeof(trace_event)));
+      return state->mh.close();
+    }
+  };
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
+
+#endif
@@ -26,6 +26,7 @@ Distributed under the Boost Software License, Version 1.0.
 #define LLFIO_ALGORITHM_VECTOR_HPP
 
 #include "../map_handle.hpp"
+#include "../path_discovery.hpp"
 #include "../utils.hpp"
 
 
@@ -35,6 +36,28 @@ LLFIO_V2_NAMESPACE_BEGIN
 
 namespace algorithm
 {
+  /*! \brief Storage policy for a `trivial_vector`.
+
+  Very large vectors can spend much of their time in TLB misses, and in page faulting in each
+  new 4Kb page as they grow. These options trade memory usage and growth latency for that.
+  */
+  struct trivial_vector_policy
+  {
+    /*! Once the capacity in bytes reaches this, the storage is moved into memory using
+    `utils::page_sizes()[1]` sized pages (i.e. `section_handle::flag::page_sizes_1`), with
+    capacity rounded up to multiples of that page size thereafter. Zero disables. If large pages
+    cannot be allocated, the vector silently continues with normal pages.
+    */
+    size_t large_page_threshold{0};
+    /*! If not negative, all storage is bound to this NUMA node (see `map_handle::bind_to_numa_node()`).
+    To make this effective, normal page sized storage is placed in
+    `path_discovery::memory_backed_temporary_files_directory()` where available.
+    */
+    int numa_node{-1};
+    //! Fault in each increase of capacity immediately (see `map_handle::prefault()`).
+    bool prefault{false};
+  };
+
 #ifndef DOXYGEN_IS_IN_THE_HOUSE
   namespace detail
 #else
@@ -185,6 +208,8 @@ namespace algorithm
       section_handle _sh;
       map_handle _mh;
       pointer _begin{nullptr}, _end{nullptr}, _capacity{nullptr};
+      trivial_vector_policy _policy;
+      bool _large_pages{false}, _large_pages_failed{false};
 
       static size_type _scale_capacity(size_type cap)
       {
@@ -196,6 +221,56 @@ namespace algorithm
         return cap * 2;
       }
 
+      // Moves or grows the storage into large pages, returning false if they could not be allocated
+      bool _reserve_large_pages(size_type bytes)
+      {
+        const auto &pagesizes = utils::page_sizes();
+        if(pagesizes.size() < 2)
+        {
+          _large_pages_failed = true;
+          return false;
+        }
+        bytes = utils::round_up_to_page_size(bytes, pagesizes[1]);
+        if(_large_pages && _mh.truncate(bytes, true))
+        {
+          return true;
+        }
+        auto mh = map_handle::map(bytes, false, section_handle::flag::readwrite | section_handle::flag::page_sizes_1);
+        if(!mh)
+        {
+          if(!_large_pages)
+          {
+            _large_pages_failed = true;
+            return false;
+          }
+          // Can't go back to normal pages, so the error is fatal
+          mh.value();
+        }
+        // One off copy of the contents
+        memcpy(mh.value().address(), _begin, size() * sizeof(value_type));
+        _mh = std::move(mh).value();
+        _sh = section_handle();
+        _large_pages = true;
+        return true;
+      }
+      // Applies the NUMA and prefault policies to new storage [oldbytes, bytes)
+      void _apply_policy(size_type oldbytes, size_type bytes) noexcept
+      {
+        if(bytes <= oldbytes)
+        {
+          return;
+        }
+        if(_policy.numa_node >= 0)
+        {
+          // Best effort, as the storage is perfectly usable if this fails
+          (void) _mh.bind_to_numa_node({_mh.address(), bytes}, (unsigned) _policy.numa_node);
+        }
+        if(_policy.prefault)
+        {
+          (void) _mh.prefault({_mh.address() + oldbytes, bytes - oldbytes});
+        }
+      }
+
     public:
       //! Default constructor
       constexpr trivial_vector_impl() {}  // NOLINT
@@ -208,10 +283,14 @@ namespace algorithm
       //! Copy assigned disabled, use range constructor if you really want this
       trivial_vector_impl &operator=(const trivial_vector_impl &) = delete;
       //! Move constructor
-      trivial_vector_impl(trivial_vector_impl &&o) noexcept : _sh(std::move(o._sh)), _mh(std::move(o._mh)), _begin(o._begin), _end(o._end), _capacity(o._capacity)
+      trivial_vector_impl(trivial_vector_impl &&o) noexcept : _sh(std::move(o._sh)), _mh(std::move(o._mh)), _begin(o._begin), _end(o._end), _capacity(o._capacity), _policy(o._policy), _large_pages(o._large_pages), _large_pages_failed(o._large_pages_failed)
       {
-        _mh.set_section(&_sh);
+        if(!_large_pages)
+        {
+          _mh.set_section(&_sh);
+        }
         o._begin = o._end = o._capacity = nullptr;
+        o._large_pages = false;
       }
       //! Move assignment
       trivial_vector_impl &operator=(trivial_vector_impl &&o) noexcept
@@ -226,8 +305,24 @@ namespace algorithm
       }
       //! Initialiser list constructor
       trivial_vector_impl(std::initializer_list<value_type> il);
+      //! Constructs an empty vector with the given storage policy
+      explicit trivial_vector_impl(const trivial_vector_policy &policy)
+          : _policy(policy)
+      {
+      }
       ~trivial_vector_impl() { clear(); }
 
+      //! The storage policy
+      const trivial_vector_policy &policy() const noexcept { return _policy; }
+      //! Sets the storage policy, which takes effect from the next increase in capacity
+      void set_policy(const trivial_vector_policy &policy) noexcept
+      {
+        _policy = policy;
+        _large_pages_failed = false;
+      }
+      //! True if the storage is currently in large pages
+      bool uses_large_pages() const noexcept { return _large_pages; }
+
       //! Assigns
       void assign(size_type count, const value_type &v)
       {
@@ -316,34 +411,52 @@ namespace algorithm
         {
           throw std::length_error("Max size exceeded");  // NOLINT
         }
+        if(_sh.is_valid() || _large_pages)
+        {
+          if(n <= capacity())
+          {
+            return;
+          }
+        }
         size_type current_size = size();
+        size_type oldbytes = capacity() * sizeof(value_type);
         size_type bytes = n * sizeof(value_type);
         bytes = utils::round_up_to_page_size(bytes, utils::page_size());
-        if(!_sh.is_valid())
+        if(_large_pages || (_policy.large_page_threshold != 0 && !_large_pages_failed && bytes >= _policy.large_page_threshold))
         {
-          _sh = section_handle::section(bytes).value();
-          _mh = map_handle::map(_sh, bytes).value();
+          _reserve_large_pages(bytes);
         }
-        else if(n > capacity())
+        if(!_large_pages)
         {
-          // We can always grow a section even with maps open on it
-          _sh.truncate(bytes).value();
-          // Attempt to resize the map in place
-          if(!_mh.truncate(bytes, true))
+          if(!_sh.is_valid())
           {
-            // std::cerr << "truncate fail" << std::endl;
-            // If can't resize, close the map and reopen it into a new address
-            _mh.close().value();
+            const path_handle &memory_backed = path_discovery::memory_backed_temporary_files_directory();
+            _sh = ((_policy.numa_node >= 0 && memory_backed.is_valid()) ? section_handle::section(bytes, memory_backed) : section_handle::section(bytes)).value();
             _mh = map_handle::map(_sh, bytes).value();
+            oldbytes = 0;
+          }
+          else
+          {
+            // We can always grow a section even with maps open on it
+            _sh.truncate(bytes).value();
+            // Attempt to resize the map in place
+            if(!_mh.truncate(bytes, true))
+            {
+              // std::cerr << "truncate fail" << std::endl;
+              // If can't resize, close the map and reopen it into a new address
+              _mh.close().value();
+              _mh = map_handle::map(_sh, bytes).value();
+            }
           }
         }
         else
         {
-          return;
+          bytes = _mh.length();
         }
         _begin = reinterpret_cast<pointer>(_mh.address());
         _capacity = reinterpret_cast<pointer>(_mh.address() + bytes);
         _end = _begin + current_size;
+        _apply_policy(oldbytes, bytes);
       }
       //! Items can be stored until storage expanded
       size_type capacity() const noexcept { return _capacity - _begin; }
@@ -360,13 +473,24 @@ namespace algorithm
         if(bytes == 0)
         {
           _mh.close().value();
-          _sh.close().value();
+          if(_sh.is_valid())
+          {
+            _sh.close().value();
+          }
+          _large_pages = false;
           _begin = _end = _capacity = nullptr;
           return;
         }
-        _mh.close().value();
-        _sh.truncate(bytes).value();
-        _mh = map_handle::map(_sh, bytes).value();
+        if(_large_pages)
+        {
+          _mh.truncate(bytes, true).value();
+        }
+        else
+        {
+          _mh.close().value();
+          _sh.truncate(bytes).value();
+          _mh = map_handle::map(_sh, bytes).value();
+        }
         _begin = reinterpret_cast<pointer>(_mh.address());
         _capacity = reinterpret_cast<pointer>(_mh.address() + bytes);
         _end = _begin + current_size;
@@ -542,6 +666,18 @@ namespace algorithm
         swap(_begin, o._begin);
         swap(_end, o._end);
         swap(_capacity, o._capacity);
+        swap(_policy, o._policy);
+        swap(_large_pages, o._large_pages);
+        swap(_large_pages_failed, o._large_pages_failed);
+        // The maps now refer to each other's section
+        if(!_large_pages)
+        {
+          _mh.set_section(&_sh);
+        }
+        if(!o._large_pages)
+        {
+          o._mh.set_section(&o._sh);
+        }
       }
     };
 
@@ -610,6 +746,11 @@ before going to the kernel to resize the `section_handle` and remapping memory
 becomes faster than `memcpy`. For these reasons, this vector implementation is
 best suited to arrays of unknown in advance, but likely large, sizes.
 
+For very large vectors, a `trivial_vector_policy` can be supplied at construction or via
+`set_policy()` to move the storage into large pages past a capacity threshold, to bind the
+storage to a NUMA node, and to prefault each increase in capacity. Note that storage in large
+pages is anonymous memory, so on platforms other than Linux its growth may require a `memcpy()`.
+
 Benchmarking notes for Skylake 3.1Ghz Intel Core i5 with 2133Mhz DDR3 RAM, L2 256Kb,
 L3 4Mb:
 - OS X with clang 5.0 and libc++
@@ -0,0 +1,490 @@
+/* A read-through block cache handle adapter
+(C) 2026 agent <agent@local> (2 commits)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#include "../../algorithm/handle_adapter/block_cache.hpp"
+
+#include <mutex>
+
+LLFIO_V2_NAMESPACE_BEGIN
+
+namespace algorithm
+{
+  namespace detail
+  {
+    struct block_cache::_shard
+    {
+      enum class slot_state : uint8_t
+      {
+        free,
+        pending,  // reserved by a reader, not yet readable
+        small,
+        main,
+        invalid  // dropped, but still in a queue awaiting reclaim
+      };
+      struct slot_type
+      {
+        extent_type block{0};
+        slot_state state{slot_state::free};
+        uint8_t freq{0};
+        bool tracked{false};    // pending slot is in the table and may be published
+        bool was_ghost{false};  // pending slot was a ghost, so goes straight into main
+      };
+      static constexpr uint32_t ghost = (uint32_t) -1;
+      static constexpr extent_type empty_key = (extent_type) -1;
+      static constexpr size_t npos = (size_t) -1;
+      struct entry_type
+      {
+        extent_type key{empty_key};
+        uint32_t value{0};
+      };
+      template <class T> struct ring
+      {
+        std::vector<T> items;
+        size_t head{0}, count{0};
+
+        bool empty() const noexcept { return count == 0; }
+        bool full() const noexcept { return count == items.size(); }
+        void push(T v) noexcept
+        {
+          items[(head + count) % items.size()] = v;
+          count++;
+        }
+        T pop() noexcept
+        {
+          T v = items[head];
+          head = (head + 1) % items.size();
+          count--;
+          return v;
+        }
+      };
+
+      std::mutex lock;
+      byte *base{nullptr};
+      size_t blocksize{0};
+      std::vector<slot_type> slots;
+      std::vector<uint32_t> freelist;
+      ring<uint32_t> small, main;
+      ring<extent_type> ghosts;
+      size_t smalltarget{1}, invalidinmain{0};
+      // Open addressed hash table of block to slot index, or to ghost
+      std::vector<entry_type> table;
+      size_t mask{0};
+      unsigned shift{0};
+      block_cache_statistics stats;
+
+      void init(byte *_base, size_t count, size_t _blocksize)
+      {
+        base = _base;
+        blocksize = _blocksize;
+        slots.resize(count);
+        freelist.reserve(count);
+        for(size_t n = count; n > 0; n--)
+        {
+          freelist.push_back((uint32_t)(n - 1));
+        }
+        small.items.resize(count);
+        main.items.resize(count);
+        ghosts.items.resize(count);
+        smalltarget = std::max((size_t) 1, count / 10);
+        // At most one entry per slot plus one per ghost, kept under half full
+        size_t tablesize = 4;
+        shift = 62;
+        while(tablesize < count * 4)
+        {
+          tablesize <<= 1;
+          shift--;
+        }
+        table.resize(tablesize);
+        mask = tablesize - 1;
+      }
+
+      size_t _home(extent_type key) const noexcept { return (size_t)((key * 0x9E3779B97F4A7C15ULL) >> shift) & mask; }
+      size_t find(extent_type key) const noexcept
+      {
+        for(size_t i = _home(key);; i = (i + 1) & mask)
+        {
+          if(table[i].key == key)
+          {
+            return i;
+          }
+          if(table[i].key == empty_key)
+          {
+            return npos;
+          }
+        }
+      }
+      void insert(extent_type key, uint32_t value) noexcept
+      {
+        size_t i = _home(key);
+        while(table[i].key != empty_key)
+        {
+          i = (i + 1) & mask;
+        }
+        table[i].key = key;
+        table[i].value = value;
+      }
+      // Backward shift deletion, so no tombstones are needed
+      void erase(size_t i) noexcept
+      {
+        for(size_t j = i;;)
+        {
+          j = (j + 1) & mask;
+          if(table[j].key == empty_key)
+          {
+            break;
+          }
+          const size_t k = _home(table[j].key);
+          if((i <= j) ? (i < k && k <= j) : (i < k || k <= j))
+          {
+            continue;
+          }
+          table[i] = table[j];
+          i = j;
+        }
+        table[i] = entry_type();
+      }
+
+      uint32_t index(const byte *p) const noexcept { return (uint32_t)((size_t)(p - base) / blocksize); }
+      bool is_resident(const entry_type &e) const noexcept { return e.value != ghost && (slots[e.value].state == slot_state::small || slots[e.value].state == slot_state::main); }
+      void free_slot(uint32_t idx) noexcept
+      {
+        slots[idx].state = slot_state::free;
+        slots[idx].tracked = false;
+        freelist.push_back(idx);
+      }
+      void remember_ghost(extent_type block) noexcept
+      {
+        if(ghosts.full())
+        {
+          const extent_type old = ghosts.pop();
+          const size_t pos = find(old);
+          if(pos != npos && table[pos].value == ghost)
+          {
+            erase(pos);
+          }
+        }
+        ghosts.push(block);
+      }
+      // Drops whatever the table entry refers to
+      void drop(size_t pos) noexcept
+      {
+        const uint32_t v = table[pos].value;
+        erase(pos);
+        if(v == ghost)
+        {
+          return;
+        }
+        slot_type &s = slots[v];
+        if(s.state == slot_state::pending)
+        {
+          s.tracked = false;
+          return;
+        }
+        if(s.state == slot_state::main)
+        {
+          invalidinmain++;
+        }
+        s.state = slot_state::invalid;
+        stats.invalidations++;
+      }
+
+      // S3-FIFO eviction of one slot onto the freelist
+      bool evict() noexcept
+      {
+        // Dropped slots in main would otherwise only be reclaimed when main next evicts, which a
+        // scan never causes, so rotate main to reclaim them first
+        while(invalidinmain > 0)
+        {
+          const uint32_t idx = main.pop();
+          if(slots[idx].state == slot_state::invalid)
+          {
+            invalidinmain--;
+            free_slot(idx);
+            return true;
+          }
+          main.push(idx);
+        }
+        for(;;)
+        {
+          if(!small.empty() && (small.count >= smalltarget || main.empty()))
+          {
+            const uint32_t idx = small.pop();
+            slot_type &s = slots[idx];
+            if(s.state == slot_state::invalid)
+            {
+              free_slot(idx);
+              return true;
+            }
+            if(s.freq > 0)
+            {
+              s.state = slot_state::main;
+              s.freq = 0;
+              main.push(idx);
+              continue;
+            }
+            table[find(s.block)].value = ghost;
+            remember_ghost(s.block);
+            free_slot(idx);
+            stats.evictions++;
+            return true;
+          }
+          if(main.empty())
+          {
+            return false;
+          }
+          const uint32_t idx = main.pop();
+          slot_type &s = slots[idx];
+          if(s.freq > 0)
+          {
+            s.freq--;
+            main.push(idx);
+            continue;
+          }
+          erase(find(s.block));
+          free_slot(idx);
+          stats.evictions++;
+          return true;
+        }
+      }
+    };
+
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC block_cache::block_cache(size_t capacity, size_t blocksize, size_t shards)
+    {
+      _blocksize = std::max(utils::page_size(), (size_t) 4096);
+      while(_blocksize < blocksize)
+      {
+        _blocksize <<= 1;
+      }
+      const size_t slots = capacity / _blocksize;
+      _shardcount = std::max((size_t) 1, std::min(shards, slots));
+      const size_t slotspershard = slots / _shardcount;
+      if(slotspershard == 0)
+      {
+        return;
+      }
+      auto arena = map_handle::map(slotspershard * _shardcount * _blocksize);
+      if(!arena)
+      {
+        return;
+      }
+      _arena = std::move(arena).value();
+      _slots = slotspershard * _shardcount;
+      _shards = std::make_unique<_shard[]>(_shardcount);
+      for(size_t n = 0; n < _shardcount; n++)
+      {
+        _shards[n].init(_arena.address() + n * slotspershard * _blocksize, slotspershard, _blocksize);
+      }
+    }
+
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC block_cache::~block_cache() = default;
+
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC block_cache::_shard &block_cache::_shard_for(extent_type block) const noexcept { return _shards[(size_t)(block % _shardcount)]; }
+
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC bool block_cache::contains(extent_type block) const noexcept
+    {
+      _shard &s = _shard_for(block);
+      std::lock_guard<std::mutex> g(s.lock);
+      const size_t pos = s.find(block);
+      return pos != _shard::npos && s.is_resident(s.table[pos]);
+    }
+
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC bool block_cache::lookup(extent_type block, size_t offset, size_t bytes, block_cache_scatter_cursor &out) noexcept
+    {
+      _shard &s = _shard_for(block);
+      std::lock_guard<std::mutex> g(s.lock);
+      const size_t pos = s.find(block);
+      if(pos == _shard::npos || !s.is_resident(s.table[pos]))
+      {
+        return false;
+      }
+      const uint32_t idx = s.table[pos].value;
+      if(s.slots[idx].freq < 3)
+      {
+        s.slots[idx].freq++;
+      }
+      // Copied under the lock so the slot cannot be evicted and reused meanwhile
+      out.copy_in(s.base + idx * _blocksize + offset, bytes);
+      s.stats.hits++;
+      return true;
+    }
+
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC byte *block_cache::reserve(extent_type block) noexcept
+    {
+      _shard &s = _shard_for(block);
+      std::lock_guard<std::mutex> g(s.lock);
+      s.stats.misses++;
+      if(s.freelist.empty() && !s.evict())
+      {
+        return nullptr;
+      }
+      const uint32_t idx = s.freelist.back();
+      s.freelist.pop_back();
+      _shard::slot_type &slot = s.slots[idx];
+      slot.block = block;
+      slot.state = _shard::slot_state::pending;
+      slot.freq = 0;
+      slot.tracked = false;
+      slot.was_ghost = false;
+      const size_t pos = s.find(block);
+      if(pos == _shard::npos)
+      {
+        slot.tracked = true;
+        s.insert(block, idx);
+      }
+      else if(s.table[pos].value == _shard::ghost)
+      {
+        slot.tracked = true;
+        slot.was_ghost = true;
+        s.table[pos].value = idx;
+      }
+      // Otherwise another reader got here first, and this slot is only used to read into
+      return s.base + idx * _blocksize;
+    }
+
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void block_cache::publish(extent_type block, byte *slot) noexcept
+    {
+      _shard &s = _shard_for(block);
+      std::lock_guard<std::mutex> g(s.lock);
+      const uint32_t idx = s.index(slot);
+      _shard::slot_type &sl = s.slots[idx];
+      if(!sl.tracked)
+      {
+        s.free_slot(idx);
+        return;
+      }
+      sl.tracked = false;
+      sl.freq = 0;
+      if(sl.was_ghost)
+      {
+        sl.state = _shard::slot_state::main;
+        s.main.push(idx);
+      }
+      else
+      {
+        sl.state = _shard::slot_state::small;
+        s.small.push(idx);
+      }
+      s.stats.insertions++;
+    }
+
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void block_cache::release(extent_type block, byte *slot) noexcept
+    {
+      _shard &s = _shard_for(block);
+      std::lock_guard<std::mutex> g(s.lock);
+      const uint32_t idx = s.index(slot);
+      if(s.slots[idx].tracked)
+      {
+        const size_t pos = s.find(block);
+        if(pos != _shard::npos)
+        {
+          s.erase(pos);
+        }
+      }
+      s.free_slot(idx);
+    }
+
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void block_cache::update(extent_type block, size_t offset, const byte *data, size_t bytes) noexcept
+    {
+      _shard &s = _shard_for(block);
+      std::lock_guard<std::mutex> g(s.lock);
+      const size_t pos = s.find(block);
+      if(pos == _shard::npos || s.table[pos].value == _shard::ghost)
+      {
+        return;
+      }
+      const uint32_t idx = s.table[pos].value;
+      if(s.slots[idx].state == _shard::slot_state::pending)
+      {
+        // What is being read may predate this write
+        s.drop(pos);
+        return;
+      }
+      memcpy(s.base + idx * _blocksize + offset, data, bytes);
+    }
+
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void block_cache::invalidate(extent_type block) noexcept
+    {
+      _shard &s = _shard_for(block);
+      std::lock_guard<std::mutex> g(s.lock);
+      const size_t pos = s.find(block);
+      if(pos != _shard::npos)
+      {
+        s.drop(pos);
+      }
+    }
+
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void block_cache::invalidate_from(extent_type block) noexcept
+    {
+      for(size_t n = 0; n < _shardcount && _shards; n++)
+      {
+        _shard &s = _shards[n];
+        std::lock_guard<std::mutex> g(s.lock);
+        for(auto &sl : s.slots)
+        {
+          const bool intable = sl.state == _shard::slot_state::small || sl.state == _shard::slot_state::main || (sl.state == _shard::slot_state::pending && sl.tracked);
+          if(intable && sl.block >= block)
+          {
+            s.drop(s.find(sl.block));
+          }
+        }
+      }
+    }
+
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC block_cache_statistics block_cache::statistics() const noexcept
+    {
+      block_cache_statistics ret;
+      for(size_t n = 0; n < _shardcount && _shards; n++)
+      {
+        _shard &s = _shards[n];
+        std::lock_guard<std::mutex> g(s.lock);
+        ret.hits += s.stats.hits;
+        ret.misses += s.stats.misses;
+        ret.insertions += s.stats.insertions;
+        ret.evictions += s.stats.evictions;
+        ret.invalidations += s.stats.invalidations;
+        ret.bypasses += s.stats.bypasses;
+      }
+      return ret;
+    }
+
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void block_cache::reset_statistics() noexcept
+    {
+      for(size_t n = 0; n < _shardcount && _shards; n++)
+      {
+        _shard &s = _shards[n];
+        std::lock_guard<std::mutex> g(s.lock);
+        s.stats = block_cache_statistics();
+      }
+    }
+
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void block_cache::note_bypass(extent_type block) noexcept
+    {
+      _shard &s = _shard_for(block);
+      std::lock_guard<std::mutex> g(s.lock);
+      s.stats.bypasses++;
+    }
+  }  // namespace detail
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
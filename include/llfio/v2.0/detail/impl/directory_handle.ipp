@@ -0,0 +1,247 @@
+/* A handle to a directory
+(C) 2026 agent <agent@local> (2 commits)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#include "../../directory_handle.hpp"
+#include "../../utils.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+
+LLFIO_V2_NAMESPACE_BEGIN
+
+namespace detail
+{
+  struct directory_kernel_buffer_pool_globals
+  {
+    std::atomic<uint64_t> allocations{0}, reallocations{0}, reuses{0}, pooled_bytes{0};
+  };
+  inline directory_kernel_buffer_pool_globals &directory_kernel_buffer_pool_globals_instance() noexcept
+  {
+    static directory_kernel_buffer_pool_globals v;
+    return v;
+  }
+  inline bool &directory_kernel_buffer_pool_destroyed() noexcept
+  {
+    static LLFIO_THREAD_LOCAL bool v;
+    return v;
+  }
+  inline void directory_kernel_buffer_free(char *p) noexcept { operator delete[](p, std::align_val_t(utils::page_size())); }
+
+  struct directory_kernel_buffer_pool
+  {
+    static constexpr size_t max_cached = 4;
+    struct item_type
+    {
+      char *p;
+      size_t size;
+    };
+    item_type cached[max_cached]{};
+    size_t count{0};
+    size_t learned{0};  // what directories enumerated by this thread tend to need
+
+    directory_kernel_buffer_pool() = default;
+    directory_kernel_buffer_pool(const directory_kernel_buffer_pool &) = delete;
+    directory_kernel_buffer_pool &operator=(const directory_kernel_buffer_pool &) = delete;
+    ~directory_kernel_buffer_pool()
+    {
+      trim();
+      directory_kernel_buffer_pool_destroyed() = true;
+    }
+    void trim() noexcept
+    {
+      size_t freed = 0;
+      for(size_t n = 0; n < count; n++)
+      {
+        directory_kernel_buffer_free(cached[n].p);
+        freed += cached[n].size;
+      }
+      count = 0;
+      directory_kernel_buffer_pool_globals_instance().pooled_bytes.fetch_sub(freed, std::memory_order_relaxed);
+    }
+    // Takes the smallest cached buffer of at least `bytes`
+    item_type take(size_t bytes) noexcept
+    {
+      size_t best = count;
+      for(size_t n = 0; n < count; n++)
+      {
+        if(cached[n].size >= bytes && (best == count || cached[n].size < cached[best].size))
+        {
+          best = n;
+        }
+      }
+      if(best == count)
+      {
+        return {nullptr, 0};
+      }
+      auto ret = cached[best];
+      cached[best] = cached[--count];
+      directory_kernel_buffer_pool_globals_instance().pooled_bytes.fetch_sub(ret.size, std::memory_order_relaxed);
+      return ret;
+    }
+    // Keeps the buffer, evicting the smallest cached buffer if full
+    void give(char *p, size_t size) noexcept
+    {
+      if(count == max_cached)
+      {
+        size_t smallest = 0;
+        for(size_t n = 1; n < count; n++)
+        {
+          if(cached[n].size < cached[smallest].size)
+          {
+            smallest = n;
+          }
+        }
+        if(cached[smallest].size >= size)
+        {
+          directory_kernel_buffer_free(p);
+          return;
+        }
+        directory_kernel_buffer_free(cached[smallest].p);
+        directory_kernel_buffer_pool_globals_instance().pooled_bytes.fetch_sub(cached[smallest].size, std::memory_order_relaxed);
+        cached[smallest] = cached[--count];
+      }
+      cached[count++] = {p, size};
+      directory_kernel_buffer_pool_globals_instance().pooled_bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+  };
+  // Returns null if the calling thread is exiting
+  inline directory_kernel_buffer_pool *directory_kernel_buffer_pool_for_this_thread() noexcept
+  {
+    if(directory_kernel_buffer_pool_destroyed())
+    {
+      return nullptr;
+    }
+    static thread_local directory_kernel_buffer_pool v;
+    return &v;
+  }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void directory_kernel_buffer_deleter::operator()(char *p) const noexcept
+  {
+    if(p == nullptr)
+    {
+      return;
+    }
+    auto *pool = directory_kernel_buffer_pool_for_this_thread();
+    if(pool == nullptr)
+    {
+      directory_kernel_buffer_free(p);
+      return;
+    }
+    pool->give(p, size);
+  }
+}  // namespace detail
+
+LLFIO_HEADERS_ONLY_MEMFUNC_SPEC directory_handle::kernel_buffer_pool_statistics directory_handle::kernel_buffer_pool_stats() noexcept
+{
+  auto &globals = detail::directory_kernel_buffer_pool_globals_instance();
+  kernel_buffer_pool_statistics ret;
+  ret.allocations = globals.allocations.load(std::memory_order_relaxed);
+  ret.reallocations = globals.reallocations.load(std::memory_order_relaxed);
+  ret.reuses = globals.reuses.load(std::memory_order_relaxed);
+  ret.pooled_bytes = globals.pooled_bytes.load(std::memory_order_relaxed);
+  return ret;
+}
+
+LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void directory_handle::trim_kernel_buffer_pool() noexcept
+{
+  if(auto *pool = detail::directory_kernel_buffer_pool_for_this_thread())
+  {
+    pool->trim();
+    pool->learned = 0;
+  }
+}
+
+LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<void> directory_handle::_acquire_kernel_buffer(buffers_type &buffers, size_t minimum, bool grow) noexcept
+{
+  auto &globals = detail::directory_kernel_buffer_pool_globals_instance();
+  auto *pool = detail::directory_kernel_buffer_pool_for_this_thread();
+  size_t bytes = minimum;
+  if(grow)
+  {
+    bytes = std::max(bytes, buffers._kernel_buffer_size * 2);
+    globals.reallocations.fetch_add(1, std::memory_order_relaxed);
+    if(pool != nullptr)
+    {
+      // Directories on this thread need at least this much
+      pool->learned = std::max(pool->learned, bytes);
+    }
+  }
+  if(pool != nullptr)
+  {
+    bytes = std::max(bytes, pool->learned);
+  }
+  const size_t pagesize = utils::page_size();
+  bytes = utils::round_up_to_page_size(std::max<size_t>(bytes, 1), pagesize);
+  if(!grow && buffers._kernel_buffer && buffers._kernel_buffer_size >= bytes)
+  {
+    return success();
+  }
+  // Release the current buffer first, so it can be reused if large enough
+  buffers._kernel_buffer.reset();
+  buffers._kernel_buffer_size = 0;
+  if(pool != nullptr)
+  {
+    auto item = pool->take(bytes);
+    if(item.p != nullptr)
+    {
+      globals.reuses.fetch_add(1, std::memory_order_relaxed);
+      buffers._kernel_buffer = buffers_type::_kernel_buffer_ptr(item.p, detail::directory_kernel_buffer_deleter{item.size});
+      buffers._kernel_buffer_size = item.size;
+      return success();
+    }
+    // Allow a quarter for directory growth when allocating
+    bytes = utils::round_up_to_page_size(std::max(bytes, pool->learned + pool->learned / 4), pagesize);
+  }
+  auto *mem = static_cast<char *>(operator new[](bytes, std::align_val_t(pagesize), std::nothrow));  // don't initialise
+  if(mem == nullptr)
+  {
+    return errc::not_enough_memory;
+  }
+  globals.allocations.fetch_add(1, std::memory_order_relaxed);
+  buffers._kernel_buffer = buffers_type::_kernel_buffer_ptr(mem, detail::directory_kernel_buffer_deleter{bytes});
+  buffers._kernel_buffer_size = bytes;
+  return success();
+}
+
+LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void directory_handle::_kernel_buffer_used(size_t bytes) noexcept
+{
+  auto *pool = detail::directory_kernel_buffer_pool_for_this_thread();
+  if(pool == nullptr)
+  {
+    return;
+  }
+  // Jump up immediately, but decay only slowly, so the occasional small directory does not cause
+  // the next large one to reallocate
+  if(bytes >= pool->learned)
+  {
+    pool->learned = bytes;
+  }
+  else
+  {
+    pool->learned -= (pool->learned - bytes) / 8;
+  }
+}
+
+LLFIO_V2_NAMESPACE_END
@@ -65,9 +65,22 @@ Distributed under the Boost Software License, Version 1.0.
 #include <condition_variable>
 #include <thread>
 #endif
+#ifdef __linux__
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
 
 #define LLFIO_DYNAMIC_THREAD_POOL_GROUP_PRINTING 0
 
+#ifndef LLFIO_DYNAMIC_THREAD_POOL_GROUP_MAX_NUMA_NODES
+#define LLFIO_DYNAMIC_THREAD_POOL_GROUP_MAX_NUMA_NODES 8
+#endif
+
+#ifndef LLFIO_DYNAMIC_THREAD_POOL_GROUP_STARVATION_INTERVAL
+#define LLFIO_DYNAMIC_THREAD_POOL_GROUP_STARVATION_INTERVAL 16
+#endif
+
 /* NOTE that the Linux results are from a VM on the same machine as the Windows results,
 so they are not directly comparable.
 
@@ -227,6 +240,157 @@ namespace detail
   {
     using std::unique_lock<std::mutex>::unique_lock;
   };
+
+  /* The NUMA topology of the system, read once from /sys on Linux. Kernel node
+  numbers can be sparse, so they are mapped onto dense indices which are what
+  the thread pool uses internally.
+  */
+  struct dynamic_thread_pool_numa_topology
+  {
+    static constexpr size_t max_nodes = LLFIO_DYNAMIC_THREAD_POOL_GROUP_MAX_NUMA_NODES;
+    size_t nodes{1};
+#ifdef __linux__
+    size_t cpus_per_node[max_nodes]{};
+    cpu_set_t cpus[max_nodes];
+    std::vector<int> node_to_index;  // kernel node number => dense index
+    std::vector<int> cpu_to_index;   // cpu number => dense index
+
+    // Calls f(cpu) for each cpu in a list like "0-3,8-11"
+    template <class F> static bool _parse_list(const char *path, F &&f)
+    {
+      int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+      if(-1 == fd)
+      {
+        return false;
+      }
+      char buffer[4096];
+      auto bytesread = ::read(fd, buffer, sizeof(buffer) - 1);
+      ::close(fd);
+      if(bytesread <= 0)
+      {
+        return false;
+      }
+      buffer[bytesread] = 0;
+      for(char *p = buffer; *p >= '0' && *p <= '9';)
+      {
+        long first = strtol(p, &p, 10), last = first;
+        if(*p == '-')
+        {
+          last = strtol(p + 1, &p, 10);
+        }
+        for(long n = first; n <= last; n++)
+        {
+          f((int) n);
+        }
+        if(*p == ',')
+        {
+          ++p;
+        }
+      }
+      return true;
+    }
+#endif
+
+    dynamic_thread_pool_numa_topology()
+    {
+#ifdef __linux__
+      for(auto &i : cpus)
+      {
+        CPU_ZERO(&i);
+      }
+      std::vector<int> online;
+      _parse_list("/sys/devices/system/node/has_cpu", [&](int node) { online.push_back(node); });
+      if(online.size() < 2)
+      {
+        return;
+      }
+      try
+      {
+        node_to_index.assign(online.back() + 1, -1);
+        size_t idx = 0;
+        for(auto node : online)
+        {
+          node_to_index[node] = (int) (idx % max_nodes);
+          char path[64];
+          snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+          _parse_list(path, [&](int cpu) {
+            if(cpu < CPU_SETSIZE)
+            {
+              CPU_SET(cpu, &cpus[idx % max_nodes]);
+              cpus_per_node[idx % max_nodes]++;
+            }
+            if((size_t) cpu >= cpu_to_index.size())
+            {
+              cpu_to_index.resize(cpu + 1, -1);
+            }
+            cpu_to_index[cpu] = (int) (idx % max_nodes);
+          });
+          idx++;
+        }
+        nodes = std::min(idx, max_nodes);
+      }
+      catch(...)
+      {
+        node_to_index.clear();
+        cpu_to_index.clear();
+        nodes = 1;
+      }
+#endif
+    }
+
+    // Returns the dense index for a kernel node number, or -1 if NUMA hints are to be ignored
+    int node_index(int node) const noexcept
+    {
+#ifdef __linux__
+      if(node < 0 || nodes < 2 || (size_t) node >= node_to_index.size())
+      {
+        return -1;
+      }
+      return node_to_index[node];
+#else
+      (void) node;
+      return -1;
+#endif
+    }
+    // Returns the kernel node number for a dense index
+    int node_number(int idx) const noexcept
+    {
+#ifdef __linux__
+      for(size_t n = 0; n < node_to_index.size(); n++)
+      {
+        if(node_to_index[n] == idx)
+        {
+          return (int) n;
+        }
+      }
+#endif
+      (void) idx;
+      return 0;
+    }
+    // Returns the kernel node number of the calling thread's current CPU, or -1 if unknown
+    int current_node() const noexcept
+    {
+#ifdef __linux__
+      if(nodes < 2)
+      {
+        return 0;
+      }
+      const int cpu = sched_getcpu();
+      if(cpu < 0 || (size_t) cpu >= cpu_to_index.size() || cpu_to_index[cpu] < 0)
+      {
+        return -1;
+      }
+      return node_number(cpu_to_index[cpu]);
+#else
+      return 0;
+#endif
+    }
+  };
+  inline const dynamic_thread_pool_numa_topology &numa_topology()
+  {
+    static dynamic_thread_pool_numa_topology v;
+    return v;
+  }
 #if 0
   template <class T> class fake_atomic
   {
@@ -251,20 +415,37 @@ namespace detail
     }
   };
 #endif
+  /* The work queue is a chain of these, ordered by priority class and then by nesting
+  level, so the highest priority class and deepest nesting level is at the front.
+  */
   struct global_dynamic_thread_pool_impl_workqueue_item
   {
+    using priority_class = dynamic_thread_pool_group::priority_class;
     const size_t nesting_level;
+    const priority_class priority;
     std::shared_ptr<global_dynamic_thread_pool_impl_workqueue_item> next;
     std::unordered_set<dynamic_thread_pool_group_impl *> items;  // Do NOT use without holding workqueue_lock
 
-    explicit global_dynamic_thread_pool_impl_workqueue_item(size_t _nesting_level, std::shared_ptr<global_dynamic_thread_pool_impl_workqueue_item> &&preceding)
+    explicit global_dynamic_thread_pool_impl_workqueue_item(size_t _nesting_level, priority_class _priority,
+                                                            std::shared_ptr<global_dynamic_thread_pool_impl_workqueue_item> &&preceding)
         : nesting_level(_nesting_level)
+        , priority(_priority)
         , next(preceding)
     {
     }
 
+    bool is(size_t _nesting_level, priority_class _priority) const noexcept { return nesting_level == _nesting_level && priority == _priority; }
+    // True if this item is scheduled ahead of, or is, the one for that nesting level and priority
+    bool ranks_before(size_t _nesting_level, priority_class _priority) const noexcept
+    {
+      return priority > _priority || (priority == _priority && nesting_level >= _nesting_level);
+    }
+
 #if !LLFIO_DYNAMIC_THREAD_POOL_GROUP_USING_GCD && !defined(_WIN32)
-    static constexpr unsigned TOTAL_NEXTACTIVES = 1;
+    /* next_actives[0] holds work items without a NUMA node preference, next_actives[1 + n]
+    holds work items preferring the NUMA node with dense index n.
+    */
+    static constexpr unsigned TOTAL_NEXTACTIVES = 1 + LLFIO_DYNAMIC_THREAD_POOL_GROUP_MAX_NUMA_NODES;
     struct next_active_base_t
     {
       std::atomic<unsigned> count{0};
@@ -286,108 +467,68 @@ namespace detail
     static_assert(sizeof(next_active_work_t) == 64, "next_active_work_t is not a cacheline");
     next_active_base_t next_timer_relative, next_timer_absolute;
 
-    dynamic_thread_pool_group::work_item *next_active(unsigned &count, size_t threadidx)
+  private:
+    static dynamic_thread_pool_group::work_item *_pop_active(next_active_base_t &x, unsigned &count)
     {
-      if(TOTAL_NEXTACTIVES > 1)
+      if(x.count.load(std::memory_order_relaxed) == 0)
       {
-        threadidx &= (TOTAL_NEXTACTIVES - 1);
-        const size_t original_threadidx = threadidx;
-        bool all_empty = true;
-        for(;;)
-        {
-          next_active_base_t &x = next_actives[threadidx];
-          if(x.count.load(std::memory_order_relaxed) > 0)
-          {
-            all_empty = false;
-            if(x.lock.try_lock())
-            {
-              auto *ret = x.front;
-              if(ret != nullptr)
-              {
-                x.front = ret->_next_scheduled;
-                count = x.count.fetch_sub(1, std::memory_order_relaxed);
-                if(x.front == nullptr)
-                {
-                  assert(x.back == ret);
-                  x.back = nullptr;
-                }
-                ret->_next_scheduled = nullptr;
-                x.lock.unlock();
-                return ret;
-              }
-              x.lock.unlock();
-            }
-          }
-          if(++threadidx >= TOTAL_NEXTACTIVES)
-          {
-            threadidx = 0;
-          }
-          if(threadidx == original_threadidx)
-          {
-            if(all_empty)
-            {
-              return nullptr;
-            }
-            all_empty = true;
-          }
-        }
+        return nullptr;
       }
-      else
+      x.lock.lock();
+      auto *ret = x.front;
+      if(ret != nullptr)
       {
-        next_active_base_t &x = next_actives[0];
-        if(x.count.load(std::memory_order_relaxed) > 0)
+        x.front = ret->_next_scheduled;
+        count = x.count.fetch_sub(1, std::memory_order_relaxed);
+        if(x.front == nullptr)
         {
-          x.lock.lock();
-          auto *ret = x.front;
-          if(ret != nullptr)
-          {
-            x.front = ret->_next_scheduled;
-            count = x.count.fetch_sub(1, std::memory_order_relaxed);
-            if(x.front == nullptr)
-            {
-              assert(x.back == ret);
-              x.back = nullptr;
-            }
-            ret->_next_scheduled = nullptr;
-            x.lock.unlock();
-            return ret;
-          }
-          x.lock.unlock();
+          assert(x.back == ret);
+          x.back = nullptr;
         }
+        ret->_next_scheduled = nullptr;
       }
-      return nullptr;
+      x.lock.unlock();
+      return ret;
+    }
+    static unsigned _active_index(const dynamic_thread_pool_group::work_item *p)
+    {
+      const int idx = numa_topology().node_index(p->_numa_node);
+      return (idx < 0) ? 0 : (1 + (unsigned) idx);
     }
 
-  private:
-    next_active_base_t &_choose_next_active()
+  public:
+    // Prefers work for the caller's NUMA node, then work without preference, then steals work from other nodes
+    dynamic_thread_pool_group::work_item *next_active(unsigned &count, int nodeidx)
     {
-      unsigned idx = (unsigned) -1, max_count = (unsigned) -1;
-      for(unsigned n = 0; n < TOTAL_NEXTACTIVES; n++)
+      if(nodeidx >= 0)
       {
-        auto c = next_actives[n].count.load(std::memory_order_relaxed);
-        if(c < max_count)
+        if(auto *ret = _pop_active(next_actives[1 + nodeidx], count))
         {
-          idx = n;
-          max_count = c;
+          return ret;
         }
       }
-      for(;;)
+      if(auto *ret = _pop_active(next_actives[0], count))
       {
-        if(next_actives[idx].lock.try_lock())
-        {
-          return next_actives[idx];
-        }
-        if(++idx >= TOTAL_NEXTACTIVES)
+        return ret;
+      }
+      const auto nodes = (int) numa_topology().nodes;
+      for(int n = 0; nodes > 1 && n < nodes; n++)
+      {
+        if(n != nodeidx)
         {
-          idx = 0;
+          if(auto *ret = _pop_active(next_actives[1 + n], count))
+          {
+            return ret;
+          }
         }
       }
+      return nullptr;
     }
 
-  public:
     void append_active(dynamic_thread_pool_group::work_item *p)
     {
-      next_active_base_t &x = _choose_next_active();
+      next_active_base_t &x = next_actives[_active_index(p)];
+      x.lock.lock();
       x.count.fetch_add(1, std::memory_order_relaxed);
       if(x.back == nullptr)
       {
@@ -403,7 +544,8 @@ namespace detail
     }
     void prepend_active(dynamic_thread_pool_group::work_item *p)
     {
-      next_active_base_t &x = _choose_next_active();
+      next_active_base_t &x = next_actives[_active_index(p)];
+      x.lock.lock();
       x.count.fetch_add(1, std::memory_order_relaxed);
       if(x.front == nullptr)
       {
@@ -454,6 +596,13 @@ namespace detail
         {
           next_timer_relative.front = next_timer_relative.back = i;
         }
+        else if(next_timer_relative.back->_timepoint1 <= i->_timepoint1)
+        {
+          // Most new timers expire after all existing ones, so avoid the linear insertion
+          next_timer_relative.back->_next_scheduled = i;
+          i->_next_scheduled = nullptr;
+          next_timer_relative.back = i;
+        }
         else
         {
           bool done = false;
@@ -507,6 +656,13 @@ namespace detail
         {
           next_timer_absolute.front = next_timer_absolute.back = i;
         }
+        else if(next_timer_absolute.back->_timepoint2 <= i->_timepoint2)
+        {
+          // Most new timers expire after all existing ones, so avoid the linear insertion
+          next_timer_absolute.back->_next_scheduled = i;
+          i->_next_scheduled = nullptr;
+          next_timer_absolute.back = i;
+        }
         else
         {
           bool done = false;
@@ -544,6 +700,7 @@ namespace detail
   struct global_dynamic_thread_pool_impl
   {
     using _spinlock_type = QUICKCPPLIB_NAMESPACE::configurable_spinlock::spinlock<unsigned>;
+    using priority_class = dynamic_thread_pool_group::priority_class;
 
     _spinlock_type workqueue_lock;
     struct workqueue_guard : std::unique_lock<_spinlock_type>
@@ -578,7 +735,11 @@ namespace detail
       global_dynamic_thread_pool()._timerthread(workitem, threadh);
     }
 #else
-    global_dynamic_thread_pool_impl_workqueue_item first_execute{(size_t) -1, {}};
+    // Newly submitted work, indexed by priority class - 1
+    global_dynamic_thread_pool_impl_workqueue_item first_execute[3]{
+    global_dynamic_thread_pool_impl_workqueue_item{(size_t) -1, priority_class::background, {}},
+    global_dynamic_thread_pool_impl_workqueue_item{(size_t) -1, priority_class::normal, {}},
+    global_dynamic_thread_pool_impl_workqueue_item{(size_t) -1, priority_class::latency_critical, {}}};
     using threadh_type = void *;
     using grouph_type = void *;
     std::mutex threadpool_lock;
@@ -593,13 +754,30 @@ namespace detail
       std::condition_variable cond;
       std::chrono::steady_clock::time_point last_did_work;
       std::atomic<int> state{0};  // <0 = dead, 0 = sleeping/please die, 1 = busy
+      int numa_node{-1};          // dense NUMA node index this thread is bound to, if any
+      unsigned dispatched{0};     // work items executed, for starvation protection
+#ifdef __linux__
+      std::atomic<int> schedstat_fd{-1};                // this thread's /proc/thread-self/schedstat, -1 if unopened, -2 if unavailable
+      uint64_t schedstat_run{0}, schedstat_delay{0};  // last nanoseconds running and waiting to run
+      bool schedstat_valid{false};
+
+      ~thread_t()
+      {
+        if(schedstat_fd.load(std::memory_order_relaxed) >= 0)
+        {
+          ::close(schedstat_fd.load(std::memory_order_relaxed));
+        }
+      }
+#endif
     };
     struct threads_t
     {
       size_t count{0};
       thread_t *front{nullptr}, *back{nullptr};
     } threadpool_active, threadpool_sleeping;
+    size_t threadpool_numa_threads[dynamic_thread_pool_numa_topology::max_nodes]{};  // Do NOT use without holding threadpool_lock
     std::atomic<size_t> total_submitted_workitems{0}, threadpool_threads{0};
+    std::atomic<size_t> numa_submitted_workitems[dynamic_thread_pool_numa_topology::max_nodes]{};
     std::atomic<uint32_t> ms_sleep_for_more_work{20000};
 
     std::mutex threadmetrics_lock;
@@ -650,9 +828,16 @@ namespace detail
     std::vector<threadmetrics_item *> threadmetrics_sorted;  // sorted by threadid
     std::chrono::steady_clock::time_point threadmetrics_last_updated;
     std::atomic<unsigned> populate_threadmetrics_reentrancy{0};
+    std::atomic<dynamic_thread_pool_group::concurrency_controller_type> concurrency_controller{
+    dynamic_thread_pool_group::concurrency_controller_type::proc_task_stat};
 #ifdef __linux__
     std::mutex proc_self_task_fd_lock;
     int proc_self_task_fd{-1};
+    // Only used by the schedstat_pressure controller while holding populate_threadmetrics_reentrancy
+    std::chrono::steady_clock::time_point schedstat_last_updated;
+    bool pressure_fds_opened{false};
+    int pressure_fds[2]{-1, -1};  // cpu, io
+    uint64_t pressure_totals[2]{0, 0};
 #endif
 #endif
 
@@ -668,6 +853,10 @@ namespace detail
       float average_busy{0}, average_queuedepth{0};
       std::chrono::steady_clock::time_point last_updated;
       statfs_t statfs;
+      // For pacing_policy::latency, all in nanoseconds
+      deadline latency_deadline;
+      float latency_average{0}, latency_baseline{0};
+      std::chrono::steady_clock::time_point latency_last_updated, latency_baseline_reset;
     };
     std::unordered_map<fs_handle::unique_id_type, io_aware_work_item_statfs, fs_handle::unique_id_type_hasher> io_aware_work_item_handles;
 
@@ -746,13 +935,27 @@ namespace detail
 #if !LLFIO_DYNAMIC_THREAD_POOL_GROUP_USING_GCD && !defined(_WIN32)
     inline void _execute_work(thread_t *self);
 
-    void _add_thread(threadpool_guard & /*unused*/)
+    void _add_thread(threadpool_guard & /*unused*/, int nodeidx = -1)
     {
+      const auto &topology = numa_topology();
+      if(nodeidx < 0 && topology.nodes > 1)
+      {
+        // Place the new thread on the NUMA node with the fewest threads per CPU
+        for(int n = 0; n < (int) topology.nodes; n++)
+        {
+          if(nodeidx < 0 || threadpool_numa_threads[n] * topology.cpus_per_node[nodeidx] < threadpool_numa_threads[nodeidx] * topology.cpus_per_node[n])
+          {
+            nodeidx = n;
+          }
+        }
+      }
       thread_t *p = nullptr;
       try
       {
         p = new thread_t;
+        p->numa_node = nodeidx;
         _append_to_list(threadpool_active, p);
+        _thread_numa_node_changed(p, 1);
         p->thread = std::thread([this, p] { _execute_work(p); });
       }
       catch(...)
@@ -760,10 +963,42 @@ namespace detail
         if(p != nullptr)
         {
           _remove_from_list(threadpool_active, p);
+          _thread_numa_node_changed(p, -1);
+          delete p;
         }
         // drop failure
       }
     }
+    // threadpool_lock must be held
+    void _thread_numa_node_changed(thread_t *p, int delta)
+    {
+      if(p->numa_node >= 0)
+      {
+        threadpool_numa_threads[p->numa_node] += delta;
+      }
+    }
+    /* If there is a thread sleeping on the NUMA node, wake it, otherwise if that node
+    has more work than threads and spare CPUs, add a thread. Returns false if neither.
+    */
+    bool _wake_numa_node_thread(threadpool_guard &g, int nodeidx)
+    {
+      for(auto *t = threadpool_sleeping.back; t != nullptr; t = t->_prev)
+      {
+        if(t->numa_node == nodeidx)
+        {
+          t->last_did_work = std::chrono::steady_clock::now();  // prevent reap
+          t->cond.notify_one();
+          return true;
+        }
+      }
+      const auto threads = threadpool_numa_threads[nodeidx];
+      if(threads < numa_topology().cpus_per_node[nodeidx] && numa_submitted_workitems[nodeidx].load(std::memory_order_relaxed) > threads)
+      {
+        _add_thread(g, nodeidx);
+        return true;
+      }
+      return false;
+    }
 
     bool _remove_thread(threadpool_guard &g, threads_t &which)
     {
@@ -793,6 +1028,7 @@ namespace detail
       std::cout << "*** DTP " << t << " has quit, deleting" << std::endl;
 #endif
       _remove_from_list(threadpool_active, t);
+      _thread_numa_node_changed(t, -1);
       t->thread.join();
       delete t;
       return true;
@@ -831,6 +1067,14 @@ namespace detail
         ::close(proc_self_task_fd);
         proc_self_task_fd = -1;
       }
+      for(auto &fd : pressure_fds)
+      {
+        if(fd >= 0)
+        {
+          ::close(fd);
+          fd = -1;
+        }
+      }
 #endif
     }
 
@@ -960,6 +1204,167 @@ namespace detail
       }
       return false;
     }
+    // Opens the cpu or io pressure stall information for our cgroup, else for the system
+    static int _open_pressure(const char *what)
+    {
+      char path[4096];
+      int fd = ::open("/proc/self/cgroup", O_RDONLY | O_CLOEXEC);
+      if(fd >= 0)
+      {
+        char buffer[4096];
+        auto bytesread = ::read(fd, buffer, sizeof(buffer) - 1);
+        ::close(fd);
+        buffer[(bytesread > 0) ? bytesread : 0] = 0;
+        // The cgroup v2 hierarchy is the line beginning with "0::"
+        for(char *line = buffer; line != nullptr && *line != 0;)
+        {
+          char *eol = strchr(line, '\n');
+          if(eol != nullptr)
+          {
+            *eol = 0;
+          }
+          if(0 == strncmp(line, "0::", 3))
+          {
+            for(const char *root : {"/sys/fs/cgroup", "/sys/fs/cgroup/unified"})
+            {
+              snprintf(path, sizeof(path), "%s%s/%s.pressure", root, (line[3] == '/' && line[4] == 0) ? "" : line + 3, what);
+              fd = ::open(path, O_RDONLY | O_CLOEXEC);
+              if(fd >= 0)
+              {
+                return fd;
+              }
+            }
+          }
+          line = (eol != nullptr) ? eol + 1 : nullptr;
+        }
+      }
+      snprintf(path, sizeof(path), "/proc/pressure/%s", what);
+      return ::open(path, O_RDONLY | O_CLOEXEC);
+    }
+    // Returns the total microseconds some tasks were stalled
+    static bool _read_pressure(int fd, uint64_t &total)
+    {
+      char buffer[256];
+      auto bytesread = ::pread(fd, buffer, sizeof(buffer) - 1, 0);
+      if(bytesread <= 0)
+      {
+        return false;
+      }
+      buffer[bytesread] = 0;
+      const char *p = strstr(buffer, "total=");
+      if(0 != strncmp(buffer, "some", 4) || p == nullptr)
+      {
+        return false;
+      }
+      total = strtoull(p + 6, nullptr, 10);
+      return true;
+    }
+    static bool _read_schedstat(int fd, uint64_t &run, uint64_t &delay)
+    {
+      char buffer[128];
+      auto bytesread = ::pread(fd, buffer, sizeof(buffer) - 1, 0);
+      if(bytesread <= 0)
+      {
+        return false;
+      }
+      buffer[bytesread] = 0;
+      unsigned long long _run = 0, _delay = 0;
+      if(2 != sscanf(buffer, "%llu %llu", &_run, &_delay))
+      {
+        return false;
+      }
+      run = _run;
+      delay = _delay;
+      return true;
+    }
+    /* The schedstat_pressure controller. Every ten milliseconds, the CPU time and run delay
+    of each of our active threads is sampled, along with the cgroup's CPU and i/o pressure.
+    Returns true if calling thread is to exit.
+    */
+    bool update_schedstat_metrics(std::chrono::steady_clock::time_point now)
+    {
+      if(now - schedstat_last_updated < std::chrono::milliseconds(10))
+      {
+        return false;
+      }
+      const auto interval = (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(now - schedstat_last_updated).count();
+      // If nothing was sampled for a while, the deltas are meaningless, so just take new samples
+      const bool first_sample = (now - schedstat_last_updated > std::chrono::seconds(1));
+      schedstat_last_updated = now;
+      if(!pressure_fds_opened)
+      {
+        pressure_fds_opened = true;
+        pressure_fds[0] = _open_pressure("cpu");
+        pressure_fds[1] = _open_pressure("io");
+      }
+      // Fraction of the interval during which some tasks in our cgroup were stalled
+      float pressure[2]{0, 0};
+      for(size_t n = 0; n < 2; n++)
+      {
+        uint64_t total = 0;
+        if(pressure_fds[n] >= 0 && _read_pressure(pressure_fds[n], total))
+        {
+          if(!first_sample && pressure_totals[n] != 0)
+          {
+            pressure[n] = (float) ((double) (total - pressure_totals[n]) * 1000.0 / (double) interval);
+          }
+          pressure_totals[n] = total;
+        }
+      }
+      static const auto min_hardware_concurrency = std::thread::hardware_concurrency();
+      static const auto max_hardware_concurrency = min_hardware_concurrency + 3;
+      threadpool_guard gg(threadpool_lock);
+      ssize_t running = 0, blocked = 0, sampled = 0;
+      uint64_t total_delay = 0;
+      for(auto *t = threadpool_active.front; t != nullptr; t = t->_next)
+      {
+        const int fd = t->schedstat_fd.load(std::memory_order_acquire);
+        uint64_t run = 0, delay = 0;
+        if(fd < 0 || !_read_schedstat(fd, run, delay))
+        {
+          continue;
+        }
+        if(t->schedstat_valid && !first_sample)
+        {
+          // A thread which is executing work, but got almost no CPU, must be blocked
+          if(run - t->schedstat_run < interval / 8)
+          {
+            blocked++;
+          }
+          else
+          {
+            running++;
+          }
+          total_delay += delay - t->schedstat_delay;
+          sampled++;
+        }
+        t->schedstat_run = run;
+        t->schedstat_delay = delay;
+        t->schedstat_valid = true;
+      }
+      if(sampled == 0)
+      {
+        return false;
+      }
+      // If our threads wait to be scheduled more than a quarter of the time, or the cgroup is stalled on CPU, there are too many
+      const bool cpu_oversubscribed = (total_delay > interval * (uint64_t) sampled / 4) || pressure[0] > 0.2f;
+      // If the cgroup is mostly stalled on i/o, adding threads to replace blocked ones would make it worse
+      const bool io_congested = pressure[1] > 0.5f;
+      const auto desired_concurrency = std::min((ssize_t) min_hardware_concurrency, (ssize_t) total_submitted_workitems.load(std::memory_order_relaxed));
+      if(!cpu_oversubscribed && !io_congested && running < desired_concurrency &&
+         (ssize_t) threadpool_active.count < desired_concurrency + blocked)
+      {
+        _add_thread(gg);
+        return false;
+      }
+      if((cpu_oversubscribed || running > (ssize_t) max_hardware_concurrency) && running > 1 && threadpool_active.count > 1)
+      {
+        // Kill myself, but not if I'm the final thread who might need to run timers
+        return true;
+      }
+      return false;
+    }
+
     // Returns true if calling thread is to exit
     bool populate_threadmetrics(std::chrono::steady_clock::time_point now)
     {
@@ -968,6 +1373,10 @@ namespace detail
         return false;
       }
       auto unpopulate_threadmetrics_reentrancy = make_scope_exit([this]() noexcept { populate_threadmetrics_reentrancy.store(0, std::memory_order_relaxed); });
+      if(concurrency_controller.load(std::memory_order_relaxed) == dynamic_thread_pool_group::concurrency_controller_type::schedstat_pressure)
+      {
+        return update_schedstat_metrics(now);
+      }
 
       static thread_local std::vector<char> kernelbuffer(1024);
       static thread_local std::vector<threadmetrics_threadid> threadidsbuffer(1024 / sizeof(dirent));
@@ -1270,6 +1679,7 @@ class dynamic_thread_pool_group_impl final : public dynamic_thread_pool_group
 
   mutable std::mutex _lock;
   size_t _nesting_level{0};
+  priority_class _priority{priority_class::normal};
   struct workitems_t
   {
     size_t count{0};
@@ -1291,13 +1701,19 @@ class dynamic_thread_pool_group_impl final : public dynamic_thread_pool_group
 #endif
 
 public:
-  result<void> init()
+  result<void> init(priority_class priority)
   {
     LLFIO_LOG_FUNCTION_CALL(this);
     try
     {
       auto &impl = detail::global_dynamic_thread_pool();
-      _nesting_level = detail::global_dynamic_thread_pool_thread_local_state().nesting_level;
+      auto &tls = detail::global_dynamic_thread_pool_thread_local_state();
+      _nesting_level = tls.nesting_level;
+      if(priority == priority_class::unspecified)
+      {
+        priority = (tls.workitem != nullptr) ? tls.workitem->_parent.load(std::memory_order_relaxed)->_priority : priority_class::normal;
+      }
+      _priority = priority;
 #if LLFIO_DYNAMIC_THREAD_POOL_GROUP_USING_GCD
       _grouph = dispatch_group_create();
       if(_grouph == nullptr)
@@ -1308,15 +1724,20 @@ public:
       InitializeThreadpoolEnvironment(_grouph);
 #endif
       detail::global_dynamic_thread_pool_impl::workqueue_guard g(impl.workqueue_lock);
-      // Append this group to the global work queue at its nesting level
-      if(!impl.workqueue || impl.workqueue->nesting_level <= _nesting_level)
+      // Append this group to the global work queue at its priority class and nesting level
+      std::shared_ptr<detail::global_dynamic_thread_pool_impl_workqueue_item> *slot = &impl.workqueue;
+      while(*slot && (*slot)->ranks_before(_nesting_level, _priority) && !(*slot)->is(_nesting_level, _priority))
+      {
+        slot = &(*slot)->next;
+      }
+      if(!*slot || !(*slot)->is(_nesting_level, _priority))
       {
         // It is stupid we need to use a custom allocator here, but older libstdc++ don't
         // implement overaligned allocation for std::make_shared().
-        impl.workqueue = std::allocate_shared<detail::global_dynamic_thread_pool_impl_workqueue_item>(
-        detail::global_dynamic_thread_pool_impl_workqueue_item_allocator(), _nesting_level, std::move(impl.workqueue));
+        *slot = std::allocate_shared<detail::global_dynamic_thread_pool_impl_workqueue_item>(
+        detail::global_dynamic_thread_pool_impl_workqueue_item_allocator(), _nesting_level, _priority, std::move(*slot));
       }
-      impl.workqueue->items.insert(this);
+      (*slot)->items.insert(this);
       return success();
     }
     catch(...)
@@ -1345,21 +1766,24 @@ public:
     }
 #endif
     detail::global_dynamic_thread_pool_impl::workqueue_guard g2(impl.workqueue_lock);
-    assert(impl.workqueue->nesting_level >= _nesting_level);
-    for(auto *p = impl.workqueue.get(); p != nullptr; p = p->next.get())
+    for(std::shared_ptr<detail::global_dynamic_thread_pool_impl_workqueue_item> *slot = &impl.workqueue; *slot; slot = &(*slot)->next)
     {
-      if(p->nesting_level == _nesting_level)
+      if((*slot)->is(_nesting_level, _priority))
       {
-        p->items.erase(this);
+        (*slot)->items.erase(this);
+        if((*slot)->items.empty())
+        {
+          // Worker threads may still hold the item, but they will follow its next to the rest of the chain
+          auto next = (*slot)->next;
+          *slot = std::move(next);
+        }
         break;
       }
     }
-    while(impl.workqueue && impl.workqueue->items.empty())
-    {
-      impl.workqueue = std::move(impl.workqueue->next);
-    }
   }
 
+  virtual priority_class priority() const noexcept override { return _priority; }
+
   virtual result<void> submit(span<work_item *> work) noexcept override
   {
     LLFIO_LOG_FUNCTION_CALL(this);
@@ -1454,12 +1878,68 @@ LLFIO_HEADERS_ONLY_MEMFUNC_SPEC uint32_t dynamic_thread_pool_group::ms_sleep_for
 #endif
 }
 
-LLFIO_HEADERS_ONLY_FUNC_SPEC result<dynamic_thread_pool_group_ptr> make_dynamic_thread_pool_group() noexcept
+LLFIO_HEADERS_ONLY_MEMFUNC_SPEC dynamic_thread_pool_group::concurrency_controller_type dynamic_thread_pool_group::concurrency_controller() noexcept
+{
+#if !LLFIO_DYNAMIC_THREAD_POOL_GROUP_USING_GCD && !defined(_WIN32)
+  return detail::global_dynamic_thread_pool().concurrency_controller.load(std::memory_order_relaxed);
+#else
+  return concurrency_controller_type::system;
+#endif
+}
+
+LLFIO_HEADERS_ONLY_MEMFUNC_SPEC dynamic_thread_pool_group::concurrency_controller_type
+dynamic_thread_pool_group::concurrency_controller(concurrency_controller_type v) noexcept
+{
+#if !LLFIO_DYNAMIC_THREAD_POOL_GROUP_USING_GCD && !defined(_WIN32)
+  auto &impl = detail::global_dynamic_thread_pool();
+  if(v == concurrency_controller_type::schedstat_pressure)
+  {
+    int fd = ::open("/proc/thread-self/schedstat", O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+    {
+      return impl.concurrency_controller.load(std::memory_order_relaxed);
+    }
+    ::close(fd);
+  }
+  else if(v != concurrency_controller_type::proc_task_stat)
+  {
+    return impl.concurrency_controller.load(std::memory_order_relaxed);
+  }
+  impl.concurrency_controller.store(v, std::memory_order_relaxed);
+  return v;
+#else
+  (void) v;
+  return concurrency_controller_type::system;
+#endif
+}
+
+LLFIO_HEADERS_ONLY_MEMFUNC_SPEC size_t dynamic_thread_pool_group::numa_nodes() noexcept
+{
+  return detail::numa_topology().nodes;
+}
+
+LLFIO_HEADERS_ONLY_MEMFUNC_SPEC int dynamic_thread_pool_group::current_numa_node() noexcept
+{
+  return detail::numa_topology().current_node();
+}
+
+LLFIO_HEADERS_ONLY_MEMFUNC_SPEC dynamic_thread_pool_group::pool_statistics dynamic_thread_pool_group::statistics() noexcept
+{
+  pool_statistics ret;
+#if !LLFIO_DYNAMIC_THREAD_POOL_GROUP_USING_GCD && !defined(_WIN32)
+  auto &impl = detail::global_dynamic_thread_pool();
+  ret.threads = impl.threadpool_threads.load(std::memory_order_relaxed);
+  ret.work_items_pending = impl.total_submitted_workitems.load(std::memory_order_relaxed);
+#endif
+  return ret;
+}
+
+LLFIO_HEADERS_ONLY_FUNC_SPEC result<dynamic_thread_pool_group_ptr> make_dynamic_thread_pool_group(dynamic_thread_pool_group::priority_class priority) noexcept
 {
   try
   {
     auto ret = std::make_unique<dynamic_thread_pool_group_impl>();
-    OUTCOME_TRY(ret->init());
+    OUTCOME_TRY(ret->init(priority));
     return dynamic_thread_pool_group_ptr(std::move(ret));
   }
   catch(...)
@@ -1474,14 +1954,26 @@ namespace detail
   inline void global_dynamic_thread_pool_impl::_execute_work(thread_t *self)
   {
     pthread_setname_np(pthread_self(), "LLFIO DYN TPG");
+    if(self->numa_node >= 0)
+    {
+      // Failure here is harmless, we simply run wherever the kernel puts us
+      (void) sched_setaffinity(0, sizeof(cpu_set_t), &numa_topology().cpus[self->numa_node]);
+    }
     self->last_did_work = std::chrono::steady_clock::now();
     self->state.fetch_add(1, std::memory_order_release);  // busy
-    const unsigned mythreadidx = threadpool_threads.fetch_add(1, std::memory_order_release);
+    threadpool_threads.fetch_add(1, std::memory_order_release);
 #if LLFIO_DYNAMIC_THREAD_POOL_GROUP_PRINTING
     std::cout << "*** DTP " << self << " begins." << std::endl;
 #endif
     while(self->state.load(std::memory_order_relaxed) > 0)
     {
+      // Only the schedstat_pressure controller reads our schedstat, from other threads, so open it once that is in use
+      if(self->schedstat_fd.load(std::memory_order_relaxed) == -1 &&
+         concurrency_controller.load(std::memory_order_relaxed) == dynamic_thread_pool_group::concurrency_controller_type::schedstat_pressure)
+      {
+        const int fd = ::open("/proc/thread-self/schedstat", O_RDONLY | O_CLOEXEC);
+        self->schedstat_fd.store((fd >= 0) ? fd : -2, std::memory_order_release);
+      }
       dynamic_thread_pool_group::work_item *workitem = nullptr;
       bool workitem_is_timer = false;
       std::chrono::steady_clock::time_point now_steady, earliest_duration;
@@ -1489,6 +1981,8 @@ namespace detail
       // Start from highest priority work group, executing any timers due before selecting a work item
       {
         auto examine_wq = [&](global_dynamic_thread_pool_impl_workqueue_item &wq) -> dynamic_thread_pool_group::work_item * {
+          // Of the two timer queues, execute whichever due timer is the most overdue
+          std::chrono::nanoseconds relative_overdue(-1), absolute_overdue(-1);
           if(wq.next_timer_relative.count.load(std::memory_order_relaxed) > 0)
           {
             if(now_steady == std::chrono::steady_clock::time_point())
@@ -1500,11 +1994,9 @@ namespace detail
             {
               if(wq.next_timer_relative.front->_timepoint1 <= now_steady)
               {
-                workitem = wq.next_timer<1>();  // unlocks wq.next_timer_relative.lock
-                workitem_is_timer = true;
-                return workitem;
+                relative_overdue = now_steady - wq.next_timer_relative.front->_timepoint1;
               }
-              if(earliest_duration == std::chrono::steady_clock::time_point() || wq.next_timer_relative.front->_timepoint1 < earliest_duration)
+              else if(earliest_duration == std::chrono::steady_clock::time_point() || wq.next_timer_relative.front->_timepoint1 < earliest_duration)
               {
                 earliest_duration = wq.next_timer_relative.front->_timepoint1;
               }
@@ -1522,40 +2014,98 @@ namespace detail
             {
               if(wq.next_timer_absolute.front->_timepoint2 <= now_system)
               {
-                workitem = wq.next_timer<2>();  // unlocks wq.next_timer_absolute.lock
-                workitem_is_timer = true;
-                return workitem;
+                absolute_overdue = now_system - wq.next_timer_absolute.front->_timepoint2;
               }
-              if(earliest_absolute == std::chrono::system_clock::time_point() || wq.next_timer_absolute.front->_timepoint2 < earliest_absolute)
+              else if(earliest_absolute == std::chrono::system_clock::time_point() || wq.next_timer_absolute.front->_timepoint2 < earliest_absolute)
               {
                 earliest_absolute = wq.next_timer_absolute.front->_timepoint2;
               }
             }
             wq.next_timer_absolute.lock.unlock();
           }
+          if(relative_overdue.count() >= 0 && relative_overdue >= absolute_overdue)
+          {
+            wq.next_timer_relative.lock.lock();
+            if(wq.next_timer_relative.front != nullptr && wq.next_timer_relative.front->_timepoint1 <= now_steady)
+            {
+              workitem = wq.next_timer<1>();  // unlocks wq.next_timer_relative.lock
+              workitem_is_timer = true;
+              return workitem;
+            }
+            wq.next_timer_relative.lock.unlock();
+          }
+          else if(absolute_overdue.count() >= 0)
+          {
+            wq.next_timer_absolute.lock.lock();
+            if(wq.next_timer_absolute.front != nullptr && wq.next_timer_absolute.front->_timepoint2 <= now_system)
+            {
+              workitem = wq.next_timer<2>();  // unlocks wq.next_timer_absolute.lock
+              workitem_is_timer = true;
+              return workitem;
+            }
+            wq.next_timer_absolute.lock.unlock();
+          }
           unsigned count = 0;
-          return wq.next_active(count, mythreadidx);
+          return wq.next_active(count, self->numa_node);
         };
-        workitem = examine_wq(first_execute);
-        if(workitem == nullptr)
-        {
+        /* Work is examined in priority class order, and within each priority class newly
+        submitted work first and then the deepest nesting level first. Only the priority
+        classes below `below` are examined.
+        */
+        auto scan = [&](int below) -> dynamic_thread_pool_group::work_item * {
+          int next_first_execute = (int) priority_class::latency_critical;
           workqueue_lock.lock();
           auto lock_wq = workqueue;  // take shared_ptr to highest priority collection of work groups
           workqueue_lock.unlock();
-          while(lock_wq)
+          for(;;)
           {
-            workitem = examine_wq(*lock_wq);
-            if(workitem != nullptr)
+            const int wq_priority = lock_wq ? (int) lock_wq->priority : (int) priority_class::unspecified;
+            for(; next_first_execute > 0 && next_first_execute >= wq_priority; next_first_execute--)
             {
-              // workqueue_lock.lock();
-              // std::cout << "workitem = " << workitem << " nesting_level = " << wq.nesting_level << " count = " << count << std::endl;
-              // workqueue_lock.unlock();
-              break;
+              if(next_first_execute < below)
+              {
+                if(auto *ret = examine_wq(first_execute[next_first_execute - 1]))
+                {
+                  return ret;
+                }
+              }
+            }
+            if(!lock_wq)
+            {
+              return nullptr;
+            }
+            if(wq_priority < below)
+            {
+              if(auto *ret = examine_wq(*lock_wq))
+              {
+                // workqueue_lock.lock();
+                // std::cout << "workitem = " << ret << " nesting_level = " << lock_wq->nesting_level << std::endl;
+                // workqueue_lock.unlock();
+                return ret;
+              }
             }
             workqueue_lock.lock();
             lock_wq = lock_wq->next;
             workqueue_lock.unlock();
           }
+        };
+        /* So lower priority classes cannot be starved forever, every STARVATION_INTERVAL'th
+        work item this thread executes is looked for below the highest priority class first,
+        and every STARVATION_INTERVAL squared'th in the lowest priority class first.
+        */
+        static constexpr unsigned starvation_interval = LLFIO_DYNAMIC_THREAD_POOL_GROUP_STARVATION_INTERVAL;
+        const auto dispatch = self->dispatched + 1;
+        if(dispatch % (starvation_interval * starvation_interval) == 0)
+        {
+          workitem = scan((int) priority_class::normal);
+        }
+        else if(dispatch % starvation_interval == 0)
+        {
+          workitem = scan((int) priority_class::latency_critical);
+        }
+        if(workitem == nullptr)
+        {
+          workitem = scan((int) priority_class::latency_critical + 1);
         }
       }
       if(now_steady == std::chrono::steady_clock::time_point())
@@ -1574,6 +2124,7 @@ namespace detail
              (earliest_duration == std::chrono::steady_clock::time_point() && earliest_absolute == std::chrono::system_clock::time_point()))
           {
             _remove_from_list(threadpool_active, self);
+            _thread_numa_node_changed(self, -1);
             threadpool_threads.fetch_sub(1, std::memory_order_release);
 #if LLFIO_DYNAMIC_THREAD_POOL_GROUP_PRINTING
             std::cout << "*** DTP " << self << " exits due to no new work for ms_sleep_for_more_work" << std::endl;
@@ -1624,6 +2175,7 @@ namespace detail
         self->state.fetch_add(1, std::memory_order_release);
         _remove_from_list(threadpool_sleeping, self);
         _append_to_list(threadpool_active, self);
+        self->schedstat_valid = false;  // time asleep is not time blocked
 #if LLFIO_DYNAMIC_THREAD_POOL_GROUP_PRINTING
         std::cout << "*** DTP " << self << " wakes, state = " << self->state << std::endl;
 #endif
@@ -1638,10 +2190,18 @@ namespace detail
         continue;
       }
       self->last_did_work = now_steady;
+      self->dispatched++;
 #if LLFIO_DYNAMIC_THREAD_POOL_GROUP_PRINTING
       std::cout << "*** DTP " << self << " executes work item " << workitem << std::endl;
 #endif
       total_submitted_workitems.fetch_sub(1, std::memory_order_relaxed);
+      {
+        const int nodeidx = numa_topology().node_index(workitem->_numa_node);
+        if(nodeidx >= 0)
+        {
+          numa_submitted_workitems[nodeidx].fetch_sub(1, std::memory_order_relaxed);
+        }
+      }
       if(workitem_is_timer)
       {
         _timerthread(workitem, nullptr);
@@ -1657,6 +2217,7 @@ namespace detail
         {
           threadpool_guard g(threadpool_lock);
           _remove_from_list(threadpool_active, self);
+          _thread_numa_node_changed(self, -1);
           threadpool_threads.fetch_sub(1, std::memory_order_release);
 #if LLFIO_DYNAMIC_THREAD_POOL_GROUP_PRINTING
           std::cout << "*** DTP " << self << " exits due to threadmetrics saying we exceed max concurrency" << std::endl;
@@ -1770,7 +2331,7 @@ namespace detail
         workqueue_guard gg(workqueue_lock);
         for(auto *p = workqueue.get(); p != nullptr; p = p->next.get())
         {
-          if(p->nesting_level == parent->_nesting_level)
+          if(p->is(parent->_nesting_level, parent->_priority))
           {
             p->append_timer(workitem);
             break;
@@ -1782,6 +2343,15 @@ namespace detail
       {
 #if LLFIO_DYNAMIC_THREAD_POOL_GROUP_USING_GCD
         intptr_t priority = DISPATCH_QUEUE_PRIORITY_LOW;
+        if(parent->_priority == priority_class::latency_critical)
+        {
+          priority = DISPATCH_QUEUE_PRIORITY_HIGH;
+        }
+        else if(parent->_priority == priority_class::background)
+        {
+          priority = DISPATCH_QUEUE_PRIORITY_BACKGROUND;
+        }
+        else
         {
           global_dynamic_thread_pool_impl::workqueue_guard gg(workqueue_lock);
           if(workqueue->nesting_level == parent->_nesting_level)
@@ -1796,8 +2366,13 @@ namespace detail
         // std::cout << "*** submit " << workitem << std::endl;
         dispatch_group_async_f(parent->_grouph, dispatch_get_global_queue(priority, 0), workitem, _gcd_dispatch_callback);
 #elif defined(_WIN32)
-        // Set the priority of the group according to distance from the top
+        // Set the priority of the group according to its priority class and distance from the top
         TP_CALLBACK_PRIORITY priority = TP_CALLBACK_PRIORITY_LOW;
+        if(parent->_priority == priority_class::latency_critical)
+        {
+          priority = TP_CALLBACK_PRIORITY_HIGH;
+        }
+        else if(parent->_priority != priority_class::background)
         {
           global_dynamic_thread_pool_impl::workqueue_guard gg(workqueue_lock);
           if(workqueue->nesting_level == parent->_nesting_level)
@@ -1816,17 +2391,15 @@ namespace detail
         global_dynamic_thread_pool_impl::workqueue_guard gg(workqueue_lock);
         if(submit_into_highest_priority)
         {
-          // TODO: It would be super nice if we prepended this instead if it came from a timer
-          first_execute.append_active(workitem);
+          first_execute[(int) parent->_priority - 1].append_active(workitem);
           // std::cout << "append_active _nesting_level = " << parent->_nesting_level << std::endl;
         }
         else
         {
           for(auto *p = workqueue.get(); p != nullptr; p = p->next.get())
           {
-            if(p->nesting_level == parent->_nesting_level)
+            if(p->is(parent->_nesting_level, parent->_priority))
             {
-              // TODO: It would be super nice if we prepended this instead if it came from a timer
               p->append_active(workitem);
               // std::cout << "append_active _nesting_level = " << parent->_nesting_level << std::endl;
               break;
@@ -1841,13 +2414,22 @@ namespace detail
       std::cout << "*** DTP submits work item " << workitem << std::endl;
 #endif
       const auto active_work_items = total_submitted_workitems.fetch_add(1, std::memory_order_relaxed) + 1;
+      const int nodeidx = numa_topology().node_index(workitem->_numa_node);
+      if(nodeidx >= 0)
+      {
+        numa_submitted_workitems[nodeidx].fetch_add(1, std::memory_order_relaxed);
+      }
       if(!defer_pool_wake)
       {
         {
           threadpool_guard gg(threadpool_lock);
           if(threadpool_active.count == 0 && threadpool_sleeping.count == 0)
           {
-            _add_thread(gg);
+            _add_thread(gg, nodeidx);
+          }
+          else if(nodeidx >= 0 && _wake_numa_node_thread(gg, nodeidx))
+          {
+            // Node local scaling decision made
           }
           else if(threadpool_sleeping.count > 0 && active_work_items > threadpool_active.count)
           {
@@ -2305,9 +2887,15 @@ namespace detail
         _work_item_done(g, workitem);
         return;
       }
-      _submit_work_item(false, workitem, false);
+    }
+#if !LLFIO_DYNAMIC_THREAD_POOL_GROUP_USING_GCD && !defined(_WIN32)
+    // Timers are executed earliest deadline first, so execute due work now rather than queue it behind work without a deadline
+    if(workitem->_nextwork.load(std::memory_order_acquire) != 0 && !workitem->_has_timer_set())
+    {
+      _workerthread(workitem, nullptr);
       return;
     }
+#endif
     _submit_work_item(false, workitem, false);
   }
 
@@ -2333,7 +2921,15 @@ namespace detail
     tls.workitem = workitem;
     tls.current_callback_instance = selfthreadh;
     tls.nesting_level = parent->_nesting_level + 1;
-    auto r = (*workitem)(workitem->_nextwork.load(std::memory_order_acquire));
+    const auto work = workitem->_nextwork.load(std::memory_order_acquire);
+    detail::trace_scope trace(trace_event_kind::thread_pool_work, (uint64_t) (uintptr_t) workitem, (uint64_t) work);
+    const auto began = workitem->_is_io_aware ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+    auto r = (*workitem)(work);
+    if(workitem->_is_io_aware)
+    {
+      static_cast<dynamic_thread_pool_group::io_aware_work_item *>(workitem)->_record_latency(std::chrono::steady_clock::now() - began);
+    }
+    trace.finish((uint64_t) work, !r);
     workitem->_nextwork.store(0, std::memory_order_release);  // call next() next time
     tls = old_thread_local_state;
     // std::cout << "*** _workerthread " << workitem << " ends with work " << workitem->_nextwork << std::endl;
@@ -2375,8 +2971,8 @@ namespace detail
 
 /****************************************** io_aware_work_item *********************************************/
 
-LLFIO_HEADERS_ONLY_MEMFUNC_SPEC dynamic_thread_pool_group::io_aware_work_item::io_aware_work_item(span<io_handle_awareness> hs)
-    : _handles([](span<io_handle_awareness> hs) -> span<io_handle_awareness> {
+LLFIO_HEADERS_ONLY_MEMFUNC_SPEC dynamic_thread_pool_group::io_aware_work_item::io_aware_work_item(span<io_handle_awareness> hs, pacing_policy policy)
+    : _handles([](span<io_handle_awareness> hs, pacing_policy policy) -> span<io_handle_awareness> {
       float all = 0;
       for(auto &i : hs)
       {
@@ -2410,10 +3006,18 @@ LLFIO_HEADERS_ONLY_MEMFUNC_SPEC dynamic_thread_pool_group::io_aware_work_item::i
         if(it == impl.io_aware_work_item_handles.end())
         {
           it = impl.io_aware_work_item_handles.emplace(unique_id, detail::global_dynamic_thread_pool_impl::io_aware_work_item_statfs{}).first;
+        }
+        // The first busy time paced work item to use this device fetches its statistics
+        if(policy == pacing_policy::busy_time && it->second.statfs.f_iosinprogress == (uint32_t) -1)
+        {
           auto r = it->second.statfs.fill(*fh, statfs_t::want::iosinprogress | statfs_t::want::iosbusytime);
           if(!r || it->second.statfs.f_iosinprogress == (uint32_t) -1)
           {
-            impl.io_aware_work_item_handles.erase(it);
+            it->second.statfs.f_iosinprogress = (uint32_t) -1;
+            if(0 == it->second.refcount)
+            {
+              impl.io_aware_work_item_handles.erase(it);
+            }
             if(!r)
             {
               r.value();
@@ -2426,9 +3030,11 @@ LLFIO_HEADERS_ONLY_MEMFUNC_SPEC dynamic_thread_pool_group::io_aware_work_item::i
         h._internal = &*it;
       }
       return hs;
-    }(hs))
+    }(hs, policy))
+    , _pacing(policy)
 {
   LLFIO_LOG_FUNCTION_CALL(this);
+  _is_io_aware = true;
 }
 
 LLFIO_HEADERS_ONLY_MEMFUNC_SPEC dynamic_thread_pool_group::io_aware_work_item::~io_aware_work_item()
@@ -2458,6 +3064,41 @@ LLFIO_HEADERS_ONLY_MEMFUNC_SPEC intptr_t dynamic_thread_pool_group::io_aware_wor
     for(auto &h : _handles)
     {
       auto *i = (value_type *) h._internal;
+      if(_pacing == pacing_policy::latency)
+      {
+        if(now - i->second.latency_last_updated >= std::chrono::milliseconds(10))
+        {
+          i->second.latency_last_updated = now;
+          const float ratio = (i->second.latency_baseline > 0) ? (i->second.latency_average / i->second.latency_baseline) : 1.0f;
+          if(ratio > this->max_latency_ratio)
+          {
+            if(0 == i->second.latency_deadline.nsecs)
+            {
+              i->second.latency_deadline = std::chrono::microseconds(100);  // start with 100us, it'll grow from there if needed
+            }
+            else
+            {
+              i->second.latency_deadline.nsecs += (i->second.latency_deadline.nsecs >> 2) + 1;
+            }
+          }
+          else if(ratio < this->min_latency_ratio)
+          {
+            if((i->second.latency_deadline.nsecs >> 4) > 0)
+            {
+              i->second.latency_deadline.nsecs -= i->second.latency_deadline.nsecs >> 4;
+            }
+            else
+            {
+              i->second.latency_deadline.nsecs = 0;  // remove pacing
+            }
+          }
+        }
+        if(d.nsecs < i->second.latency_deadline.nsecs)
+        {
+          d = i->second.latency_deadline;
+        }
+        continue;
+      }
       if(std::chrono::duration_cast<std::chrono::milliseconds>(now - i->second.last_updated) >= std::chrono::milliseconds(100))
       {
         // auto old_iosinprogress = i->second.statfs.f_iosinprogress;
@@ -2515,5 +3156,40 @@ LLFIO_HEADERS_ONLY_MEMFUNC_SPEC intptr_t dynamic_thread_pool_group::io_aware_wor
   return io_aware_next(d);
 }
 
+LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void dynamic_thread_pool_group::io_aware_work_item::_record_latency(std::chrono::steady_clock::duration latency) noexcept
+{
+  if(_pacing != pacing_policy::latency)
+  {
+    return;
+  }
+  const auto now = std::chrono::steady_clock::now();
+  const auto sample = (float) std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count();
+  auto &impl = detail::global_dynamic_thread_pool();
+  detail::global_dynamic_thread_pool_impl::io_aware_work_item_handles_guard g(impl.io_aware_work_item_handles_lock);
+  using value_type = decltype(impl.io_aware_work_item_handles)::value_type;
+  for(auto &h : _handles)
+  {
+    auto *i = (value_type *) h._internal;
+    if(0 == i->second.latency_average)
+    {
+      i->second.latency_average = sample;
+    }
+    else
+    {
+      i->second.latency_average = (i->second.latency_average * 0.9f) + (sample * 0.1f);
+    }
+    // The baseline is the least average latency seen, periodically reset in case the workload changed
+    if(0 == i->second.latency_baseline || now - i->second.latency_baseline_reset >= std::chrono::seconds(10))
+    {
+      i->second.latency_baseline = i->second.latency_average;
+      i->second.latency_baseline_reset = now;
+    }
+    else if(i->second.latency_average < i->second.latency_baseline)
+    {
+      i->second.latency_baseline = i->second.latency_average;
+    }
+  }
+}
+
 
 LLFIO_V2_NAMESPACE_END
@@ -0,0 +1,487 @@
+/* Memory maps populated on demand from an i/o handle
+(C) 2026 agent <agent@local> (4 commits)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#include "../../algorithm/lazy_map.hpp"
+#include "../../utils.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/userfaultfd.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#ifndef UFFD_USER_MODE_ONLY
+#define UFFD_USER_MODE_ONLY 1
+#endif
+#endif
+
+LLFIO_V2_NAMESPACE_BEGIN
+
+namespace algorithm
+{
+  struct lazy_map::_state_type
+  {
+    map_handle mh;
+    io_handle *source{nullptr};
+    extent_type offset{0};
+    size_t pagesize{0}, pages{0};
+    lazy_map_config config;
+
+    int uffd{-1}, stopfd{-1};
+    std::thread thread;
+    map_handle staging;                // page aligned buffer of max_readahead_pages
+    std::vector<uint64_t> populated;   // bitmap, only touched by the handler thread
+    std::atomic<size_t> populated_count{0};
+    size_t next_background{0}, last_fault_end{(size_t) -1}, window{0};  // read ahead state
+
+    std::atomic<uint64_t> faults{0}, background_pages{0}, bytes_read{0}, read_errors{0};
+    mutable std::mutex lock;
+    result<void> first_error{success()};
+
+    _state_type() = default;
+    _state_type(const _state_type &) = delete;
+    _state_type &operator=(const _state_type &) = delete;
+    ~_state_type() { (void) close(); }
+
+    bool is_populated(size_t page) const noexcept { return ((populated[page / 64] >> (page % 64)) & 1) != 0; }
+    void set_populated(size_t page) noexcept { populated[page / 64] |= (uint64_t) 1 << (page % 64); }
+
+#ifdef __linux__
+    // Read `count` pages at `page` from the source into the staging buffer, zero filling whatever could not be read
+    void read_pages(size_t page, size_t count) noexcept
+    {
+      byte *buffer = staging.address();
+      const size_t bytes = count * pagesize;
+      size_t done = 0;
+      while(done < bytes)
+      {
+        auto r = source->read(offset + (extent_type) page * pagesize + done, {{buffer + done, bytes - done}});
+        if(!r)
+        {
+          read_errors.fetch_add(1, std::memory_order_relaxed);
+          std::lock_guard<std::mutex> g(lock);
+          if(first_error)
+          {
+            first_error = std::move(r).as_failure();
+          }
+          break;
+        }
+        if(r.bytes_transferred() == 0)
+        {
+          break;  // end of source
+        }
+        done += r.bytes_transferred();
+        bytes_read.fetch_add(r.bytes_transferred(), std::memory_order_relaxed);
+      }
+      if(done < bytes)
+      {
+        memset(buffer + done, 0, bytes - done);
+      }
+    }
+    // Atomically install the staging buffer at `page`, waking any threads faulting on those pages
+    result<void> install_pages(size_t page, size_t count) noexcept
+    {
+      struct uffdio_copy copy;
+      copy.dst = (uint64_t)(uintptr_t)(mh.address() + page * pagesize);
+      copy.src = (uint64_t)(uintptr_t) staging.address();
+      copy.len = count * pagesize;
+      copy.mode = 0;
+      copy.copy = 0;
+      while(-1 == ::ioctl(uffd, UFFDIO_COPY, &copy))
+      {
+        if(EAGAIN == errno && copy.copy > 0)
+        {
+          // Partially copied, continue from where it stopped
+          copy.dst += copy.copy;
+          copy.src += copy.copy;
+          copy.len -= copy.copy;
+          copy.copy = 0;
+          continue;
+        }
+        if(EEXIST == errno)
+        {
+          // Some of these pages were populated behind our back, install the remainder page by page
+          for(size_t n = 0; n < count; n++)
+          {
+            struct uffdio_copy one;
+            one.dst = (uint64_t)(uintptr_t)(mh.address() + (page + n) * pagesize);
+            one.src = (uint64_t)(uintptr_t)(staging.address() + n * pagesize);
+            one.len = pagesize;
+            one.mode = 0;
+            one.copy = 0;
+            if(-1 == ::ioctl(uffd, UFFDIO_COPY, &one) && EEXIST != errno)
+            {
+              return posix_error();
+            }
+          }
+          break;
+        }
+        return posix_error();
+      }
+      for(size_t n = 0; n < count; n++)
+      {
+        set_populated(page + n);
+      }
+      populated_count.fetch_add(count, std::memory_order_relaxed);
+      return success();
+    }
+    // Populate the run of unpopulated pages starting at `page`, of at most `maximum` pages
+    result<size_t> populate(size_t page, size_t maximum) noexcept
+    {
+      size_t count = 0;
+      while(count < maximum && page + count < pages && !is_populated(page + count))
+      {
+        ++count;
+      }
+      if(count == 0)
+      {
+        return 0;
+      }
+      read_pages(page, count);
+      OUTCOME_TRY(install_pages(page, count));
+      return count;
+    }
+    result<void> fault(uintptr_t address) noexcept
+    {
+      faults.fetch_add(1, std::memory_order_relaxed);
+      const size_t page = (size_t)(address - (uintptr_t) mh.address()) / pagesize;
+      if(page >= pages)
+      {
+        return success();
+      }
+      if(is_populated(page))
+      {
+        // Either another fault on the same page raced the first, or the page has since been
+        // discarded. Read it afresh, which fails with EEXIST if it is in fact still present.
+        read_pages(page, 1);
+        struct uffdio_copy copy;
+        copy.dst = (uint64_t)(uintptr_t)(mh.address() + page * pagesize);
+        copy.src = (uint64_t)(uintptr_t) staging.address();
+        copy.len = pagesize;
+        copy.mode = 0;
+        copy.copy = 0;
+        while(-1 == ::ioctl(uffd, UFFDIO_COPY, &copy))
+        {
+          if(EAGAIN == errno)
+          {
+            copy.copy = 0;
+            continue;
+          }
+          if(EEXIST != errno)
+          {
+            return posix_error();
+          }
+          // Make sure the thread of the racing fault is woken
+          struct uffdio_range range;
+          range.start = copy.dst;
+          range.len = pagesize;
+          (void) ::ioctl(uffd, UFFDIO_WAKE, &range);
+          break;
+        }
+        return success();
+      }
+      // A fault just after the previous read ahead, allowing for strides, is a stream. Grow the
+      // window, and fill any gap left behind so the stream does not fault on it later.
+      size_t start = page;
+      if(page >= last_fault_end && page - last_fault_end <= window)
+      {
+        window = std::min(window * 2, config.max_readahead_pages);
+        start = last_fault_end;
+      }
+      else
+      {
+        window = config.readahead_pages;
+      }
+      size_t count = 0;
+      OUTCOME_TRY(count, populate(start, window));
+      if(!is_populated(page))
+      {
+        // Something already populated lay between the stream and this page
+        start = page;
+        OUTCOME_TRY(count, populate(start, window));
+      }
+      last_fault_end = start + count;
+      return success();
+    }
+    // Stop servicing faults, so that faulting threads see zeroed pages rather than hang
+    void fail(result<void> r) noexcept
+    {
+      {
+        std::lock_guard<std::mutex> g(lock);
+        if(first_error)
+        {
+          first_error = std::move(r);
+        }
+      }
+      struct uffdio_range range;
+      range.start = (uint64_t)(uintptr_t) mh.address();
+      range.len = pages * pagesize;
+      (void) ::ioctl(uffd, UFFDIO_UNREGISTER, &range);
+    }
+    void run() noexcept
+    {
+      for(;;)
+      {
+        while(next_background < pages && is_populated(next_background))
+        {
+          ++next_background;
+        }
+        const bool background = config.background_populate && next_background < pages;
+        struct pollfd fds[2];
+        fds[0].fd = uffd;
+        fds[0].events = POLLIN;
+        fds[0].revents = 0;
+        fds[1].fd = stopfd;
+        fds[1].events = POLLIN;
+        fds[1].revents = 0;
+        const int ret = ::poll(fds, 2, background ? 0 : -1);
+        if(ret < 0)
+        {
+          if(EINTR == errno)
+          {
+            continue;
+          }
+          fail(posix_error());
+          return;
+        }
+        if(fds[1].revents != 0)
+        {
+          break;
+        }
+        if(ret == 0)
+        {
+          auto r = populate(next_background, config.max_readahead_pages);
+          if(!r)
+          {
+            fail(std::move(r).as_failure());
+            return;
+          }
+          background_pages.fetch_add(r.value(), std::memory_order_relaxed);
+          continue;
+        }
+        struct uffd_msg msgs[16];
+        const auto bytes = ::read(uffd, msgs, sizeof(msgs));
+        if(bytes < 0)
+        {
+          if(EAGAIN == errno || EINTR == errno)
+          {
+            continue;
+          }
+          fail(posix_error());
+          return;
+        }
+        for(size_t n = 0; n < (size_t) bytes / sizeof(struct uffd_msg); n++)
+        {
+          if(msgs[n].event == UFFD_EVENT_PAGEFAULT)
+          {
+            auto r = fault((uintptr_t) msgs[n].arg.pagefault.address);
+            if(!r)
+            {
+              fail(std::move(r));
+              return;
+            }
+          }
+        }
+      }
+    }
+#endif
+
+    result<void> close() noexcept
+    {
+#ifdef __linux__
+      if(thread.joinable())
+      {
+        const uint64_t v = 1;
+        (void) ::write(stopfd, &v, sizeof(v));
+        thread.join();
+      }
+      // Closing the userfaultfd unregisters the map, and wakes anything faulting on it
+      if(uffd != -1)
+      {
+        ::close(uffd);
+        uffd = -1;
+      }
+      if(stopfd != -1)
+      {
+        ::close(stopfd);
+        stopfd = -1;
+      }
+#endif
+      if(staging.is_valid())
+      {
+        OUTCOME_TRY(staging.close());
+      }
+      if(mh.is_valid())
+      {
+        OUTCOME_TRY(mh.close());
+      }
+      return success();
+    }
+  };
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC lazy_map::lazy_map(std::unique_ptr<_state_type> state) noexcept
+      : _state(std::move(state))
+  {
+  }
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC lazy_map::lazy_map() noexcept = default;
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC lazy_map::lazy_map(lazy_map &&o) noexcept = default;
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC lazy_map &lazy_map::operator=(lazy_map &&o) noexcept
+  {
+    if(this == &o)
+    {
+      return *this;
+    }
+    _state = std::move(o._state);
+    return *this;
+  }
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC lazy_map::~lazy_map() = default;
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<lazy_map> lazy_map::map(io_handle &source, extent_type offset, size_type bytes, lazy_map_config config) noexcept
+  {
+#ifdef __linux__
+    try
+    {
+      auto state = std::make_unique<_state_type>();
+      state->source = &source;
+      state->offset = offset;
+      state->config = config;
+      state->config.readahead_pages = std::max<size_t>(config.readahead_pages, 1);
+      state->config.max_readahead_pages = std::max(config.max_readahead_pages, state->config.readahead_pages);
+      state->pagesize = utils::page_size();
+      bytes = utils::round_up_to_page_size(bytes, state->pagesize);
+      if(bytes == 0)
+      {
+        return errc::invalid_argument;
+      }
+      state->pages = bytes / state->pagesize;
+      state->populated.resize((state->pages + 63) / 64);
+      // A freshly allocated map, never one recycled from the map cache, so every page is missing
+      OUTCOME_TRY(state->mh, map_handle::map(bytes, true));
+      OUTCOME_TRY(state->staging, map_handle::map(state->config.max_readahead_pages * state->pagesize, true));
+
+      // Ask only for faults from user space if the kernel permits, as that needs no privileges
+      state->uffd = (int) ::syscall(SYS_userfaultfd, O_CLOEXEC | O_NONBLOCK | UFFD_USER_MODE_ONLY);
+      if(state->uffd == -1 && EINVAL == errno)
+      {
+        state->uffd = (int) ::syscall(SYS_userfaultfd, O_CLOEXEC | O_NONBLOCK);
+      }
+      if(state->uffd == -1)
+      {
+        return posix_error();
+      }
+      struct uffdio_api api;
+      memset(&api, 0, sizeof(api));
+      api.api = UFFD_API;
+      if(-1 == ::ioctl(state->uffd, UFFDIO_API, &api))
+      {
+        return posix_error();
+      }
+      struct uffdio_register reg;
+      memset(&reg, 0, sizeof(reg));
+      reg.range.start = (uint64_t)(uintptr_t) state->mh.address();
+      reg.range.len = bytes;
+      reg.mode = UFFDIO_REGISTER_MODE_MISSING;
+      if(-1 == ::ioctl(state->uffd, UFFDIO_REGISTER, &reg))
+      {
+        return posix_error();
+      }
+      state->stopfd = ::eventfd(0, EFD_CLOEXEC);
+      if(state->stopfd == -1)
+      {
+        return posix_error();
+      }
+      auto *s = state.get();
+      state->thread = std::thread([s] { s->run(); });
+      return lazy_map(std::move(state));
+    }
+    catch(...)
+    {
+      return error_from_exception();
+    }
+#else
+    (void) source;
+    (void) offset;
+    (void) bytes;
+    (void) config;
+    return errc::operation_not_supported;
+#endif
+  }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC byte *lazy_map::address() const noexcept { return _state ? _state->mh.address() : nullptr; }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC lazy_map::size_type lazy_map::length() const noexcept { return _state ? _state->pages * _state->pagesize : 0; }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC bool lazy_map::is_fully_populated() const noexcept
+  {
+    return _state && _state->populated_count.load(std::memory_order_relaxed) == _state->pages;
+  }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC lazy_map_statistics lazy_map::statistics() const noexcept
+  {
+    lazy_map_statistics ret;
+    if(_state)
+    {
+      ret.faults = _state->faults.load(std::memory_order_relaxed);
+      ret.pages_populated = _state->populated_count.load(std::memory_order_relaxed);
+      ret.background_pages = _state->background_pages.load(std::memory_order_relaxed);
+      ret.bytes_read = _state->bytes_read.load(std::memory_order_relaxed);
+      ret.read_errors = _state->read_errors.load(std::memory_order_relaxed);
+    }
+    return ret;
+  }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<void> lazy_map::error() const noexcept
+  {
+    if(!_state)
+    {
+      return success();
+    }
+    std::lock_guard<std::mutex> g(_state->lock);
+    if(_state->first_error)
+    {
+      return success();
+    }
+    return _state->first_error.error();
+  }
+
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<void> lazy_map::close() noexcept
+  {
+    if(!_state)
+    {
+      return success();
+    }
+    auto state = std::move(_state);
+    return state->close();
+  }
+}  // namespace algorithm
+
+LLFIO_V2_NAMESPACE_END
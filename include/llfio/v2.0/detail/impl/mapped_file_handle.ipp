@@ -0,0 +1,134 @@
+/* Adaptive readahead for mapped_file_handle
+(C) 2026 agent <agent@local> (2 commits)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#include "../../mapped_file_handle.hpp"
+#include "../../utils.hpp"
+
+#include <algorithm>
+
+LLFIO_V2_NAMESPACE_BEGIN
+
+LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void mapped_file_handle::_readahead(const io_request<buffers_type> &reqs) noexcept
+{
+  static constexpr size_type minimum_window = (size_type) 128 * 1024, maximum_window = (size_type) 16 * 1024 * 1024;
+  static constexpr size_t maximum_strided_regions = 16;
+  if(_ra.busy.exchange(true, std::memory_order_acquire))
+  {
+    return;
+  }
+  auto unbusy = make_scope_exit([this]() noexcept { _ra.busy.store(false, std::memory_order_release); });
+  auto &f = _ra.f;
+  const size_type length = _mh.length();
+  size_type bytes = 0;
+  for(auto &b : reqs.buffers)
+  {
+    bytes += b.size();
+  }
+  if(bytes == 0 || reqs.offset >= length || _mh.address() == nullptr)
+  {
+    return;
+  }
+  const extent_type offset = reqs.offset, end = std::min<extent_type>(offset + bytes, length);
+  const bool first = (f.stats.reads++ == 0);
+  const extent_type prev_end = f.last_end;
+  const bool sequential = !first && offset == f.last_end;
+  const bool strided = !first && !sequential && offset > f.last_offset && offset - f.last_offset == f.stride && f.stride > bytes;
+  f.stride = (offset > f.last_offset) ? offset - f.last_offset : 0;
+  f.last_offset = offset;
+  f.last_end = end;
+  auto &window = f.stats.window;
+  if(window == 0)
+  {
+    window = minimum_window;
+  }
+  if(!sequential && !strided)
+  {
+    f.stats.random_reads++;
+    if(f.ahead_end > prev_end)
+    {
+      // The stream ended, so whatever was prefetched beyond where it got to was for nothing
+      f.stats.bytes_wasted += f.ahead_end - prev_end;
+      window = std::max(window / 2, minimum_window);
+    }
+    f.ahead_begin = f.ahead_end = 0;
+    return;
+  }
+  if(offset >= f.ahead_begin && end <= f.ahead_end)
+  {
+    f.stats.hits++;
+    window = std::min(window * 2, maximum_window);
+  }
+  else
+  {
+    f.stats.misses++;
+    f.ahead_begin = f.ahead_end = offset;
+  }
+  const size_type pagesize = _mh.page_size();
+  buffer_type regions[maximum_strided_regions];
+  size_t count = 0;
+  if(sequential)
+  {
+    f.stats.sequential_reads++;
+    // Top up the window once less than half of it remains ahead of the reader
+    const extent_type target = std::min<extent_type>(end + window, length);
+    if(f.ahead_end < end + window / 2 && f.ahead_end < target)
+    {
+      regions[count++] = buffer_type(_mh.address() + f.ahead_end, (size_type)(target - f.ahead_end));
+      f.ahead_end = target;
+    }
+  }
+  else
+  {
+    f.stats.strided_reads++;
+    // Prefetch as many of the following records as the window's worth of record bytes covers
+    const size_t records = (size_t) std::min<size_type>(std::max<size_type>(window / bytes, 1), maximum_strided_regions);
+    for(size_t n = 1; n <= records; n++)
+    {
+      const extent_type next = offset + n * f.stride;
+      if(next >= length)
+      {
+        break;
+      }
+      if(next < f.ahead_end)
+      {
+        continue;
+      }
+      const extent_type nextend = std::min<extent_type>(next + bytes, length);
+      regions[count++] = buffer_type(_mh.address() + next, (size_type)(nextend - next));
+      f.ahead_end = nextend;
+    }
+  }
+  if(count > 0)
+  {
+    for(size_t n = 0; n < count; n++)
+    {
+      f.stats.bytes_prefetched += regions[n].size();
+      regions[n] = utils::round_to_page_size_larger(regions[n], pagesize);
+    }
+    f.stats.prefetches++;
+    (void) map_handle::prefetch(span<buffer_type>(regions, count));
+  }
+}
+
+LLFIO_V2_NAMESPACE_END
@@ -24,7 +24,11 @@ Distributed under the Boost Software License, Version 1.0.
 
 #include "../../path_view.hpp"
 
+#include <cstdlib>
 #include <locale>
+#include <mutex>
+#include <new>
+#include <vector>
 
 #ifdef _WIN32
 #include "windows/import.hpp"
@@ -523,8 +527,101 @@ namespace detail
 #endif
   }
 
+
+  struct interned_path_table
+  {
+    std::mutex lock;
+    std::vector<interned_path_entry *> buckets;  // always a power of two in size
+    size_t count{0};
+  };
+  inline interned_path_table &interned_path_table_instance() noexcept
+  {
+    static interned_path_table v;
+    return v;
+  }
 }  // namespace detail
 
+LLFIO_HEADERS_ONLY_MEMFUNC_SPEC interned_path interned_path::intern(path_view_component v)
+{
+  if(v.empty())
+  {
+    return {};
+  }
+  path_view_component::zero_terminated_rendered_path<> zpath(v);
+  const auto *s = zpath.data();
+  const size_t length = zpath.size();
+  // FNV-1a over the native characters, translating separators as we go
+  size_t hash = (sizeof(size_t) == 8) ? (size_t) 14695981039346656037ULL : (size_t) 2166136261U;
+  const size_t prime = (sizeof(size_t) == 8) ? (size_t) 1099511628211ULL : (size_t) 16777619U;
+  const bool translate = (filesystem::path::preferred_separator != '/') &&
+                         (v.formatting() == path_view_component::auto_format || v.formatting() == path_view_component::generic_format);
+  auto native = [&](value_type c) -> value_type { return (translate && c == '/') ? (value_type) filesystem::path::preferred_separator : c; };
+  for(size_t n = 0; n < length; n++)
+  {
+    hash = (hash ^ (size_t) native(s[n])) * prime;
+  }
+  auto &table = detail::interned_path_table_instance();
+  std::lock_guard<std::mutex> g(table.lock);
+  if(!table.buckets.empty())
+  {
+    for(auto *e = table.buckets[hash & (table.buckets.size() - 1)]; e != nullptr; e = e->next)
+    {
+      if(e->hash == hash && e->length == length)
+      {
+        size_t n = 0;
+        while(n < length && e->str[n] == native(s[n]))
+        {
+          n++;
+        }
+        if(n == length)
+        {
+          return interned_path(e);
+        }
+      }
+    }
+  }
+  if(table.count >= table.buckets.size())
+  {
+    std::vector<detail::interned_path_entry *> buckets(table.buckets.empty() ? 256 : table.buckets.size() * 2, nullptr);
+    for(auto *e : table.buckets)
+    {
+      while(e != nullptr)
+      {
+        auto *next = e->next;
+        auto &bucket = buckets[e->hash & (buckets.size() - 1)];
+        e->next = bucket;
+        bucket = e;
+        e = next;
+      }
+    }
+    table.buckets = std::move(buckets);
+  }
+  auto *e = (detail::interned_path_entry *) malloc(sizeof(detail::interned_path_entry) + length * sizeof(value_type));
+  if(e == nullptr)
+  {
+    throw std::bad_alloc();
+  }
+  e->hash = hash;
+  e->length = length;
+  for(size_t n = 0; n < length; n++)
+  {
+    e->str[n] = native(s[n]);
+  }
+  e->str[length] = 0;
+  auto &bucket = table.buckets[hash & (table.buckets.size() - 1)];
+  e->next = bucket;
+  bucket = e;
+  table.count++;
+  return interned_path(e);
+}
+
+LLFIO_HEADERS_ONLY_MEMFUNC_SPEC size_t interned_path::interned_count() noexcept
+{
+  auto &table = detail::interned_path_table_instance();
+  std::lock_guard<std::mutex> g(table.lock);
+  return table.count;
+}
+
 LLFIO_V2_NAMESPACE_END
 
 #ifdef __GNUC__
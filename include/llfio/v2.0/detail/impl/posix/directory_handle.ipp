@@ -24,6 +24,9 @@ http://www.boost.org/LICENSE_1_0.txt)
 
 #include "../../../directory_handle.hpp"
 #include "import.hpp"
+#ifdef __linux__
+#include "io_uring.hpp"
+#endif
 
 #ifdef QUICKCPPLIB_ENABLE_VALGRIND
 #include "quickcpplib/valgrind/memcheck.h"  // from quickcpplib include directory
@@ -34,9 +37,12 @@ http://www.boost.org/LICENSE_1_0.txt)
 
 #include <dirent.h> /* Defines DT_* constants */
 #include <fnmatch.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/syscall.h>
 
+#include <vector>
+
 LLFIO_V2_NAMESPACE_BEGIN
 
 result<directory_handle> directory_handle::directory(const path_handle &base, path_view_type path, mode _mode, creation _creation, caching _caching,
@@ -259,6 +265,406 @@ LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<path_handle> directory_handle::clone_to_p
   return ret;
 }
 
+namespace detail
+{
+  /* A shell glob compiled once per enumeration, so each leafname can be rejected with a few
+  `memcmp()`s before any `directory_entry` is built. Globs made of only literals and `*` are
+  matched exactly without `fnmatch()`, with the literal runs between stars found using `memchr()`
+  which the C library vectorises. Globs with `?`, `[` or `\` use any literal prefix (and for
+  globs without `[` or `\`, literal suffix) as a prefilter before calling `fnmatch()`.
+  */
+  class compiled_glob
+  {
+    static constexpr size_t _max_segments = 8;
+
+    const char *_glob{nullptr};  // zero terminated, for fnmatch()
+    string_view _prefix, _suffix;
+    string_view _segments[_max_segments];  // literal runs between stars, in order
+    size_t _segments_count{0};
+    bool _match_all{false}, _literal{false}, _needs_fnmatch{false};
+
+    // Returns the first occurrence of `needle` in `[begin, end)`, or null
+    static const char *_find(const char *begin, const char *end, string_view needle) noexcept
+    {
+      const char first = needle.front();
+      while((size_t)(end - begin) >= needle.size())
+      {
+        begin = static_cast<const char *>(memchr(begin, first, (end - begin) - needle.size() + 1));
+        if(begin == nullptr)
+        {
+          return nullptr;
+        }
+        if(0 == memcmp(begin + 1, needle.data() + 1, needle.size() - 1))
+        {
+          return begin;
+        }
+        ++begin;
+      }
+      return nullptr;
+    }
+
+  public:
+    compiled_glob() = default;
+    //! Compiles `glob`, which must be zero terminated. An empty glob matches everything.
+    explicit compiled_glob(const char *glob, size_t length) noexcept
+        : _glob(glob)
+    {
+      const string_view g(glob, length);
+      const auto first_meta = g.find_first_of("*?[\\");
+      if(first_meta == string_view::npos)
+      {
+        // Literal, including empty
+        _match_all = g.empty();
+        _literal = true;
+        _prefix = g;
+        return;
+      }
+      _prefix = g.substr(0, first_meta);
+      if(g.find_first_of("?[\\", first_meta) != string_view::npos)
+      {
+        _needs_fnmatch = true;
+        if(g.find_first_of("[\\", first_meta) == string_view::npos)
+        {
+          // `?` matches exactly one character, so text after the last metacharacter must end the name
+          _suffix = g.substr(g.find_last_of("*?") + 1);
+        }
+        return;
+      }
+      // Only literals and stars remain
+      const auto last_star = g.rfind('*');
+      _suffix = g.substr(last_star + 1);
+      _match_all = (_prefix.empty() && _suffix.empty() && g.find_first_not_of('*') == string_view::npos);
+      for(size_t idx = first_meta; idx < last_star;)
+      {
+        const auto next_star = g.find('*', idx + 1);
+        if(next_star > idx + 1)
+        {
+          if(_segments_count == _max_segments)
+          {
+            _needs_fnmatch = true;
+            _segments_count = 0;
+            return;
+          }
+          _segments[_segments_count++] = g.substr(idx + 1, next_star - idx - 1);
+        }
+        idx = next_star;
+      }
+    }
+
+    //! True if this glob matches everything
+    bool matches_all() const noexcept { return _match_all; }
+
+    //! True if the zero terminated leafname `name` of `length` characters matches
+    bool matches(const char *name, size_t length) const noexcept
+    {
+      if(_match_all)
+      {
+        return true;
+      }
+      if(_literal)
+      {
+        return length == _prefix.size() && 0 == memcmp(name, _prefix.data(), length);
+      }
+      if(length < _prefix.size() + _suffix.size())
+      {
+        return false;
+      }
+      if(0 != memcmp(name, _prefix.data(), _prefix.size()) || 0 != memcmp(name + length - _suffix.size(), _suffix.data(), _suffix.size()))
+      {
+        return false;
+      }
+      if(_needs_fnmatch)
+      {
+        return 0 == fnmatch(_glob, name, 0);
+      }
+      const char *begin = name + _prefix.size(), *end = name + length - _suffix.size();
+      for(size_t n = 0; n < _segments_count; n++)
+      {
+        begin = _find(begin, end, _segments[n]);
+        if(begin == nullptr)
+        {
+          return false;
+        }
+        begin += _segments[n].size();
+      }
+      return true;
+    }
+  };
+
+#ifdef __linux__
+  /* A small io_uring used solely to batch `IORING_OP_STATX` for directory enumeration, set up
+  for the duration of one batch of at least `minimum_batch` entries. If io_uring is unavailable
+  (old kernel, seccomp, memlock limits) or does not know `IORING_OP_STATX` (before Linux 5.6),
+  `available` becomes false and callers issue `statx()` themselves.
+  */
+  struct directory_statx_ring : private io_uring_abi
+  {
+    using sqe_type = _io_uring_sqe;
+    using cqe_type = _io_uring_cqe;
+    static_assert(sizeof(sqe_type) == 64, "io_uring sqe is not 64 bytes!");
+    static constexpr unsigned ring_entries = 256;
+    static constexpr size_t minimum_batch = 64;
+
+    int fd{-1};
+    bool available{true};
+    void *sqring{MAP_FAILED}, *cqring{MAP_FAILED}, *sqesmem{MAP_FAILED};
+    size_t sqringsize{0}, cqringsize{0}, sqessize{0};
+    unsigned entries{0};
+    uint32_t *sqtail{nullptr}, *sqmask{nullptr}, *sqarray{nullptr};
+    uint32_t *cqhead{nullptr}, *cqtail{nullptr}, *cqmask{nullptr};
+    sqe_type *sqes{nullptr};
+    cqe_type *cqes{nullptr};
+    std::unique_ptr<linux_statx[]> results;
+
+    directory_statx_ring() = default;
+    directory_statx_ring(const directory_statx_ring &) = delete;
+    directory_statx_ring &operator=(const directory_statx_ring &) = delete;
+    ~directory_statx_ring() { _destroy(); }
+
+    void _destroy() noexcept
+    {
+      if(sqesmem != MAP_FAILED)
+      {
+        ::munmap(sqesmem, sqessize);
+      }
+      if(cqring != MAP_FAILED)
+      {
+        ::munmap(cqring, cqringsize);
+      }
+      if(sqring != MAP_FAILED)
+      {
+        ::munmap(sqring, sqringsize);
+      }
+      if(fd != -1)
+      {
+        ::close(fd);
+      }
+      sqring = cqring = sqesmem = MAP_FAILED;
+      fd = -1;
+    }
+    bool init() noexcept
+    {
+      if(fd != -1 || !available)
+      {
+        return available;
+      }
+      _io_uring_params p;
+      memset(&p, 0, sizeof(p));
+      fd = _io_uring_setup(ring_entries, &p);
+      if(fd < 0)
+      {
+        fd = -1;
+        return available = false;
+      }
+      entries = p.sq_entries;
+      sqringsize = p.sq_off.array + p.sq_entries * sizeof(uint32_t);
+      cqringsize = p.cq_off.cqes + p.cq_entries * sizeof(cqe_type);
+      sqessize = p.sq_entries * sizeof(sqe_type);
+      sqring = ::mmap(nullptr, sqringsize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, _IORING_OFF_SQ_RING);
+      cqring = ::mmap(nullptr, cqringsize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, _IORING_OFF_CQ_RING);
+      sqesmem = ::mmap(nullptr, sqessize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, _IORING_OFF_SQES);
+      results.reset(new(std::nothrow) linux_statx[entries]);
+      if(sqring == MAP_FAILED || cqring == MAP_FAILED || sqesmem == MAP_FAILED || !results)
+      {
+        _destroy();
+        return available = false;
+      }
+      auto *sq = static_cast<char *>(sqring);
+      auto *cq = static_cast<char *>(cqring);
+      sqtail = reinterpret_cast<uint32_t *>(sq + p.sq_off.tail);
+      sqmask = reinterpret_cast<uint32_t *>(sq + p.sq_off.ring_mask);
+      sqarray = reinterpret_cast<uint32_t *>(sq + p.sq_off.array);
+      cqhead = reinterpret_cast<uint32_t *>(cq + p.cq_off.head);
+      cqtail = reinterpret_cast<uint32_t *>(cq + p.cq_off.tail);
+      cqmask = reinterpret_cast<uint32_t *>(cq + p.cq_off.ring_mask);
+      cqes = reinterpret_cast<cqe_type *>(cq + p.cq_off.cqes);
+      sqes = static_cast<sqe_type *>(sqesmem);
+      return true;
+    }
+    /* Stat up to `entries` leafnames relative to `dirfd`, calling `f(idx, res, const linux_statx &)`
+    for each. Returns false if the ring could not be used, in which case no callbacks were made.
+    */
+    template <class F> result<bool> statx(int dirfd, const char *const *names, size_t count, unsigned mask, F &&f) noexcept
+    {
+      assert(count <= entries);
+      const uint32_t tail = *sqtail;
+      for(size_t i = 0; i < count; i++)
+      {
+        const uint32_t idx = (tail + (uint32_t) i) & *sqmask;
+        sqe_type &sqe = sqes[idx];
+        memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = _IORING_OP_STATX;
+        sqe.fd = dirfd;
+        sqe.addr = (uint64_t) (uintptr_t) names[i];
+        sqe.len = mask;
+        sqe.off = (uint64_t) (uintptr_t) &results[i];
+        sqe.statx_flags = AT_SYMLINK_NOFOLLOW | AT_NO_AUTOMOUNT;
+        sqe.user_data = i;
+        sqarray[idx] = idx;
+      }
+      reinterpret_cast<std::atomic<uint32_t> *>(sqtail)->store(tail + (uint32_t) count, std::memory_order_release);
+      size_t tosubmit = count, completed = 0;
+      bool first = true;
+      while(completed < count)
+      {
+        const size_t inflight = count - tosubmit - completed;
+        int r = _io_uring_enter(fd, (unsigned) tosubmit, (tosubmit > 0) ? 0 : (unsigned) inflight, (tosubmit > 0) ? 0 : _IORING_ENTER_GETEVENTS);
+        if(r < 0)
+        {
+          if(EINTR == errno || EAGAIN == errno || EBUSY == errno)
+          {
+            continue;
+          }
+          return posix_error();
+        }
+        if(tosubmit > 0)
+        {
+          tosubmit -= (size_t) r;
+        }
+        uint32_t head = *cqhead;
+        const uint32_t cqt = reinterpret_cast<std::atomic<uint32_t> *>(cqtail)->load(std::memory_order_acquire);
+        for(; head != cqt; ++head, ++completed)
+        {
+          const cqe_type &cqe = cqes[head & *cqmask];
+          if(first && cqe.res == -EINVAL)
+          {
+            // This kernel's io_uring doesn't know STATX. Drain the rest and give up on the ring.
+            available = false;
+          }
+          first = false;
+          if(available)
+          {
+            f((size_t) cqe.user_data, cqe.res, results[cqe.user_data]);
+          }
+        }
+        reinterpret_cast<std::atomic<uint32_t> *>(cqhead)->store(head, std::memory_order_release);
+      }
+      return available;
+    }
+  };
+#endif
+
+  /* Fills `wanted` metadata into entries returned by a POSIX enumeration, whose leafnames are
+  always zero terminated views of the kernel buffer. Returns the metadata actually filled.
+  */
+  inline result<stat_t::want> fill_directory_entry_metadata(int dirfd, span<directory_entry> entries, stat_t::want wanted) noexcept
+  {
+#ifdef __linux__
+    const stat_t::want supported = stat_t::want::dev | stat_t::want::ino | stat_t::want::type | stat_t::want::perms | stat_t::want::nlink |
+                                     stat_t::want::uid | stat_t::want::gid | stat_t::want::rdev | stat_t::want::atim | stat_t::want::mtim |
+                                     stat_t::want::ctim | stat_t::want::size | stat_t::want::allocated | stat_t::want::blocks |
+                                     stat_t::want::blksize | stat_t::want::birthtim | stat_t::want::sparse | stat_t::want::compressed;
+#else
+    const stat_t::want supported = stat_t::want::dev | stat_t::want::ino | stat_t::want::type | stat_t::want::perms | stat_t::want::nlink |
+                                     stat_t::want::uid | stat_t::want::gid | stat_t::want::rdev | stat_t::want::atim | stat_t::want::mtim |
+                                     stat_t::want::ctim | stat_t::want::size | stat_t::want::allocated | stat_t::want::blocks |
+                                     stat_t::want::blksize
+#ifdef HAVE_STAT_FLAGS
+                                     | stat_t::want::flags
+#endif
+#ifdef HAVE_STAT_GEN
+                                     | stat_t::want::gen
+#endif
+#ifdef HAVE_BIRTHTIMESPEC
+                                     | stat_t::want::birthtim
+#endif
+                                     | stat_t::want::sparse;
+#endif
+    wanted &= supported;
+    if(!wanted || entries.empty())
+    {
+      return wanted;
+    }
+    auto leafname = [](const directory_entry &item) -> const char * { return visit(item.leafname, [](const auto &v) { return reinterpret_cast<const char *>(v.data()); }); };
+    // Returns zero or an errno
+    auto stat_one = [&](directory_entry &item) -> int {
+#ifdef __linux__
+      static std::atomic<bool> have_statx{true};
+      if(have_statx.load(std::memory_order_relaxed))
+      {
+        linux_statx s;
+        memset(&s, 0, sizeof(s));
+        if(do_statx(dirfd, leafname(item), AT_SYMLINK_NOFOLLOW | AT_NO_AUTOMOUNT, statx_mask(wanted), &s) >= 0)
+        {
+          fill_stat_from_statx(item.stat, s, wanted);
+          return 0;
+        }
+        if(ENOSYS != errno)
+        {
+          return errno;
+        }
+        have_statx.store(false, std::memory_order_relaxed);
+      }
+#endif
+      struct stat s
+      {
+      };
+      if(-1 == ::fstatat(dirfd, leafname(item), &s, AT_SYMLINK_NOFOLLOW))
+      {
+        return errno;
+      }
+      fill_stat_from_stat(item.stat, s, wanted);
+      return 0;
+    };
+    size_t idx = 0;
+#ifdef __linux__
+    // A ring only repays its setup cost over a large enough batch
+    static std::atomic<bool> have_statx_ring{true};
+    if(entries.size() >= directory_statx_ring::minimum_batch && have_statx_ring.load(std::memory_order_relaxed))
+    {
+      directory_statx_ring ring;
+      if(!ring.init())
+      {
+        have_statx_ring.store(false, std::memory_order_relaxed);
+      }
+      else
+      {
+        const char *names[directory_statx_ring::ring_entries];
+        const unsigned mask = statx_mask(wanted);
+        int failure = 0;
+        while(idx < entries.size())
+        {
+          const size_t count = std::min(entries.size() - idx, (size_t) std::min<unsigned>(ring.entries, directory_statx_ring::ring_entries));
+          for(size_t n = 0; n < count; n++)
+          {
+            names[n] = leafname(entries[idx + n]);
+          }
+          OUTCOME_TRY(auto &&used, ring.statx(dirfd, names, count, mask, [&](size_t n, int res, const linux_statx &s) {
+            if(res >= 0)
+            {
+              fill_stat_from_statx(entries[idx + n].stat, s, wanted);
+            }
+            else if(-res != ENOENT && failure == 0)
+            {
+              failure = -res;
+            }
+          }));
+          if(!used)
+          {
+            have_statx_ring.store(false, std::memory_order_relaxed);
+            break;  // finish with statx() below
+          }
+          if(failure != 0)
+          {
+            return posix_error(failure);
+          }
+          idx += count;
+        }
+      }
+    }
+#endif
+    for(; idx < entries.size(); idx++)
+    {
+      const int errcode = stat_one(entries[idx]);
+      if(errcode != 0 && errcode != ENOENT)
+      {
+        return posix_error(errcode);
+      }
+    }
+    return wanted;
+  }
+}  // namespace detail
+
 result<directory_handle::buffers_type> directory_handle::read(io_request<buffers_type> req, deadline /*unused*/) const noexcept
 {
   LLFIO_LOG_FUNCTION_CALL(this);
@@ -350,18 +756,12 @@ result<directory_handle::buffers_type> directory_handle::read(io_request<buffers
     return syscall(SYS_getdirentries64, fd, buf, count, &foo);
   });
 #endif
-  if(!req.buffers._kernel_buffer && req.kernelbuffer.empty())
+  if(req.kernelbuffer.empty())
   {
-    // Let's assume the average leafname will be 64 characters long.
-    size_t toallocate = (sizeof(dirent) + 64) * req.buffers.size();
-    auto *mem = (char *) operator new[](toallocate, std::nothrow);  // don't initialise
-    if(mem == nullptr)
-    {
-      return errc::not_enough_memory;
-    }
-    req.buffers._kernel_buffer = std::unique_ptr<char[]>(mem);
-    req.buffers._kernel_buffer_size = toallocate;
+    // Let's assume the average leafname will be 64 characters long, unless this thread has learned otherwise
+    OUTCOME_TRY(_acquire_kernel_buffer(req.buffers, (sizeof(dirent) + 64) * req.buffers.size(), false));
   }
+  const detail::compiled_glob glob(zglob.c_str(), req.glob.empty() ? 0 : strlen(zglob.c_str()));
   stat_t::want default_stat_contents = stat_t::want::ino | stat_t::want::type;
   dirent *buffer;
   size_t bytesavailable, bytes;
@@ -399,15 +799,7 @@ result<directory_handle::buffers_type> directory_handle::read(io_request<buffers
       }
       if(req.kernelbuffer.empty() && _bytes == -1 && EINVAL == errno)
       {
-        size_t toallocate = req.buffers._kernel_buffer_size * 2;
-        auto *mem = (char *) operator new[](toallocate, std::nothrow);  // don't initialise
-        if(mem == nullptr)
-        {
-          return errc::not_enough_memory;
-        }
-        req.buffers._kernel_buffer.reset();
-        req.buffers._kernel_buffer = std::unique_ptr<char[]>(mem);
-        req.buffers._kernel_buffer_size = toallocate;
+        OUTCOME_TRY(_acquire_kernel_buffer(req.buffers, 0, true));
         // We need to reset and do the whole thing against to ensure single shot atomicity
         break;
       }
@@ -422,6 +814,10 @@ result<directory_handle::buffers_type> directory_handle::read(io_request<buffers
       }
     } while(!done);
   } while(!done);
+  if(req.kernelbuffer.empty())
+  {
+    _kernel_buffer_used(bytes);
+  }
   if(bytes == 0)
   {
     req.buffers._resize(0);
@@ -435,7 +831,15 @@ result<directory_handle::buffers_type> directory_handle::read(io_request<buffers
   {
     if(dent->d_ino != 0u)
     {
-      size_t length = strchr(dent->d_name, 0) - dent->d_name;
+#ifdef __linux__
+      // Records are padded to eight bytes, so the terminating null lies within the last eight
+      const size_t namebytes = dent->d_reclen - offsetof(dirent, d_name);
+      const size_t skip = (namebytes > 8) ? namebytes - 8 : 0;
+      const auto *end = static_cast<const char *>(memchr(dent->d_name + skip, 0, namebytes - skip));
+      size_t length = (end != nullptr) ? (size_t)(end - dent->d_name) : strlen(dent->d_name);
+#else
+      size_t length = strlen(dent->d_name);
+#endif
       if(length <= 2 && '.' == dent->d_name[0])
       {
         if(1 == length || '.' == dent->d_name[1])
@@ -443,7 +847,8 @@ result<directory_handle::buffers_type> directory_handle::read(io_request<buffers
           goto cont;
         }
       }
-      if(!req.glob.empty() && fnmatch(zglob.c_str(), dent->d_name, 0) != 0)
+      // Reject non-matching names before building anything
+      if(!glob.matches(dent->d_name, length))
       {
         goto cont;
       }
@@ -487,18 +892,23 @@ result<directory_handle::buffers_type> directory_handle::read(io_request<buffers
     {
       // Fill is complete
       req.buffers._resize(n);
-      req.buffers._metadata = default_stat_contents;
       req.buffers._done = true;
-      return std::move(req.buffers);
+      break;
     }
     if(n >= req.buffers.size())
     {
       // Fill is incomplete
-      req.buffers._metadata = default_stat_contents;
       req.buffers._done = false;
-      return std::move(req.buffers);
+      break;
     }
   }
+  req.buffers._metadata = default_stat_contents;
+  if(req.metadata & ~default_stat_contents)
+  {
+    OUTCOME_TRY(auto &&filled, detail::fill_directory_entry_metadata(_v.fd, req.buffers, req.metadata & ~default_stat_contents));
+    req.buffers._metadata |= filled;
+  }
+  return std::move(req.buffers);
 }
 
 LLFIO_V2_NAMESPACE_END
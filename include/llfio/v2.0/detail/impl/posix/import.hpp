@@ -31,6 +31,9 @@ Distributed under the Boost Software License, Version 1.0.
 #error You should not include posix/import.hpp on Windows platforms
 #endif
 
+#include <algorithm>
+#include <climits>
+
 #include <fcntl.h>
 #include <unistd.h>
 
@@ -176,6 +179,30 @@ inline result<int> attribs_from_handle_mode_caching_and_flags(native_handle_type
     }                                                                                                                                                                                                                                                                                                                          \
   }
 
+namespace detail
+{
+  // Returns the milliseconds remaining until the deadline for poll(), -1 if infinite
+  inline int deadline_to_poll_timeout(deadline d, std::chrono::steady_clock::time_point began_steady) noexcept
+  {
+    if(!d)
+    {
+      return -1;
+    }
+    std::chrono::milliseconds remaining;
+    if(d.steady)
+    {
+      remaining =
+      std::chrono::duration_cast<std::chrono::milliseconds>((began_steady + std::chrono::nanoseconds(d.nsecs)) - std::chrono::steady_clock::now());
+    }
+    else
+    {
+      remaining = std::chrono::duration_cast<std::chrono::milliseconds>(d.to_time_point() - std::chrono::system_clock::now());
+    }
+    // Round up, so we do not wake just before the deadline and spin
+    return (remaining.count() < 0) ? 0 : (int) std::min<std::chrono::milliseconds::rep>(remaining.count() + 1, INT_MAX);
+  }
+}  // namespace detail
+
 LLFIO_V2_NAMESPACE_END
 
 #endif
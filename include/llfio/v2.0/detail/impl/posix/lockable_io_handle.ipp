@@ -104,6 +104,7 @@ void lockable_io_handle::unlock_file_shared() noexcept
 result<lockable_io_handle::extent_guard> lockable_io_handle::lock_file_range(io_handle::extent_type offset, io_handle::extent_type bytes, lock_kind kind, deadline d) noexcept
 {
   LLFIO_LOG_FUNCTION_CALL(this);
+  detail::trace_scope trace(trace_event_kind::lock, (uint64_t) _v._init, offset);
   if(d && d.nsecs > 0)
   {
     return errc::not_supported;
@@ -159,12 +160,14 @@ result<lockable_io_handle::extent_guard> lockable_io_handle::lock_file_range(io_
     }
     return posix_error();
   }
+  trace.finish(bytes, false);
   return extent_guard(this, offset, bytes, kind);
 }
 
 void lockable_io_handle::unlock_file_range(io_handle::extent_type offset, io_handle::extent_type bytes) noexcept
 {
   LLFIO_LOG_FUNCTION_CALL(this);
+  tracing::record(trace_event_kind::unlock, trace_event_phase::instant, (uint64_t) _v._init, offset);
   bool failed = false;
   {
     struct flock fl
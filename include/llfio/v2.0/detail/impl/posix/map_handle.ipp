@@ -28,6 +28,12 @@ Distributed under the Boost Software License, Version 1.0.
 #include "quickcpplib/signal_guard.hpp"
 
 #include <sys/mman.h>
+#ifdef __linux__
+#include <linux/userfaultfd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>  // for SYS_mbind
+#include <unistd.h>       // for syscall()
+#endif
 
 //#define LLFIO_DEBUG_LINUX_MUNMAP
 
@@ -170,6 +176,7 @@ result<void> map_handle::close() noexcept
   LLFIO_LOG_FUNCTION_CALL(this);
   if(_addr != nullptr)
   {
+    detail::trace_scope trace(trace_event_kind::unmap, (uint64_t) _addr, _reservation);
     if(is_writable() && (_flag & section_handle::flag::barrier_on_close))
     {
       OUTCOME_TRYV(map_handle::barrier(barrier_kind::wait_all));
@@ -201,6 +208,7 @@ result<void> map_handle::close() noexcept
         return posix_error();
       }
     }
+    trace.finish(0, false);
   }
   // We don't want ~handle() to close our borrowed handle
   _v = native_handle_type();
@@ -219,6 +227,146 @@ native_handle_type map_handle::release() noexcept
   return {};
 }
 
+#ifdef __linux__
+namespace detail
+{
+  /* Written page tracking uses a single process wide userfaultfd in asynchronous write protect
+  mode (Linux 6.7+), which never generates events: the kernel simply clears the write protect bit
+  of a page when it is first written. The PAGEMAP_SCAN ioctl then reports the runs of pages written,
+  and atomically write protects them again.
+  */
+  struct written_page_tracker
+  {
+    struct page_region
+    {
+      uint64_t start, end, categories;
+    };
+    struct pm_scan_arg
+    {
+      uint64_t size, flags, start, end, walk_end, vec, vec_len, max_pages, category_inverted, category_mask, category_anyof_mask, return_mask;
+    };
+    static constexpr unsigned long PAGEMAP_SCAN = _IOWR('f', 16, pm_scan_arg);
+    static constexpr uint64_t PM_SCAN_WP_MATCHING = 1U << 0U, PM_SCAN_CHECK_WPASYNC = 1U << 1U;
+    static constexpr uint64_t PAGE_IS_WRITTEN = 1U << 1U;
+    static constexpr uint64_t UFFD_FEATURE_WP_UNPOPULATED = 1U << 13U, UFFD_FEATURE_WP_ASYNC = 1U << 15U;
+
+    int uffd{-1}, pagemapfd{-1};
+
+    written_page_tracker()
+    {
+      uffd = (int) ::syscall(SYS_userfaultfd, O_CLOEXEC | O_NONBLOCK | 1 /*UFFD_USER_MODE_ONLY*/);
+      if(uffd == -1)
+      {
+        uffd = (int) ::syscall(SYS_userfaultfd, O_CLOEXEC | O_NONBLOCK);
+      }
+      if(uffd == -1)
+      {
+        return;
+      }
+      struct uffdio_api api;
+      memset(&api, 0, sizeof(api));
+      api.api = UFFD_API;
+      api.features = UFFD_FEATURE_WP_ASYNC | UFFD_FEATURE_WP_UNPOPULATED;
+      if(-1 == ::ioctl(uffd, UFFDIO_API, &api) || (pagemapfd = ::open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC)) == -1)
+      {
+        ::close(uffd);
+        uffd = -1;
+      }
+    }
+    written_page_tracker(const written_page_tracker &) = delete;
+    written_page_tracker &operator=(const written_page_tracker &) = delete;
+    ~written_page_tracker()
+    {
+      if(uffd != -1)
+      {
+        ::close(pagemapfd);
+        ::close(uffd);
+      }
+    }
+
+    // Begin tracking writes to the pages in a range. Failure just means writes go untracked.
+    bool track(void *addr, size_t bytes) noexcept
+    {
+      if(uffd == -1)
+      {
+        return false;
+      }
+      struct uffdio_register reg;
+      memset(&reg, 0, sizeof(reg));
+      reg.range.start = (uint64_t) addr;
+      reg.range.len = bytes;
+      reg.mode = UFFDIO_REGISTER_MODE_WP;
+      if(-1 == ::ioctl(uffd, UFFDIO_REGISTER, &reg))
+      {
+        return false;
+      }
+      struct uffdio_writeprotect wp;
+      memset(&wp, 0, sizeof(wp));
+      wp.range = reg.range;
+      wp.mode = UFFDIO_WRITEPROTECT_MODE_WP;
+      return -1 != ::ioctl(uffd, UFFDIO_WRITEPROTECT, &wp);
+    }
+
+    /* Call f(begin, end) for each run of pages written since last reset within the range.
+    Fails if any of the range is not tracked, in which case some of it may have been reset.
+    */
+    template <class F> result<void> scan(byte *addr, size_t bytes, bool reset, F &&f) noexcept
+    {
+      if(uffd == -1)
+      {
+        return errc::operation_not_supported;
+      }
+      page_region vec[64];
+      pm_scan_arg arg;
+      memset(&arg, 0, sizeof(arg));
+      arg.size = sizeof(arg);
+      arg.flags = PM_SCAN_CHECK_WPASYNC | (reset ? PM_SCAN_WP_MATCHING : 0);
+      arg.start = (uint64_t) addr;
+      arg.end = (uint64_t)(addr + bytes);
+      arg.vec = (uint64_t) vec;
+      arg.vec_len = sizeof(vec) / sizeof(vec[0]);
+      arg.category_mask = PAGE_IS_WRITTEN;
+      arg.return_mask = PAGE_IS_WRITTEN;
+      for(;;)
+      {
+        auto count = ::ioctl(pagemapfd, PAGEMAP_SCAN, &arg);
+        if(count < 0)
+        {
+          if(EINTR == errno)
+          {
+            continue;
+          }
+          if(EPERM == errno || EINVAL == errno || ENOTTY == errno)
+          {
+            return errc::operation_not_supported;
+          }
+          return posix_error();
+        }
+        for(long n = 0; n < count; n++)
+        {
+          f(reinterpret_cast<byte *>(vec[n].start), reinterpret_cast<byte *>(vec[n].end));
+        }
+        if(arg.walk_end >= arg.end)
+        {
+          return success();
+        }
+        arg.start = arg.walk_end;
+      }
+    }
+    // Write protect again the pages written within the range, so they are no longer reported
+    result<void> reset(byte *addr, size_t bytes) noexcept
+    {
+      return scan(addr, bytes, true, [](byte * /*unused*/, byte * /*unused*/) {});
+    }
+  };
+  inline written_page_tracker &written_page_tracker_instance() noexcept
+  {
+    static written_page_tracker v;
+    return v;
+  }
+}  // namespace detail
+#endif
+
 map_handle::io_result<map_handle::const_buffers_type> map_handle::_do_barrier(map_handle::io_request<map_handle::const_buffers_type> reqs, barrier_kind kind,
                                                                               deadline d) noexcept
 {
@@ -249,7 +397,55 @@ map_handle::io_result<map_handle::const_buffers_type> map_handle::_do_barrier(ma
     }
   }
   int flags = ((uint8_t) kind & 1) ? MS_SYNC : MS_ASYNC;
-  if(-1 == ::msync(addr, bytes, flags))
+  bool synced = false;
+#ifdef __linux__
+  if(_flag & section_handle::flag::track_written_pages)
+  {
+    /* Only msync the pages written since the last barrier, merging runs separated by small gaps.
+    Each run is reset only once its msync succeeds, so after a failed msync the next barrier
+    flushes that run and any after it again. A write to a run between its msync and its reset
+    is not seen by later barriers.
+    */
+    static constexpr size_t mergegap = 65536;
+    auto &tracker = detail::written_page_tracker_instance();
+    byte *begin = utils::round_down_to_page_size(addr, _pagesize), *runbegin = nullptr, *runend = nullptr;
+    int errcode = 0;
+    auto flush = [&] {
+      if(runbegin == nullptr || errcode != 0)
+      {
+        return;
+      }
+      if(-1 == ::msync(runbegin, runend - runbegin, flags))
+      {
+        errcode = errno;
+        return;
+      }
+      // If the reset fails the run is merely flushed again by the next barrier
+      (void) tracker.reset(runbegin, runend - runbegin);
+    };
+    auto r = tracker.scan(begin, utils::round_up_to_page_size(addr + bytes, _pagesize) - begin, false, [&](byte *b, byte *e) {
+      if(runbegin != nullptr && b - runend <= (ptrdiff_t) mergegap)
+      {
+        runend = e;
+        return;
+      }
+      flush();
+      runbegin = b;
+      runend = e;
+    });
+    if(r)
+    {
+      flush();
+      if(errcode != 0)
+      {
+        return posix_error(errcode);
+      }
+      synced = true;
+    }
+    // Otherwise some of the range is untracked, so msync all of it
+  }
+#endif
+  if(!synced && -1 == ::msync(addr, bytes, flags))
   {
     return posix_error();
   }
@@ -292,6 +488,37 @@ LLFIO_HEADERS_ONLY_MEMFUNC_SPEC map_handle::memory_accounting_kind map_handle::m
 #endif
 
 
+#ifdef __linux__
+namespace detail
+{
+  // The size of a transparent huge page, which is the size of memory mapped by a page middle directory entry
+  inline size_t transparent_huge_page_size() noexcept
+  {
+    static const size_t v = [] {
+      size_t ret = 2 * 1024 * 1024;
+      int fd = ::open("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size", O_RDONLY);
+      if(fd != -1)
+      {
+        char buffer[32];
+        auto bytes = ::read(fd, buffer, sizeof(buffer) - 1);
+        if(bytes > 0)
+        {
+          buffer[bytes] = 0;
+          auto parsed = (size_t) strtoull(buffer, nullptr, 10);
+          if(parsed != 0 && (parsed & (parsed - 1)) == 0)
+          {
+            ret = parsed;
+          }
+        }
+        ::close(fd);
+      }
+      return ret;
+    }();
+    return v;
+  }
+}  // namespace detail
+#endif
+
 static inline result<void *> do_mmap(native_handle_type &nativeh, void *ataddr, int extra_flags, section_handle *section, map_handle::size_type pagesize,
                                      map_handle::size_type &bytes, map_handle::extent_type offset, section_handle::flag _flag) noexcept
 {
@@ -364,6 +591,22 @@ static inline result<void *> do_mmap(native_handle_type &nativeh, void *ataddr,
     flags |= MAP_NOSYNC;
 #endif
   flags |= extra_flags;
+#ifdef __linux__
+  const bool thp = (_flag & section_handle::flag::transparent_huge_pages) && pagesize == utils::page_size();
+  size_t thp_alignment = 0;
+  if(thp)
+  {
+#if defined(MADV_POPULATE_WRITE) && defined(MADV_POPULATE_READ)
+    // Populate only after advising, else the pages populated will be normal ones
+    flags &= ~MAP_POPULATE;
+#endif
+    // Huge pages can only back naturally aligned runs, so over reserve new anonymous maps and trim
+    if(ataddr == nullptr && !have_backing && bytes >= detail::transparent_huge_page_size())
+    {
+      thp_alignment = detail::transparent_huge_page_size();
+    }
+  }
+#endif
   int fd_to_use = have_backing ? section->native_handle().fd : -1;
   if(pagesize != utils::page_size())
   {
@@ -406,6 +649,23 @@ static inline result<void *> do_mmap(native_handle_type &nativeh, void *ataddr,
     flagscopy |= MAP_SHARED_VALIDATE | MAP_SYNC;
     addr = ::mmap(ataddr, _bytes, prot, flagscopy, fd_to_use, _offset);
   }
+#endif
+#ifdef __linux__
+  if(addr == nullptr && thp_alignment != 0)
+  {
+    addr = ::mmap(ataddr, _bytes + thp_alignment, prot, flags, fd_to_use, _offset);
+    if(MAP_FAILED != addr)  // NOLINT
+    {
+      auto *base = static_cast<char *>(addr);
+      auto *aligned = reinterpret_cast<char *>((reinterpret_cast<uintptr_t>(base) + thp_alignment - 1) & ~(uintptr_t)(thp_alignment - 1));
+      if(aligned != base)
+      {
+        ::munmap(base, aligned - base);
+      }
+      ::munmap(aligned + _bytes, (base + thp_alignment) - aligned);
+      addr = aligned;
+    }
+  }
 #endif
   if(addr == nullptr)
   {
@@ -416,6 +676,26 @@ static inline result<void *> do_mmap(native_handle_type &nativeh, void *ataddr,
   {
     return posix_error();
   }
+#ifdef __linux__
+  if((_flag & section_handle::flag::track_written_pages) && (prot & PROT_WRITE))
+  {
+    // If this fails, barrier() notices and falls back to flushing everything
+    (void) detail::written_page_tracker_instance().track(addr, _bytes);
+  }
+#endif
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  if(thp)
+  {
+    // Fails with EINVAL if the kernel lacks transparent huge pages, which is not an error as this is a hint
+    (void) ::madvise(addr, _bytes, MADV_HUGEPAGE);
+#if defined(MADV_POPULATE_WRITE) && defined(MADV_POPULATE_READ)
+    if(_flag & section_handle::flag::prefault)
+    {
+      (void) ::madvise(addr, _bytes, (prot & PROT_WRITE) ? MADV_POPULATE_WRITE : MADV_POPULATE_READ);
+    }
+#endif
+  }
+#endif
 #ifdef MADV_FREE_REUSABLE
   if((prot & PROT_WRITE) != 0 && (_flag & section_handle::flag::nocommit))
   {
@@ -475,8 +755,9 @@ result<map_handle> map_handle::_new_map(size_type bytes, bool fallback, section_
   return ret;
 }
 
-result<map_handle> map_handle::map(section_handle &section, size_type bytes, extent_type offset, section_handle::flag _flag) noexcept
+result<map_handle> map_handle::map(section_handle &section, size_type bytes, extent_type offset, section_handle::flag _flag, void *address) noexcept
 {
+  detail::trace_scope trace(trace_event_kind::map, (uint64_t) section.native_handle()._init, bytes);
   OUTCOME_TRY(auto &&length, section.length());  // length of the backing file
   if(length <= offset)
   {
@@ -497,7 +778,30 @@ result<map_handle> map_handle::map(section_handle &section, size_type bytes, ext
   result<map_handle> ret{map_handle(&section, _flag)};
   native_handle_type &nativeh = ret.value()._v;
   OUTCOME_TRY(auto &&pagesize, detail::pagesize_from_flags(ret.value()._flag));
-  OUTCOME_TRY(auto &&addr, do_mmap(nativeh, nullptr, 0, &section, pagesize, bytes, offset, ret.value()._flag));
+  int extra_flags = 0;
+  if(address != nullptr)
+  {
+#if defined(MAP_EXCL)  // BSD type systems
+    extra_flags = MAP_FIXED | MAP_EXCL;
+#elif defined(__linux__)
+    extra_flags = 0x100000 /*MAP_FIXED_NOREPLACE*/;  // older kernels ignore this and treat the address as a hint
+#endif
+  }
+  auto mapped = do_mmap(nativeh, address, extra_flags, &section, pagesize, bytes, offset, ret.value()._flag);
+  if(!mapped)
+  {
+    if(address != nullptr && mapped.error() == errc::file_exists)
+    {
+      return errc::address_in_use;
+    }
+    return std::move(mapped).error();
+  }
+  void *addr = mapped.value();
+  if(address != nullptr && addr != address)
+  {
+    ::munmap(addr, bytes);
+    return errc::address_in_use;
+  }
   ret.value()._addr = static_cast<byte *>(addr);
   ret.value()._offset = offset;
   ret.value()._reservation = utils::round_up_to_page_size(bytes, pagesize);
@@ -507,6 +811,7 @@ result<map_handle> map_handle::map(section_handle &section, size_type bytes, ext
   ret.value()._v.fd = section.native_handle().fd;
   nativeh.behaviour |= native_handle_type::disposition::allocation;
   LLFIO_LOG_FUNCTION_CALL(&ret);
+  trace.finish((uint64_t) addr, false);
   return ret;
 }
 
@@ -622,7 +927,7 @@ result<map_handle::buffer_type> map_handle::commit(buffer_type region, section_h
   region = utils::round_to_page_size_larger(region, _pagesize);
   extent_type offset = _offset + (region.data() - _addr);
   size_type bytes = region.size();
-  OUTCOME_TRYV(do_mmap(_v, region.data(), MAP_FIXED, _section, _pagesize, bytes, offset, flag));
+  OUTCOME_TRYV(do_mmap(_v, region.data(), MAP_FIXED, _section, _pagesize, bytes, offset, flag | (_flag & section_handle::flag::track_written_pages)));
   // Tell the kernel we will be using these pages soon
   if(_section != nullptr && -1 == ::madvise(region.data(), region.size(), MADV_WILLNEED))
   {
@@ -699,6 +1004,234 @@ result<span<map_handle::buffer_type>> map_handle::prefetch(span<buffer_type> reg
   return regions;
 }
 
+result<map_handle::buffer_type> map_handle::prefault(buffer_type region) noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+  region = utils::round_to_page_size_larger(region, _pagesize);
+  if(region.data() == nullptr)
+  {
+    return errc::invalid_argument;
+  }
+  const bool writable = !!(_flag & section_handle::flag::write);
+#if defined(MADV_POPULATE_WRITE) && defined(MADV_POPULATE_READ)
+  if(-1 != ::madvise(region.data(), region.size(), writable ? MADV_POPULATE_WRITE : MADV_POPULATE_READ))
+  {
+    return region;
+  }
+  if(errno != EINVAL)  // EINVAL means a kernel before 5.14
+  {
+    return posix_error();
+  }
+#endif
+  // Touch every page, an atomic add of zero faults the page for write without racing other writers
+  for(byte *p = region.data(); p < region.data() + region.size(); p += _pagesize)
+  {
+    if(writable)
+    {
+      __atomic_fetch_add(reinterpret_cast<unsigned char *>(p), 0, __ATOMIC_RELAXED);
+    }
+    else
+    {
+      (void) *reinterpret_cast<volatile unsigned char *>(p);
+    }
+  }
+  return region;
+}
+
+result<map_handle::buffer_type> map_handle::bind_to_numa_node(buffer_type region, unsigned node) noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+  region = utils::round_to_page_size_larger(region, _pagesize);
+  if(region.data() == nullptr)
+  {
+    return errc::invalid_argument;
+  }
+#ifdef __linux__
+  // Avoid a dependency on libnuma by calling the syscall directly
+  static constexpr int _MPOL_BIND = 2;
+  static constexpr unsigned _MPOL_MF_MOVE = (1U << 1U);
+  static constexpr size_t bits_per_word = 8 * sizeof(unsigned long);
+  unsigned long nodemask[16];
+  if(node >= 16 * bits_per_word)
+  {
+    return errc::invalid_argument;
+  }
+  memset(nodemask, 0, sizeof(nodemask));
+  nodemask[node / bits_per_word] = 1UL << (node % bits_per_word);
+  // The kernel ignores the last bit of maxnode
+  if(-1 == ::syscall(SYS_mbind, region.data(), region.size(), _MPOL_BIND, nodemask, 16 * bits_per_word + 1, _MPOL_MF_MOVE))
+  {
+    return posix_error();
+  }
+  return region;
+#else
+  (void) node;
+  return errc::operation_not_supported;
+#endif
+}
+
+result<span<map_handle::buffer_type>> map_handle::written_regions(span<buffer_type> out, buffer_type region) const noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+  if(region.data() == nullptr)
+  {
+    region = {_addr, _length};
+  }
+  region = utils::round_to_page_size_larger(region, _pagesize);
+  if(!(_flag & section_handle::flag::track_written_pages) || region.data() == nullptr)
+  {
+    return errc::operation_not_supported;
+  }
+#ifdef __linux__
+  size_t count = 0;
+  bool truncated = false;
+  OUTCOME_TRY(detail::written_page_tracker_instance().scan(region.data(), region.size(), false, [&](byte *b, byte *e) {
+    if(count > 0 && out[count - 1].data() + out[count - 1].size() == b)
+    {
+      out[count - 1] = {out[count - 1].data(), (size_t)(e - out[count - 1].data())};
+    }
+    else if(count < out.size())
+    {
+      out[count++] = {b, (size_t)(e - b)};
+    }
+    else
+    {
+      truncated = true;
+    }
+  }));
+  if(truncated)
+  {
+    return errc::value_too_large;
+  }
+  return out.subspan(0, count);
+#else
+  (void) out;
+  return errc::operation_not_supported;
+#endif
+}
+
+result<map_handle::buffer_type> map_handle::collapse_to_huge_pages(buffer_type region) noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+  region = utils::round_to_page_size_larger(region, _pagesize);
+  if(region.data() == nullptr)
+  {
+    return errc::invalid_argument;
+  }
+#ifdef __linux__
+  static constexpr int _MADV_COLLAPSE = 25;  // Linux 6.1 or later
+  if(-1 == ::madvise(region.data(), region.size(), _MADV_COLLAPSE))
+  {
+    if(EINVAL == errno)
+    {
+      return errc::operation_not_supported;
+    }
+    return posix_error();
+  }
+  return region;
+#else
+  return errc::operation_not_supported;
+#endif
+}
+
+result<map_handle::size_type> map_handle::huge_page_bytes() const noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+  if(_addr == nullptr)
+  {
+    return 0;
+  }
+  if(_pagesize != utils::page_size())
+  {
+    return _reservation;
+  }
+#ifdef __linux__
+  /* Each map in /proc/self/smaps is a header line "start-end perms offset dev inode path"
+  followed by "Key:   value kB" lines. Sum the huge page counts of every map overlapping ours.
+  The kernel may have merged ours with a neighbouring map, so from a map which extends beyond
+  ours count no more than the huge page aligned extents of the overlap, as huge pages are
+  always aligned to their size.
+  */
+  int fd = ::open("/proc/self/smaps", O_RDONLY | O_CLOEXEC);
+  if(fd == -1)
+  {
+    return posix_error();
+  }
+  auto unfd = make_scope_exit([fd]() noexcept { ::close(fd); });
+  const auto begin = reinterpret_cast<uintptr_t>(_addr), end = begin + _reservation;
+  const uintptr_t thp = detail::transparent_huge_page_size();
+  size_type ret = 0, limit = 0;
+  char buffer[4096];
+  size_t buffered = 0;
+  for(;;)
+  {
+    const auto bytes = ::read(fd, buffer + buffered, sizeof(buffer) - buffered);
+    if(bytes < 0)
+    {
+      if(EINTR == errno)
+      {
+        continue;
+      }
+      return posix_error();
+    }
+    buffered += (size_t) bytes;
+    size_t consumed = 0;
+    for(;;)
+    {
+      auto *line = buffer + consumed;
+      auto *eol = static_cast<char *>(memchr(line, '\n', buffered - consumed));
+      if(eol == nullptr)
+      {
+        break;
+      }
+      *eol = 0;
+      consumed = eol + 1 - buffer;
+      if(line[0] >= 'A' && line[0] <= 'Z')
+      {
+        if(limit > 0 && (0 == strncmp(line, "AnonHugePages:", 14) || 0 == strncmp(line, "ShmemPmdMapped:", 15) || 0 == strncmp(line, "FilePmdMapped:", 14)))
+        {
+          const auto v = (size_type) strtoull(strchr(line, ':') + 1, nullptr, 10) * 1024;
+          ret += std::min(v, limit);
+          limit -= std::min(v, limit);
+        }
+      }
+      else
+      {
+        char *p = line;
+        const auto start = (uintptr_t) strtoull(p, &p, 16);
+        const auto finish = (*p == '-') ? (uintptr_t) strtoull(p + 1, &p, 16) : start;
+        if(start >= begin && finish <= end)
+        {
+          limit = finish - start;
+        }
+        else if(start < end && finish > begin)
+        {
+          const auto lo = (std::max(start, begin) + thp - 1) & ~(thp - 1), hi = std::min(finish, end) & ~(thp - 1);
+          limit = (hi > lo) ? (hi - lo) : 0;
+        }
+        else
+        {
+          limit = 0;
+        }
+      }
+    }
+    if(bytes == 0)
+    {
+      break;
+    }
+    memmove(buffer, buffer + consumed, buffered - consumed);
+    buffered -= consumed;
+    if(buffered == sizeof(buffer))
+    {
+      buffered = 0;  // overlong line, cannot be one we want
+    }
+  }
+  return ret;
+#else
+  return errc::operation_not_supported;
+#endif
+}
+
 result<map_handle::buffer_type> map_handle::do_not_store(buffer_type region) noexcept
 {
   LLFIO_LOG_FUNCTION_CALL(0);
@@ -25,6 +25,11 @@ Distributed under the Boost Software License, Version 1.0.
 #include "../../../pipe_handle.hpp"
 #include "import.hpp"
 
+#include <poll.h>
+#ifdef __linux__
+#include <sys/uio.h>  // for vmsplice
+#endif
+
 LLFIO_V2_NAMESPACE_BEGIN
 
 result<pipe_handle> pipe_handle::pipe(pipe_handle::path_view_type path, pipe_handle::mode _mode, pipe_handle::creation _creation, pipe_handle::caching _caching, pipe_handle::flag flags, const path_handle &base) noexcept
@@ -177,4 +182,150 @@ result<std::pair<pipe_handle, pipe_handle>> pipe_handle::anonymous_pipe(caching
   return ret;
 }
 
+result<size_t> pipe_handle::buffer_size() const noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+#ifdef F_GETPIPE_SZ
+  int ret = ::fcntl(_v.fd, F_GETPIPE_SZ);
+  if(-1 == ret)
+  {
+    return posix_error();
+  }
+  return (size_t) ret;
+#else
+  return errc::operation_not_supported;
+#endif
+}
+
+result<size_t> pipe_handle::set_buffer_size(size_t bytes) noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+#ifdef F_SETPIPE_SZ
+  int ret = ::fcntl(_v.fd, F_SETPIPE_SZ, (int) std::min<size_t>(bytes, INT_MAX));
+  if(-1 == ret)
+  {
+    return posix_error();
+  }
+  return (size_t) ret;
+#else
+  (void) bytes;
+  return errc::operation_not_supported;
+#endif
+}
+
+#ifdef __linux__
+namespace detail
+{
+  // The fd of a handle if polling it says anything, else -1. Regular files and directories always poll ready.
+  inline int pipe_splice_pollable_fd(const native_handle_type &h) noexcept { return (h.is_regular() || h.is_directory()) ? -1 : h.fd; }
+
+  /* Calls op(flags) until it moves some bytes. If a deadline is set, op() is asked not to block
+  on pipes, and if it would have blocked we poll until the source has data and the destination
+  has space. Either fd may be -1 if it cannot be polled.
+  */
+  template <class F> inline result<size_t> pipe_splice_loop(int srcfd, int destfd, deadline d, F &&op) noexcept
+  {
+    LLFIO_POSIX_DEADLINE_TO_SLEEP_INIT(d);
+    (void) timeout;
+    for(;;)
+    {
+      auto ret = op(d ? SPLICE_F_NONBLOCK : 0);
+      if(ret >= 0)
+      {
+        return (size_t) ret;
+      }
+      if(EINTR == errno)
+      {
+        continue;
+      }
+      if(EAGAIN != errno)
+      {
+        return posix_error();
+      }
+      LLFIO_POSIX_DEADLINE_TO_TIMEOUT_LOOP(d);
+      // Both ends must be ready for progress, and readiness is level triggered, so wait on each in turn
+      pollfd p[2];
+      memset(p, 0, sizeof(p));
+      p[0].fd = destfd;
+      p[0].events = POLLOUT;
+      p[1].fd = srcfd;
+      p[1].events = POLLIN;
+      for(auto &i : p)
+      {
+        if(i.fd != -1 && -1 == ::poll(&i, 1, deadline_to_poll_timeout(d, began_steady)) && EINTR != errno)
+        {
+          return posix_error();
+        }
+      }
+    }
+  }
+}  // namespace detail
+#endif
+
+result<size_t> pipe_handle::splice_from(io_handle &src, extent_type offset, size_t bytes, deadline d) noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+#ifdef __linux__
+  const int srcfd = src.native_handle().fd;
+  const bool seekable = src.is_seekable();
+  return detail::pipe_splice_loop(detail::pipe_splice_pollable_fd(src.native_handle()), _v.fd, d, [&](unsigned flags) {
+    loff_t off = (loff_t) offset;
+    return ::splice(srcfd, seekable ? &off : nullptr, _v.fd, nullptr, bytes, SPLICE_F_MOVE | flags);
+  });
+#else
+  return detail::pipe_bounce_transfer(src, offset, *this, 0, bytes, d);
+#endif
+}
+
+result<size_t> pipe_handle::splice_to(io_handle &dest, extent_type offset, size_t bytes, deadline d) noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+#ifdef __linux__
+  const int destfd = dest.native_handle().fd;
+  const bool seekable = dest.is_seekable();
+  return detail::pipe_splice_loop(_v.fd, detail::pipe_splice_pollable_fd(dest.native_handle()), d, [&](unsigned flags) {
+    loff_t off = (loff_t) offset;
+    return ::splice(_v.fd, nullptr, destfd, seekable ? &off : nullptr, bytes, SPLICE_F_MOVE | flags);
+  });
+#else
+  return detail::pipe_bounce_transfer(*this, 0, dest, offset, bytes, d);
+#endif
+}
+
+result<size_t> pipe_handle::tee_to(pipe_handle &dest, size_t bytes, deadline d) noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+#ifdef __linux__
+  const int destfd = dest.native_handle().fd;
+  return detail::pipe_splice_loop(_v.fd, destfd, d, [&](unsigned flags) { return ::tee(_v.fd, destfd, bytes, flags); });
+#else
+  (void) dest;
+  (void) bytes;
+  (void) d;
+  return errc::operation_not_supported;
+#endif
+}
+
+result<size_t> pipe_handle::gift(const_buffers_type buffers, deadline d) noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+#ifdef __linux__
+  static_assert(sizeof(struct iovec) == sizeof(const_buffer_type), "const_buffer_type does not have the same layout as struct iovec");
+  if(buffers.size() > IOV_MAX)
+  {
+    return errc::argument_list_too_long;
+  }
+  return detail::pipe_splice_loop(-1, _v.fd, d, [&](unsigned flags) {
+    return ::vmsplice(_v.fd, reinterpret_cast<const struct iovec *>(buffers.data()), buffers.size(), SPLICE_F_GIFT | flags);
+  });
+#else
+  auto written = write({buffers, 0}, d);
+  if(!written)
+  {
+    return std::move(written).error();
+  }
+  return written.bytes_transferred();
+#endif
+}
+
 LLFIO_V2_NAMESPACE_END
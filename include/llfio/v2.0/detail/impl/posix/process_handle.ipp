@@ -26,10 +26,25 @@ Distributed under the Boost Software License, Version 1.0.
 
 #include "import.hpp"
 
+#include <climits>
+#include <cstring>
+#include <vector>
+
+#include <poll.h>
 #include <signal.h>  // for siginfo_t
 #include <spawn.h>
 #include <sys/wait.h>
 
+#ifdef __linux__
+#include <atomic>
+#include <memory>
+#include <new>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#endif
+
 #ifdef __FreeBSD__
 #include <sys/sysctl.h>
 extern "C" char **environ;
@@ -41,6 +56,20 @@ extern "C" char **environ;
 
 LLFIO_V2_NAMESPACE_BEGIN
 
+namespace detail
+{
+  // Returns a pidfd for the process, or -1 if the kernel does not support pidfds
+  inline int pidfd_open(int pid) noexcept
+  {
+#ifdef __linux__
+    return (int) ::syscall(434 /*__NR_pidfd_open*/, pid, 0);
+#else
+    (void) pid;
+    return -1;
+#endif
+  }
+}  // namespace detail
+
 LLFIO_HEADERS_ONLY_MEMFUNC_SPEC bool process_handle::is_running() const noexcept
 {
   LLFIO_LOG_FUNCTION_CALL(this);
@@ -99,19 +128,51 @@ LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<process_handle::path_type> process_handle
 
 LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<void> process_handle::close() noexcept
 {
+#ifdef __linux__
+  // Close the pidfd even if closing the pipes or waiting fails
+  auto unpidfd = make_scope_exit([this]() noexcept {
+    if(_pidfd != -1)
+    {
+      (void) ::close(_pidfd);
+      _pidfd = -1;
+    }
+  });
+#endif
   OUTCOME_TRY(close_pipes());
   if(_flags & flag::wait_on_close)
   {
     log_level_guard g(log_level::fatal);
     OUTCOME_TRY(wait());
   }
+#ifdef __linux__
+  if(_pidfd != -1)
+  {
+    const int fd = _pidfd;
+    _pidfd = -1;
+    if(-1 == ::close(fd))
+    {
+      return posix_error();
+    }
+  }
+#endif
   _v = {};
   return success();
 }
 
 LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<process_handle> process_handle::clone() const noexcept
 {
-  return process_handle(_v, _flags);
+  process_handle ret(_v, _flags);
+#ifdef __linux__
+  if(_pidfd != -1)
+  {
+    ret._pidfd = ::fcntl(_pidfd, F_DUPFD_CLOEXEC, 0);
+    if(-1 == ret._pidfd)
+    {
+      return posix_error();
+    }
+  }
+#endif
+  return ret;
 }
 
 LLFIO_HEADERS_ONLY_MEMFUNC_SPEC std::unique_ptr<span<path_view_component>, process_handle::_byte_array_deleter> process_handle::environment() const noexcept
@@ -173,17 +234,117 @@ LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<intptr_t> process_handle::wait(deadline d
   };
   LLFIO_POSIX_DEADLINE_TO_SLEEP_INIT(d);
   (void) timeout;
-  // We currently spin poll non-infinite non-zero waits :(
   for(;;)
   {
     OUTCOME_TRY(auto &&running, check_child());
     if(!running)
       return ret;
     LLFIO_POSIX_DEADLINE_TO_TIMEOUT_LOOP(d);
+#ifdef __linux__
+    if(_pidfd != -1)
+    {
+      // The pidfd becomes readable when the process exits
+      pollfd p;
+      memset(&p, 0, sizeof(p));
+      p.fd = _pidfd;
+      p.events = POLLIN;
+      if(-1 == ::poll(&p, 1, detail::deadline_to_poll_timeout(d, began_steady)) && EINTR != errno)
+      {
+        return posix_error();
+      }
+      continue;
+    }
+#endif
+    // Without a pidfd, we can only spin poll non-infinite non-zero waits :(
     std::this_thread::sleep_for(std::chrono::milliseconds(10));
   }
 }
 
+LLFIO_HEADERS_ONLY_MEMFUNC_SPEC native_handle_type process_handle::exit_native_handle() const noexcept
+{
+#ifdef __linux__
+  if(_pidfd != -1)
+  {
+    return native_handle_type(native_handle_type::disposition::readable, _pidfd);
+  }
+#endif
+  return {};
+}
+
+LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<size_t> process_handle::wait_for_any(span<const process_handle *> processes, span<const pipe_handle *> pipes,
+                                                                           span<bool> ready, deadline d) noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(nullptr);
+  if(ready.size() < processes.size() + pipes.size())
+  {
+    return errc::invalid_argument;
+  }
+  try
+  {
+    // Processes without a pidfd are checked every 10 milliseconds
+    bool spin = false;
+    std::vector<pollfd> fds(processes.size() + pipes.size());
+    for(size_t n = 0; n < processes.size(); n++)
+    {
+      fds[n].fd = -1;
+      if(processes[n] != nullptr && processes[n]->is_valid())
+      {
+        fds[n].fd = processes[n]->exit_native_handle().fd;
+        fds[n].events = POLLIN;
+        spin |= (fds[n].fd == -1);
+      }
+    }
+    for(size_t n = 0; n < pipes.size(); n++)
+    {
+      auto &p = fds[processes.size() + n];
+      p.fd = (pipes[n] != nullptr && pipes[n]->is_valid()) ? pipes[n]->native_handle().fd : -1;
+      p.events = POLLIN;
+    }
+    LLFIO_POSIX_DEADLINE_TO_SLEEP_INIT(d);
+    (void) timeout;
+    for(;;)
+    {
+      size_t count = 0;
+      for(size_t n = 0; n < processes.size(); n++)
+      {
+        ready[n] = (fds[n].fd == -1) ? (processes[n] != nullptr && processes[n]->is_valid() && !processes[n]->is_running()) : false;
+        count += ready[n];
+      }
+      int mstimeout = (count > 0) ? 0 : detail::deadline_to_poll_timeout(d, began_steady);
+      if(spin && (mstimeout < 0 || mstimeout > 10))
+      {
+        mstimeout = 10;
+      }
+      int ret = ::poll(fds.data(), (nfds_t) fds.size(), mstimeout);
+      if(-1 == ret && EINTR != errno)
+      {
+        return posix_error();
+      }
+      for(size_t n = 0; n < fds.size(); n++)
+      {
+        if(fds[n].fd != -1 && ret > 0)
+        {
+          ready[n] = (fds[n].revents & (POLLIN | POLLHUP | POLLERR)) != 0;
+          count += ready[n];
+        }
+        else if(n >= processes.size())
+        {
+          ready[n] = false;
+        }
+      }
+      if(count > 0)
+      {
+        return count;
+      }
+      LLFIO_POSIX_DEADLINE_TO_TIMEOUT_LOOP(d);
+    }
+  }
+  catch(...)
+  {
+    return error_from_exception();
+  }
+}
+
 LLFIO_HEADERS_ONLY_MEMFUNC_SPEC const process_handle &process_handle::current() noexcept
 {
   static process_handle self = []() -> process_handle {
@@ -197,12 +358,126 @@ LLFIO_HEADERS_ONLY_MEMFUNC_SPEC const process_handle &process_handle::current()
 }
 
 LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<process_handle> process_handle::launch_process(path_view path, span<path_view_component> args, span<path_view_component> env, flag flags) noexcept
+{
+  OUTCOME_TRY(auto &&t, make_spawn_template(path, args, env, flags));
+  return launch_process(t);
+}
+
+#ifdef __linux__
+namespace detail
+{
+  struct spawn_child_state
+  {
+    const char *path;
+    char *const *argv;
+    char *const *envp;
+    int fds[3];  // to become stdin, stdout, stderr, or -1
+    sigset_t oldmask;
+    volatile int err;
+  };
+  // Runs in the child sharing our address space, so must only call async signal safe functions
+  inline int spawn_child(void *_state) noexcept
+  {
+    auto *state = static_cast<spawn_child_state *>(_state);
+    // Handlers installed by the parent must not run in the child before it execs
+    for(int sig = 1; sig < NSIG; sig++)
+    {
+      struct sigaction sa;
+      if(0 == ::sigaction(sig, nullptr, &sa) && sa.sa_handler != SIG_IGN && sa.sa_handler != SIG_DFL)
+      {
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = SIG_DFL;
+        (void) ::sigaction(sig, &sa, nullptr);
+      }
+    }
+    ::sigprocmask(SIG_SETMASK, &state->oldmask, nullptr);
+    for(int n = 0; n < 3; n++)
+    {
+      // The originals are close on exec, the duplicates are not
+      if(state->fds[n] != -1 && -1 == ::dup2(state->fds[n], n))
+      {
+        state->err = errno;
+        ::_exit(127);
+      }
+    }
+    ::execve(state->path, state->argv, state->envp);
+    state->err = errno;
+    ::_exit(127);
+  }
+  // Returns false if clone() refuses to create the process, in which case posix_spawn() ought to be used
+  inline result<bool> spawn_with_clone(int &pid, int &pidfd, spawn_child_state &state) noexcept
+  {
+#ifndef CLONE_PIDFD
+    static constexpr int CLONE_PIDFD = 0x00001000;
+#endif
+    static std::atomic<bool> unsupported{false};
+    if(unsupported.load(std::memory_order_relaxed))
+    {
+      return false;
+    }
+    // The child runs on this until it execs, during which this thread is suspended
+    static constexpr size_t stack_size = 65536;
+    static thread_local std::unique_ptr<char[]> stack;
+    if(!stack)
+    {
+      stack.reset(new(std::nothrow) char[stack_size]);
+      if(!stack)
+      {
+        return errc::not_enough_memory;
+      }
+    }
+    state.err = 0;
+    sigset_t all;
+    ::sigfillset(&all);
+    ::pthread_sigmask(SIG_BLOCK, &all, &state.oldmask);
+    pidfd = -1;
+    pid = ::clone(spawn_child, stack.get() + stack_size, CLONE_VM | CLONE_VFORK | CLONE_PIDFD | SIGCHLD, &state, &pidfd);
+    const int cloneerrno = errno;
+    ::pthread_sigmask(SIG_SETMASK, &state.oldmask, nullptr);
+    if(-1 == pid)
+    {
+      if(EINVAL == cloneerrno)
+      {
+        unsupported.store(true, std::memory_order_relaxed);
+        return false;
+      }
+      return posix_error(cloneerrno);
+    }
+    if(state.err != 0)
+    {
+      // The child failed before exec, and has already exited
+      siginfo_t info;
+      (void) ::waitid(P_PID, pid, &info, WEXITED);
+      if(pidfd >= 0)
+      {
+        ::close(pidfd);
+      }
+      return posix_error(state.err);
+    }
+    if(pidfd < 0)
+    {
+      // Kernels before 5.2 ignore CLONE_PIDFD. The child cannot be reaped before we open its
+      // pidfd, so this cannot race with pid reuse. If the kernel is too old for pidfds, wait()
+      // falls back to polling.
+      pidfd = pidfd_open(pid);
+    }
+    return true;
+  }
+}  // namespace detail
+#endif
+
+LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<process_handle> process_handle::launch_process(const spawn_template &t) noexcept
 {
   try
   {
+    const flag flags = t._flags;
     result<process_handle> ret(in_place_type<process_handle>, native_handle_type(), flags);
     native_handle_type &nativeh = ret.value()._v;
     LLFIO_LOG_FUNCTION_CALL(&ret);
+    if(t._argv.empty())
+    {
+      return errc::invalid_argument;
+    }
     nativeh.behaviour |= native_handle_type::disposition::process;
     pipe_handle childinpipe, childoutpipe, childerrorpipe;
     pipe_handle::flag pipeflags = !(flags & flag::no_multiplexable_pipes) ? pipe_handle::flag::multiplexable : pipe_handle::flag::none;
@@ -243,62 +518,22 @@ LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<process_handle> process_handle::launch_pr
         return posix_error();
     }
 
-    using small_path_view_c_str = path_view::zero_terminated_rendered_path<filesystem::path::value_type, std::default_delete<filesystem::path::value_type[]>, 1>;
-    std::vector<const char *> argptrs(args.size() + 2);
-    std::vector<small_path_view_c_str> _args;
-    _args.reserve(args.size() + 1);
-    _args.emplace_back(path);
-    argptrs[0] = _args[0].c_str();
-    for(size_t n = 0; n < args.size(); ++n)
-    {
-      _args.emplace_back(args[n]);
-      argptrs[n + 1] = _args[n + 1].c_str();
-    }
-    std::vector<small_path_view_c_str> _envs;
-    std::vector<const char *> envptrs;
-    _envs.reserve(env.size());
-    envptrs.reserve(env.size() + 1);
-    for(const auto &i : env)
-    {
-      _envs.emplace_back(i);
-      envptrs.push_back(_envs.back().c_str());
-    }
-    envptrs.push_back(nullptr);
-#if 0
-    ret._processh.fd = ::fork();
-    if(0 == ret._processh.fd)
+    char *const *argv = const_cast<char *const *>(t._argv.data());
+    char *const *envp = const_cast<char *const *>(t._envp.data());
+#ifdef __linux__
+    detail::spawn_child_state state;
+    state.path = t._argv[0];
+    state.argv = argv;
+    state.envp = envp;
+    state.fds[STDIN_FILENO] = childinpipe.is_valid() ? childinpipe.native_handle().fd : -1;
+    state.fds[STDOUT_FILENO] = childoutpipe.is_valid() ? childoutpipe.native_handle().fd : -1;
+    state.fds[STDERR_FILENO] = childerrorpipe.is_valid() ? childerrorpipe.native_handle().fd : -1;
+    OUTCOME_TRY(auto &&cloned, detail::spawn_with_clone(nativeh.pid, ret.value()._pidfd, state));
+    if(cloned)
     {
-      // I am the child
-      if(-1 == ::dup2(childinpipe.native_handle().fd, STDIN_FILENO))
-      {
-        ::perror("dup2 readh");
-        ::exit(1);
-      }
-      ::close(childreadh.fd);
-      if(-1 == ::dup2(childwriteh.fd, STDOUT_FILENO))
-      {
-        ::perror("dup2 writeh");
-        ::exit(1);
-      }
-      ::close(childwriteh.fd);
-      if(!use_parent_errh)
-      {
-        if(-1 == ::dup2(childerrh.fd, STDERR_FILENO))
-        {
-          ::perror("dup2 errh");
-          ::exit(1);
-        }
-        ::close(childerrh.fd);
-      }
-      if(-1 == ::execve(ret._path.c_str(), (char **) argptrs.data(), (char **) envptrs.data()))
-      {
-        ::perror("execve");
-        ::exit(1);
-      }
+      return ret;
     }
-    if(-1 == ret._processh.fd)
-      return posix_error();
-#else
+#endif
     posix_spawn_file_actions_t child_fd_actions;
     if(childinpipe.is_valid() || childoutpipe.is_valid() || childerrorpipe.is_valid())
     {
@@ -333,13 +568,17 @@ LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<process_handle> process_handle::launch_pr
           return posix_error(err);
       }
     }
-    int err = ::posix_spawn(&nativeh.pid, argptrs[0], (childinpipe.is_valid() || childoutpipe.is_valid() || childerrorpipe.is_valid()) ? &child_fd_actions : nullptr, nullptr, (char **) argptrs.data(), (char **) envptrs.data());
-    if(err)
-      return posix_error(err);
+    int err = ::posix_spawn(&nativeh.pid, t._argv[0], (childinpipe.is_valid() || childoutpipe.is_valid() || childerrorpipe.is_valid()) ? &child_fd_actions : nullptr, nullptr, argv, envp);
     if(childinpipe.is_valid() || childoutpipe.is_valid() || childerrorpipe.is_valid())
     {
       ::posix_spawn_file_actions_destroy(&child_fd_actions);
     }
+    if(err)
+      return posix_error(err);
+#ifdef __linux__
+    // The child cannot be reaped before we open its pidfd, so this cannot race with pid reuse.
+    // If the kernel is too old for pidfds, wait() falls back to polling.
+    ret.value()._pidfd = detail::pidfd_open(nativeh.pid);
 #endif
     return ret;
   }
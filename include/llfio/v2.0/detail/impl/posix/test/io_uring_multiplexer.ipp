@@ -23,6 +23,7 @@ Distributed under the Boost Software License, Version 1.0.
 */
 
 #include "../io_handle.ipp"
+#include "../io_uring.hpp"
 
 #ifndef __linux__
 #error This implementation file is for Linux only
@@ -95,7 +96,7 @@ namespace test
   - Registered i/o buffers
 
   */
-  template <bool is_threadsafe> class linux_io_uring_multiplexer final : public io_multiplexer_impl<is_threadsafe>
+  template <bool is_threadsafe> class linux_io_uring_multiplexer final : public io_multiplexer_impl<is_threadsafe>, private detail::io_uring_abi
   {
     friend LLFIO_HEADERS_ONLY_FUNC_SPEC result<io_multiplexer_ptr> multiplexer_linux_io_uring(size_t threads, bool is_polling) noexcept;
 
@@ -119,291 +120,6 @@ namespace test
     using io_operation_state_visitor = typename _base::io_operation_state_visitor;
     using check_for_any_completed_io_statistics = typename _base::check_for_any_completed_io_statistics;
 
-    // The io_uring kernel submission structure
-    struct _io_uring_sqe
-    {
-      uint8_t opcode;  /* type of operation for this sqe */
-      uint8_t flags;   /* IOSQE_ flags */
-      uint16_t ioprio; /* ioprio for the request */
-      int32_t fd;      /* file descriptor to do IO on */
-      union {
-        uint64_t off; /* offset into file */
-        uint64_t addr2;
-      };
-      union {
-        uint64_t addr; /* pointer to buffer or iovecs */
-        uint64_t splice_off_in;
-      };
-      uint32_t len; /* buffer size or number of iovecs */
-      union {
-        __kernel_rwf_t rw_flags;
-        uint32_t fsync_flags;
-        uint16_t poll_events;
-        uint32_t sync_range_flags;
-        uint32_t msg_flags;
-        uint32_t timeout_flags;
-        uint32_t accept_flags;
-        uint32_t cancel_flags;
-        uint32_t open_flags;
-        uint32_t statx_flags;
-        uint32_t fadvise_advice;
-        uint32_t splice_flags;
-      };
-      uint64_t user_data; /* data to be passed back at completion time */
-      union {
-        struct
-        {
-          /* pack this to avoid bogus arm OABI complaints */
-          union {
-            /* index into fixed buffers, if used */
-            uint16_t buf_index;
-            /* for grouped buffer selection */
-            uint16_t buf_group;
-          } __attribute__((packed));
-          /* personality to use, if used */
-          uint16_t personality;
-          int32_t splice_fd_in;
-        };
-        uint64_t __pad2[3];
-      };
-    };
-
-    // sqe->flags
-    /* use fixed fileset */
-    static constexpr uint32_t _IOSQE_FIXED_FILE = (1U << 0);
-    /* issue after inflight IO */
-    static constexpr uint32_t _IOSQE_IO_DRAIN = (1U << 1);
-    /* links next sqe */
-    static constexpr uint32_t _IOSQE_IO_LINK = (1U << 2);
-    /* like LINK, but stronger */
-    static constexpr uint32_t _IOSQE_IO_HARDLINK = (1U << 3);
-    /* always go async */
-    static constexpr uint32_t _IOSQE_ASYNC = (1U << 4);
-    /* select buffer from sqe->buf_group */
-    static constexpr uint32_t _IOSQE_BUFFER_SELECT = (1U << 5);
-
-    // io_uring_setup() flags
-    static constexpr uint32_t _IORING_SETUP_IOPOLL = (1U << 0);    /* io_context is polled */
-    static constexpr uint32_t _IORING_SETUP_SQPOLL = (1U << 1);    /* SQ poll thread */
-    static constexpr uint32_t _IORING_SETUP_SQ_AFF = (1U << 2);    /* sq_thread_cpu is valid */
-    static constexpr uint32_t _IORING_SETUP_CQSIZE = (1U << 3);    /* app defines CQ size */
-    static constexpr uint32_t _IORING_SETUP_CLAMP = (1U << 4);     /* clamp SQ/CQ ring sizes */
-    static constexpr uint32_t _IORING_SETUP_ATTACH_WQ = (1U << 5); /* attach to existing wq */
-
-    // sqe->opcode
-    enum
-    {
-      _IORING_OP_NOP,
-      _IORING_OP_READV,
-      _IORING_OP_WRITEV,
-      _IORING_OP_FSYNC,
-      _IORING_OP_READ_FIXED,
-      _IORING_OP_WRITE_FIXED,
-      _IORING_OP_POLL_ADD,
-      _IORING_OP_POLL_REMOVE,
-      _IORING_OP_SYNC_FILE_RANGE,
-      _IORING_OP_SENDMSG,
-      _IORING_OP_RECVMSG,
-      _IORING_OP_TIMEOUT,
-      _IORING_OP_TIMEOUT_REMOVE,
-      _IORING_OP_ACCEPT,
-      _IORING_OP_ASYNC_CANCEL,
-      _IORING_OP_LINK_TIMEOUT,
-      _IORING_OP_CONNECT,
-      _IORING_OP_FALLOCATE,
-      _IORING_OP_OPENAT,
-      _IORING_OP_CLOSE,
-      _IORING_OP_FILES_UPDATE,
-      _IORING_OP_STATX,
-      _IORING_OP_READ,
-      _IORING_OP_WRITE,
-      _IORING_OP_FADVISE,
-      _IORING_OP_MADVISE,
-      _IORING_OP_SEND,
-      _IORING_OP_RECV,
-      _IORING_OP_OPENAT2,
-      _IORING_OP_EPOLL_CTL,
-      _IORING_OP_SPLICE,
-      _IORING_OP_PROVIDE_BUFFERS,
-      _IORING_OP_REMOVE_BUFFERS,
-
-      /* this goes last, obviously */
-      _IORING_OP_LAST,
-    };
-
-    // sqe->fsync_flags
-    static constexpr uint32_t _IORING_FSYNC_DATASYNC = (1U << 0);
-
-    // sqe->timeout_flags
-    static constexpr uint32_t _IORING_TIMEOUT_ABS = (1U << 0);
-
-    /*
-     * sqe->splice_flags
-     * extends splice(2) flags
-     */
-    static constexpr uint32_t _SPLICE_F_FD_IN_FIXED = (1U << 31); /* the last bit of uint32_t */
-
-
-    // The io_uring kernel completion structure
-    struct _io_uring_cqe
-    {
-      uint64_t user_data; /* sqe->data submission passed back */
-      int32_t res;        /* result code for this event */
-      uint32_t flags;
-    };
-
-    // cqe->flags
-    // IORING_CQE_F_BUFFER	If set, the upper 16 bits are the buffer ID
-    static constexpr uint32_t _IORING_CQE_F_BUFFER = (1U << 0);
-
-    static constexpr uint32_t _IORING_CQE_BUFFER_SHIFT = 16;
-
-    // Magic offsets for the application to mmap the data it needs
-    static constexpr size_t _IORING_OFF_SQ_RING = (size_t) 0;
-    static constexpr size_t _IORING_OFF_CQ_RING = (size_t) 0x8000000;
-    static constexpr size_t _IORING_OFF_SQES = (size_t) 0x10000000;
-
-    // Filled with the offset for mmap(2)
-    struct _io_sqring_offsets
-    {
-      uint32_t head;
-      uint32_t tail;
-      uint32_t ring_mask;
-      uint32_t ring_entries;
-      uint32_t flags;
-      uint32_t dropped;
-      uint32_t array;
-      uint32_t resv1;
-      uint64_t resv2;
-    };
-
-    // sq_ring->flags
-    static constexpr uint32_t _IORING_SQ_NEED_WAKEUP = (1U << 0); /* needs io_uring_enter wakeup */
-
-    struct _io_cqring_offsets
-    {
-      uint32_t head;
-      uint32_t tail;
-      uint32_t ring_mask;
-      uint32_t ring_entries;
-      uint32_t overflow;
-      uint32_t cqes;
-      uint64_t resv[2];
-    };
-
-    // io_uring_enter(2) flags
-    static constexpr uint32_t _IORING_ENTER_GETEVENTS = (1U << 0);
-    static constexpr uint32_t _IORING_ENTER_SQ_WAKEUP = (1U << 1);
-
-    // Passed in for io_uring_setup(2). Copied back with updated info on success
-    struct _io_uring_params
-    {
-      uint32_t sq_entries;
-      uint32_t cq_entries;
-      uint32_t flags;
-      uint32_t sq_thread_cpu;
-      uint32_t sq_thread_idle;
-      uint32_t features;
-      uint32_t wq_fd;
-      uint32_t resv[3];
-      struct _io_sqring_offsets sq_off;
-      struct _io_cqring_offsets cq_off;
-    };
-
-    // io_uring_params->features flags
-    static constexpr uint32_t _IORING_FEAT_SINGLE_MMAP = (1U << 0);
-    static constexpr uint32_t _IORING_FEAT_NODROP = (1U << 1);
-    static constexpr uint32_t _IORING_FEAT_SUBMIT_STABLE = (1U << 2);
-    static constexpr uint32_t _IORING_FEAT_RW_CUR_POS = (1U << 3);
-    static constexpr uint32_t _IORING_FEAT_CUR_PERSONALITY = (1U << 4);
-    static constexpr uint32_t _IORING_FEAT_FAST_POLL = (1U << 5);
-
-    // io_uring_register(2) opcodes and arguments
-    enum
-    {
-      _IORING_REGISTER_BUFFERS,
-      _IORING_UNREGISTER_BUFFERS,
-      _IORING_REGISTER_FILES,
-      _IORING_UNREGISTER_FILES,
-      _IORING_REGISTER_EVENTFD,
-      _IORING_UNREGISTER_EVENTFD,
-      _IORING_REGISTER_FILES_UPDATE,
-      _IORING_REGISTER_EVENTFD_ASYNC,
-      _IORING_REGISTER_PROBE,
-      _IORING_REGISTER_PERSONALITY,
-      _IORING_UNREGISTER_PERSONALITY
-    };
-
-    struct _io_uring_files_update
-    {
-      uint32_t offset;
-      uint32_t resv;
-      __aligned_u64 /* int32_t * */ fds;
-    };
-
-    static constexpr uint32_t _IO_URING_OP_SUPPORTED = (1U << 0);
-
-    struct _io_uring_probe_op
-    {
-      uint8_t op;
-      uint8_t resv;
-      uint16_t flags; /* IO_URING_OP_* flags */
-      uint32_t resv2;
-    };
-
-    struct _io_uring_probe
-    {
-      uint8_t last_op; /* last opcode supported */
-      uint8_t ops_len; /* length of ops[] array below */
-      uint16_t resv;
-      uint32_t resv2[3];
-      struct _io_uring_probe_op ops[0];
-    };
-
-    template <class T> static T _io_uring_smp_load_acquire(const T &_v) noexcept
-    {
-      auto *v = (const std::atomic<T> *) &_v;
-      return v->load(std::memory_order_acquire);
-    }
-    template <class T> static void _io_uring_smp_store_release(T &_v, T x) noexcept
-    {
-      auto *v = (std::atomic<T> *) &_v;
-      v->store(x, std::memory_order_release);
-    }
-    static int _io_uring_setup(unsigned entries, struct _io_uring_params *p)
-    {
-#ifdef __alpha__
-      return syscall(535 /*__NR_io_uring_setup*/, entries, p);
-#else
-      return syscall(425 /*__NR_io_uring_setup*/, entries, p);
-#endif
-    }
-    static int _io_uring_register(int fd, unsigned opcode, void *arg, unsigned nr_args)
-    {
-#ifdef __alpha__
-      return syscall(537 /*__NR_io_uring_register*/, fd, opcode, arg, nr_args);
-#else
-      return syscall(427 /*__NR_io_uring_register*/, fd, opcode, arg, nr_args);
-#endif
-    }
-    static int _io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags, sigset_t *sig)
-    {
-#ifdef __alpha__
-      return syscall(536 /*__NR_io_uring_enter*/, fd, to_submit, min_complete, flags, sig, _NSIG / 8);
-#else
-      return syscall(426 /*__NR_io_uring_enter*/, fd, to_submit, min_complete, flags, sig, _NSIG / 8);
-#endif
-    }
-    static int _io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
-    {
-#ifdef __alpha__
-      return syscall(536 /*__NR_io_uring_enter*/, fd, to_submit, min_complete, flags, nullptr, 0);
-#else
-      return syscall(426 /*__NR_io_uring_enter*/, fd, to_submit, min_complete, flags, nullptr, 0);
-#endif
-    }
-
-
     struct _io_uring_operation_state final : public std::conditional_t<is_threadsafe, typename _base::_synchronised_io_operation_state, typename _base::_unsynchronised_io_operation_state>
     {
       using _impl = std::conditional_t<is_threadsafe, typename _base::_synchronised_io_operation_state, typename _base::_unsynchronised_io_operation_state>;
@@ -0,0 +1,139 @@
+/* Binary per-thread event tracing
+(C) 2026 agent <agent@local> (2 commits)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#include "../../tracing.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <new>
+
+LLFIO_V2_NAMESPACE_EXPORT_BEGIN
+
+namespace detail
+{
+  struct trace_registry
+  {
+    std::mutex lock;
+    trace_thread_buffer *buffers{nullptr};
+    uint32_t next_thread_id{1};
+    uint64_t dropped_by_exited{0};
+  };
+  inline trace_registry &trace_registry_instance() noexcept
+  {
+    static trace_registry v;
+    return v;
+  }
+
+  // Marks the calling thread's ring as exited when the thread exits
+  struct trace_thread_owner
+  {
+    trace_thread_buffer *buffer{nullptr};
+    ~trace_thread_owner()
+    {
+      auto &tls = trace_this_thread();
+      tls.buffer = nullptr;
+      tls.finished = true;
+      if(buffer != nullptr)
+      {
+        buffer->exited.store(true, std::memory_order_release);
+      }
+    }
+  };
+
+  LLFIO_HEADERS_ONLY_FUNC_SPEC trace_thread_buffer *trace_register_this_thread() noexcept
+  {
+    auto *buffer = new(std::nothrow) trace_thread_buffer;
+    if(buffer == nullptr)
+    {
+      return nullptr;
+    }
+    static thread_local trace_thread_owner owner;
+    auto &registry = trace_registry_instance();
+    {
+      std::lock_guard<std::mutex> g(registry.lock);
+      buffer->thread_id = registry.next_thread_id++;
+      buffer->next = registry.buffers;
+      registry.buffers = buffer;
+    }
+    owner.buffer = buffer;
+    trace_this_thread().buffer = buffer;
+    return buffer;
+  }
+}  // namespace detail
+
+namespace tracing
+{
+  LLFIO_HEADERS_ONLY_FUNC_SPEC void enable(bool v) noexcept
+  {
+#ifndef LLFIO_DISABLE_TRACING
+    detail::trace_enabled_flag().store(v, std::memory_order_relaxed);
+#else
+    (void) v;
+#endif
+  }
+
+  LLFIO_HEADERS_ONLY_FUNC_SPEC size_t drain(trace_event *out, size_t max) noexcept
+  {
+    auto &registry = detail::trace_registry_instance();
+    std::lock_guard<std::mutex> g(registry.lock);
+    size_t ret = 0;
+    for(detail::trace_thread_buffer **pbuffer = &registry.buffers; *pbuffer != nullptr;)
+    {
+      auto *buffer = *pbuffer;
+      // Read exited before head, so if it is set we are guaranteed to see the final head
+      const bool exited = buffer->exited.load(std::memory_order_acquire);
+      const auto tail = buffer->tail.load(std::memory_order_relaxed);
+      const auto head = buffer->head.load(std::memory_order_acquire);
+      const auto toread = (size_t) std::min<uint64_t>(head - tail, max - ret);
+      for(size_t n = 0; n < toread; n++)
+      {
+        out[ret++] = buffer->events[(tail + n) & (detail::trace_thread_buffer::capacity - 1)];
+      }
+      buffer->tail.store(tail + toread, std::memory_order_release);
+      if(exited && tail + toread == head)
+      {
+        registry.dropped_by_exited += buffer->dropped.load(std::memory_order_relaxed);
+        *pbuffer = buffer->next;
+        delete buffer;
+        continue;
+      }
+      pbuffer = &buffer->next;
+    }
+    return ret;
+  }
+
+  LLFIO_HEADERS_ONLY_FUNC_SPEC uint64_t dropped() noexcept
+  {
+    auto &registry = detail::trace_registry_instance();
+    std::lock_guard<std::mutex> g(registry.lock);
+    uint64_t ret = registry.dropped_by_exited;
+    for(auto *buffer = registry.buffers; buffer != nullptr; buffer = buffer->next)
+    {
+      ret += buffer->dropped.load(std::memory_order_relaxed);
+    }
+    return ret;
+  }
+}  // namespace tracing
+
+LLFIO_V2_NAMESPACE_END
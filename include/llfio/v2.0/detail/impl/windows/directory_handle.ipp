@@ -356,17 +356,8 @@ result<directory_handle::buffers_type> directory_handle::read(io_request<buffers
     }
     if(req.kernelbuffer.empty())
     {
-      if(!req.buffers._kernel_buffer || req.buffers._kernel_buffer_size < kernelbuffertoallocate)
-      {
-        auto *mem = (char *) operator new[](kernelbuffertoallocate, std::nothrow);  // don't initialise
-        if(mem == nullptr)
-        {
-          return errc::not_enough_memory;
-        }
-        req.buffers._kernel_buffer.reset();
-        req.buffers._kernel_buffer = std::unique_ptr<char[]>(mem);
-        req.buffers._kernel_buffer_size = kernelbuffertoallocate;
-      }
+      OUTCOME_TRY(_acquire_kernel_buffer(req.buffers, kernelbuffertoallocate, false));
+      _kernel_buffer_used(kernelbuffertoallocate);
     }
     else if(req.kernelbuffer.size() < kernelbuffertoallocate)
     {
@@ -67,13 +67,16 @@ void lockable_io_handle::unlock_file_shared() noexcept
 result<lockable_io_handle::extent_guard> lockable_io_handle::lock_file_range(io_handle::extent_type offset, io_handle::extent_type bytes, lock_kind kind, deadline d) noexcept
 {
   LLFIO_LOG_FUNCTION_CALL(this);
+  detail::trace_scope trace(trace_event_kind::lock, (uint64_t) _v._init, offset);
   OUTCOME_TRY(do_lock_file_range(_v, offset, bytes, kind != lock_kind::shared, d));
+  trace.finish(bytes, false);
   return extent_guard(this, offset, bytes, kind);
 }
 
 void lockable_io_handle::unlock_file_range(io_handle::extent_type offset, io_handle::extent_type bytes) noexcept
 {
   LLFIO_LOG_FUNCTION_CALL(this);
+  tracing::record(trace_event_kind::unlock, trace_event_phase::instant, (uint64_t) _v._init, offset);
   do_unlock_file_range(_v, offset, bytes);
 }
 
@@ -544,6 +544,7 @@ result<void> map_handle::close() noexcept
   LLFIO_LOG_FUNCTION_CALL(this);
   if(_addr != nullptr)
   {
+    detail::trace_scope trace(trace_event_kind::unmap, (uint64_t) _addr, _reservation);
     if(_section != nullptr)
     {
       if(is_writable() && (_flag & section_handle::flag::barrier_on_close))
@@ -559,6 +560,7 @@ result<void> map_handle::close() noexcept
         OUTCOME_TRYV(win32_release_nonfile_allocations(_addr, _reservation, MEM_RELEASE));
       }
     }
+    trace.finish(0, false);
   }
   // We don't want ~handle() to close our borrowed handle
   _v = native_handle_type();
@@ -678,10 +680,11 @@ result<map_handle> map_handle::_new_map(size_type bytes, bool fallback, section_
   return ret;
 }
 
-result<map_handle> map_handle::map(section_handle &section, size_type bytes, extent_type offset, section_handle::flag _flag) noexcept
+result<map_handle> map_handle::map(section_handle &section, size_type bytes, extent_type offset, section_handle::flag _flag, void *address) noexcept
 {
   windows_nt_kernel::init();
   using namespace windows_nt_kernel;
+  detail::trace_scope trace(trace_event_kind::map, (uint64_t) section.native_handle()._init, bytes);
   OUTCOME_TRY(auto &&length, section.length());  // length of the backing file
   if(length <= offset)
   {
@@ -702,7 +705,7 @@ result<map_handle> map_handle::map(section_handle &section, size_type bytes, ext
   result<map_handle> ret{map_handle(&section, _flag)};
   native_handle_type &nativeh = ret.value()._v;
   ULONG allocation = 0, prot;
-  PVOID addr = nullptr;
+  PVOID addr = address;
   size_t commitsize = bytes + (offset & 65535);
   LARGE_INTEGER _offset{};
   _offset.QuadPart = offset & ~65535;
@@ -713,6 +716,10 @@ result<map_handle> map_handle::map(section_handle &section, size_type bytes, ext
   NTSTATUS ntstat = NtMapViewOfSection(section.native_handle().h, GetCurrentProcess(), &addr, 0, commitsize, &_offset, &_bytes, ViewUnmap, allocation, prot);
   if(ntstat < 0)
   {
+    if(address != nullptr && ntstat == (NTSTATUS) 0xC0000018 /*STATUS_CONFLICTING_ADDRESSES*/)
+    {
+      return errc::address_in_use;
+    }
     return ntkernel_error(ntstat);
   }
   ret.value()._addr = static_cast<byte *>(addr);
@@ -736,6 +743,7 @@ result<map_handle> map_handle::map(section_handle &section, size_type bytes, ext
       a[n];
     }
   }
+  trace.finish((uint64_t) addr, false);
   return ret;
 }
 
@@ -942,6 +950,61 @@ result<span<map_handle::buffer_type>> map_handle::prefetch(span<buffer_type> reg
   return regions;
 }
 
+result<map_handle::buffer_type> map_handle::prefault(buffer_type region) noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+  region = utils::round_to_page_size_larger(region, _pagesize);
+  if(region.data() == nullptr)
+  {
+    return errc::invalid_argument;
+  }
+  const bool writable = !!(_flag & section_handle::flag::write);
+  // Touch every page, an interlocked or of zero faults the page for write without racing other writers
+  for(byte *p = region.data(); p < region.data() + region.size(); p += _pagesize)
+  {
+    if(writable)
+    {
+      InterlockedOr8(reinterpret_cast<volatile char *>(p), 0);
+    }
+    else
+    {
+      (void) *reinterpret_cast<volatile unsigned char *>(p);
+    }
+  }
+  return region;
+}
+
+result<map_handle::buffer_type> map_handle::bind_to_numa_node(buffer_type /*unused*/, unsigned /*unused*/) noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+  // Windows can only choose the NUMA node of a view when it is created
+  return errc::operation_not_supported;
+}
+
+result<span<map_handle::buffer_type>> map_handle::written_regions(span<buffer_type> /*unused*/, buffer_type /*unused*/) const noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+  // Write watching is only available for VirtualAlloc() memory, not for views of sections
+  return errc::operation_not_supported;
+}
+
+result<map_handle::buffer_type> map_handle::collapse_to_huge_pages(buffer_type /*unused*/) noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+  // Windows has no transparent huge pages, large pages must be requested when mapping
+  return errc::operation_not_supported;
+}
+
+result<map_handle::size_type> map_handle::huge_page_bytes() const noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+  if(_pagesize > utils::page_size())
+  {
+    return _reservation;
+  }
+  return errc::operation_not_supported;
+}
+
 result<map_handle::buffer_type> map_handle::do_not_store(buffer_type region) noexcept
 {
   windows_nt_kernel::init();
@@ -254,4 +254,49 @@ pipe_handle::io_result<pipe_handle::const_buffers_type> pipe_handle::_do_write(p
   return io_handle::_do_write(reqs, d);
 }
 
+result<size_t> pipe_handle::buffer_size() const noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+  DWORD outbuffersize = 0, inbuffersize = 0;
+  if(!GetNamedPipeInfo(_v.h, nullptr, &outbuffersize, &inbuffersize, nullptr))
+  {
+    return win32_error();
+  }
+  return (size_t) (is_writable() ? outbuffersize : inbuffersize);
+}
+
+result<size_t> pipe_handle::set_buffer_size(size_t /*unused*/) noexcept
+{
+  // Named pipe buffers are sized at creation
+  return errc::operation_not_supported;
+}
+
+result<size_t> pipe_handle::splice_from(io_handle &src, extent_type offset, size_t bytes, deadline d) noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+  return detail::pipe_bounce_transfer(src, offset, *this, 0, bytes, d);
+}
+
+result<size_t> pipe_handle::splice_to(io_handle &dest, extent_type offset, size_t bytes, deadline d) noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+  return detail::pipe_bounce_transfer(*this, 0, dest, offset, bytes, d);
+}
+
+result<size_t> pipe_handle::tee_to(pipe_handle & /*unused*/, size_t /*unused*/, deadline /*unused*/) noexcept
+{
+  return errc::operation_not_supported;
+}
+
+result<size_t> pipe_handle::gift(const_buffers_type buffers, deadline d) noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(this);
+  auto written = write({buffers, 0}, d);
+  if(!written)
+  {
+    return std::move(written).error();
+  }
+  return written.bytes_transferred();
+}
+
 LLFIO_V2_NAMESPACE_END
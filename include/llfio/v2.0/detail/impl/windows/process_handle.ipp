@@ -149,6 +149,86 @@ LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<intptr_t> process_handle::wait(deadline d
   }
 }
 
+LLFIO_HEADERS_ONLY_MEMFUNC_SPEC native_handle_type process_handle::exit_native_handle() const noexcept
+{
+  // A process handle is signalled when the process exits
+  return _v;
+}
+
+LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<size_t> process_handle::wait_for_any(span<const process_handle *> processes, span<const pipe_handle *> pipes,
+                                                                           span<bool> ready, deadline d) noexcept
+{
+  LLFIO_LOG_FUNCTION_CALL(nullptr);
+  if(ready.size() < processes.size() + pipes.size())
+  {
+    return errc::invalid_argument;
+  }
+  for(auto *p : pipes)
+  {
+    if(p != nullptr)
+    {
+      return errc::operation_not_supported;
+    }
+  }
+  for(size_t n = 0; n < pipes.size(); n++)
+  {
+    ready[processes.size() + n] = false;
+  }
+  HANDLE hs[MAXIMUM_WAIT_OBJECTS];
+  DWORD count = 0;
+  for(auto *p : processes)
+  {
+    if(p != nullptr && p->is_valid())
+    {
+      if(count == MAXIMUM_WAIT_OBJECTS)
+      {
+        return errc::argument_list_too_long;
+      }
+      hs[count++] = p->native_handle().h;
+    }
+  }
+  const auto began_steady = std::chrono::steady_clock::now();
+  for(;;)
+  {
+    size_t ret = 0;
+    for(size_t n = 0; n < processes.size(); n++)
+    {
+      ready[n] = processes[n] != nullptr && processes[n]->is_valid() && !processes[n]->is_running();
+      ret += ready[n];
+    }
+    if(ret > 0)
+    {
+      return ret;
+    }
+    DWORD mstimeout = INFINITE;
+    if(d)
+    {
+      std::chrono::milliseconds remaining;
+      if(d.steady)
+      {
+        remaining = std::chrono::duration_cast<std::chrono::milliseconds>((began_steady + std::chrono::nanoseconds(d.nsecs)) - std::chrono::steady_clock::now());
+      }
+      else
+      {
+        remaining = std::chrono::duration_cast<std::chrono::milliseconds>(d.to_time_point() - std::chrono::system_clock::now());
+      }
+      if(remaining.count() <= 0 || count == 0)
+      {
+        return errc::timed_out;
+      }
+      mstimeout = (DWORD) std::min<std::chrono::milliseconds::rep>(remaining.count() + 1, (std::chrono::milliseconds::rep) INFINITE - 1);
+    }
+    else if(count == 0)
+    {
+      return errc::invalid_argument;
+    }
+    if(WAIT_FAILED == WaitForMultipleObjects(count, hs, false, mstimeout))
+    {
+      return win32_error();
+    }
+  }
+}
+
 LLFIO_HEADERS_ONLY_MEMFUNC_SPEC const process_handle &process_handle::current() noexcept
 {
   static process_handle self = []() -> process_handle {
@@ -277,4 +357,12 @@ LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<process_handle> process_handle::launch_pr
   return ret;
 }
 
+LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<process_handle> process_handle::launch_process(const spawn_template &t) noexcept
+{
+  // CreateProcessW() needs a command line and environment block built afresh, so there is nothing to gain over the path overload
+  auto &args = const_cast<std::vector<path_view_component> &>(t._args);
+  auto &env = const_cast<std::vector<path_view_component> &>(t._env);
+  return launch_process(t._path, {args.data(), args.size()}, {env.data(), env.size()}, t._flags);
+}
+
 LLFIO_V2_NAMESPACE_END
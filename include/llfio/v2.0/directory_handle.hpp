@@ -58,13 +58,26 @@ static_assert(std::is_trivially_move_assignable<directory_entry>::value, "direct
 static_assert(std::is_standard_layout<directory_entry>::value, "directory_entry is not a standard layout type!");
 #endif
 
+namespace detail
+{
+  // Returns page aligned kernel buffers used by directory_handle::read() to the calling thread's pool
+  struct directory_kernel_buffer_deleter
+  {
+    size_t size{0};
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void operator()(char *p) const noexcept;
+  };
+}  // namespace detail
+
 /*! \class directory_handle
 \brief A handle to a directory which can be enumerated.
 
 \note For good performance, make sure you reuse `buffers_type` across calls to `read()`, including
 across different instances of `directory_handle`. This is because a kernel buffer is allocated
 within the first use of a `buffers_type` in a `read()`, so reusing `buffers_type` will save on
-an allocation-free cycle per directory enumeration.
+an allocation-free cycle per directory enumeration. Kernel buffers released by a `buffers_type`
+are kept in a small per-thread pool for the next `read()` on that thread, and each thread learns
+how large a kernel buffer its directories need, so fresh `buffers_type` are cheap too. See
+`kernel_buffer_pool_stats()`.
 */
 class LLFIO_DECL directory_handle : public path_handle, public fs_handle
 {
@@ -139,7 +152,7 @@ public:
       {
         return *this;
       }
-      std::unique_ptr<char[]> kernel_buffer = std::move(_kernel_buffer);
+      _kernel_buffer_ptr kernel_buffer = std::move(_kernel_buffer);
       size_t kernel_buffer_size = _kernel_buffer_size;
       this->~buffers_type();
       new(this) buffers_type(std::move(o));
@@ -156,7 +169,8 @@ public:
 
   private:
     friend class directory_handle;
-    std::unique_ptr<char[]> _kernel_buffer;
+    using _kernel_buffer_ptr = std::unique_ptr<char[], detail::directory_kernel_buffer_deleter>;
+    _kernel_buffer_ptr _kernel_buffer;
     size_t _kernel_buffer_size{0};
     void _resize(size_t l) { *static_cast<span<buffer_type> *>(this) = this->subspan(0, l); }
     stat_t::want _metadata{stat_t::want::none};
@@ -175,6 +189,7 @@ public:
     path_view_type glob{};
     filter filtering{filter::fastdeleted};
     span<char> kernelbuffer{};
+    stat_t::want metadata{stat_t::want::none};
 
     /*! Construct a request to enumerate a directory with optionally specified kernel buffer.
 
@@ -184,16 +199,45 @@ public:
     \param _kernelbuffer A buffer to use for the kernel to fill. If left defaulted, a kernel buffer
     is allocated internally and returned in the buffers returned which needs to not be destructed until one
     is no longer using any items within (leafnames are views onto the original kernel data).
+    \param _metadata Additional metadata to fill for each entry beyond what enumeration returns for free.
+    On POSIX this costs a stat per entry on the calling thread, which on Linux is batched through
+    `IORING_OP_STATX` where available for larger directories. On Windows, enumeration already
+    returns most metadata, and anything else requested is not filled. Check `buffers_type::metadata()`
+    for what was actually filled. Entries which vanish between enumeration and stat have their
+    additional metadata zeroed.
     */
-    /*constexpr*/ io_request(buffers_type _buffers, path_view_type _glob = {}, filter _filtering = filter::fastdeleted, span<char> _kernelbuffer = {})
+    /*constexpr*/ io_request(buffers_type _buffers, path_view_type _glob = {}, filter _filtering = filter::fastdeleted, span<char> _kernelbuffer = {},
+                             stat_t::want _metadata = stat_t::want::none)
         : buffers(std::move(_buffers))
         , glob(_glob)
         , filtering(_filtering)
         , kernelbuffer(_kernelbuffer)
+        , metadata(_metadata)
     {
     }
   };
 
+  //! Statistics about the per-thread pools of kernel buffers used by `read()`, summed across all threads.
+  struct kernel_buffer_pool_statistics
+  {
+    uint64_t allocations{0};    //!< Kernel buffers allocated from the system.
+    uint64_t reallocations{0};  //!< Times a kernel buffer proved too small for a directory, and was replaced with one twice the size.
+    uint64_t reuses{0};         //!< Kernel buffers supplied from a pool instead of being allocated.
+    uint64_t pooled_bytes{0};   //!< Bytes currently held unused in pools.
+  };
+  //! Returns statistics about the per-thread pools of kernel buffers used by `read()`.
+  static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC kernel_buffer_pool_statistics kernel_buffer_pool_stats() noexcept;
+  //! Frees the calling thread's pooled kernel buffers, and forgets the kernel buffer size it has learned.
+  static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void trim_kernel_buffer_pool() noexcept;
+
+private:
+  /* Ensures `buffers` has a page aligned kernel buffer of at least `minimum` bytes and of at least
+  the size this thread has learned directories need. If `grow`, the current kernel buffer was too
+  small and is replaced by one at least twice its size.
+  */
+  static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<void> _acquire_kernel_buffer(buffers_type &buffers, size_t minimum, bool grow) noexcept;
+  // Feedback of how many bytes of kernel buffer a complete enumeration used
+  static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void _kernel_buffer_used(size_t bytes) noexcept;
 
 public:
   //! Default constructor
@@ -425,6 +469,7 @@ LLFIO_V2_NAMESPACE_END
 
 #if LLFIO_HEADERS_ONLY == 1 && !defined(DOXYGEN_SHOULD_SKIP_THIS)
 #define LLFIO_INCLUDED_BY_HEADER 1
+#include "detail/impl/directory_handle.ipp"
 #ifdef _WIN32
 #include "detail/impl/windows/directory_handle.ipp"
 #else
@@ -107,6 +107,27 @@ progress slowly, whereas the work items in the second set progress quickly.
 
 `work_item::next()` may optionally set a deadline to delay when that work
 item ought to be processed again. Deadlines can be relative or absolute.
+Delayed work items are scheduled earliest deadline first, and when their
+deadline arrives they are executed ahead of work items which were not delayed.
+
+## Priority classes
+
+Each work group has a `priority_class`, set when it is created. Work from
+a `priority_class::latency_critical` group is always scheduled before work
+from a `priority_class::normal` group, which in turn is always scheduled before
+work from a `priority_class::background` group. Within a priority class,
+nested work groups are scheduled preferentially as described above. Nested
+work groups inherit the priority class of the work item which creates them,
+unless told otherwise.
+
+So that a steady stream of higher priority work cannot starve lower priority
+work forever, each kernel thread in the Linux native implementation looks at
+lower priority classes first every `LLFIO_DYNAMIC_THREAD_POOL_GROUP_STARVATION_INTERVAL`
+(default 16) work items it executes, and at the lowest priority class first every
+`LLFIO_DYNAMIC_THREAD_POOL_GROUP_STARVATION_INTERVAL` squared work items. The
+Grand Central Dispatch and Win32 thread pool implementations map priority classes
+onto the low, normal and high priorities of the system thread pool, which have
+their own starvation protection.
 
 ## C++ 23 Executors
 
@@ -166,6 +187,30 @@ not just the kernel threads created by this thread pool implementation.
 Therefore, if you have alternative thread pool implementations (e.g. OpenMP,
 `std::async`), those are also included in the dynamic adjustment.
 
+By default, which kernel threads are blocked is determined by periodically
+scanning `/proc/self/task/*/stat`, which gets expensive and laggy with many
+threads. An alternative controller can be selected at runtime using
+`concurrency_controller()`, which reads instead the `schedstat` of the pool's
+own kernel threads from file descriptors kept open, and the pressure stall
+information (PSI) for CPU and i/o of the process' cgroup. A pool thread which is
+executing a work item but whose CPU time did not advance is blocked, and more
+kernel threads are added so long as the cgroup is not stalled on i/o. If the pool's
+kernel threads spend more than a quarter of their time waiting to be scheduled
+(`schedstat` run delay), or the cgroup is stalled on CPU more than a fifth of the
+time, kernel threads are removed. This controller re-evaluates every ten
+milliseconds. Note that unlike the default, it considers only the pool's own
+kernel threads directly, other threads in the process affect it only via CPU
+pressure.
+
+On machines with more than one NUMA node, each kernel thread is bound to the
+CPUs of one NUMA node, and new kernel threads are spread across the nodes
+in proportion to their CPUs. Work items with a NUMA node hint (see
+`work_item::set_numa_node()`) are queued per node, and are preferentially
+executed by that node's kernel threads, with threads of other nodes only
+stealing such work when they have nothing else to do. Submitting hinted
+work wakes or creates a kernel thread on the hinted node, up to the number
+of CPUs in that node.
+
 As this is wholly implemented by this library, dynamic memory allocation
 occurs in the initial `make_dynamic_thread_pool_group()` and per thread
 creation, but otherwise the implementation does not perform dynamic memory
@@ -184,12 +229,14 @@ class LLFIO_DECL dynamic_thread_pool_group
 {
   friend class dynamic_thread_pool_group_impl;
 public:
+  class io_aware_work_item;
   //! An individual item of work within the work group.
   class work_item
   {
     friend struct detail::global_dynamic_thread_pool_impl;
     friend struct detail::global_dynamic_thread_pool_impl_workqueue_item;
     friend class dynamic_thread_pool_group_impl;
+    friend class io_aware_work_item;
     std::atomic<dynamic_thread_pool_group_impl *> _parent{nullptr};
     void *_internalworkh{nullptr};
     void *_internaltimerh{nullptr};  // lazily created if next() ever returns a deadline
@@ -198,6 +245,8 @@ public:
     std::chrono::steady_clock::time_point _timepoint1;
     std::chrono::system_clock::time_point _timepoint2;
     int _internalworkh_inuse{0};
+    int _numa_node{-1};
+    bool _is_io_aware{false};
 
   protected:
     constexpr bool _has_timer_set_relative() const noexcept { return _timepoint1 != std::chrono::steady_clock::time_point(); }
@@ -217,6 +266,8 @@ public:
         , _timepoint1(o._timepoint1)
         , _timepoint2(o._timepoint2)
         , _internalworkh_inuse(o._internalworkh_inuse)
+        , _numa_node(o._numa_node)
+        , _is_io_aware(o._is_io_aware)
     {
       assert(o._parent.load(std::memory_order_relaxed) == nullptr);
       assert(o._internalworkh == nullptr);
@@ -255,6 +306,22 @@ public:
     //! Returns the parent work group between successful submission and just before `group_complete()`.
     dynamic_thread_pool_group *parent() const noexcept { return reinterpret_cast<dynamic_thread_pool_group *>(_parent.load(std::memory_order_relaxed)); }
 
+    //! Returns the NUMA node upon which this work item prefers to execute, or -1 if it has no preference (the default).
+    int numa_node() const noexcept { return _numa_node; }
+    /*! \brief Sets the NUMA node upon which this work item prefers to execute, or -1 for no preference.
+
+    Node numbers are those of the kernel i.e. as returned by `current_numa_node()`. The
+    hint should be set before submission, and not changed until `group_complete()`.
+    If you know that the memory this work item will touch lives on a particular NUMA node
+    (e.g. because it was first touched by a thread running on that node), setting this
+    will cause the work item to be preferentially executed by kernel threads bound to
+    that node, avoiding cross-socket memory traffic.
+
+    The hint is only acted upon by the Linux native implementation. The Grand Central
+    Dispatch and Win32 thread pool implementations ignore it.
+    */
+    void set_numa_node(int node) noexcept { _numa_node = node; }
+
     /*! Invoked by the i/o thread pool to determine if this work item
     has more work to do.
 
@@ -348,10 +415,35 @@ public:
   work item invoked with the next piece of work.
 
   \note Non-seekable handle support is not implemented yet.
+
+  The above describes the default `pacing_policy::busy_time`. As `statfs_t::f_iosbusytime`
+  saturates at 100% long before a NVMe device is saturated, there is also
+  `pacing_policy::latency`, which ignores the storage device statistics and instead
+  measures how long each execution of each work item takes. A baseline latency is
+  the minimum of the moving average, and is reset every ten seconds. Every ten
+  milliseconds, if the moving average latency exceeds `max_latency_ratio` times the
+  baseline, the pacing deadline is increased by a quarter (starting at 100 microseconds),
+  whereas if it is below `min_latency_ratio` times the baseline, the pacing deadline
+  is decreased by a sixteenth, until it is removed entirely. This is the same idea as
+  TCP Vegas: back off when queues are building up, long before the device reports itself
+  as fully busy. Note that the latency measured is of the whole work item, so work items
+  should mainly do i/o for this to work well.
   */
   class LLFIO_DECL io_aware_work_item : public work_item
   {
+    friend struct detail::global_dynamic_thread_pool_impl;
+
   public:
+    //! The policy by which the execution of work is paced
+    enum class pacing_policy : uint8_t
+    {
+      busy_time,  //!< Pace according to the storage devices' `f_iosbusytime` and `f_iosinprogress` (the default).
+      latency     //!< Pace according to the measured latency of work item execution versus a baseline.
+    };
+    //! For `pacing_policy::latency`, average latency above this multiple of the baseline is congestion.
+    float max_latency_ratio{2.0f};
+    //! For `pacing_policy::latency`, average latency below this multiple of the baseline is no congestion.
+    float min_latency_ratio{1.25f};
     //! Maximum i/o busyness above which throttling is to begin.
     float max_iosbusytime{0.95f};
     //! Minimum i/o in progress to target if `iosbusytime` exceeded. The default of 16 suits SSDs, you want around 4 for spinning rust or NV-RAM.
@@ -379,8 +471,10 @@ public:
 
   private:
     const span<io_handle_awareness> _handles;
+    const pacing_policy _pacing{pacing_policy::busy_time};
 
     LLFIO_HEADERS_ONLY_VIRTUAL_SPEC intptr_t next(deadline &d) noexcept override final;
+    LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void _record_latency(std::chrono::steady_clock::duration latency) noexcept;
 
   public:
     constexpr io_aware_work_item() {}
@@ -394,17 +488,25 @@ public:
     Note that normalisation is across *all* i/o handles in the set, so three handles
     each with `reads/writes/barriers = 200/100/0` on entry would have `0.22/0.11/0.0`
     each after construction.
+
+    If `policy` is `pacing_policy::latency`, the storage device statistics are not
+    used, and so the constructor does not throw if they are unavailable.
     */
-    explicit LLFIO_HEADERS_ONLY_MEMFUNC_SPEC io_aware_work_item(span<io_handle_awareness> hs);
+    explicit LLFIO_HEADERS_ONLY_MEMFUNC_SPEC io_aware_work_item(span<io_handle_awareness> hs, pacing_policy policy = pacing_policy::busy_time);
     io_aware_work_item(io_aware_work_item &&o) noexcept
         : work_item(std::move(o))
+        , max_latency_ratio(o.max_latency_ratio)
+        , min_latency_ratio(o.min_latency_ratio)
         , _handles(o._handles)
+        , _pacing(o._pacing)
     {
     }
     LLFIO_HEADERS_ONLY_MEMFUNC_SPEC ~io_aware_work_item();
 
     //! The handles originally registered during construction.
     span<io_handle_awareness> handles() const noexcept { return _handles; }
+    //! The pacing policy chosen during construction.
+    pacing_policy pacing() const noexcept { return _pacing; }
 
     /*! \brief As for `work_item::next()`, but deadline may be extended to
     reduce i/o congestion on the hardware devices to which the handles
@@ -413,8 +515,20 @@ public:
     virtual intptr_t io_aware_next(deadline &d) noexcept = 0;
   };
 
+  //! The priority class of a work group
+  enum class priority_class : uint8_t
+  {
+    unspecified = 0,      //!< Inherit the priority class of the calling work item, else `normal`.
+    background = 1,       //!< Bulk work which should only use otherwise spare capacity, e.g. compaction.
+    normal = 2,           //!< The default.
+    latency_critical = 3  //!< Work which should preempt all other work, e.g. servicing a foreground request.
+  };
+
   virtual ~dynamic_thread_pool_group() {}
 
+  //! The priority class of this work group, which never changes after construction.
+  virtual priority_class priority() const noexcept = 0;
+
   /*! \brief A textual description of the underlying implementation of
   this dynamic thread pool group.
 
@@ -505,12 +619,55 @@ public:
   on Windows, Grand Central Dispatch etc.
   */
   static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC uint32_t ms_sleep_for_more_work(uint32_t v) noexcept;
+
+  //! The algorithm used to decide how many kernel threads the pool runs
+  enum class concurrency_controller_type : uint8_t
+  {
+    system = 0,             //!< The system thread pool decides (Grand Central Dispatch, Win32 thread pool).
+    proc_task_stat = 1,     //!< Linux native: scan `/proc/self/task/*/stat` for blocked threads in the whole process (the default).
+    schedstat_pressure = 2  //!< Linux native: per pool thread `schedstat` run time and run delay, plus cgroup CPU and i/o pressure.
+  };
+  //! Returns the algorithm used to decide how many kernel threads the pool runs.
+  static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC concurrency_controller_type concurrency_controller() noexcept;
+  /*! \brief Sets the algorithm used to decide how many kernel threads the pool runs,
+  returning the value actually set.
+
+  Note that this will have no effect (and thus return `system`) on all but on Linux if
+  using our local thread pool implementation. If `schedstat_pressure` is requested but
+  the kernel does not provide `/proc/thread-self/schedstat`, the controller is not changed.
+  */
+  static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC concurrency_controller_type concurrency_controller(concurrency_controller_type v) noexcept;
+
+  /*! \brief Returns the number of NUMA nodes with CPUs in this system.
+  Note that this will be one on all but Linux, and that at most
+  `LLFIO_DYNAMIC_THREAD_POOL_GROUP_MAX_NUMA_NODES` (default 8) nodes are
+  distinguished, with any more being folded onto those.
+  */
+  static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC size_t numa_nodes() noexcept;
+  //! Returns the NUMA node of the CPU the calling thread is currently running upon, or -1 if unknown.
+  static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC int current_numa_node() noexcept;
+
+  //! Statistics about the process wide thread pool
+  struct pool_statistics
+  {
+    size_t threads{0};             //!< The threads currently in the pool, whether busy or sleeping.
+    size_t work_items_pending{0};  //!< The work items submitted, but not yet begun.
+  };
+  /*! \brief Returns statistics about the process wide thread pool. Note that these will be
+  zero on all but POSIX if using our local thread pool implementation, because the system
+  owns the thread pool on Windows, Grand Central Dispatch etc.
+  */
+  static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC pool_statistics statistics() noexcept;
 };
 //! A unique ptr to a work group within the global dynamic thread pool.
 using dynamic_thread_pool_group_ptr = std::unique_ptr<dynamic_thread_pool_group>;
 
-//! Creates a new work group within the global dynamic thread pool.
-LLFIO_HEADERS_ONLY_FUNC_SPEC result<dynamic_thread_pool_group_ptr> make_dynamic_thread_pool_group() noexcept;
+/*! \brief Creates a new work group within the global dynamic thread pool.
+\param priority The priority class of the work group. If unspecified, the priority
+class of the work item calling this function is inherited, else `normal` is used.
+*/
+LLFIO_HEADERS_ONLY_FUNC_SPEC result<dynamic_thread_pool_group_ptr>
+make_dynamic_thread_pool_group(dynamic_thread_pool_group::priority_class priority = dynamic_thread_pool_group::priority_class::unspecified) noexcept;
 
 // BEGIN make_free_functions.py
 // END make_free_functions.py
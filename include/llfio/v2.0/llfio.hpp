@@ -78,6 +78,10 @@ import LLFIO_MODULE_NAME;
 #include "algorithm/clone.hpp"
 #include "algorithm/contents.hpp"
 #include "algorithm/handle_adapter/cached_parent.hpp"
+#ifndef LLFIO_EXCLUDE_DYNAMIC_THREAD_POOL_GROUP
+#include "algorithm/parallel_for.hpp"
+#include "algorithm/process_sampler.hpp"
+#endif
 #include "algorithm/reduce.hpp"
 #include "algorithm/shared_fs_mutex/atomic_append.hpp"
 #include "algorithm/shared_fs_mutex/byte_ranges.hpp"
@@ -86,8 +90,14 @@ import LLFIO_MODULE_NAME;
 #include "algorithm/summarize.hpp"
 
 #ifndef LLFIO_EXCLUDE_MAPPED_FILE_HANDLE
+#include "algorithm/handle_adapter/block_cache.hpp"
+#include "algorithm/handle_adapter/checksum.hpp"
+#include "algorithm/handle_adapter/striped.hpp"
 #include "algorithm/handle_adapter/xor.hpp"
+#include "algorithm/lazy_map.hpp"
 #include "algorithm/shared_fs_mutex/memory_map.hpp"
+#include "algorithm/shared_map_registry.hpp"
+#include "algorithm/trace_recorder.hpp"
 #include "algorithm/trivial_vector.hpp"
 #include "mapped.hpp"
 #endif
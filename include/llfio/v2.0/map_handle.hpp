@@ -73,6 +73,10 @@ public:
   write_via_syscall =
   1U
   << 18U,  //!< For file backed maps, `map_handle::write()` is implemented as a `write()` syscall to the file descriptor. This causes the map to be mapped read-only.
+  transparent_huge_pages =
+  1U << 19U,  //!< Ask for transparent huge pages where the kernel offers them (Linux). New anonymous maps are aligned so huge pages can apply. Ignored elsewhere.
+  track_written_pages =
+  1U << 20U,  //!< Track which pages of writable maps are written, so `map_handle::barrier()` flushes only those (Linux 6.7+). Ignored elsewhere.
 
   page_sizes_1 = 1U << 24U,  //!< Use `utils::page_sizes()[1]` sized pages, or fail.
   page_sizes_2 = 2U << 24U,  //!< Use `utils::page_sizes()[2]` sized pages, or fail.
@@ -244,6 +248,14 @@ inline std::ostream &operator<<(std::ostream &s, const section_handle::flag &v)
   {
     temp.append("write_via_syscall|");
   }
+  if(!!(v & section_handle::flag::transparent_huge_pages))
+  {
+    temp.append("transparent_huge_pages|");
+  }
+  if(!!(v & section_handle::flag::track_written_pages))
+  {
+    temp.append("track_written_pages|");
+  }
   if((v & section_handle::flag::page_sizes_3) == section_handle::flag::page_sizes_3)
   {
     temp.append("page_sizes_3|");
@@ -632,7 +644,12 @@ public:
   LLFIO_MAKE_FREE_FUNCTION
   static inline result<map_handle> map(size_type bytes, bool zeroed = false, section_handle::flag _flag = section_handle::flag::readwrite) noexcept
   {
-    return (zeroed || (_flag & section_handle::flag::nocommit)) ? _new_map(bytes, true, _flag) : _recycled_map(bytes, _flag);
+    detail::trace_scope trace(trace_event_kind::map, (uint64_t) -1, bytes);
+    // Recycled maps are not aligned for transparent huge pages
+    const bool fresh = zeroed || (_flag & section_handle::flag::nocommit) || (_flag & section_handle::flag::transparent_huge_pages);
+    auto ret = fresh ? _new_map(bytes, true, _flag) : _recycled_map(bytes, _flag);
+    trace.finish(ret ? (uint64_t) ret.value().address() : 0, !ret);
+    return ret;
   }
 
   /*! Reserve address space within which individual pages can later be committed. Reserved address
@@ -666,12 +683,15 @@ public:
   permissions of the memory section. `flag::none` can be useful for reserving virtual address
   space without committing system resources, use `commit()` to later change availability of memory.
   Note that apart from read/write/cow/execute, the section's flags override the map's flags.
+  \param address If not null, the view must be placed at exactly this address, which must be
+  suitably aligned (64Kb on Windows), else `errc::address_in_use` is returned. Existing maps are
+  never replaced.
 
   \errors Any of the values POSIX `mmap()` or `NtMapViewOfSection()` can return.
   */
   LLFIO_MAKE_FREE_FUNCTION
   static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<map_handle> map(section_handle &section, size_type bytes = 0, extent_type offset = 0,
-                                                                section_handle::flag _flag = section_handle::flag::readwrite) noexcept;
+                                                                section_handle::flag _flag = section_handle::flag::readwrite, void *address = nullptr) noexcept;
 
   //! The kind of memory accounting this system uses
   enum class memory_accounting_kind
@@ -859,6 +879,68 @@ public:
   */
   LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<buffer_type> do_not_store(buffer_type region) noexcept;
 
+  /*! Ask the system to fault in the memory represented by the buffer now, so that the first
+  access to each page does not page fault later. addr and length should be page aligned
+  (see `page_size()`), if not the returned buffer is the region actually prefaulted.
+
+  On Linux 5.14 or later this uses `MADV_POPULATE_WRITE` (or `MADV_POPULATE_READ` for read
+  only maps), elsewhere every page is touched with an atomic no-op write (or a read for read
+  only maps), which is safe against concurrent modification of the region.
+
+  \errors Any of the values `madvise()` can return.
+  */
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<buffer_type> prefault(buffer_type region) noexcept;
+
+  /*! Ask the system to allocate any pages of the memory represented by the buffer not yet
+  allocated from the given NUMA node, and to migrate any already allocated pages to it. addr
+  and length should be page aligned (see `page_size()`), if not the returned buffer is the
+  region actually bound.
+
+  Only implemented on Linux, via `mbind(MPOL_BIND)`. Note that Linux only honours memory policy
+  for anonymous and shared memory (i.e. `tmpfs`) maps, pages of a map of a regular file come
+  from the page cache which ignores the policy. Other platforms return
+  `errc::operation_not_supported`.
+
+  \errors Any of the values `mbind()` can return.
+  */
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<buffer_type> bind_to_numa_node(buffer_type region, unsigned node) noexcept;
+
+  /*! Fill `out` with the runs of pages within `region` written since the last `barrier()`, or
+  since mapping, returning the subspan of `out` filled. An empty `region` means the whole map.
+  Adjacent runs are coalesced.
+
+  Requires the map to have been created with `section_handle::flag::track_written_pages`, upon
+  which each `barrier()` only flushes the pages written since the previous `barrier()`. Only
+  implemented on Linux 6.7 or later, via asynchronous userfaultfd write protection and the
+  `PAGEMAP_SCAN` ioctl.
+
+  \errors `errc::operation_not_supported` if the region is not tracked, `errc::value_too_large` if
+  `out` is too small. Any of the values `ioctl()` can return.
+  */
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<span<buffer_type>> written_regions(span<buffer_type> out, buffer_type region = {}) const noexcept;
+
+  /*! Ask the system to synchronously replace the normal pages of the memory represented by the
+  buffer with transparent huge pages where possible, without waiting for `khugepaged`. addr and
+  length should be page aligned (see `page_size()`), if not the returned buffer is the region
+  actually collapsed.
+
+  Only implemented on Linux 6.1 or later, via `MADV_COLLAPSE`. Other platforms and older kernels
+  return `errc::operation_not_supported`.
+
+  \errors Any of the values `madvise()` can return.
+  */
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<buffer_type> collapse_to_huge_pages(buffer_type region) noexcept;
+
+  /*! Returns how many bytes of this map are currently backed by huge pages, be those transparent
+  huge pages or the large pages of `section_handle::flag::page_sizes_1` etc.
+
+  On Linux this parses `/proc/self/smaps`, which is not cheap for processes with many maps. Other
+  platforms return `errc::operation_not_supported`, except for large page maps.
+
+  \errors Any of the values `open()` or `read()` can return.
+  */
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<size_type> huge_page_bytes() const noexcept;
+
   //! Ask the system to begin to asynchronously prefetch the span of memory regions given, returning the regions actually prefetched. Note that on Windows 7 or
   //! earlier the system call to implement this was not available, and so you will see an empty span returned.
   static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<span<buffer_type>> prefetch(span<buffer_type> regions) noexcept;
@@ -184,11 +184,47 @@ public:
   template <class T> using io_request = io_handle::io_request<T>;
   template <class T> using io_result = io_handle::io_result<T>;
 
+  //! Statistics about the adaptive readahead of this handle, see `set_adaptive_readahead()`.
+  struct readahead_statistics
+  {
+    uint64_t reads{0};             //!< Reads observed.
+    uint64_t sequential_reads{0};  //!< Reads which continued a sequential stream.
+    uint64_t strided_reads{0};     //!< Reads which continued a fixed stride stream.
+    uint64_t random_reads{0};      //!< Reads which continued no stream.
+    uint64_t hits{0};              //!< Stream reads which fell entirely within memory already prefetched.
+    uint64_t misses{0};            //!< Stream reads which did not.
+    uint64_t prefetches{0};        //!< Calls made to `map_handle::prefetch()`.
+    uint64_t bytes_prefetched{0};  //!< Bytes asked to be prefetched.
+    uint64_t bytes_wasted{0};      //!< Bytes prefetched ahead of a stream which then ended.
+    size_type window{0};           //!< The current readahead window in bytes.
+  };
+
 protected:
+  struct _readahead_type
+  {
+    struct fields_type
+    {
+      bool enabled{false};
+      extent_type last_offset{0}, last_end{0};
+      extent_type stride{0};                     // distance between the starts of the last two reads
+      extent_type ahead_begin{0}, ahead_end{0};  // extent of the stream already prefetched
+      readahead_statistics stats;
+    } f;
+    std::atomic<bool> busy{false};  // readers finding this set skip readahead rather than wait
+
+    constexpr _readahead_type() {}  // NOLINT
+    _readahead_type(const _readahead_type &o) noexcept
+        : f(o.f)
+    {
+    }
+    _readahead_type &operator=(const _readahead_type &) = delete;
+  };
+
   size_type _reservation{0};
   extent_type _offset{0};
   section_handle _sh;  // Tracks the file (i.e. *this) somewhat lazily
   map_handle _mh;      // The current map with valid extent
+  _readahead_type _ra;
 
   LLFIO_HEADERS_ONLY_VIRTUAL_SPEC size_t _do_max_buffers() const noexcept override { return _mh.max_buffers(); }
   LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<const_buffers_type> _do_barrier(io_request<const_buffers_type> reqs = io_request<const_buffers_type>(),
@@ -233,6 +269,10 @@ protected:
   LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<buffers_type> _do_read(io_request<buffers_type> reqs, deadline d = deadline()) noexcept override
   {
     assert(_mh.native_handle()._init == native_handle()._init);
+    if(_ra.f.enabled)
+    {
+      _readahead(reqs);
+    }
     return _mh.read(reqs, d);
   }
   LLFIO_HEADERS_ONLY_VIRTUAL_SPEC io_result<const_buffers_type> _do_write(io_request<const_buffers_type> reqs, deadline d = deadline()) noexcept override
@@ -276,6 +316,7 @@ protected:
   }
 
   LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<size_type> _reserve(extent_type &length, size_type reservation) noexcept;
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC void _readahead(const io_request<buffers_type> &reqs) noexcept;
 
 public:
   //! Default constructor
@@ -288,6 +329,7 @@ public:
       , _offset(o._offset)
       , _sh(std::move(o._sh))
       , _mh(std::move(o._mh))
+      , _ra(o._ra)
   {
 #ifndef NDEBUG
     if(_mh.is_valid())
@@ -530,6 +572,33 @@ public:
   //! True if the map is of non-volatile RAM
   bool is_nvram() const noexcept { return _mh.is_nvram(); }
 
+  /*! \brief Enable or disable adaptive readahead for `read()`, which is disabled by default.
+
+  As `read()` returns pointers into the map rather than copying, the cost of a cold read is
+  paid later when the memory is first touched, one page fault at a time. When enabled, each
+  `read()` is classified as continuing a sequential stream, continuing a fixed stride stream,
+  or random. Stream reads cause the memory a window ahead of the read to be prefetched using
+  `map_handle::prefetch()` (`MADV_WILLNEED` on POSIX), such that later touches find the data
+  already in the page cache. The window starts at 128Kb, doubles whenever a read finds its
+  memory was already prefetched up to 16Mb, and halves whenever a stream ends with prefetched
+  memory left unread.
+
+  Only one stream per handle is tracked. Concurrent readers of the same handle are safe, but
+  a reader finding another reader updating the readahead state skips readahead for its read.
+  */
+  void set_adaptive_readahead(bool enable) noexcept
+  {
+    _ra.f.enabled = enable;
+    if(enable && _ra.f.stats.window == 0)
+    {
+      _ra.f.stats.window = (size_type) 128 * 1024;
+    }
+  }
+  //! True if adaptive readahead is enabled for `read()`.
+  bool adaptive_readahead() const noexcept { return _ra.f.enabled; }
+  //! Statistics about adaptive readahead. Not synchronised with concurrent readers.
+  readahead_statistics readahead_stats() const noexcept { return _ra.f.stats; }
+
   //! The maximum extent of the underlying file, minus any offset.
   result<extent_type> underlying_file_maximum_extent() const noexcept
   {
@@ -850,6 +919,7 @@ LLFIO_V2_NAMESPACE_END
 
 #if LLFIO_HEADERS_ONLY == 1 && !defined(DOXYGEN_SHOULD_SKIP_THIS)
 #define LLFIO_INCLUDED_BY_HEADER 1
+#include "detail/impl/mapped_file_handle.ipp"
 #ifdef _WIN32
 #include "detail/impl/windows/mapped_file_handle.ipp"
 #else
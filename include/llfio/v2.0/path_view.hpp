@@ -27,8 +27,10 @@ Distributed under the Boost Software License, Version 1.0.
 
 #include "config.hpp"
 
+#include <functional>  // for hash
 #include <iterator>
 #include <memory>  // for unique_ptr
+#include <utility>  // for pair
 
 //! \file path_view.hpp Provides view of a path
 
@@ -57,6 +59,41 @@ MSVC seems to only implement char8_t if C++ 20 is enabled.
 #endif
 #endif
 
+// True if the compiler can tell constant evaluation apart from runtime evaluation
+#ifndef LLFIO_PATH_VIEW_HAVE_IS_CONSTANT_EVALUATED
+#if defined(__clang__)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define LLFIO_PATH_VIEW_HAVE_IS_CONSTANT_EVALUATED 1
+#endif
+#elif defined(__GNUC__) && __GNUC__ >= 9
+#define LLFIO_PATH_VIEW_HAVE_IS_CONSTANT_EVALUATED 1
+#elif defined(_MSC_VER) && _MSC_VER >= 1925
+#define LLFIO_PATH_VIEW_HAVE_IS_CONSTANT_EVALUATED 1
+#endif
+#ifndef LLFIO_PATH_VIEW_HAVE_IS_CONSTANT_EVALUATED
+#define LLFIO_PATH_VIEW_HAVE_IS_CONSTANT_EVALUATED 0
+#endif
+#endif
+
+/*! \def LLFIO_PATH_VIEW_SIMD
+\brief Define to 1 to have `path_view` search for path separators using SSE2 at runtime, or to 0
+to always search element by element. Defaults to 1 if the compiler targets SSE2 and can tell
+constant evaluation apart from runtime evaluation.
+*/
+#ifndef LLFIO_PATH_VIEW_SIMD
+#if LLFIO_PATH_VIEW_HAVE_IS_CONSTANT_EVALUATED && (defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define LLFIO_PATH_VIEW_SIMD 1
+#else
+#define LLFIO_PATH_VIEW_SIMD 0
+#endif
+#endif
+#if LLFIO_PATH_VIEW_SIMD
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
 LLFIO_V2_NAMESPACE_EXPORT_BEGIN
 
 namespace detail
@@ -77,6 +114,94 @@ namespace detail
     }
     return e - s;
   }
+#if LLFIO_PATH_VIEW_SIMD
+  /* Separator searches over raw code units, sixteen bytes at a time. The element type is
+  the unsigned integer of the same size as the source character type.
+  */
+  inline unsigned simd_sep_mask(const uint8_t *s, uint8_t a, uint8_t b) noexcept
+  {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s));
+    return (unsigned) _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8((char) a)), _mm_cmpeq_epi8(v, _mm_set1_epi8((char) b))));
+  }
+  inline unsigned simd_sep_mask(const uint16_t *s, uint16_t a, uint16_t b) noexcept
+  {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s));
+    return (unsigned) _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi16(v, _mm_set1_epi16((short) a)), _mm_cmpeq_epi16(v, _mm_set1_epi16((short) b))));
+  }
+  inline unsigned simd_sep_mask(const uint32_t *s, uint32_t a, uint32_t b) noexcept
+  {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s));
+    return (unsigned) _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi32(v, _mm_set1_epi32((int) a)), _mm_cmpeq_epi32(v, _mm_set1_epi32((int) b))));
+  }
+  inline unsigned simd_lowest_bit(unsigned v) noexcept
+  {
+#ifdef _MSC_VER
+    unsigned long ret;
+    _BitScanForward(&ret, v);
+    return (unsigned) ret;
+#else
+    return (unsigned) __builtin_ctz(v);
+#endif
+  }
+  inline unsigned simd_highest_bit(unsigned v) noexcept
+  {
+#ifdef _MSC_VER
+    unsigned long ret;
+    _BitScanReverse(&ret, v);
+    return (unsigned) ret;
+#else
+    return 31U - (unsigned) __builtin_clz(v);
+#endif
+  }
+  // Returns the index of the first element at or after startidx which is a or b
+  template <class T> inline size_t simd_find_first_sep(const T *s, size_t length, size_t startidx, T a, T b) noexcept
+  {
+    static constexpr size_t per = 16 / sizeof(T);
+    if(startidx >= length)
+    {
+      return (size_t) -1;
+    }
+    size_t idx = startidx;
+    for(; idx + per <= length; idx += per)
+    {
+      const auto mask = simd_sep_mask(s + idx, a, b);
+      if(mask != 0)
+      {
+        return idx + simd_lowest_bit(mask) / sizeof(T);
+      }
+    }
+    for(; idx < length; idx++)
+    {
+      if(s[idx] == a || s[idx] == b)
+      {
+        return idx;
+      }
+    }
+    return (size_t) -1;
+  }
+  // Returns the index of the last element at or before endidx which is a or b
+  template <class T> inline size_t simd_find_last_sep(const T *s, size_t length, size_t endidx, T a, T b) noexcept
+  {
+    static constexpr size_t per = 16 / sizeof(T);
+    size_t end = (endidx >= length) ? length : (endidx + 1);
+    for(; end >= per; end -= per)
+    {
+      const auto mask = simd_sep_mask(s + end - per, a, b);
+      if(mask != 0)
+      {
+        return end - per + simd_highest_bit(mask) / sizeof(T);
+      }
+    }
+    while(end > 0)
+    {
+      if(s[--end] == a || s[end] == b)
+      {
+        return end;
+      }
+    }
+    return (size_t) -1;
+  }
+#endif
 
 #if LLFIO_PATH_VIEW_CHAR8_TYPE_EMULATED
 #ifdef _MSC_VER  // MSVC's standard library refuses any basic_string_view<T> where T is not an unsigned type
@@ -465,9 +590,63 @@ private:
                                        :
                                        f(basic_string_view<char>((const char *) _bytestr, _length))));
   }
+#if LLFIO_PATH_VIEW_SIMD
+  // The separators to search for, which are the same if only one kind of separator separates
+  std::pair<char, char> _simd_separators() const noexcept
+  {
+#ifdef _WIN32
+    switch(_format)
+    {
+    case format::native_format:
+      return {'\\', '\\'};
+    case format::generic_format:
+      return {'/', '/'};
+    default:
+      return {'/', '\\'};
+    }
+#else
+    return {'/', '/'};
+#endif
+  }
+  size_t _simd_find_first_sep(size_t startidx) const noexcept
+  {
+    using wchar_type = std::conditional_t<sizeof(wchar_t) == 2, uint16_t, uint32_t>;
+    const auto seps = _simd_separators();
+    if(_wchar)
+    {
+      return detail::simd_find_first_sep(reinterpret_cast<const wchar_type *>(_wcharstr), _length, startidx, (wchar_type) seps.first,
+                                         (wchar_type) seps.second);
+    }
+    if(_utf16)
+    {
+      return detail::simd_find_first_sep(reinterpret_cast<const uint16_t *>(_char16str), _length, startidx, (uint16_t) seps.first, (uint16_t) seps.second);
+    }
+    return detail::simd_find_first_sep(reinterpret_cast<const uint8_t *>(_bytestr), _length, startidx, (uint8_t) seps.first, (uint8_t) seps.second);
+  }
+  size_t _simd_find_last_sep(size_t endidx) const noexcept
+  {
+    using wchar_type = std::conditional_t<sizeof(wchar_t) == 2, uint16_t, uint32_t>;
+    const auto seps = _simd_separators();
+    if(_wchar)
+    {
+      return detail::simd_find_last_sep(reinterpret_cast<const wchar_type *>(_wcharstr), _length, endidx, (wchar_type) seps.first, (wchar_type) seps.second);
+    }
+    if(_utf16)
+    {
+      return detail::simd_find_last_sep(reinterpret_cast<const uint16_t *>(_char16str), _length, endidx, (uint16_t) seps.first, (uint16_t) seps.second);
+    }
+    return detail::simd_find_last_sep(reinterpret_cast<const uint8_t *>(_bytestr), _length, endidx, (uint8_t) seps.first, (uint8_t) seps.second);
+  }
+#endif
   constexpr auto _find_first_sep(size_t startidx = 0) const noexcept
   {
     using LLFIO_V2_NAMESPACE::basic_string_view;
+#if LLFIO_PATH_VIEW_SIMD
+    if(!__builtin_is_constant_evaluated() && _format != format::binary_format)
+    {
+      return _simd_find_first_sep(startidx);
+    }
+#endif
     switch(_format)
     {
     case format::binary_format:
@@ -512,6 +691,12 @@ private:
   constexpr auto _find_last_sep(size_t endidx = _npos) const noexcept
   {
     using LLFIO_V2_NAMESPACE::basic_string_view;
+#if LLFIO_PATH_VIEW_SIMD
+    if(!__builtin_is_constant_evaluated() && _format != format::binary_format)
+    {
+      return _simd_find_last_sep(endidx);
+    }
+#endif
     switch(_format)
     {
     case format::binary_format:
@@ -738,6 +923,33 @@ private:
     return _do_compare(_a.data(), _b.data(), _a.size());
   }
 
+protected:
+  // The bytes occupied by the source characters
+  constexpr size_t _source_bytes() const noexcept { return _wchar ? (_length * sizeof(wchar_t)) : (_utf16 ? (_length * 2) : _length); }
+  /* True if both have the same source encoding and formatting, and bitwise identical contents.
+  Identical views are always equal, but equal views need not be identical, so this lets
+  whole path comparisons skip iterating components in the common case.
+  */
+  constexpr bool _identical(path_view_component o) const noexcept
+  {
+#if LLFIO_PATH_VIEW_HAVE_IS_CONSTANT_EVALUATED
+    if(__builtin_is_constant_evaluated())
+    {
+      return false;
+    }
+    if(_length != o._length || _format != o._format || _passthrough != o._passthrough || _char != o._char || _wchar != o._wchar || _utf8 != o._utf8 ||
+       _utf16 != o._utf16)
+    {
+      return false;
+    }
+    return _length == 0 || _bytestr == o._bytestr || 0 == memcmp(_bytestr, o._bytestr, _source_bytes());
+#else
+    // Cannot avoid calling memcmp() during constant evaluation
+    (void) o;
+    return false;
+#endif
+  }
+
 public:
   //! Return the path view as a path. Allocates and copies memory!
   filesystem::path path() const
@@ -1462,8 +1674,7 @@ inline LLFIO_PATH_VIEW_CONSTEXPR bool operator==(path_view_component x, path_vie
   }
   assert(x._bytestr != nullptr);
   assert(y._bytestr != nullptr);
-  const auto bytes = (x._wchar || x._utf16) ? (x._length * 2) : x._length;
-  return 0 == memcmp(x._bytestr, y._bytestr, bytes);
+  return 0 == memcmp(x._bytestr, y._bytestr, x._source_bytes());
 }
 inline LLFIO_PATH_VIEW_CONSTEXPR bool operator!=(path_view_component x, path_view_component y) noexcept
 {
@@ -1497,8 +1708,7 @@ inline LLFIO_PATH_VIEW_CONSTEXPR bool operator!=(path_view_component x, path_vie
   }
   assert(x._bytestr != nullptr);
   assert(y._bytestr != nullptr);
-  const auto bytes = (x._wchar || x._utf16) ? (x._length * 2) : x._length;
-  return 0 != memcmp(x._bytestr, y._bytestr, bytes);
+  return 0 != memcmp(x._bytestr, y._bytestr, x._source_bytes());
 }
 LLFIO_TEMPLATE(class CharT)
 LLFIO_TREQUIRES(LLFIO_TPRED(path_view_component::is_source_acceptable<CharT>))
@@ -1581,6 +1791,85 @@ inline std::ostream &operator<<(std::ostream &s, const path_view_component &v)
 }
 
 
+namespace detail
+{
+  // Never freed, so an interned_path is merely a pointer which remains valid for the life of the process
+  struct interned_path_entry
+  {
+    interned_path_entry *next;  // in the intern table hash chain
+    size_t hash;
+    size_t length;                         // in characters, excluding the zero terminator
+    filesystem::path::value_type str[1];  // actually length + 1 characters, zero terminated
+  };
+}  // namespace detail
+
+/*! \class interned_path
+\brief A pre-rendered, zero terminated, native platform transport form of a path, with a
+precomputed hash, which lives for the remaining lifetime of the process.
+
+Every consumer of a `path_view` which needs a zero terminated native path must render it,
+which is a copy into a `rendered_path` at best, and a reencode and possibly a memory allocation
+at worst. If the same paths are opened over and over, intern them once with `intern()`,
+and pass the `interned_path` thereafter. `path_view` constructs from `interned_path` without
+copying, and rendering that view to a zero terminated native path never copies nor allocates.
+
+Interning the same path twice yields the same `interned_path`, so equality comparison is a
+pointer comparison, and `hash()` merely returns the value calculated when first interned.
+The hash is only stable for the current process.
+
+On Microsoft Windows, generic separators are converted into native separators during interning,
+so the interned form is always separated at the native path separator only.
+
+Interned paths are never freed, so do not intern paths which are not going to be reused.
+*/
+class LLFIO_DECL interned_path
+{
+  const detail::interned_path_entry *_entry{nullptr};
+
+  constexpr explicit interned_path(const detail::interned_path_entry *entry) noexcept
+      : _entry(entry)
+  {
+  }
+
+public:
+  //! The character type
+  using value_type = filesystem::path::value_type;
+  //! The size type
+  using size_type = path_view_component::size_type;
+
+  //! Constructs an empty interned path
+  constexpr interned_path() {}  // NOLINT
+
+  /*! \brief Returns the interned form of `v`, rendering and interning it if it was not already interned.
+
+  \mallocs If `v` was not already interned, allocates the interned form, and possibly grows the intern
+  table. This may throw `std::bad_alloc`. Calls are serialised by a process wide mutex.
+  */
+  static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC interned_path intern(path_view_component v);
+  //! Returns the number of paths interned so far by this process.
+  static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC size_t interned_count() noexcept;
+
+  //! True if empty
+  constexpr bool empty() const noexcept { return _entry == nullptr; }
+  //! Returns the size of the path in characters, excluding the zero terminator.
+  constexpr size_type size() const noexcept { return (_entry == nullptr) ? 0 : _entry->length; }
+  //! Returns the zero terminated native path.
+  const value_type *c_str() const noexcept
+  {
+    static constexpr value_type empty_[1] = {0};
+    return (_entry == nullptr) ? empty_ : _entry->str;
+  }
+  //! Returns the path as a string view, which is guaranteed to be zero terminated.
+  basic_string_view<value_type> as_string_view() const noexcept { return {c_str(), size()}; }
+  //! Returns the hash of the path, as calculated when it was interned.
+  constexpr size_t hash() const noexcept { return (_entry == nullptr) ? 0 : _entry->hash; }
+
+  //! True if the two interned paths are the same path.
+  friend constexpr bool operator==(interned_path a, interned_path b) noexcept { return a._entry == b._entry; }
+  //! True if the two interned paths are not the same path.
+  friend constexpr bool operator!=(interned_path a, interned_path b) noexcept { return a._entry != b._entry; }
+};
+
 /*! \class path_view
 \brief A borrowed view of a path. A lightweight trivial-type alternative to
 `std::filesystem::path`.
@@ -1703,6 +1992,13 @@ public:
       : path_view_component(v, fmt)
   {
   }
+  /*! Implicitly constructs a path view from an interned path. Rendering this view into a zero terminated
+  native path never copies nor allocates.
+  */
+  path_view(const interned_path &v) noexcept  // NOLINT
+      : path_view_component(v.c_str(), v.size(), zero_terminated, native_format)
+  {
+  }
 
   /*! Constructs from a basic string if the character type is one of
   `char`, `wchar_t`, `char8_t` or `char16_t`.
@@ -2363,6 +2659,10 @@ constexpr inline path_view::iterator path_view::end() noexcept
 
 inline LLFIO_PATH_VIEW_CONSTEXPR bool operator==(path_view x, path_view y) noexcept
 {
+  if(x._identical(y))
+  {
+    return true;
+  }
   auto it1 = x.begin(), it2 = y.begin();
   for(; it1 != x.end() && it2 != y.end(); ++it1, ++it2)
   {
@@ -2383,6 +2683,10 @@ inline LLFIO_PATH_VIEW_CONSTEXPR bool operator==(path_view x, path_view y) noexc
 }
 inline LLFIO_PATH_VIEW_CONSTEXPR bool operator!=(path_view x, path_view y) noexcept
 {
+  if(x._identical(y))
+  {
+    return false;
+  }
   auto it1 = x.begin(), it2 = y.begin();
   for(; it1 != x.end() && it2 != y.end(); ++it1, ++it2)
   {
@@ -2439,6 +2743,10 @@ template <class T, class Deleter, size_t _internal_buffer_size, typename std::en
 #endif
 constexpr inline int path_view::compare(path_view o, const std::locale &loc) const
 {
+  if(_identical(o))
+  {
+    return 0;
+  }
   auto it1 = begin(), it2 = o.begin();
   for(; it1 != end() && it2 != o.end(); ++it1, ++it2)
   {
@@ -2468,6 +2776,10 @@ template <class T, class Deleter, size_t _internal_buffer_size, typename std::en
 #endif
 constexpr inline int path_view::compare(path_view o) const
 {
+  if(_identical(o))
+  {
+    return 0;
+  }
   auto it1 = begin(), it2 = o.begin();
   for(; it1 != end() && it2 != o.end(); ++it1, ++it2)
   {
@@ -2549,6 +2861,15 @@ static_assert(std::is_trivially_copyable<path_view>::value, "path_view is not a
 
 LLFIO_V2_NAMESPACE_END
 
+namespace std
+{
+  //! Hashes an interned path by returning its precomputed hash
+  template <> struct hash<LLFIO_V2_NAMESPACE::interned_path>
+  {
+    size_t operator()(LLFIO_V2_NAMESPACE::interned_path v) const noexcept { return v.hash(); }
+  };
+}  // namespace std
+
 #if LLFIO_HEADERS_ONLY == 1 && !defined(DOXYGEN_SHOULD_SKIP_THIS)
 #define LLFIO_INCLUDED_BY_HEADER 1
 #include "detail/impl/path_view.ipp"
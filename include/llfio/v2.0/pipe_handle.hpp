@@ -31,6 +31,30 @@ Distributed under the Boost Software License, Version 1.0.
 
 LLFIO_V2_NAMESPACE_EXPORT_BEGIN
 
+namespace detail
+{
+  // Moves bytes from src to dest through a buffer, for where there is no splice()
+  inline result<size_t> pipe_bounce_transfer(io_handle &src, io_handle::extent_type srcoffset, io_handle &dest, io_handle::extent_type destoffset,
+                                             size_t bytes, deadline d) noexcept
+  {
+    byte buffer[16384];
+    io_handle::buffer_type b(buffer, (bytes < sizeof(buffer)) ? bytes : sizeof(buffer));
+    auto read = src.read({{&b, 1}, srcoffset}, d);
+    if(!read)
+    {
+      return std::move(read).error();
+    }
+    // Having consumed the bytes, we must write all of them
+    io_handle::const_buffer_type cb(buffer, read.bytes_transferred());
+    auto written = dest.write({{&cb, 1}, destoffset});
+    if(!written)
+    {
+      return std::move(written).error();
+    }
+    return written.bytes_transferred();
+  }
+}  // namespace detail
+
 /*! \class pipe_handle
 \brief A handle to a named or anonymous pipe.
 
@@ -235,6 +259,74 @@ public:
   LLFIO_MAKE_FREE_FUNCTION
   static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<std::pair<pipe_handle, pipe_handle>> anonymous_pipe(caching _caching = caching::all, flag flags = flag::none) noexcept;
 
+  /*! \brief Returns the capacity of the pipe's kernel buffer in bytes.
+
+  \errors Any of the values POSIX `fcntl(F_GETPIPE_SZ)` or `GetNamedPipeInfo()` can return.
+  `errc::operation_not_supported` on POSIX other than Linux.
+  */
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<size_t> buffer_size() const noexcept;
+  /*! \brief Sets the capacity of the pipe's kernel buffer, returning the capacity actually set,
+  which may be rounded up.
+
+  A larger buffer lets more data be moved per syscall when transferring, and lets a writer
+  run further ahead of its reader. Unprivileged processes on Linux cannot exceed
+  `/proc/sys/fs/pipe-max-size`, usually 1Mb.
+
+  \errors Any of the values POSIX `fcntl(F_SETPIPE_SZ)` can return. `errc::operation_not_supported`
+  on platforms other than Linux, where pipe buffers are sized at creation.
+  */
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<size_t> set_buffer_size(size_t bytes) noexcept;
+
+  /*! \brief Moves up to `bytes` from `src` into this pipe, without copying through userspace
+  where possible.
+
+  \return The bytes moved, which is zero if `src` has reached its end.
+  \param src The handle to read from, which can be a file, a socket or another pipe.
+  \param offset The offset within `src` to read from. Ignored if `src` is not seekable.
+  \param bytes The maximum number of bytes to move.
+  \param d An optional deadline, which sets whether to wait for this pipe to have space. A
+  zero deadline never waits, making this suitable for calling from an external event loop.
+
+  On Linux this is `splice()`, which moves page references from the page cache or the other
+  pipe into this pipe. Elsewhere, the bytes are bounced through a buffer.
+
+  \errors Any of the values POSIX `splice()`, `read()` or `write()` can return, `errc::timed_out`.
+  */
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<size_t> splice_from(io_handle &src, extent_type offset, size_t bytes, deadline d = {}) noexcept;
+  /*! \brief Moves up to `bytes` from this pipe into `dest`, without copying through userspace
+  where possible.
+
+  \return The bytes moved, which is zero if the other end of this pipe has been closed and
+  the pipe is empty.
+  \param dest The handle to write to, which can be a file, a socket or another pipe.
+  \param offset The offset within `dest` to write at. Ignored if `dest` is not seekable.
+  \param bytes The maximum number of bytes to move.
+  \param d An optional deadline, which sets whether to wait for this pipe to have data.
+
+  \errors Any of the values POSIX `splice()`, `read()` or `write()` can return, `errc::timed_out`.
+  */
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<size_t> splice_to(io_handle &dest, extent_type offset, size_t bytes, deadline d = {}) noexcept;
+  /*! \brief Duplicates up to `bytes` of the data in this pipe into the pipe `dest`, without
+  consuming it from this pipe.
+
+  This lets a stream be sent to two destinations without copying, by teeing into a second
+  pipe and then splicing from both.
+
+  \errors Any of the values POSIX `tee()` can return, `errc::timed_out`. `errc::operation_not_supported`
+  on platforms other than Linux.
+  */
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<size_t> tee_to(pipe_handle &dest, size_t bytes, deadline d = {}) noexcept;
+  /*! \brief Writes `buffers` into this pipe by mapping their pages into the pipe rather than
+  copying them, returning the bytes written.
+
+  The memory in `buffers` must not be modified until the reader has consumed it, otherwise the
+  reader may see the modification. This is intended for buffers which will not be reused, or
+  which are reused only after an acknowledgement. Elsewhere than Linux, this is a `write()`.
+
+  \errors Any of the values POSIX `vmsplice()` or `write()` can return, `errc::timed_out`.
+  */
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<size_t> gift(const_buffers_type buffers, deadline d = {}) noexcept;
+
   LLFIO_HEADERS_ONLY_VIRTUAL_SPEC ~pipe_handle() override
   {
     if(_v)
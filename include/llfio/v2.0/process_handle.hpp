@@ -28,6 +28,8 @@ Distributed under the Boost Software License, Version 1.0.
 #include "path_view.hpp"
 #include "pipe_handle.hpp"
 
+#include <vector>
+
 //! \file process_handle.hpp Provides a handle to a process
 
 #ifdef _MSC_VER
@@ -63,6 +65,9 @@ public:
 protected:
   flag _flags{flag::none};
   pipe_handle _in_pipe, _out_pipe, _error_pipe;
+#ifdef __linux__
+  int _pidfd{-1};  // refers to the process if the kernel supports pidfds, so waits can block precisely
+#endif
 
   struct _byte_array_deleter
   {
@@ -104,7 +109,13 @@ public:
       , _in_pipe(std::move(o._in_pipe))
       , _out_pipe(std::move(o._out_pipe))
       , _error_pipe(std::move(o._error_pipe))
+#ifdef __linux__
+      , _pidfd(o._pidfd)
+#endif
   {
+#ifdef __linux__
+    o._pidfd = -1;
+#endif
   }
   //! Move assignment of handle
   process_handle &operator=(process_handle &&o) noexcept
@@ -201,11 +212,149 @@ public:
   */
   LLFIO_HEADERS_ONLY_MEMFUNC_SPEC std::unique_ptr<span<path_view_component>, _byte_array_deleter> environment() const noexcept;
 
-  /*! Waits until a process exits, returning its exit code. */
+  /*! Waits until a process exits, returning its exit code.
+
+  On Linux, waits with a deadline sleep on a pidfd referring to the process and so wake
+  as soon as the process exits. On other POSIX, such waits check every 10 milliseconds.
+  */
   LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<intptr_t> wait(deadline d = {}) const noexcept;
 
   LLFIO_DEADLINE_TRY_FOR_UNTIL(wait)
 
+  /*! \brief Returns a native handle which becomes readable or signalled when the process exits,
+  if this platform has one, otherwise an invalid native handle.
+
+  This is a pidfd on Linux, and the process `HANDLE` on Windows. It remains owned by this
+  process handle, and is suitable for adding to an external `poll()`, `epoll`, `io_uring`
+  or `WaitForMultipleObjects()` event loop alongside the redirected pipes.
+  */
+  LLFIO_HEADERS_ONLY_MEMFUNC_SPEC native_handle_type exit_native_handle() const noexcept;
+
+  /*! \brief Waits until any of `processes` exits, or any of `pipes` has data to read or has
+  been closed by its other end, or `d` expires.
+
+  \param processes The processes to wait upon exiting. Null pointers are ignored.
+  \param pipes The pipes to wait upon becoming readable. Null pointers are ignored.
+  \param ready Must be at least `processes.size() + pipes.size()` long. Each item is set to
+  whether the corresponding item in `processes`, followed by `pipes`, is ready.
+  \param d The deadline to wait until.
+  \return The number of items which are ready.
+
+  On Linux this polls pidfds referring to the processes alongside the pipes, and so wakes
+  precisely upon process exit. On other POSIX, process exits are checked every 10 milliseconds.
+  Exited processes are not reaped, call `wait()` to retrieve their exit codes. On Windows,
+  waiting upon pipes is not supported.
+
+  \errors `errc::timed_out` if `d` expired before anything became ready. Any of the values
+  `poll()` or `WaitForMultipleObjects()` can return.
+  */
+  static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<size_t> wait_for_any(span<const process_handle *> processes, span<const pipe_handle *> pipes,
+                                                                    span<bool> ready, deadline d = {}) noexcept;
+
+  /*! \class spawn_template
+  \brief A pre-rendered description of a process to launch, for when many identical processes
+  are to be launched.
+
+  The path, arguments and environment are rendered into the native encoding once, along with
+  the zero terminated `argv` and `envp` arrays which `execve()` requires, so each launch need
+  only create the redirected pipes and the process. Create using `make_spawn_template()`, and
+  launch using the `launch_process()` overload taking a template. A template may be used by
+  many threads concurrently. Templates can be moved, but not copied.
+
+  On Windows, templates give no benefit, as `CreateProcess()` needs its command line and
+  environment block built afresh for each launch.
+  */
+  class spawn_template
+  {
+    friend class process_handle;
+    using _char_type = filesystem::path::value_type;
+
+    std::vector<_char_type> _strings;  // every string, each zero terminated
+    std::vector<path_view_component> _args, _env;
+    std::vector<const _char_type *> _argv, _envp;  // null terminated, _argv[0] is the path
+    path_view _path;
+    flag _flags{flag::none};
+
+  public:
+    //! Default constructor, an empty template
+    spawn_template() = default;
+    spawn_template(const spawn_template &) = delete;
+    spawn_template(spawn_template &&) = default;
+    spawn_template &operator=(const spawn_template &) = delete;
+    spawn_template &operator=(spawn_template &&) = default;
+    //! The absolute path to the binary to launch
+    path_view path() const noexcept { return _path; }
+    //! The arguments to pass to the process, excluding the path
+    span<const path_view_component> args() const noexcept { return _args; }
+    //! The environment variables to set for the process
+    span<const path_view_component> env() const noexcept { return _env; }
+    //! The flags for each launched process
+    flag flags() const noexcept { return _flags; }
+    //! A null terminated array of the native encoded path followed by the arguments
+    const _char_type *const *argv() const noexcept { return _argv.data(); }
+    //! A null terminated array of the native encoded environment variables
+    const _char_type *const *envp() const noexcept { return _envp.data(); }
+  };
+
+  /*! \brief Create a template for launching many processes with the same path, arguments,
+  environment and flags. The parameters are as for `launch_process()`.
+
+  \mallocs Allocates storage for the rendered strings.
+  */
+  static result<spawn_template> make_spawn_template(path_view path, span<path_view_component> args, span<path_view_component> env = *current().environment(),
+                                                    flag flags = flag::wait_on_close) noexcept
+  {
+    try
+    {
+      spawn_template ret;
+      std::vector<size_t> offsets;
+      offsets.reserve(1 + args.size() + env.size());
+      auto append = [&](path_view_component i) {
+        path_view::zero_terminated_rendered_path<> zpath(i);
+        offsets.push_back(ret._strings.size());
+        ret._strings.insert(ret._strings.end(), zpath.data(), zpath.data() + zpath.size());
+        ret._strings.push_back(0);
+      };
+      append(path);
+      for(auto &i : args)
+      {
+        append(i);
+      }
+      for(auto &i : env)
+      {
+        append(i);
+      }
+      // Only now is _strings at its final address
+      auto component = [&](size_t idx) {
+        const auto *b = ret._strings.data() + offsets[idx];
+        const size_t l = ((idx + 1 < offsets.size()) ? offsets[idx + 1] : ret._strings.size()) - offsets[idx] - 1;
+        return path_view_component(b, l, path_view_component::zero_terminated);
+      };
+      ret._path = path_view(component(0));
+      ret._argv.reserve(args.size() + 2);
+      ret._argv.push_back(ret._strings.data());
+      for(size_t n = 0; n < args.size(); n++)
+      {
+        ret._args.push_back(component(1 + n));
+        ret._argv.push_back(ret._strings.data() + offsets[1 + n]);
+      }
+      ret._argv.push_back(nullptr);
+      ret._envp.reserve(env.size() + 1);
+      for(size_t n = 0; n < env.size(); n++)
+      {
+        ret._env.push_back(component(1 + args.size() + n));
+        ret._envp.push_back(ret._strings.data() + offsets[1 + args.size() + n]);
+      }
+      ret._envp.push_back(nullptr);
+      ret._flags = flags;
+      return {std::move(ret)};
+    }
+    catch(...)
+    {
+      return error_from_exception();
+    }
+  }
+
   /*! Return a process handle referring to the current process.
    */
   static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC const process_handle &current() noexcept;
@@ -230,6 +379,21 @@ public:
   static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<process_handle> launch_process(path_view path, span<path_view_component> args, span<path_view_component> env = *current().environment(), flag flags = flag::wait_on_close) noexcept;
   //! \overload
   static result<process_handle> launch_process(path_view path, span<path_view_component> args, flag flags = flag::wait_on_close) noexcept { return launch_process(path, args, *current().environment(), flags); }
+  /*! \brief Create a new process from a template made by `make_spawn_template()`.
+
+  On Linux, the process is created using `clone(CLONE_VM|CLONE_VFORK|CLONE_PIDFD)`, so the
+  page tables of this process are never copied no matter how much memory it maps, and the
+  pidfd used by `wait()` is obtained atomically with the process. Kernels older than 5.2
+  ignore `CLONE_PIDFD`, in which case the pidfd is opened after the process is created as for
+  `posix_spawn()`, or not at all before 5.3. `posix_spawn()` is used instead if `clone()`
+  refuses to create the process.
+
+  On Windows, this launches the process exactly as the overload taking a path would, and so is
+  no faster.
+
+  \errors Any of the values POSIX `clone()`, `execve()`, `posix_spawn()` or `CreateProcess()` can return.
+  */
+  static LLFIO_HEADERS_ONLY_MEMFUNC_SPEC result<process_handle> launch_process(const spawn_template &t) noexcept;
 };
 
 inline std::ostream &operator<<(std::ostream &s, const process_handle::flag &v)
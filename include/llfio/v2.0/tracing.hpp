@@ -0,0 +1,296 @@
+/* Binary per-thread event tracing
+(C) 2026 agent <agent@local> (2 commits)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#ifndef LLFIO_TRACING_HPP
+#define LLFIO_TRACING_HPP
+
+#include "config.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+//! \file tracing.hpp Provides low overhead binary event tracing
+
+/*! \def LLFIO_DISABLE_TRACING
+\brief Define to compile out all binary event tracing. The `tracing` namespace still exists,
+but enabling it does nothing.
+*/
+
+LLFIO_V2_NAMESPACE_EXPORT_BEGIN
+
+//! The kind of a traced event
+enum class trace_event_kind : uint16_t
+{
+  unknown = 0,
+
+  read = 1,     //!< `io_handle::read()`. `id` is the native handle, `value` is offset then bytes transferred.
+  write = 2,    //!< `io_handle::write()`. `id` is the native handle, `value` is offset then bytes transferred.
+  barrier = 3,  //!< `io_handle::barrier()`. `id` is the native handle, `value` is offset then bytes barriered.
+
+  map = 16,    //!< A memory map was created. `id` is the backing native handle, `value` is the length then the address.
+  unmap = 17,  //!< A memory map was destroyed. `id` is the address, `value` is the reservation.
+
+  lock = 32,    //!< A byte range lock was taken. `id` is the native handle, `value` is the offset then bytes locked.
+  unlock = 33,  //!< A byte range lock was released, an instant event. `id` is the native handle, `value` is the offset.
+
+  thread_pool_work = 48,  //!< A dynamic thread pool work item executed. `id` is the work item, `value` is the work value.
+
+  user = 1024  //!< The first value available for user defined events.
+};
+
+//! The phase of a traced event
+enum class trace_event_phase : uint8_t
+{
+  begin = 0,   //!< The operation began.
+  end = 1,     //!< The operation ended.
+  instant = 2  //!< A point in time event with no duration.
+};
+
+/*! \struct trace_event
+\brief A single binary trace event, exactly 32 bytes. This is also the on-disk format.
+*/
+struct trace_event
+{
+  uint64_t timestamp;  //!< Nanoseconds since the `std::chrono::steady_clock` epoch.
+  uint64_t id;         //!< What the event is about, usually a native handle or an address.
+  uint64_t value;      //!< An event specific value, usually an offset or a byte count.
+  uint32_t thread_id;  //!< A small integer uniquely identifying the thread for the lifetime of the process.
+  trace_event_kind kind;
+  trace_event_phase phase;
+  uint8_t flags;  //!< Bit 0 is set if the operation failed.
+};
+static_assert(sizeof(trace_event) == 32, "trace_event is not 32 bytes in size!");
+
+//! Returns a string describing a trace event kind
+inline const char *to_string(trace_event_kind kind) noexcept
+{
+  switch(kind)
+  {
+  case trace_event_kind::unknown:
+    break;
+  case trace_event_kind::read:
+    return "read";
+  case trace_event_kind::write:
+    return "write";
+  case trace_event_kind::barrier:
+    return "barrier";
+  case trace_event_kind::map:
+    return "map";
+  case trace_event_kind::unmap:
+    return "unmap";
+  case trace_event_kind::lock:
+    return "lock";
+  case trace_event_kind::unlock:
+    return "unlock";
+  case trace_event_kind::thread_pool_work:
+    return "thread_pool_work";
+  case trace_event_kind::user:
+    return "user";
+  }
+  return ((uint16_t) kind >= (uint16_t) trace_event_kind::user) ? "user" : "unknown";
+}
+
+namespace detail
+{
+  /* Each thread writes into its own single producer single consumer ring, so recording an event
+  is a handful of relaxed stores and one release store. Only the thread draining the rings takes
+  a lock.
+  */
+  struct trace_thread_buffer
+  {
+    static constexpr size_t capacity = 4096;  // must be a power of two
+
+    std::atomic<uint64_t> head{0};  // written only by the owning thread
+    char _pad1[64 - sizeof(std::atomic<uint64_t>)];
+    std::atomic<uint64_t> tail{0};  // written only by the draining thread
+    char _pad2[64 - sizeof(std::atomic<uint64_t>)];
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<bool> exited{false};
+    uint32_t thread_id{0};
+    trace_thread_buffer *next{nullptr};
+    trace_event events[capacity];
+  };
+  struct trace_thread_state
+  {
+    trace_thread_buffer *buffer;
+    bool finished;  // thread is exiting, discard any further events
+  };
+  inline trace_thread_state &trace_this_thread() noexcept
+  {
+    static LLFIO_THREAD_LOCAL trace_thread_state v;
+    return v;
+  }
+  inline std::atomic<bool> &trace_enabled_flag() noexcept
+  {
+    static std::atomic<bool> v{false};
+    return v;
+  }
+  LLFIO_HEADERS_ONLY_FUNC_SPEC trace_thread_buffer *trace_register_this_thread() noexcept;
+}  // namespace detail
+
+//! \brief Low overhead binary event tracing of i/o, mapping, locking and thread pool operations.
+namespace tracing
+{
+  //! Set in `trace_event::flags` if the operation failed
+  static constexpr uint8_t flag_failed = 1;
+
+  //! True if events are currently being recorded
+  inline bool is_enabled() noexcept
+  {
+#ifdef LLFIO_DISABLE_TRACING
+    return false;
+#else
+    return detail::trace_enabled_flag().load(std::memory_order_relaxed);
+#endif
+  }
+  /*! \brief Begin or cease recording events.
+
+  Each thread which records an event lazily allocates a ring of 4096 events (128Kb), and
+  if that ring is full when an event is recorded, the event is counted as dropped. Rings
+  must therefore be regularly emptied by `drain()`, or use `algorithm::trace_recorder` which
+  does so from a background thread into a memory mapped file.
+  */
+  LLFIO_HEADERS_ONLY_FUNC_SPEC void enable(bool v) noexcept;
+
+  //! Returns the current time as a trace timestamp
+  inline uint64_t now() noexcept { return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+
+  //! Record an event for the calling thread, if tracing is enabled.
+  inline void record(trace_event_kind kind, trace_event_phase phase, uint64_t id, uint64_t value, uint8_t flags = 0) noexcept
+  {
+#ifndef LLFIO_DISABLE_TRACING
+    if(!is_enabled())
+    {
+      return;
+    }
+    auto &tls = detail::trace_this_thread();
+    auto *buffer = tls.buffer;
+    if(buffer == nullptr)
+    {
+      if(tls.finished || (buffer = detail::trace_register_this_thread()) == nullptr)
+      {
+        return;
+      }
+    }
+    const auto head = buffer->head.load(std::memory_order_relaxed);
+    if(head - buffer->tail.load(std::memory_order_acquire) >= detail::trace_thread_buffer::capacity)
+    {
+      buffer->dropped.store(buffer->dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      return;
+    }
+    auto &ev = buffer->events[head & (detail::trace_thread_buffer::capacity - 1)];
+    ev.timestamp = now();
+    ev.id = id;
+    ev.value = value;
+    ev.thread_id = buffer->thread_id;
+    ev.kind = kind;
+    ev.phase = phase;
+    ev.flags = flags;
+    buffer->head.store(head + 1, std::memory_order_release);
+#else
+    (void) kind;
+    (void) phase;
+    (void) id;
+    (void) value;
+    (void) flags;
+#endif
+  }
+
+  /*! \brief Move up to `max` recorded events from all threads into `out`, returning the number moved.
+
+  Events from any one thread appear in the order recorded, but events from different threads are
+  interleaved arbitrarily. Sort by timestamp if a total order is needed. The rings of threads which
+  have exited are freed once emptied. Concurrent calls serialise.
+  */
+  LLFIO_HEADERS_ONLY_FUNC_SPEC size_t drain(trace_event *out, size_t max) noexcept;
+
+  //! Returns the total number of events dropped because a thread's ring was full
+  LLFIO_HEADERS_ONLY_FUNC_SPEC uint64_t dropped() noexcept;
+}  // namespace tracing
+
+namespace detail
+{
+  /* RAII helper emitting a begin event on construction and a matching end event on
+  finish. If never finished, the end event is marked as failed on destruction, as that
+  is usually an early error return. Costs one relaxed load when tracing is disabled.
+  */
+  class trace_scope
+  {
+#ifndef LLFIO_DISABLE_TRACING
+    trace_event_kind _kind;
+    uint64_t _id;
+    bool _active;
+#endif
+
+  public:
+    trace_scope(const trace_scope &) = delete;
+    trace_scope(trace_scope &&) = delete;
+    trace_scope &operator=(const trace_scope &) = delete;
+    trace_scope &operator=(trace_scope &&) = delete;
+#ifndef LLFIO_DISABLE_TRACING
+    trace_scope(trace_event_kind kind, uint64_t id, uint64_t value) noexcept
+        : _kind(kind)
+        , _id(id)
+        , _active(tracing::is_enabled())
+    {
+      if(_active)
+      {
+        tracing::record(_kind, trace_event_phase::begin, _id, value);
+      }
+    }
+    ~trace_scope() { finish(0, true); }
+    void finish(uint64_t value, bool failed) noexcept
+    {
+      if(_active)
+      {
+        _active = false;
+        tracing::record(_kind, trace_event_phase::end, _id, value, failed ? tracing::flag_failed : 0);
+      }
+    }
+    template <class R> R &&finish_io(R &&r) noexcept
+    {
+      if(_active)
+      {
+        finish(r ? r.bytes_transferred() : 0, !r);
+      }
+      return static_cast<R &&>(r);
+    }
+#else
+    constexpr trace_scope(trace_event_kind /*unused*/, uint64_t /*unused*/, uint64_t /*unused*/) noexcept {}
+    void finish(uint64_t /*unused*/, bool /*unused*/) noexcept {}
+    template <class R> R &&finish_io(R &&r) noexcept { return static_cast<R &&>(r); }
+#endif
+  };
+}  // namespace detail
+
+LLFIO_V2_NAMESPACE_END
+
+#if LLFIO_HEADERS_ONLY == 1 && !defined(DOXYGEN_SHOULD_SKIP_THIS)
+#define LLFIO_INCLUDED_BY_HEADER 1
+#include "detail/impl/tracing.ipp"
+#undef LLFIO_INCLUDED_BY_HEADER
+#endif
+
+#endif
@@ -22,9 +22,6 @@ Distributed under the Boost Software License, Version 1.0.
           http://www.boost.org/LICENSE_1_0.txt)
 */
 
-//! Seconds to run the benchmark
-static constexpr int BENCHMARK_DURATION = 10;
-
 /* MSVC in Release build on Windows 10.
 
 Note that the IOCP without locking enables IOCP immediate completions.
@@ -365,6 +362,7 @@ completion i/o min 1300 max 1.40714e+06 mean 23037 stddev 15035.4
 #define LLFIO_ENABLE_TEST_IO_MULTIPLEXERS 1
 
 #include "../../include/llfio/llfio.hpp"
+#include "../benchmark_harness.hpp"
 
 #include "quickcpplib/algorithm/small_prng.hpp"
 
@@ -391,6 +389,8 @@ completion i/o min 1300 max 1.40714e+06 mean 23037 stddev 15035.4
 
 namespace llfio = LLFIO_V2_NAMESPACE;
 
+static benchmark_harness::harness harness("benchmark-async");
+
 struct test_results
 {
   int handles{0};
@@ -400,6 +400,8 @@ struct test_results
     double min{0}, mean{0}, max{0}, _50{0}, _95{0}, _99{0}, _999{0}, _9999{0}, variance{0};
   } initiate, completion, total;
   size_t total_readings{0};
+  double elapsed{0};  // seconds
+  benchmark_harness::latency_histogram total_latency;
 };
 
 LLFIO_TEMPLATE(class C, class... Args)
@@ -502,7 +504,7 @@ test_results do_benchmark(int handles, Args &&... args)
       // Reap the completions
       ios.check();
     }
-    if(std::chrono::duration_cast<std::chrono::seconds>(timings[0].back().initiate - timings[0].front().initiate).count() >= (doing_warm_up ? 3U : BENCHMARK_DURATION))
+    if(timings[0].back().initiate - timings[0].front().initiate >= (doing_warm_up ? harness.warmup : harness.duration))
     {
       latch = -1;
       break;
@@ -523,6 +525,7 @@ test_results do_benchmark(int handles, Args &&... args)
   ret.creation = ((double) std::chrono::duration_cast<std::chrono::nanoseconds>(create2 - create1).count()) / handles / 1000000000.0;
   ret.cancel = ((double) std::chrono::duration_cast<std::chrono::nanoseconds>(cancel2 - cancel1).count()) / handles / 1000000000.0;
   ret.destruction = ((double) std::chrono::duration_cast<std::chrono::nanoseconds>(destroy2 - destroy1).count()) / handles / 1000000000.0;
+  ret.elapsed = ((double) std::chrono::duration_cast<std::chrono::nanoseconds>(timings[0].back().initiate - timings[0].front().initiate).count()) / 1000000000.0;
 
   ret.initiate.min = DBL_MAX;
   ret.completion.min = DBL_MAX;
@@ -563,6 +566,7 @@ test_results do_benchmark(int handles, Args &&... args)
       ret.total.mean += timing.ns_total(overhead);
       ret.initiate.mean += timing.ns_initiate(overhead);
       ret.completion.mean += timing.ns_completion(overhead);
+      ret.total_latency.record((uint64_t) std::max(timing.ns_total(overhead), 0.0));
       ++ret.total_readings;
     }
     std::sort(reader.begin(), reader.end(), [&](const timing_info &a, const timing_info &b) { return a.ns_total(overhead) < b.ns_total(overhead); });
@@ -619,6 +623,11 @@ test_results do_benchmark(int handles, Args &&... args)
 
 template <class C, class... Args> void benchmark(llfio::path_view csv, size_t max_handles, const char *desc, Args &&... args)
 {
+  if(!harness.selected(desc))
+  {
+    return;
+  }
+  max_handles = harness.max_concurrency(max_handles);
   std::vector<test_results> results;
   for(int n = 1; n <= max_handles; n <<= 2)
   {
@@ -634,6 +643,9 @@ template <class C, class... Args> void benchmark(llfio::path_view csv, size_t ma
     std::cout << "\ncompletion i/o min " << res.completion.min << " max " << res.completion.max << " mean " << res.completion.mean << " stddev " << sqrt(res.completion.variance);
     std::cout << "\n             @ 50% " << res.completion._50 << " @ 95% " << res.completion._95 << " @ 99% " << res.completion._99 << " @ 99.9% " << res.completion._999 << " @ 99.99% " << res.completion._9999;
     std::cout << "\n   total results collected = " << res.total_readings << std::endl;
+    harness.add(std::string(desc) + " with " + std::to_string(n) + " handles", "i/o per sec", (res.elapsed > 0) ? (res.total_readings / res.elapsed) : 0.0, true,
+                res.total_latency)
+    .parameters = {{"handles", (double) n}, {"creation_secs", res.creation}, {"cancel_secs", res.cancel}, {"destruction_secs", res.destruction}};
   }
   std::ofstream of(csv.path());
   of << "Handles";
@@ -1123,19 +1135,37 @@ struct benchmark_asio_pipe
 };
 #endif
 
-int main(void)
+int main(int argc, char *argv[])
 {
-  std::cout << "Warming up ..." << std::endl;
-  do_benchmark<benchmark_llfio<>>(-1, []() -> llfio::io_multiplexer_ptr { return llfio::test::multiplexer_null(2, true).value(); });
+  const auto parsed = harness.parse(argc, argv);
+  if(parsed != benchmark_harness::parse_result::run)
+  {
+    return (parsed == benchmark_harness::parse_result::help) ? 0 : 1;
+  }
+  if(harness.warmup.count() > 0)
+  {
+    std::cout << "Warming up ..." << std::endl;
+    do_benchmark<benchmark_llfio<>>(-1, []() -> llfio::io_multiplexer_ptr { return llfio::test::multiplexer_null(2, true).value(); });
+  }
   benchmark<benchmark_llfio<>>("llfio-null-unsynchronised.csv", 64, "Null i/o multiplexer unsynchronised", //
     []() -> llfio::io_multiplexer_ptr { return llfio::test::multiplexer_null(1, false).value(); });
   benchmark<benchmark_llfio<>>("llfio-null-synchronised.csv", 64, "Null i/o multiplexer synchronised", //
     []() -> llfio::io_multiplexer_ptr { return llfio::test::multiplexer_null(2, true).value(); });
+  {
+    // Measure the overhead of binary event tracing, compare with llfio-null-unsynchronised.csv
+    auto recorder = llfio::algorithm::trace_recorder::start({}, "benchmark-async.trace").value();
+    benchmark<benchmark_llfio<>>("llfio-null-unsynchronised-traced.csv", 64, "Null i/o multiplexer unsynchronised with tracing", //
+      []() -> llfio::io_multiplexer_ptr { return llfio::test::multiplexer_null(1, false).value(); });
+    recorder.stop().value();
+  }
 
 #ifdef _WIN32
-  std::cout << "\nWarming up ..." << std::endl;
-  do_benchmark<benchmark_llfio<llfio::pipe_handle>>(-1, //
-    []() -> llfio::io_multiplexer_ptr { return llfio::test::multiplexer_win_iocp(2, true).value(); });
+  if(harness.warmup.count() > 0)
+  {
+    std::cout << "\nWarming up ..." << std::endl;
+    do_benchmark<benchmark_llfio<llfio::pipe_handle>>(-1, //
+      []() -> llfio::io_multiplexer_ptr { return llfio::test::multiplexer_win_iocp(2, true).value(); });
+  }
   // No locking, enable IOCP immediate completions. ASIO can't compete with this.
   benchmark<benchmark_llfio<llfio::pipe_handle>>("llfio-pipe-handle-unsynchronised.csv", 64, "llfio::pipe_handle and IOCP unsynchronised", //
     []() -> llfio::io_multiplexer_ptr { return llfio::test::multiplexer_win_iocp(1, false).value(); });
@@ -1145,10 +1175,13 @@ int main(void)
 #endif
 
 #if ENABLE_ASIO
-  std::cout << "\nWarming up ..." << std::endl;
-  do_benchmark<benchmark_asio_pipe>(-1, 2);
+  if(harness.warmup.count() > 0)
+  {
+    std::cout << "\nWarming up ..." << std::endl;
+    do_benchmark<benchmark_asio_pipe>(-1, 2);
+  }
   benchmark<benchmark_asio_pipe>("asio-pipe-handle-synchronised.csv", 64, "ASIO with pipes synchronised", 2);
 #endif
 
-  return 0;
+  return harness.write() ? 0 : 1;
 }
\ No newline at end of file
@@ -0,0 +1,387 @@
+/* Compares the JSON results of two benchmark runs, flagging regressions
+(C) 2026 agent <agent@local> (2 commits)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+/* Usage: benchmark-compare [--threshold=<percent>] <baseline.json> <candidate.json>
+
+Results are matched by name. A result regresses if its value worsened by more
+than the threshold (default 5%), or if its 99th percentile latency rose by more
+than the threshold. Exits with 1 if anything regressed, 2 on error, else 0.
+*/
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Just enough JSON to read what benchmark_harness.hpp writes
+struct json_value
+{
+  enum class kind
+  {
+    null,
+    boolean,
+    number,
+    string,
+    array,
+    object
+  } type{kind::null};
+  bool boolean{false};
+  double number{0};
+  std::string string;
+  std::vector<json_value> array;
+  std::vector<std::pair<std::string, json_value>> object;
+
+  const json_value *find(const char *key) const
+  {
+    for(auto &i : object)
+    {
+      if(i.first == key)
+      {
+        return &i.second;
+      }
+    }
+    return nullptr;
+  }
+};
+
+class json_parser
+{
+  const char *_p, *_end;
+
+  [[noreturn]] void _fail(const char *what) { throw std::runtime_error(std::string("JSON parse error: ") + what); }
+  void _skip()
+  {
+    while(_p < _end && (*_p == ' ' || *_p == '\t' || *_p == '\r' || *_p == '\n'))
+    {
+      _p++;
+    }
+  }
+  bool _consume(const char *token)
+  {
+    const auto len = strlen(token);
+    if((size_t) (_end - _p) >= len && 0 == strncmp(_p, token, len))
+    {
+      _p += len;
+      return true;
+    }
+    return false;
+  }
+  std::string _string()
+  {
+    std::string ret;
+    _p++;  // opening quote
+    while(_p < _end && *_p != '"')
+    {
+      if(*_p == '\\')
+      {
+        if(++_p == _end)
+        {
+          break;
+        }
+        switch(*_p)
+        {
+        case 'n':
+          ret.push_back('\n');
+          break;
+        case 't':
+          ret.push_back('\t');
+          break;
+        case 'r':
+          ret.push_back('\r');
+          break;
+        case 'u':
+          if(_end - _p < 5)
+          {
+            _fail("truncated escape");
+          }
+          ret.push_back((char) strtol(std::string(_p + 1, 4).c_str(), nullptr, 16));
+          _p += 4;
+          break;
+        default:
+          ret.push_back(*_p);
+          break;
+        }
+        _p++;
+      }
+      else
+      {
+        ret.push_back(*_p++);
+      }
+    }
+    if(_p == _end)
+    {
+      _fail("unterminated string");
+    }
+    _p++;  // closing quote
+    return ret;
+  }
+
+public:
+  json_parser(const char *begin, const char *end)
+      : _p(begin)
+      , _end(end)
+  {
+  }
+
+  json_value parse()
+  {
+    json_value ret;
+    _skip();
+    if(_p == _end)
+    {
+      _fail("unexpected end");
+    }
+    if(*_p == '{')
+    {
+      ret.type = json_value::kind::object;
+      _p++;
+      _skip();
+      if(_p < _end && *_p == '}')
+      {
+        _p++;
+        return ret;
+      }
+      for(;;)
+      {
+        _skip();
+        if(_p == _end || *_p != '"')
+        {
+          _fail("expected key");
+        }
+        auto key = _string();
+        _skip();
+        if(!_consume(":"))
+        {
+          _fail("expected :");
+        }
+        ret.object.emplace_back(std::move(key), parse());
+        _skip();
+        if(_consume(","))
+        {
+          continue;
+        }
+        if(_consume("}"))
+        {
+          return ret;
+        }
+        _fail("expected , or }");
+      }
+    }
+    if(*_p == '[')
+    {
+      ret.type = json_value::kind::array;
+      _p++;
+      _skip();
+      if(_p < _end && *_p == ']')
+      {
+        _p++;
+        return ret;
+      }
+      for(;;)
+      {
+        ret.array.push_back(parse());
+        _skip();
+        if(_consume(","))
+        {
+          continue;
+        }
+        if(_consume("]"))
+        {
+          return ret;
+        }
+        _fail("expected , or ]");
+      }
+    }
+    if(*_p == '"')
+    {
+      ret.type = json_value::kind::string;
+      ret.string = _string();
+      return ret;
+    }
+    if(_consume("true"))
+    {
+      ret.type = json_value::kind::boolean;
+      ret.boolean = true;
+      return ret;
+    }
+    if(_consume("false"))
+    {
+      ret.type = json_value::kind::boolean;
+      return ret;
+    }
+    if(_consume("null"))
+    {
+      return ret;
+    }
+    char *e = nullptr;
+    ret.number = strtod(_p, &e);
+    if(e == _p)
+    {
+      _fail("unexpected character");
+    }
+    ret.type = json_value::kind::number;
+    _p = e;
+    return ret;
+  }
+};
+
+static json_value load(const char *path)
+{
+  std::ifstream in(path, std::ios::binary);
+  if(!in)
+  {
+    throw std::runtime_error(std::string("could not open ") + path);
+  }
+  std::stringstream ss;
+  ss << in.rdbuf();
+  const auto s = ss.str();
+  auto ret = json_parser(s.data(), s.data() + s.size()).parse();
+  if(ret.type != json_value::kind::object || ret.find("results") == nullptr || ret.find("results")->type != json_value::kind::array)
+  {
+    throw std::runtime_error(std::string(path) + " does not contain benchmark results");
+  }
+  return ret;
+}
+
+static double number(const json_value *v, double default_ = NAN)
+{
+  return (v != nullptr && v->type == json_value::kind::number) ? v->number : default_;
+}
+
+int main(int argc, char *argv[])
+{
+  double threshold = 5;
+  std::vector<const char *> paths;
+  for(int n = 1; n < argc; n++)
+  {
+    if(0 == strncmp(argv[n], "--threshold=", 12))
+    {
+      threshold = atof(argv[n] + 12);
+    }
+    else
+    {
+      paths.push_back(argv[n]);
+    }
+  }
+  if(paths.size() != 2)
+  {
+    std::cerr << "Usage: " << argv[0] << " [--threshold=<percent>] <baseline.json> <candidate.json>" << std::endl;
+    return 2;
+  }
+  try
+  {
+    const auto baseline = load(paths[0]), candidate = load(paths[1]);
+    std::cout << "Comparing " << paths[1] << " against baseline " << paths[0] << " with a threshold of " << threshold << "% ...\n" << std::endl;
+    size_t regressions = 0, improvements = 0, unmatched = 0;
+    std::cout << std::setprecision(4);
+    for(auto &c : candidate.find("results")->array)
+    {
+      const auto *name = c.find("name");
+      if(name == nullptr || name->type != json_value::kind::string)
+      {
+        continue;
+      }
+      const json_value *b = nullptr;
+      for(auto &i : baseline.find("results")->array)
+      {
+        const auto *bname = i.find("name");
+        if(bname != nullptr && bname->string == name->string)
+        {
+          b = &i;
+          break;
+        }
+      }
+      if(b == nullptr)
+      {
+        std::cout << "   NEW         " << name->string << std::endl;
+        unmatched++;
+        continue;
+      }
+      const auto *hib = c.find("higher_is_better");
+      const bool higher_is_better = (hib == nullptr || hib->boolean);
+      const double oldv = number(b->find("value")), newv = number(c.find("value"));
+      // Positive change is always better
+      double change = (oldv != 0) ? (100.0 * (newv - oldv) / std::fabs(oldv)) : 0.0;
+      if(!higher_is_better)
+      {
+        change = -change;
+      }
+      double latency_change = NAN;
+      const auto *oldl = b->find("latency_ns"), *newl = c.find("latency_ns");
+      if(oldl != nullptr && newl != nullptr)
+      {
+        const double oldp99 = number(oldl->find("p99")), newp99 = number(newl->find("p99"));
+        if(oldp99 > 0)
+        {
+          latency_change = 100.0 * (newp99 - oldp99) / oldp99;
+        }
+      }
+      const bool regressed = (std::isfinite(change) && change < -threshold) || (std::isfinite(latency_change) && latency_change > threshold);
+      const bool improved = !regressed && ((std::isfinite(change) && change > threshold) || (std::isfinite(latency_change) && latency_change < -threshold));
+      regressions += regressed;
+      improvements += improved;
+      std::cout << (regressed ? "   REGRESSION  " : (improved ? "   improvement " : "   unchanged   ")) << name->string << ": " << oldv << " -> " << newv << " "
+                << (c.find("unit") != nullptr ? c.find("unit")->string : std::string()) << " (" << std::showpos << change << std::noshowpos << "%)";
+      if(std::isfinite(latency_change))
+      {
+        std::cout << ", p99 latency " << number(oldl->find("p99")) << " -> " << number(newl->find("p99")) << " ns (" << std::showpos << latency_change
+                  << std::noshowpos << "%)";
+      }
+      std::cout << std::endl;
+    }
+    for(auto &b : baseline.find("results")->array)
+    {
+      const auto *name = b.find("name");
+      bool found = false;
+      for(auto &c : candidate.find("results")->array)
+      {
+        const auto *cname = c.find("name");
+        if(name != nullptr && cname != nullptr && cname->string == name->string)
+        {
+          found = true;
+          break;
+        }
+      }
+      if(!found && name != nullptr)
+      {
+        std::cout << "   MISSING     " << name->string << std::endl;
+        unmatched++;
+      }
+    }
+    std::cout << "\n" << regressions << " regressions, " << improvements << " improvements, " << unmatched << " unmatched." << std::endl;
+    return (regressions > 0) ? 1 : 0;
+  }
+  catch(const std::exception &e)
+  {
+    std::cerr << "FATAL: " << e.what() << std::endl;
+    return 2;
+  }
+}
@@ -22,22 +22,30 @@ Distributed under the Boost Software License, Version 1.0.
           http://www.boost.org/LICENSE_1_0.txt)
 */
 
-//! Seconds to run the benchmark
-static constexpr unsigned BENCHMARK_DURATION = 10;
-//! Maximum work items to create
+//! Maximum work items to create, unless overridden with --threads
 static constexpr unsigned MAX_WORK_ITEMS = 1024;
 // Size of buffer to SHA256
 static constexpr unsigned SHA256_BUFFER_SIZE = 4096;
+// Size of memory each work item streams through in the memory bandwidth benchmark
+static constexpr size_t MEMORY_BANDWIDTH_BUFFER_SIZE = 16 * 1024 * 1024;
+// Items to process in the parallel for benchmark
+static constexpr size_t PARALLEL_FOR_ITEMS = 16 * 1024 * 1024;
+// Grain of the hand written work items in the parallel for benchmark
+static constexpr size_t PARALLEL_FOR_GRAIN = 4096;
 
 #include "../../include/llfio/llfio.hpp"
+#include "../benchmark_harness.hpp"
 
 #include "quickcpplib/algorithm/small_prng.hpp"
 
 #include <cfloat>
 #include <chrono>
 #include <cmath>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <string>
 #include <thread>
 #include <tuple>
 #include <vector>
@@ -56,6 +64,8 @@ static constexpr unsigned SHA256_BUFFER_SIZE = 4096;
 
 namespace llfio = LLFIO_V2_NAMESPACE;
 
+static benchmark_harness::harness harness("benchmark-dynamic_thread_pool_group");
+
 struct llfio_runner
 {
   std::atomic<bool> cancel{false};
@@ -69,7 +79,7 @@ struct llfio_runner
       delete p;
     }
   }
-  template <class F> void add_workitem(F &&f)
+  template <class F> void add_workitem(F &&f, int numa_node = -1)
   {
     struct workitem final : public llfio::dynamic_thread_pool_group::work_item
     {
@@ -88,6 +98,7 @@ struct llfio_runner
       }
     };
     workitems.push_back(new workitem(this, std::move(f)));
+    workitems.back()->set_numa_node(numa_node);
   }
   std::chrono::microseconds run(unsigned seconds)
   {
@@ -149,6 +160,10 @@ struct asio_runner
 
 template <class Runner> void benchmark(const char *name)
 {
+  if(!harness.selected(name))
+  {
+    return;
+  }
   std::cout << "\nBenchmarking " << name << " ..." << std::endl;
   struct shared_t
   {
@@ -181,11 +196,12 @@ template <class Runner> void benchmark(const char *name)
   std::vector<worker> workers;
   std::vector<std::tuple<size_t, double, unsigned>> results;
   QUICKCPPLIB_NAMESPACE::algorithm::small_prng::small_prng rand;
-  for(size_t items = 1; items <= MAX_WORK_ITEMS; items <<= 1)
+  // Zero work items means warm up with sixteen
+  for(size_t items = (harness.warmup.count() > 0) ? 0 : 1; items <= harness.max_concurrency(MAX_WORK_ITEMS); items = (items == 0) ? 1 : (items << 1))
   {
     shared_t shared;
     workers.clear();
-    for(size_t n = 0; n < items; n++)
+    for(size_t n = 0; n < ((items == 0) ? 16 : items); n++)
     {
       workers.emplace_back(&shared);
       for(size_t i = 0; i < sizeof(worker::buffer); i += 4)
@@ -199,7 +215,13 @@ template <class Runner> void benchmark(const char *name)
     {
       runner.add_workitem([&] { i(); });
     }
-    auto duration = runner.run(BENCHMARK_DURATION);
+    if(items == 0)
+    {
+      std::cout << "   Warming up ..." << std::endl;
+      runner.run((unsigned) harness.warmup.count());
+      continue;
+    }
+    auto duration = runner.run((unsigned) harness.duration.count());
     uint64_t total = 0;
     for(auto &i : workers)
     {
@@ -208,6 +230,8 @@ template <class Runner> void benchmark(const char *name)
     results.emplace_back(items, 1000000.0 * total / duration.count(), shared.max_concurrency);
     std::cout << "   For " << std::get<0>(results.back()) << " work items got " << std::get<1>(results.back()) << " SHA256 hashes/sec with "
               << std::get<2>(results.back()) << " maximum concurrency." << std::endl;
+    harness.add(std::string(name) + " with " + std::to_string(items) + " work items", "SHA256 hashes/sec", std::get<1>(results.back())).parameters = {
+    {"work_items", (double) items}, {"max_concurrency", (double) std::get<2>(results.back())}};
   }
   std::ofstream out(std::string(name) + "_results.csv");
   out << R"("Work items","SHA256 hashes/sec","Max concurrency")";
@@ -218,15 +242,252 @@ template <class Runner> void benchmark(const char *name)
   out << std::endl;
 }
 
-int main(void)
+/* Each work item repeatedly sums a buffer which was first touched by a thread on
+a particular NUMA node, so its pages live on that node. Without NUMA hints, work
+items run wherever, and on multi socket machines much of the bandwidth is
+cross socket. With NUMA hints, work items run on their memory's node.
+*/
+void benchmark_memory_bandwidth()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  if(!harness.selected("Memory bandwidth with NUMA hints") && !harness.selected("Memory bandwidth without NUMA hints"))
+  {
+    return;
+  }
+  const auto nodes = llfio::dynamic_thread_pool_group::numa_nodes();
+  const size_t items = std::thread::hardware_concurrency();
+  std::cout << "\nBenchmarking memory bandwidth with " << items << " work items across " << nodes << " NUMA nodes ..." << std::endl;
+  if(nodes == 1)
+  {
+    std::cout << "   NOTE: This system has a single NUMA node, so NUMA hints will make no difference." << std::endl;
+  }
+  struct chunk_t
+  {
+    int numa_node{-1};
+    std::unique_ptr<uint64_t[]> buffer;
+    uint64_t sum{0}, bytes{0};
+  };
+  std::vector<chunk_t> chunks(items);
+  // First touch every chunk from a kernel thread on the NUMA node we want it on
+  struct first_touch final : public llfio::dynamic_thread_pool_group::work_item
+  {
+    chunk_t *chunk;
+    std::atomic<bool> done{false};
+    explicit first_touch(chunk_t *_chunk)
+        : chunk(_chunk)
+    {
+    }
+    virtual intptr_t next(llfio::deadline & /*unused*/) noexcept override { return done.exchange(true, std::memory_order_relaxed) ? -1 : 1; }
+    virtual llfio::result<void> operator()(intptr_t /*unused*/) noexcept override
+    {
+      chunk->numa_node = llfio::dynamic_thread_pool_group::current_numa_node();
+      for(size_t n = 0; n < MEMORY_BANDWIDTH_BUFFER_SIZE / sizeof(uint64_t); n++)
+      {
+        chunk->buffer[n] = n;
+      }
+      return llfio::success();
+    }
+  };
+  {
+    std::vector<std::unique_ptr<first_touch>> touchers;
+    std::vector<llfio::dynamic_thread_pool_group::work_item *> wis;
+    for(size_t n = 0; n < items; n++)
+    {
+      // Not value initialised, so no pages are faulted in here
+      chunks[n].buffer.reset(new uint64_t[MEMORY_BANDWIDTH_BUFFER_SIZE / sizeof(uint64_t)]);
+      touchers.push_back(std::make_unique<first_touch>(&chunks[n]));
+      wis.push_back(touchers.back().get());
+    }
+    auto group = llfio::make_dynamic_thread_pool_group().value();
+    group->submit(wis).value();
+    group->wait().value();
+  }
+  std::vector<std::tuple<const char *, double>> results;
+  for(bool hinted : {false, true})
+  {
+    const std::string name = hinted ? "Memory bandwidth with NUMA hints" : "Memory bandwidth without NUMA hints";
+    if(!harness.selected(name))
+    {
+      continue;
+    }
+    llfio_runner runner;
+    for(auto &chunk : chunks)
+    {
+      chunk.bytes = 0;
+      runner.add_workitem(
+      [&chunk] {
+        uint64_t sum = 0;
+        for(size_t n = 0; n < MEMORY_BANDWIDTH_BUFFER_SIZE / sizeof(uint64_t); n++)
+        {
+          sum += chunk.buffer[n];
+        }
+        chunk.sum = sum;
+        chunk.bytes += MEMORY_BANDWIDTH_BUFFER_SIZE;
+      },
+      hinted ? chunk.numa_node : -1);
+    }
+    auto duration = runner.run((unsigned) harness.duration.count());
+    uint64_t total = 0;
+    for(auto &chunk : chunks)
+    {
+      total += chunk.bytes;
+    }
+    results.emplace_back(hinted ? "With NUMA hints" : "Without NUMA hints", (double) total / duration.count() / 1000.0);
+    std::cout << "   " << std::get<0>(results.back()) << " got " << std::get<1>(results.back()) << " Gb/sec." << std::endl;
+    harness.add(name, "Gb/sec", std::get<1>(results.back())).parameters = {{"work_items", (double) items}, {"numa_nodes", (double) nodes}};
+  }
+  std::ofstream out("memory_bandwidth_results.csv");
+  out << R"("NUMA hints","Gb/sec")";
+  for(auto &i : results)
+  {
+    out << "\n\"" << std::get<0>(i) << "\"," << std::get<1>(i);
+  }
+  out << std::endl;
+}
+
+/* Compares hand written work items each processing a fixed slice of the range,
+which is the pattern users of dynamic_thread_pool_group had to write themselves,
+against parallel_reduce() with the same grain and with an adaptive grain. The
+skewed workload's cost per item grows with its index, so fixed slices finish
+unevenly.
+*/
+void benchmark_parallel_for()
 {
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  std::cout << "\nBenchmarking parallel_reduce() against hand written work items ..." << std::endl;
+  static const auto cost = [](size_t n, bool skewed) -> uint64_t {
+    const size_t rounds = skewed ? (1 + n * 64 / PARALLEL_FOR_ITEMS) : 8;
+    uint64_t x = n;
+    for(size_t i = 0; i < rounds; i++)
+    {
+      x ^= x << 13;
+      x ^= x >> 7;
+      x ^= x << 17;
+    }
+    return x;
+  };
+  struct hand_written final : public llfio::dynamic_thread_pool_group::work_item
+  {
+    size_t begin, end;
+    bool skewed;
+    uint64_t sum{0};
+    hand_written(size_t _begin, size_t _end, bool _skewed)
+        : begin(_begin)
+        , end(_end)
+        , skewed(_skewed)
+    {
+    }
+    virtual intptr_t next(llfio::deadline & /*unused*/) noexcept override { return (begin < end) ? 1 : -1; }
+    virtual llfio::result<void> operator()(intptr_t /*unused*/) noexcept override
+    {
+      const auto e = std::min(end, begin + PARALLEL_FOR_GRAIN);
+      for(; begin < e; begin++)
+      {
+        sum += cost(begin, skewed);
+      }
+      return llfio::success();
+    }
+  };
+  auto run_hand_written = [](bool skewed) -> uint64_t {
+    const size_t items = std::thread::hardware_concurrency();
+    std::vector<std::unique_ptr<hand_written>> workers;
+    std::vector<llfio::dynamic_thread_pool_group::work_item *> wis;
+    for(size_t n = 0; n < items; n++)
+    {
+      workers.push_back(std::make_unique<hand_written>(PARALLEL_FOR_ITEMS * n / items, PARALLEL_FOR_ITEMS * (n + 1) / items, skewed));
+      wis.push_back(workers.back().get());
+    }
+    auto group = llfio::make_dynamic_thread_pool_group().value();
+    group->submit(wis).value();
+    group->wait().value();
+    uint64_t ret = 0;
+    for(auto &i : workers)
+    {
+      ret += i->sum;
+    }
+    return ret;
+  };
+  auto run_parallel_reduce = [](bool skewed, size_t grain) -> uint64_t {
+    return llfio::algorithm::parallel_reduce(
+           0, PARALLEL_FOR_ITEMS, grain, (uint64_t) 0,
+           [skewed](size_t begin, size_t end, uint64_t &sum) {
+             for(size_t n = begin; n < end; n++)
+             {
+               sum += cost(n, skewed);
+             }
+           },
+           [](uint64_t a, uint64_t b) { return a + b; })
+    .value();
+  };
+  std::vector<std::tuple<std::string, double>> results;
+  for(bool skewed : {false, true})
+  {
+    const char *workload = skewed ? "skewed" : "uniform";
+    uint64_t expected = 0;
+    auto time = [&](const char *name, auto &&f) {
+      if(!harness.selected(std::string(name) + " (" + workload + ")"))
+      {
+        return;
+      }
+      // Best of five
+      double best = 0;
+      for(size_t n = 0; n < 5; n++)
+      {
+        auto begin = std::chrono::steady_clock::now();
+        auto sum = f();
+        auto end = std::chrono::steady_clock::now();
+        if(expected == 0)
+        {
+          expected = sum;
+        }
+        else if(sum != expected)
+        {
+          std::cerr << "FATAL: " << name << " calculated the wrong answer" << std::endl;
+          abort();
+        }
+        best = std::max(best, (double) PARALLEL_FOR_ITEMS / std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count());
+      }
+      results.emplace_back(std::string(name) + " (" + workload + ")", best);
+      std::cout << "   " << std::get<0>(results.back()) << " got " << best << " million items/sec." << std::endl;
+      harness.add(std::get<0>(results.back()), "million items/sec", best);
+    };
+    time("Hand written work items", [&] { return run_hand_written(skewed); });
+    time("parallel_reduce() with same grain", [&] { return run_parallel_reduce(skewed, PARALLEL_FOR_GRAIN); });
+    time("parallel_reduce() with adaptive grain", [&] { return run_parallel_reduce(skewed, 0); });
+  }
+  std::ofstream out("parallel_for_results.csv");
+  out << R"("Implementation","Million items/sec")";
+  for(auto &i : results)
+  {
+    out << "\n\"" << std::get<0>(i) << "\"," << std::get<1>(i);
+  }
+  out << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+  const auto parsed = harness.parse(argc, argv);
+  if(parsed != benchmark_harness::parse_result::run)
+  {
+    return (parsed == benchmark_harness::parse_result::help) ? 0 : 1;
+  }
   std::string llfio_name("llfio (");
   llfio_name.append(llfio::dynamic_thread_pool_group::implementation_description());
   llfio_name.push_back(')');
   benchmark<llfio_runner>(llfio_name.c_str());
+  // Compare the alternative concurrency controller, if there is one
+  using concurrency_controller_type = llfio::dynamic_thread_pool_group::concurrency_controller_type;
+  if(llfio::dynamic_thread_pool_group::concurrency_controller(concurrency_controller_type::schedstat_pressure) ==
+     concurrency_controller_type::schedstat_pressure)
+  {
+    benchmark<llfio_runner>((llfio_name + " with schedstat and pressure controller").c_str());
+    llfio::dynamic_thread_pool_group::concurrency_controller(concurrency_controller_type::proc_task_stat);
+  }
+  benchmark_memory_bandwidth();
+  benchmark_parallel_for();
 
 #if ENABLE_ASIO
   benchmark<asio_runner>("asio");
 #endif
-  return 0;
+  return harness.write() ? 0 : 1;
 }
\ No newline at end of file
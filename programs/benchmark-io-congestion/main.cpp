@@ -22,9 +22,18 @@ Distributed under the Boost Software License, Version 1.0.
           http://www.boost.org/LICENSE_1_0.txt)
 */
 
-//! Seconds to run the benchmark
-static constexpr unsigned BENCHMARK_DURATION = 10;
-//! Maximum work items to create
+/* To compare pacing policies on a slow device, place the test file on a throttled
+loopback device by supplying its mount point as the first argument, e.g. on Linux with
+cgroups v2:
+
+    truncate -s 5G /tmp/slow.img && sudo losetup -f --show /tmp/slow.img
+    sudo mkfs.ext4 /dev/loop0 && sudo mount /dev/loop0 /mnt/slow
+    echo "7:0 rbps=104857600 riops=2000" | sudo tee /sys/fs/cgroup/<your cgroup>/io.max
+
+and drop the page cache between runs (echo 3 > /proc/sys/vm/drop_caches).
+*/
+
+//! Maximum work items to create, unless overridden with --threads
 static constexpr unsigned MAX_WORK_ITEMS = 4096;
 // Size of buffer to SHA256
 static constexpr unsigned SHA256_BUFFER_SIZE = 4 * 1024;  // 64Kb
@@ -32,14 +41,17 @@ static constexpr unsigned SHA256_BUFFER_SIZE = 4 * 1024;  // 64Kb
 static constexpr unsigned long long TEST_FILE_SIZE = 4ULL * 1024 * 1024 * 1024;  // 4Gb
 
 #include "../../include/llfio/llfio.hpp"
+#include "../benchmark_harness.hpp"
 
 #include "quickcpplib/algorithm/small_prng.hpp"
 
 #include <cfloat>
+#include <cstdlib>
 #include <chrono>
 #include <cmath>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <thread>
 #include <tuple>
 #include <vector>
@@ -58,6 +70,8 @@ static constexpr unsigned long long TEST_FILE_SIZE = 4ULL * 1024 * 1024 * 1024;
 
 namespace llfio = LLFIO_V2_NAMESPACE;
 
+static benchmark_harness::harness harness("benchmark-io-congestion", std::chrono::seconds(10), "[directory for test file]");
+
 struct benchmark_results
 {
   std::chrono::microseconds duration;
@@ -172,7 +186,7 @@ struct llfio_runner_unpaced
   }
 };
 
-struct llfio_runner_paced
+template <llfio::dynamic_thread_pool_group::io_aware_work_item::pacing_policy Policy> struct llfio_runner_paced
 {
   std::atomic<bool> cancel{false};
   llfio::dynamic_thread_pool_group_ptr group = llfio::make_dynamic_thread_pool_group().value();
@@ -198,7 +212,7 @@ struct llfio_runner_paced
       llfio_runner_paced *parent;
       F f;
       workitem(llfio_runner_paced *_parent, F &&_f)
-          : llfio::dynamic_thread_pool_group::io_aware_work_item({&_parent->awareness, 1})
+          : llfio::dynamic_thread_pool_group::io_aware_work_item({&_parent->awareness, 1}, Policy)
           , parent(_parent)
           , f(std::move(_f))
       {
@@ -206,8 +220,9 @@ struct llfio_runner_paced
       virtual intptr_t io_aware_next(llfio::deadline &d) noexcept override
       {
 #if 1
+        // Only report large changes, the latency policy adjusts pacing every 10ms
         auto last_pace = parent->last_pace.load(std::memory_order_relaxed);
-        if(last_pace != d.nsecs)
+        if((last_pace == 0) != (d.nsecs == 0) || (uint64_t) std::abs(last_pace - (int64_t) d.nsecs) > (uint64_t) last_pace / 4)
         {
           parent->last_pace.store(d.nsecs, std::memory_order_relaxed);
           std::cout << "Pacing work by milliseconds " << (d.nsecs / 1000000.0) << std::endl;
@@ -274,7 +289,7 @@ struct asio_runner
       }
     };
     auto cleanup = llfio::make_scope_exit(do_cleanup);
-    for(size_t n = 0; n < MAX_WORK_ITEMS; n++)
+    for(size_t n = 0; n < harness.max_concurrency(MAX_WORK_ITEMS); n++)
     {
       try
       {
@@ -301,10 +316,18 @@ template <class Runner> void benchmark(llfio::mapped_file_handle &maph, const ch
 {
   if(name != nullptr)
   {
+    if(!harness.selected(name))
+    {
+      return;
+    }
     std::cout << "\nBenchmarking " << name << " ..." << std::endl;
   }
   else
   {
+    if(harness.warmup.count() == 0)
+    {
+      return;
+    }
     std::cout << "\nWarming up ..." << std::endl;
   }
   struct shared_t
@@ -312,6 +335,8 @@ template <class Runner> void benchmark(llfio::mapped_file_handle &maph, const ch
     llfio::span<llfio::byte> ioregion;
     std::atomic<unsigned> concurrency{0};
     std::atomic<unsigned> max_concurrency{0};
+    std::mutex latencies_lock;
+    benchmark_harness::latency_histogram latencies;
   };
   struct worker
   {
@@ -319,9 +344,24 @@ template <class Runner> void benchmark(llfio::mapped_file_handle &maph, const ch
     QUICKCPPLIB_NAMESPACE::algorithm::small_prng::small_prng rand;
     QUICKCPPLIB_NAMESPACE::algorithm::hash::sha256_hash::result_type hash;
     uint64_t count{0};
+    // Latencies in nanoseconds are batched here, as a histogram per work item would page in
+    // tens of megabytes at the higher work item counts
+    uint32_t latencies[64];
+    size_t latencies_count{0};
+
+    void flush_latencies()
+    {
+      std::lock_guard<std::mutex> g(shared->latencies_lock);
+      for(size_t n = 0; n < latencies_count; n++)
+      {
+        shared->latencies.record(latencies[n]);
+      }
+      latencies_count = 0;
+    }
 
     void operator()()
     {
+      const auto begin = std::chrono::steady_clock::now();
       auto concurrency = shared->concurrency.fetch_add(1, std::memory_order_relaxed) + 1;
       if(concurrency > shared->max_concurrency.load(std::memory_order_relaxed))
       {
@@ -336,6 +376,12 @@ template <class Runner> void benchmark(llfio::mapped_file_handle &maph, const ch
       hash = QUICKCPPLIB_NAMESPACE::algorithm::hash::sha256_hash::hash(shared->ioregion.data() + offset, SHA256_BUFFER_SIZE);
       count++;
       shared->concurrency.fetch_sub(1, std::memory_order_relaxed);
+      const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+      latencies[latencies_count++] = (uint32_t) std::min(ns, (decltype(ns)) UINT32_MAX);
+      if(latencies_count == sizeof(latencies) / sizeof(latencies[0]))
+      {
+        flush_latencies();
+      }
     }
     explicit worker(shared_t *_shared, uint32_t mythreadidx)
         : shared(_shared)
@@ -350,15 +396,15 @@ template <class Runner> void benchmark(llfio::mapped_file_handle &maph, const ch
     double throughput;
     size_t paged_in;
     unsigned max_concurrency;
+    double mean_latency, p99_latency, max_latency;  // microseconds
   };
   std::vector<result_t> results;
-  for(size_t items = 1; items <= MAX_WORK_ITEMS; items <<= 1)
+  const size_t max_items = harness.max_concurrency(MAX_WORK_ITEMS);
+  // Warming up runs once, with sixteen work items or fewer
+  for(size_t items = (name == nullptr) ? std::min(max_items, (size_t) 16) : 1; items <= max_items; items <<= 1)
   {
-    if(name == nullptr && items != 16)
-    {
-      continue;
-    }
-    shared_t shared{maph.map().as_span()};
+    shared_t shared;
+    shared.ioregion = maph.map().as_span();
     workers.clear();
     for(uint32_t n = 0; n < items; n++)
     {
@@ -369,16 +415,29 @@ template <class Runner> void benchmark(llfio::mapped_file_handle &maph, const ch
     {
       runner.add_workitem([&] { i(); });
     }
-    auto out = runner.run(BENCHMARK_DURATION);
+    auto out = runner.run((unsigned) ((name == nullptr) ? harness.warmup : harness.duration).count());
+    if(name == nullptr)
+    {
+      break;
+    }
     uint64_t total = 0;
     for(auto &i : workers)
     {
       total += i.count;
+      i.flush_latencies();
     }
-    results.push_back({items, 1000000.0 * total / out.duration.count(), out.memory_usage.total_address_space_paged_in, shared.max_concurrency});
+    const auto &latencies = shared.latencies;
+    results.push_back({items, 1000000.0 * total / out.duration.count(), out.memory_usage.total_address_space_paged_in, shared.max_concurrency,
+                       latencies.mean() / 1000.0, latencies.percentile(99) / 1000.0, latencies.max() / 1000.0});
+    auto &r = harness.add(std::string(name) + " with " + std::to_string(items) + " work items", "SHA256 hashes/sec", results.back().throughput, true, latencies);
+    r.parameters = {{"work_items", (double) items},
+                    {"max_concurrency", (double) results.back().max_concurrency},
+                    {"paged_in_mb", results.back().paged_in / 1024.0 / 1024.0}};
     std::cout << "   For " << results.back().items << " work items got " << results.back().throughput << " SHA256 hashes/sec with "
               << (results.back().items * SHA256_BUFFER_SIZE / 1024.0 / 1024.0) << " Mb working set, " << results.back().max_concurrency
               << " maximum concurrency, and " << (results.back().paged_in / 1024.0 / 1024.0) << " Mb paged in." << std::endl;
+    std::cout << "      Latency mean " << results.back().mean_latency << " us, 99% " << results.back().p99_latency << " us, maximum "
+              << results.back().max_latency << " us." << std::endl;
     // std::cout << "      " << (out.memory_usage.total_address_space_in_use / 1024.0 / 1024.0) << ","
     //          << (out.memory_usage.total_address_space_paged_in / 1024.0 / 1024.0) << "," << (out.memory_usage.private_committed / 1024.0 / 1024.0) << ","
     //          << (out.memory_usage.private_paged_in / 1024.0 / 1024.0) << std::endl;
@@ -386,12 +445,12 @@ template <class Runner> void benchmark(llfio::mapped_file_handle &maph, const ch
   if(name != nullptr)
   {
     std::ofstream out(std::string(name) + "_results.csv");
-    out << R"("Work items","SHA256 hashes/sec","Working set","Max concurrency","Paged in")";
+    out << R"("Work items","SHA256 hashes/sec","Working set","Max concurrency","Paged in","Mean latency","99% latency","Max latency")";
     for(auto &i : results)
     {
       out << "\n"
           << i.items << "," << i.throughput << "," << (i.items * SHA256_BUFFER_SIZE / 1024.0 / 1024.0) << "," << i.max_concurrency << ","
-          << (i.paged_in / 1024.0 / 1024.0);
+          << (i.paged_in / 1024.0 / 1024.0) << "," << i.mean_latency << "," << i.p99_latency << "," << i.max_latency;
     }
     out << std::endl;
   }
@@ -399,6 +458,11 @@ template <class Runner> void benchmark(llfio::mapped_file_handle &maph, const ch
 
 int main(int argc, char *argv[])
 {
+  const auto parsed = harness.parse(argc, argv);
+  if(parsed != benchmark_harness::parse_result::run)
+  {
+    return (parsed == benchmark_harness::parse_result::help) ? 0 : 1;
+  }
   try
   {
     llfio::path_handle where;
@@ -453,10 +517,16 @@ int main(int argc, char *argv[])
 
 #if 1
     {
-      std::string llfio_name("llfio paced (");
+      std::string llfio_name("llfio busy time paced (");
+      llfio_name.append(llfio::dynamic_thread_pool_group::implementation_description());
+      llfio_name.push_back(')');
+      benchmark<llfio_runner_paced<llfio::dynamic_thread_pool_group::io_aware_work_item::pacing_policy::busy_time>>(fileh, llfio_name.c_str());
+    }
+    {
+      std::string llfio_name("llfio latency paced (");
       llfio_name.append(llfio::dynamic_thread_pool_group::implementation_description());
       llfio_name.push_back(')');
-      benchmark<llfio_runner_paced>(fileh, llfio_name.c_str());
+      benchmark<llfio_runner_paced<llfio::dynamic_thread_pool_group::io_aware_work_item::pacing_policy::latency>>(fileh, llfio_name.c_str());
     }
 #endif
 
@@ -465,7 +535,7 @@ int main(int argc, char *argv[])
 #endif
 
     std::cout << "\nReminder: you may wish to delete " << fileh.current_path().value() << std::endl;
-    return 0;
+    return harness.write() ? 0 : 1;
   }
   catch(const std::exception &e)
   {
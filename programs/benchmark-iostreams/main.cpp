@@ -27,6 +27,7 @@ Distributed under the Boost Software License, Version 1.0.
 #define REGIONSIZE (100 * 1024 * 1024)
 
 #include "../../include/llfio/llfio.hpp"
+#include "../benchmark_harness.hpp"
 #include "quickcpplib/algorithm/small_prng.hpp"
 
 #include <chrono>
@@ -37,6 +38,8 @@ Distributed under the Boost Software License, Version 1.0.
 namespace llfio = LLFIO_V2_NAMESPACE;
 using QUICKCPPLIB_NAMESPACE::algorithm::small_prng::small_prng;
 
+static benchmark_harness::harness harness("benchmark-iostreams");
+
 inline uint64_t ticksclock()
 {
 #ifdef _MSC_VER
@@ -94,8 +97,13 @@ inline uint64_t nanoclock()
   return (uint64_t)((ticksclock() - offset) / ticks_per_sec);
 }
 
-template <class F> inline void run_test(const char *csv, off_t max_extent, F &&f)
+template <class F> inline void run_test(const char *name, const char *csv, off_t max_extent, F &&f)
 {
+  if(!harness.selected(name))
+  {
+    return;
+  }
+  std::cout << "Testing latency of " << name << " ..." << std::endl;
   char buffer[MAXBLOCKSIZE];
   std::vector<std::pair<unsigned, unsigned>> offsets(512 * 1024);
   std::vector<std::vector<unsigned>> results;
@@ -118,10 +126,14 @@ template <class F> inline void run_test(const char *csv, off_t max_extent, F &&f
       offsets[n].second = (unsigned int) (end - begin);
     }
     results.emplace_back();
+    benchmark_harness::latency_histogram latencies;
     for(size_t n = 0; n < offsets.size() / scale; n++)
     {
       results.back().push_back(offsets[n].second);
+      latencies.record((uint64_t) offsets[n].second);
     }
+    harness.add(std::string(name) + " with " + std::to_string(blocksize) + " byte blocks", "ns mean latency", latencies.mean(), false, latencies).parameters = {
+    {"block_size", (double) blocksize}};
   }
   std::ofstream out(csv);
   for(size_t blocksize = MINBLOCKSIZE; blocksize <= MAXBLOCKSIZE; blocksize <<= 1)
@@ -141,8 +153,13 @@ template <class F> inline void run_test(const char *csv, off_t max_extent, F &&f
   }
 }
 
-int main()
+int main(int argc, char *argv[])
 {
+  const auto parsed = harness.parse(argc, argv);
+  if(parsed != benchmark_harness::parse_result::run)
+  {
+    return (parsed == benchmark_harness::parse_result::help) ? 0 : 1;
+  }
   {
     auto th = llfio::file({}, "testfile", llfio::file_handle::mode::write, llfio::file_handle::creation::if_needed).value();
     std::vector<char> buffer(REGIONSIZE, 'a');
@@ -150,13 +167,13 @@ int main()
     th.barrier({}, llfio::file_handle::barrier_kind::wait_all).value();
   }
   {
+    // Also calibrates nanoclock()
     auto begin = nanoclock();
-    while(nanoclock() - begin < 1000000000ULL)
+    while(nanoclock() - begin < (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(harness.warmup).count())
       ;
   }
 #if 0
   {
-    std::cout << "Testing latency of llfio::file_handle with random malloc/free ..." << std::endl;
     auto th = llfio::file({}, "testfile").value();
     std::vector<void *> allocations(1024 * 1024);
     small_prng rand;
@@ -164,7 +181,7 @@ int main()
     {
       i = malloc(rand() % 4096);
     }
-    run_test("file_handle_malloc_free.csv", 1024 * 1024, [&](unsigned offset, char *buffer, size_t len) {
+    run_test("llfio::file_handle with random malloc/free", "file_handle_malloc_free.csv", 1024 * 1024, [&](unsigned offset, char *buffer, size_t len) {
       th.read(offset, {{(llfio::byte *) buffer, len}}).value();
       for(size_t n = 0; n < rand() % 64; n++)
       {
@@ -182,30 +199,26 @@ int main()
 #endif
 #if 1
   {
-    std::cout << "Testing latency of iostreams ..." << std::endl;
     std::ifstream testfile("testfile");
     testfile.exceptions(std::ios::failbit | std::ios::badbit);
-    run_test("iostreams.csv", REGIONSIZE, [&](unsigned offset, char *buffer, size_t len) {
+    run_test("iostreams", "iostreams.csv", REGIONSIZE, [&](unsigned offset, char *buffer, size_t len) {
       testfile.seekg(offset, std::ios::beg);
       testfile.read(buffer, len);
     });
   }
 #endif
   {
-    std::cout << "Testing latency of llfio::file_handle ..." << std::endl;
     auto th = llfio::file({}, "testfile").value();
-    run_test("file_handle.csv", REGIONSIZE, [&](unsigned offset, char *buffer, size_t len) { th.read(offset, {{(llfio::byte *) buffer, len}}).value(); });
+    run_test("llfio::file_handle", "file_handle.csv", REGIONSIZE, [&](unsigned offset, char *buffer, size_t len) { th.read(offset, {{(llfio::byte *) buffer, len}}).value(); });
   }
 #if 1
   {
-    std::cout << "Testing latency of llfio::mapped_file_handle ..." << std::endl;
     auto th = llfio::mapped_file({}, "testfile").value();
-    run_test("mapped_file_handle.csv", REGIONSIZE, [&](unsigned offset, char *buffer, size_t len) { th.read(offset, {{(llfio::byte *) buffer, len}}).value(); });
+    run_test("llfio::mapped_file_handle", "mapped_file_handle.csv", REGIONSIZE, [&](unsigned offset, char *buffer, size_t len) { th.read(offset, {{(llfio::byte *) buffer, len}}).value(); });
   }
 #endif
 #if 1
   {
-    std::cout << "Testing latency of memcpy ..." << std::endl;
     auto th = llfio::map(REGIONSIZE).value();
 #if 1
     {
@@ -217,7 +230,7 @@ int main()
       }
     }
 #endif
-    run_test("memcpy.csv", REGIONSIZE, [&](unsigned offset, char *buffer, size_t len) {
+    run_test("memcpy", "memcpy.csv", REGIONSIZE, [&](unsigned offset, char *buffer, size_t len) {
 #if 0
       memcpy(buffer, th.address() + offset, len);
 #else
@@ -285,4 +298,5 @@ int main()
   }
 #endif
   llfio::filesystem::remove("testfile");
+  return harness.write() ? 0 : 1;
 }
@@ -25,12 +25,10 @@ Distributed under the Boost Software License, Version 1.0.
 //! On exit dumps a CSV file of the LLFIO log, one per child worker
 #define DEBUG_CSV 1
 
-//! Seconds to run the benchmark
-#define BENCHMARK_DURATION 10
-
 #define _CRT_SECURE_NO_WARNINGS 1
 
 #include "../../include/llfio/llfio.hpp"
+#include "../benchmark_harness.hpp"
 #include "kerneltest/v1.0/child_process.hpp"
 
 #include <fstream>
@@ -66,6 +64,9 @@ bool kbhit()
 namespace llfio = LLFIO_V2_NAMESPACE;
 namespace child_process = KERNELTEST_V1_NAMESPACE::child_process;
 
+static benchmark_harness::harness harness("benchmark-locking", std::chrono::seconds(10),
+                                          "[!]<atomic_append|byte_ranges|lock_files|memory_map> <entities> <no of waiters>");
+
 static volatile size_t *shared_memory;
 static void initialise_shared_memory()
 {
@@ -100,9 +101,15 @@ static void child_unlocks(size_t id)
 
 int main(int argc, char *argv[])
 {
+  // Children are never passed harness options, so this only affects the master
+  const auto parsed = harness.parse(argc, argv);
+  if(parsed != benchmark_harness::parse_result::run)
+  {
+    return (parsed == benchmark_harness::parse_result::help) ? 0 : 1;
+  }
   if(argc < 4)
   {
-    std::cerr << "Usage: " << argv[0] << " [!]<atomic_append|byte_ranges|lock_files|memory_map> <entities> <no of waiters>" << std::endl;
+    harness.print_usage(std::cerr, argv[0]);
     return 1;
   }
   initialise_shared_memory();
@@ -114,7 +121,7 @@ int main(int argc, char *argv[])
     size_t waiters = atoi(argv[3]);
     if(!waiters || !atoi(argv[2]))
     {
-      std::cerr << "Usage: " << argv[0] << " [!]<atomic_append|byte_ranges|lock_files|memory_map> <entities> <no of waiters>" << std::endl;
+      harness.print_usage(std::cerr, argv[0]);
       return 1;
     }
 
@@ -182,12 +189,12 @@ int main(int argc, char *argv[])
     while(std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - begin).count() < 2)
       ;
 #endif
-    std::cout << "Benchmarking for " << BENCHMARK_DURATION << " seconds ..." << std::endl;
+    std::cout << "Benchmarking for " << harness.duration.count() << " seconds ..." << std::endl;
     // Issue go command to all children
     for(auto &child : children)
       child.cin() << "GO" << std::endl;
     // Wait for benchmark to complete
-    std::this_thread::sleep_for(std::chrono::seconds(BENCHMARK_DURATION));
+    std::this_thread::sleep_for(harness.duration);
     std::cout << "Stopping benchmark and telling children to report results ..." << std::endl;
     // Tell children to quit
     for(auto &child : children)
@@ -215,10 +222,12 @@ int main(int argc, char *argv[])
         oh << ",";
       oh << result;
     }
-    results /= BENCHMARK_DURATION;
+    results /= harness.duration.count();
     std::cout << "Total result: " << results << " ops/sec" << std::endl;
     oh << "\n" << results << std::endl;
-    return 0;
+    harness.add(std::string(argv[1]) + " with " + argv[2] + " entities and " + argv[3] + " waiters", "ops/sec", (double) results).parameters = {
+    {"entities", (double) atoi(argv[2])}, {"waiters", (double) waiters}};
+    return harness.write() ? 0 : 1;
   }
 
 
@@ -0,0 +1,159 @@
+/* Test the performance of rendering and opening paths
+(C) 2026 agent <agent@local> (4 commits)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#include "../../include/llfio/llfio.hpp"
+#include "../benchmark_harness.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace llfio = LLFIO_V2_NAMESPACE;
+
+/* Usage: benchmark-path_view [options]
+
+Iterates and compares a long path, then renders and opens the same 64
+relative paths in the temporary files directory repeatedly, by string and
+by interned path.
+*/
+
+static benchmark_harness::harness harness("benchmark-path_view", std::chrono::seconds(3));
+
+// Stops the compiler eliding the work being benchmarked
+static volatile size_t sink;
+
+static constexpr size_t PATHS = 64;
+
+/* Calls `f(n)` with increasing `n` until the duration has elapsed, returning the mean
+nanoseconds per call. Calls are timed in batches of `PATHS`, as reading the clock takes
+longer than rendering a path.
+*/
+template <class F> double benchmark(const std::string &desc, F &&f)
+{
+  if(!harness.selected(desc))
+  {
+    return 0;
+  }
+  benchmark_harness::latency_histogram latencies;
+  harness.warm_up([&] {
+    for(size_t n = 0; n < PATHS; n++)
+    {
+      f(n);
+    }
+  });
+  for(auto begin = std::chrono::steady_clock::now(), end = begin; end - begin < harness.duration;)
+  {
+    for(size_t n = 0; n < PATHS; n++)
+    {
+      f(n);
+    }
+    const auto now = std::chrono::steady_clock::now();
+    latencies.record(std::chrono::duration_cast<std::chrono::nanoseconds>(now - end) / PATHS);
+    end = now;
+  }
+  std::cout << "   " << desc << ": " << latencies.mean() << " ns" << std::endl;
+  harness.add(desc, "ns mean latency", latencies.mean(), false, latencies);
+  return latencies.mean();
+}
+
+int main(int argc, char *argv[])
+{
+  const auto parsed = harness.parse(argc, argv);
+  if(parsed != benchmark_harness::parse_result::run)
+  {
+    return (parsed == benchmark_harness::parse_result::help) ? 0 : 1;
+  }
+  try
+  {
+    {
+      // Components of every length either side of a sixteen byte boundary
+      std::string narrow;
+      for(size_t n = 1; n < 40; n++)
+      {
+        narrow.append("/").append(std::string(n, (char) ('a' + (n % 26))));
+      }
+      const std::string narrow2(narrow);
+      std::cout << "Splitting and comparing a path of " << narrow.size() << " chars:" << std::endl;
+      benchmark("Iterating the components of a path", [&](size_t /*unused*/) {
+        llfio::path_view v(narrow);
+        size_t count = 0;
+        for(auto it = v.begin(); it != v.end(); ++it)
+        {
+          count++;
+        }
+        sink = count;
+      });
+      benchmark("Comparing identical paths", [&](size_t /*unused*/) { sink = (llfio::path_view(narrow) == llfio::path_view(narrow2)); });
+    }
+
+    const auto &base = llfio::path_discovery::storage_backed_temporary_files_directory();
+    std::vector<std::string> names;
+    for(size_t n = 0; n < PATHS; n++)
+    {
+      // The trailing characters stop the string views being zero terminated, as most are in practice
+      names.push_back("llfio_benchmark_path_view_" + std::to_string(n) + "XXXX");
+      llfio::file_handle::file(base, llfio::path_view(names.back().data(), names.back().size() - 4, llfio::path_view::not_zero_terminated),
+                               llfio::file_handle::mode::write, llfio::file_handle::creation::if_needed)
+      .value();
+    }
+    auto unlink = llfio::make_scope_exit([&]() noexcept {
+      for(auto &name : names)
+      {
+        auto fh = llfio::file_handle::file(base, llfio::path_view(name.data(), name.size() - 4, llfio::path_view::not_zero_terminated),
+                                           llfio::file_handle::mode::write);
+        if(fh)
+        {
+          (void) fh.value().unlink();
+        }
+      }
+    });
+    std::vector<llfio::interned_path> paths;
+    for(auto &name : names)
+    {
+      paths.push_back(llfio::interned_path::intern(llfio::path_view(name.data(), name.size() - 4, llfio::path_view::not_zero_terminated)));
+    }
+    auto bystring = [&](size_t idx) { return llfio::path_view(names[idx].data(), names[idx].size() - 4, llfio::path_view::not_zero_terminated); };
+    auto byinterned = [&](size_t idx) { return llfio::path_view(paths[idx]); };
+
+    std::cout << "\nRendering paths:" << std::endl;
+    benchmark("Rendering a path by string", [&](size_t n) {
+      llfio::path_view::zero_terminated_rendered_path<> zpath(bystring(n));
+      sink = zpath.size();
+    });
+    benchmark("Rendering a path by interned path", [&](size_t n) {
+      llfio::path_view::zero_terminated_rendered_path<> zpath(byinterned(n));
+      sink = zpath.size();
+    });
+    std::cout << "\nOpening files:" << std::endl;
+    benchmark("Opening a file by string", [&](size_t n) { llfio::file_handle::file(base, bystring(n)).value(); });
+    benchmark("Opening a file by interned path", [&](size_t n) { llfio::file_handle::file(base, byinterned(n)).value(); });
+  }
+  catch(const std::exception &e)
+  {
+    std::cerr << "FATAL: " << e.what() << std::endl;
+    return 1;
+  }
+  return harness.write() ? 0 : 1;
+}
@@ -0,0 +1,130 @@
+/* Test the rate at which child processes can be launched
+(C) 2026 agent <agent@local> (4 commits)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#include "../../include/llfio/llfio.hpp"
+#include "../benchmark_harness.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace llfio = LLFIO_V2_NAMESPACE;
+
+/* Usage: benchmark-process-spawn [options] [<ballast in Mb>]
+
+Launches this program as a child which exits immediately, as many times as
+possible per second, by path and by spawn template, with and without
+redirected pipes. Up to 16 children, or --threads, are kept running at once. The ballast is
+memory dirtied before benchmarking, so the cost of copying page tables during
+launch becomes visible.
+*/
+
+static constexpr size_t MAX_CHILDREN = 16;
+
+static benchmark_harness::harness harness("benchmark-process-spawn", std::chrono::seconds(3), "[<ballast in Mb>]");
+
+template <class F> double benchmark(const std::string &desc, F &&launch)
+{
+  if(!harness.selected(desc))
+  {
+    return 0;
+  }
+  const auto max_children = harness.max_concurrency(MAX_CHILDREN);
+  std::vector<llfio::process_handle> children;
+  size_t launched = 0;
+  auto begin = std::chrono::steady_clock::now(), end = begin;
+  do
+  {
+    if(children.size() >= max_children)
+    {
+      for(auto &child : children)
+      {
+        child.wait().value();
+      }
+      children.clear();
+    }
+    children.push_back(launch().value());
+    launched++;
+  } while((end = std::chrono::steady_clock::now()) - begin < harness.duration);
+  for(auto &child : children)
+  {
+    child.wait().value();
+  }
+  const double rate = (double) launched / std::chrono::duration<double>(end - begin).count();
+  std::cout << "   " << desc << ": " << rate << " launches/sec" << std::endl;
+  harness.add(desc, "launches/sec", rate).parameters = {{"max_children", (double) max_children}};
+  return rate;
+}
+
+int main(int argc, char *argv[])
+{
+  if(argc > 1 && 0 == strcmp(argv[1], "--child"))
+  {
+    return 0;
+  }
+  const auto parsed = harness.parse(argc, argv);
+  if(parsed != benchmark_harness::parse_result::run)
+  {
+    return (parsed == benchmark_harness::parse_result::help) ? 0 : 1;
+  }
+  try
+  {
+    llfio::map_handle ballast;
+    if(argc > 1)
+    {
+      const auto bytes = (size_t) atoll(argv[1]) * 1024 * 1024;
+      if(bytes > 0)
+      {
+        std::cout << "Dirtying " << (bytes / 1024 / 1024) << " Mb of ballast ..." << std::endl;
+        ballast = llfio::map_handle::map(bytes).value();
+        for(size_t n = 0; n < bytes; n += llfio::utils::page_size())
+        {
+          ballast.address()[n] = (llfio::byte) 1;
+        }
+      }
+    }
+    auto myexepath = llfio::process_handle::current().current_path().value();
+    llfio::path_view_component arg("--child");
+    auto &env = *llfio::process_handle::current().environment();
+    for(auto flags : {llfio::process_handle::flag::wait_on_close | llfio::process_handle::flag::no_redirect, llfio::process_handle::flag::wait_on_close})
+    {
+      std::stringstream flags_str;
+      flags_str << flags;
+      std::cout << "\nWith flags " << flags_str.str() << ":" << std::endl;
+      benchmark("launch_process(path, args, env) with flags " + flags_str.str(),
+                [&] { return llfio::process_handle::launch_process(myexepath, {&arg, 1}, env, flags); });
+      auto t = llfio::process_handle::make_spawn_template(myexepath, {&arg, 1}, env, flags).value();
+      benchmark("launch_process(spawn_template) with flags " + flags_str.str(), [&] { return llfio::process_handle::launch_process(t); });
+    }
+  }
+  catch(const std::exception &e)
+  {
+    std::cerr << "FATAL: " << e.what() << std::endl;
+    return 1;
+  }
+  return harness.write() ? 0 : 1;
+}
@@ -0,0 +1,438 @@
+/* Common command line options, latency capture and JSON output for the benchmarks
+(C) 2026 agent <agent@local> (3 commits)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#ifndef LLFIO_PROGRAMS_BENCHMARK_HARNESS_HPP
+#define LLFIO_PROGRAMS_BENCHMARK_HARNESS_HPP
+
+/* Every benchmark program accepts these options before any of its own:
+
+    --duration=<seconds>  How long to run each benchmark.
+    --warmup=<seconds>    How long to warm up before benchmarking.
+    --threads=<n>         The most concurrency (threads, work items, handles or
+                          child processes) to scale up to. Zero is the program's default.
+    --filter=<substring>  Only run benchmarks whose names contain this. May be repeated.
+    --json=<path>         Where to write results, by default <program>_results.json.
+    --help                Print usage and exit.
+
+Results are written as JSON, which programs/benchmark-compare can compare
+between two runs to flag regressions.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace benchmark_harness
+{
+  /*! A histogram of latencies in nanoseconds, in the manner of HdrHistogram.
+
+  Values below 128 are recorded exactly. Above that, each power of two is divided into
+  64 buckets, so values are recorded to within 1.6%, no matter how large. Values
+  above 2^40 nanoseconds (about eighteen minutes) are recorded as 2^40.
+  */
+  class latency_histogram
+  {
+  public:
+    static constexpr unsigned SUB_BUCKET_BITS = 6;
+    static constexpr unsigned MAX_VALUE_BITS = 40;
+    static constexpr size_t BUCKETS = (size_t) (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS;
+
+  private:
+    std::vector<uint64_t> _counts;
+    uint64_t _total{0}, _min{UINT64_MAX}, _max{0};
+    double _sum{0};
+
+    static unsigned _msb(uint64_t v) noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+      return 63 - (unsigned) __builtin_clzll(v);
+#else
+      unsigned ret = 0;
+      while(v >>= 1)
+      {
+        ret++;
+      }
+      return ret;
+#endif
+    }
+
+  public:
+    latency_histogram()
+        : _counts(BUCKETS)
+    {
+    }
+
+    //! The bucket into which a value is recorded
+    static size_t index_of(uint64_t v) noexcept
+    {
+      if(v >= (1ULL << MAX_VALUE_BITS))
+      {
+        v = (1ULL << MAX_VALUE_BITS) - 1;
+      }
+      if(v < (2ULL << SUB_BUCKET_BITS))
+      {
+        return (size_t) v;
+      }
+      const unsigned m = _msb(v);
+      return ((size_t) (m - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS) + (size_t) ((v >> (m - SUB_BUCKET_BITS)) - (1ULL << SUB_BUCKET_BITS));
+    }
+    //! The highest value recorded into a bucket
+    static uint64_t highest_of(size_t idx) noexcept
+    {
+      if(idx < (2U << SUB_BUCKET_BITS))
+      {
+        return idx;
+      }
+      const unsigned shift = (unsigned) (idx >> SUB_BUCKET_BITS) - 1;
+      const uint64_t lower = ((1ULL << SUB_BUCKET_BITS) + (idx & ((1U << SUB_BUCKET_BITS) - 1))) << shift;
+      return lower + (1ULL << shift) - 1;
+    }
+
+    void record(uint64_t ns) noexcept
+    {
+      _counts[index_of(ns)]++;
+      _total++;
+      _sum += (double) ns;
+      _min = std::min(_min, ns);
+      _max = std::max(_max, ns);
+    }
+    void record(std::chrono::nanoseconds ns) noexcept { record((uint64_t) std::max(ns.count(), (std::chrono::nanoseconds::rep) 0)); }
+    void merge(const latency_histogram &o) noexcept
+    {
+      for(size_t n = 0; n < BUCKETS; n++)
+      {
+        _counts[n] += o._counts[n];
+      }
+      _total += o._total;
+      _sum += o._sum;
+      _min = std::min(_min, o._min);
+      _max = std::max(_max, o._max);
+    }
+    void reset() noexcept
+    {
+      std::fill(_counts.begin(), _counts.end(), 0);
+      _total = 0;
+      _sum = 0;
+      _min = UINT64_MAX;
+      _max = 0;
+    }
+
+    uint64_t count() const noexcept { return _total; }
+    uint64_t min() const noexcept { return (_total > 0) ? _min : 0; }
+    uint64_t max() const noexcept { return _max; }
+    double mean() const noexcept { return (_total > 0) ? (_sum / (double) _total) : 0.0; }
+    //! The value at or below which `percent` of the recorded values lie
+    uint64_t percentile(double percent) const noexcept
+    {
+      if(_total == 0)
+      {
+        return 0;
+      }
+      const auto target = std::max((uint64_t) 1, (uint64_t) std::ceil(percent / 100.0 * (double) _total));
+      uint64_t seen = 0;
+      for(size_t n = 0; n < BUCKETS; n++)
+      {
+        seen += _counts[n];
+        if(seen >= target)
+        {
+          return std::min(highest_of(n), _max);
+        }
+      }
+      return _max;
+    }
+    //! Calls `f(highest value, count)` for each non-empty bucket in ascending order
+    template <class F> void for_each_bucket(F &&f) const
+    {
+      for(size_t n = 0; n < BUCKETS; n++)
+      {
+        if(_counts[n] > 0)
+        {
+          f(std::min(highest_of(n), _max), _counts[n]);
+        }
+      }
+    }
+  };
+
+  //! What `harness::parse()` found on the command line
+  enum class parse_result
+  {
+    run,   //!< The program ought to run.
+    help,  //!< Usage was printed as requested, the program ought to exit successfully.
+    error  //!< An option was invalid, the program ought to exit with failure.
+  };
+
+  //! Parses the common options, collects results, and writes them as JSON.
+  class harness
+  {
+  public:
+    struct result
+    {
+      std::string name;  //!< Unique within the program, used to match results between runs.
+      std::string unit;
+      double value{0};
+      bool higher_is_better{true};
+      std::vector<std::pair<std::string, double>> parameters;
+      bool has_latency{false};
+      latency_histogram latency;
+    };
+
+    std::chrono::seconds duration;
+    std::chrono::seconds warmup{3};
+    unsigned threads{0};
+    std::vector<std::string> filters;
+    std::string json_path;
+
+  private:
+    std::string _program, _usage;
+    std::vector<result> _results;
+
+    static std::string _escape(const std::string &s)
+    {
+      std::string ret;
+      for(char c : s)
+      {
+        if(c == '"' || c == '\\')
+        {
+          ret.push_back('\\');
+          ret.push_back(c);
+        }
+        else if((unsigned char) c < 0x20)
+        {
+          char buffer[8];
+          snprintf(buffer, sizeof(buffer), "\\u%04x", (unsigned) c);
+          ret.append(buffer);
+        }
+        else
+        {
+          ret.push_back(c);
+        }
+      }
+      return ret;
+    }
+    static void _number(std::ostream &out, double v)
+    {
+      if(std::isfinite(v))
+      {
+        out << v;
+      }
+      else
+      {
+        out << "null";
+      }
+    }
+
+  public:
+    /*! `usage` describes the program's own arguments, which follow the common options.
+     */
+    explicit harness(std::string program, std::chrono::seconds default_duration = std::chrono::seconds(10), std::string usage = {})
+        : duration(default_duration)
+        , _program(std::move(program))
+        , _usage(std::move(usage))
+    {
+    }
+
+    //! Prints the usage of the program to `out`
+    void print_usage(std::ostream &out, const char *argv0) const
+    {
+      out << "Usage: " << argv0 << " [--duration=<seconds>] [--warmup=<seconds>] [--threads=<n>] [--filter=<substring>]... [--json=<path>]";
+      if(!_usage.empty())
+      {
+        out << " " << _usage;
+      }
+      out << std::endl;
+    }
+
+    /*! Parses and removes the common options from `argv`. Unless this returns
+    `parse_result::run`, the program ought to exit, having printed usage or an error.
+    */
+    parse_result parse(int &argc, char *argv[])
+    {
+      int out = 1;
+      for(int n = 1; n < argc; n++)
+      {
+        const char *arg = argv[n];
+        auto value = [&](const char *name) -> const char * {
+          const auto len = strlen(name);
+          return (0 == strncmp(arg, name, len) && arg[len] == '=') ? arg + len + 1 : nullptr;
+        };
+        const char *v;
+        if(0 == strcmp(arg, "--help") || 0 == strcmp(arg, "-h"))
+        {
+          print_usage(std::cout, argv[0]);
+          return parse_result::help;
+        }
+        else if((v = value("--duration")) != nullptr)
+        {
+          duration = std::chrono::seconds(atoi(v));
+          if(duration.count() <= 0)
+          {
+            std::cerr << "FATAL: --duration must be positive" << std::endl;
+            return parse_result::error;
+          }
+        }
+        else if((v = value("--warmup")) != nullptr)
+        {
+          warmup = std::chrono::seconds(std::max(atoi(v), 0));
+        }
+        else if((v = value("--threads")) != nullptr)
+        {
+          threads = (unsigned) std::max(atoi(v), 0);
+        }
+        else if((v = value("--filter")) != nullptr)
+        {
+          filters.emplace_back(v);
+        }
+        else if((v = value("--json")) != nullptr)
+        {
+          json_path = v;
+        }
+        else
+        {
+          argv[out++] = argv[n];
+        }
+      }
+      argc = out;
+      argv[argc] = nullptr;
+      return parse_result::run;
+    }
+
+    //! The concurrency to scale up to, which is `threads` if set, else `default_`
+    template <class T> T max_concurrency(T default_) const noexcept { return (threads > 0) ? (T) threads : default_; }
+
+    //! True if a benchmark of this name ought to be run
+    bool selected(const std::string &name) const
+    {
+      if(filters.empty())
+      {
+        return true;
+      }
+      for(auto &i : filters)
+      {
+        if(name.find(i) != std::string::npos)
+        {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    //! Calls `f()` repeatedly until `warmup` has elapsed
+    template <class F> void warm_up(F &&f) const
+    {
+      const auto end = std::chrono::steady_clock::now() + warmup;
+      do
+      {
+        f();
+      } while(std::chrono::steady_clock::now() < end);
+    }
+
+    //! Adds a result, returning it so parameters and latencies can be filled in
+    result &add(std::string name, std::string unit, double value, bool higher_is_better = true)
+    {
+      _results.emplace_back();
+      auto &ret = _results.back();
+      ret.name = std::move(name);
+      ret.unit = std::move(unit);
+      ret.value = value;
+      ret.higher_is_better = higher_is_better;
+      return ret;
+    }
+    //! \overload Also records latencies
+    result &add(std::string name, std::string unit, double value, bool higher_is_better, const latency_histogram &latency)
+    {
+      auto &ret = add(std::move(name), std::move(unit), value, higher_is_better);
+      ret.has_latency = true;
+      ret.latency.merge(latency);
+      return ret;
+    }
+
+    //! Writes the results collected so far as JSON, returning false on failure
+    bool write() const
+    {
+      const std::string path = json_path.empty() ? (_program + "_results.json") : json_path;
+      std::ofstream out(path);
+      out << std::setprecision(10);
+      char timestamp[32] = "";
+      const auto now = std::time(nullptr);
+      std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+      out << "{\n  \"program\": \"" << _escape(_program) << "\",\n  \"timestamp\": \"" << timestamp
+          << "\",\n  \"hardware_concurrency\": " << std::thread::hardware_concurrency() << ",\n  \"options\": {\"duration\": " << duration.count()
+          << ", \"warmup\": " << warmup.count() << ", \"threads\": " << threads << ", \"filters\": [";
+      for(size_t n = 0; n < filters.size(); n++)
+      {
+        out << ((n > 0) ? ", " : "") << "\"" << _escape(filters[n]) << "\"";
+      }
+      out << "]},\n  \"results\": [";
+      for(size_t n = 0; n < _results.size(); n++)
+      {
+        const auto &r = _results[n];
+        out << ((n > 0) ? "," : "") << "\n    {\"name\": \"" << _escape(r.name) << "\", \"unit\": \"" << _escape(r.unit) << "\", \"value\": ";
+        _number(out, r.value);
+        out << ", \"higher_is_better\": " << (r.higher_is_better ? "true" : "false") << ",\n     \"parameters\": {";
+        for(size_t i = 0; i < r.parameters.size(); i++)
+        {
+          out << ((i > 0) ? ", " : "") << "\"" << _escape(r.parameters[i].first) << "\": ";
+          _number(out, r.parameters[i].second);
+        }
+        out << "}";
+        if(r.has_latency)
+        {
+          out << ",\n     \"latency_ns\": {\"count\": " << r.latency.count() << ", \"min\": " << r.latency.min() << ", \"mean\": ";
+          _number(out, r.latency.mean());
+          out << ", \"p50\": " << r.latency.percentile(50) << ", \"p90\": " << r.latency.percentile(90) << ", \"p99\": " << r.latency.percentile(99)
+              << ", \"p999\": " << r.latency.percentile(99.9) << ", \"p9999\": " << r.latency.percentile(99.99) << ", \"max\": " << r.latency.max()
+              << ",\n       \"histogram\": [";
+          bool first = true;
+          r.latency.for_each_bucket([&](uint64_t v, uint64_t count) {
+            out << (first ? "" : ", ") << "[" << v << ", " << count << "]";
+            first = false;
+          });
+          out << "]}";
+        }
+        out << "}";
+      }
+      out << "\n  ]\n}\n";
+      if(!out)
+      {
+        std::cerr << "ERROR: Failed to write results to " << path << std::endl;
+        return false;
+      }
+      std::cout << "\nResults written to " << path << std::endl;
+      return true;
+    }
+  };
+}  // namespace benchmark_harness
+
+#endif
@@ -0,0 +1,175 @@
+/* Decodes a binary trace file written by algorithm::trace_recorder
+(C) 2026 agent <agent@local> (2 commits)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#include "../../include/llfio/llfio.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace llfio = LLFIO_V2_NAMESPACE;
+
+/* Usage: trace-decode <tracefile> [--summary]
+
+Without --summary, prints every event sorted by time, one per line:
+
+  <usecs since start> <thread> <kind> <begin|end|instant> <id> <value> [FAILED]
+
+With --summary, pairs begin and end events per thread and prints for each
+kind of event the count, failures, total bytes and latency statistics.
+*/
+
+struct latency_stats
+{
+  uint64_t count{0}, failed{0}, bytes{0};
+  uint64_t min{UINT64_MAX}, max{0}, total{0};
+  std::vector<uint64_t> samples;
+};
+
+static const char *phase_string(llfio::trace_event_phase phase)
+{
+  switch(phase)
+  {
+  case llfio::trace_event_phase::begin:
+    return "begin";
+  case llfio::trace_event_phase::end:
+    return "end";
+  case llfio::trace_event_phase::instant:
+    return "instant";
+  }
+  return "?";
+}
+
+int main(int argc, char *argv[])
+{
+  if(argc < 2)
+  {
+    std::cerr << "Usage: " << argv[0] << " <tracefile> [--summary]" << std::endl;
+    return 1;
+  }
+  const bool summary = (argc > 2 && 0 == strcmp(argv[2], "--summary"));
+  auto fh = llfio::mapped_file({}, argv[1]);
+  if(!fh)
+  {
+    std::cerr << "FATAL: Could not open " << argv[1] << " due to " << fh.error().message() << std::endl;
+    return 1;
+  }
+  const auto length = fh.value().maximum_extent().value();
+  if(length < sizeof(llfio::algorithm::trace_file_header))
+  {
+    std::cerr << "FATAL: " << argv[1] << " is too short to be a trace file" << std::endl;
+    return 1;
+  }
+  llfio::algorithm::trace_file_header header;
+  memcpy(&header, fh.value().address(), sizeof(header));
+  if(header.magic != llfio::algorithm::trace_file_header::magic_value || header.event_size != sizeof(llfio::trace_event))
+  {
+    std::cerr << "FATAL: " << argv[1] << " is not a trace file" << std::endl;
+    return 1;
+  }
+  if(header.version != llfio::algorithm::trace_file_header::current_version)
+  {
+    std::cerr << "FATAL: " << argv[1] << " is trace file version " << header.version << ", this decoder understands version "
+              << llfio::algorithm::trace_file_header::current_version << std::endl;
+    return 1;
+  }
+  // If the process died, the header may claim fewer events than the file contains, never more
+  const auto available = (length - sizeof(header)) / sizeof(llfio::trace_event);
+  std::vector<llfio::trace_event> events((size_t) std::min<uint64_t>(header.events, available));
+  memcpy(events.data(), fh.value().address() + sizeof(header), events.size() * sizeof(llfio::trace_event));
+  std::stable_sort(events.begin(), events.end(), [](const llfio::trace_event &a, const llfio::trace_event &b) { return a.timestamp < b.timestamp; });
+
+  std::cout << "Trace of " << events.size() << " events, " << header.dropped << " dropped." << std::endl;
+  if(!summary)
+  {
+    for(auto &ev : events)
+    {
+      std::cout << std::fixed << std::setprecision(3) << (double) (int64_t)(ev.timestamp - header.steady_epoch) / 1000.0 << " " << ev.thread_id << " "
+                << llfio::to_string(ev.kind) << " " << phase_string(ev.phase) << " 0x" << std::hex << ev.id << std::dec << " " << ev.value
+                << ((ev.flags & llfio::tracing::flag_failed) ? " FAILED" : "") << "\n";
+    }
+    return 0;
+  }
+
+  std::unordered_map<uint32_t, std::vector<const llfio::trace_event *>> open;  // per thread stack of begun events
+  std::map<uint16_t, latency_stats> stats;
+  uint64_t unmatched = 0;
+  for(auto &ev : events)
+  {
+    auto &stack = open[ev.thread_id];
+    if(ev.phase == llfio::trace_event_phase::begin)
+    {
+      stack.push_back(&ev);
+      continue;
+    }
+    auto &s = stats[(uint16_t) ev.kind];
+    s.count++;
+    if(ev.flags & llfio::tracing::flag_failed)
+    {
+      s.failed++;
+    }
+    if(ev.phase == llfio::trace_event_phase::instant)
+    {
+      continue;
+    }
+    if(stack.empty() || stack.back()->kind != ev.kind || stack.back()->id != ev.id)
+    {
+      unmatched++;
+      continue;
+    }
+    const auto latency = ev.timestamp - stack.back()->timestamp;
+    stack.pop_back();
+    if(ev.kind == llfio::trace_event_kind::read || ev.kind == llfio::trace_event_kind::write || ev.kind == llfio::trace_event_kind::barrier ||
+       ev.kind == llfio::trace_event_kind::lock)
+    {
+      s.bytes += ev.value;
+    }
+    s.min = std::min(s.min, latency);
+    s.max = std::max(s.max, latency);
+    s.total += latency;
+    s.samples.push_back(latency);
+  }
+  if(unmatched > 0)
+  {
+    std::cout << unmatched << " end events had no matching begin event (dropped or begun before recording)." << std::endl;
+  }
+  std::cout << std::left << std::setw(20) << "kind" << std::right << std::setw(12) << "count" << std::setw(10) << "failed" << std::setw(16) << "bytes"
+            << std::setw(12) << "min ns" << std::setw(12) << "mean ns" << std::setw(12) << "50% ns" << std::setw(12) << "99% ns" << std::setw(14)
+            << "max ns" << std::endl;
+  for(auto &i : stats)
+  {
+    auto &s = i.second;
+    std::sort(s.samples.begin(), s.samples.end());
+    auto percentile = [&](double p) -> uint64_t { return s.samples.empty() ? 0 : s.samples[(size_t)(p * (s.samples.size() - 1))]; };
+    std::cout << std::left << std::setw(20) << llfio::to_string((llfio::trace_event_kind) i.first) << std::right << std::setw(12) << s.count
+              << std::setw(10) << s.failed << std::setw(16) << s.bytes << std::setw(12) << (s.samples.empty() ? 0 : s.min) << std::setw(12)
+              << (s.samples.empty() ? 0 : s.total / s.samples.size()) << std::setw(12) << percentile(0.5) << std::setw(12) << percentile(0.99)
+              << std::setw(14) << s.max << std::endl;
+  }
+  return 0;
+}
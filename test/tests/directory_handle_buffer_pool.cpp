@@ -0,0 +1,77 @@
+/* Integration test kernel for the directory enumeration kernel buffer pool
+(C) 2026 agent <agent@local> (2 commits)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#include "../test_kernel_decl.hpp"
+
+#include <string>
+#include <vector>
+
+static inline void TestDirectoryHandleBufferPool()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  auto dirh = llfio::temp_directory().value();
+  auto untempdir = llfio::make_scope_exit([&]() noexcept { (void) llfio::algorithm::reduce(std::move(dirh)); });
+  // Long leafnames, so the initial kernel buffer guess is too small on POSIX
+  for(size_t n = 0; n < 2000; n++)
+  {
+    auto name = std::to_string(n) + std::string(150, 'x');
+    llfio::file_handle::file(dirh, name, llfio::file_handle::mode::write, llfio::file_handle::creation::if_needed).value();
+  }
+  llfio::directory_handle::trim_kernel_buffer_pool();
+  const auto before = llfio::directory_handle::kernel_buffer_pool_stats();
+  std::vector<llfio::directory_entry> entries(2000);
+  {
+    auto filled = dirh.read({entries}).value();
+    BOOST_REQUIRE(filled.done());
+    BOOST_CHECK(filled.size() == 2000);
+  }
+  const auto first = llfio::directory_handle::kernel_buffer_pool_stats();
+  std::cout << "First enumeration: " << (first.allocations - before.allocations) << " allocations, " << (first.reallocations - before.reallocations)
+            << " reallocations, " << (first.reuses - before.reuses) << " reuses, " << first.pooled_bytes << " bytes pooled." << std::endl;
+  BOOST_CHECK(first.allocations > before.allocations);
+#ifndef _WIN32
+  BOOST_CHECK(first.reallocations > before.reallocations);
+#endif
+  // The released kernel buffer is now pooled
+  BOOST_CHECK(first.pooled_bytes > before.pooled_bytes);
+
+  // A fresh buffers_type now reuses the pooled kernel buffer, which is already big enough
+  {
+    auto filled = dirh.read({entries}).value();
+    BOOST_REQUIRE(filled.done());
+    BOOST_CHECK(filled.size() == 2000);
+  }
+  const auto second = llfio::directory_handle::kernel_buffer_pool_stats();
+  std::cout << "Second enumeration: " << (second.allocations - first.allocations) << " allocations, " << (second.reallocations - first.reallocations)
+            << " reallocations, " << (second.reuses - first.reuses) << " reuses, " << second.pooled_bytes << " bytes pooled." << std::endl;
+  BOOST_CHECK(second.allocations == first.allocations);
+  BOOST_CHECK(second.reallocations == first.reallocations);
+  BOOST_CHECK(second.reuses == first.reuses + 1);
+
+  llfio::directory_handle::trim_kernel_buffer_pool();
+  BOOST_CHECK(llfio::directory_handle::kernel_buffer_pool_stats().pooled_bytes == before.pooled_bytes);
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, directory_handle_buffer_pool, works, "Tests that the directory enumeration kernel buffer pool works as expected",
+                       TestDirectoryHandleBufferPool())
@@ -0,0 +1,88 @@
+/* Integration test kernel for glob filtered directory enumeration
+(C) 2026 agent <agent@local> (2 commits)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#include "../test_kernel_decl.hpp"
+
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fnmatch.h>
+#endif
+
+static inline void TestDirectoryHandleGlob()
+{
+#ifdef _WIN32
+  // Globs are matched by the kernel on Windows
+  return;
+#else
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  auto dirh = llfio::temp_directory().value();
+  auto untempdir = llfio::make_scope_exit([&]() noexcept { (void) llfio::algorithm::reduce(std::move(dirh)); });
+  std::vector<std::string> names;
+  for(size_t n = 0; n < 500; n++)
+  {
+    const auto day = std::to_string(100 + n % 31).substr(1);
+    names.push_back("app-2026-" + std::to_string(1 + n / 31) + "-" + day + ".log");
+    names.push_back("app-2026-" + std::to_string(1 + n / 31) + "-" + day + ".log.gz");
+    names.push_back("db" + std::to_string(n) + ".txt");
+  }
+  names.push_back("a");
+  names.push_back(".hidden.log");
+  for(auto &name : names)
+  {
+    llfio::file_handle::file(dirh, name, llfio::file_handle::mode::write, llfio::file_handle::creation::if_needed).value();
+  }
+
+  static const char *globs[] = {"*",   "**",   "*.log", "app-*.log.gz", "*-1-*",     "app*2026*3*log", "db?.txt",      "db[0-4]*.txt", "*.t?t", "a",
+                                "a*",  "*a",   "*zzz*", ".*",           "*\\.log",   "db1*0.txt",      "*1*2*3*4*",    "app-*-0?.log", "*[!g]", "?",
+                                "app-2026-*"};
+  std::vector<llfio::directory_entry> entries(names.size() + 16);
+  for(const char *glob : globs)
+  {
+    size_t expected = 0;
+    for(auto &name : names)
+    {
+      if(0 == fnmatch(glob, name.c_str(), 0))
+      {
+        expected++;
+      }
+    }
+    auto filled = dirh.read({entries, glob}).value();
+    BOOST_CHECK(filled.done());
+    BOOST_CHECK(filled.size() == expected);
+    if(filled.size() != expected)
+    {
+      std::cerr << "Glob " << glob << " matched " << filled.size() << " entries, expected " << expected << std::endl;
+    }
+    for(auto &entry : filled)
+    {
+      BOOST_CHECK(0 == fnmatch(glob, entry.leafname.path().c_str(), 0));
+    }
+  }
+#endif
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, directory_handle_glob, works, "Tests that glob filtered directory enumeration works as expected",
+                       TestDirectoryHandleGlob())
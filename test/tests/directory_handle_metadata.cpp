@@ -0,0 +1,78 @@
+/* Integration test kernel for directory enumeration metadata enrichment
+(C) 2026 agent <agent@local> (3 commits)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#include "../test_kernel_decl.hpp"
+
+#include <string>
+#include <vector>
+
+static inline void TestDirectoryHandleMetadata()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  using LLFIO_V2_NAMESPACE::byte;
+  using want = llfio::stat_t::want;
+  static constexpr size_t item_count = 3000;  // enough for several io_uring batches
+  auto dirh = llfio::temp_directory().value();
+  auto untempdir = llfio::make_scope_exit([&]() noexcept { (void) llfio::algorithm::reduce(std::move(dirh)); });
+  std::vector<byte> buffer(item_count, byte(0));
+  for(size_t n = 0; n < item_count; n++)
+  {
+    auto fh = llfio::file_handle::file(dirh, std::to_string(n), llfio::file_handle::mode::write, llfio::file_handle::creation::if_needed).value();
+    fh.write(0, {{buffer.data(), n}}).value();
+  }
+
+  std::vector<llfio::directory_entry> entries(item_count * 2);
+  // Without asking, only the default metadata is returned
+  auto filled = dirh.read({entries}).value();
+  BOOST_REQUIRE(filled.done());
+  BOOST_CHECK(filled.size() == item_count);
+  BOOST_CHECK(!(filled.metadata() & want::size));
+
+  // Ask for sizes and modification times
+  filled = dirh.read({llfio::directory_handle::buffers_type(entries, std::move(filled)), {}, llfio::directory_handle::filter::fastdeleted, {}, want::size | want::mtim}).value();
+  BOOST_REQUIRE(filled.done());
+  BOOST_CHECK(filled.size() == item_count);
+  BOOST_REQUIRE((filled.metadata() & (want::size | want::mtim)) == (want::size | want::mtim));
+  size_t mismatches = 0;
+  for(auto &entry : filled)
+  {
+    auto expected = (llfio::handle::extent_type) std::stoul(entry.leafname.path().string());
+    if(entry.stat.st_size != expected || entry.stat.st_mtim == std::chrono::system_clock::time_point())
+    {
+      mismatches++;
+    }
+  }
+  BOOST_CHECK(mismatches == 0);
+
+  // With a glob, only the matching entries are stat-ed
+  filled = dirh.read({llfio::directory_handle::buffers_type(entries, std::move(filled)), "29*", llfio::directory_handle::filter::fastdeleted, {}, want::size}).value();
+  BOOST_CHECK(filled.size() == 111);
+  for(auto &entry : filled)
+  {
+    BOOST_CHECK(entry.stat.st_size == (llfio::handle::extent_type) std::stoul(entry.leafname.path().string()));
+  }
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, directory_handle_metadata, works, "Tests that directory enumeration fills additional metadata on request",
+                       TestDirectoryHandleMetadata())
@@ -573,6 +573,347 @@ static inline void TestDynamicThreadPoolGroupIoAwareWorks()
   BOOST_CHECK(paced > 0);
 }
 
+static inline void TestDynamicThreadPoolGroupIoAwareLatencyWorks()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  static constexpr size_t WORK_ITEMS = 4;
+  struct shared_state_t
+  {
+    llfio::file_handle h;
+    llfio::dynamic_thread_pool_group::io_aware_work_item::io_handle_awareness awareness;
+    std::atomic<bool> congested{false};
+    std::atomic<uint64_t> current_pacing{0};
+  } shared_state;
+  struct work_item final : public llfio::dynamic_thread_pool_group::io_aware_work_item
+  {
+    using _base = llfio::dynamic_thread_pool_group::io_aware_work_item;
+    shared_state_t *shared_state;
+
+    explicit work_item(shared_state_t *_shared_state)
+        : _base({&_shared_state->awareness, 1}, pacing_policy::latency)
+        , shared_state(_shared_state)
+    {
+    }
+    work_item(work_item &&o) noexcept
+        : _base(std::move(o))
+        , shared_state(o.shared_state)
+    {
+    }
+
+    virtual intptr_t io_aware_next(llfio::deadline &d) noexcept override
+    {
+      shared_state->current_pacing.store(d.nsecs, std::memory_order_relaxed);
+      return 1;
+    }
+    virtual llfio::result<void> operator()(intptr_t /*unused*/) noexcept override
+    {
+      // Simulate a storage device whose latency increases fivefold when congested
+      std::this_thread::sleep_for(std::chrono::milliseconds(shared_state->congested.load(std::memory_order_relaxed) ? 5 : 1));
+      return llfio::success();
+    }
+  };
+  shared_state.h = llfio::file_handle::temp_file().value();
+  shared_state.awareness.h = &shared_state.h;
+  std::vector<work_item> workitems;
+  for(size_t n = 0; n < WORK_ITEMS; n++)
+  {
+    workitems.emplace_back(&shared_state);
+    BOOST_CHECK(workitems.back().pacing() == llfio::dynamic_thread_pool_group::io_aware_work_item::pacing_policy::latency);
+  }
+  auto tpg = llfio::make_dynamic_thread_pool_group().value();
+  tpg->submit(llfio::span<work_item>(workitems)).value();
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  const auto uncongested_pacing = shared_state.current_pacing.load(std::memory_order_relaxed);
+  shared_state.congested = true;
+  uint64_t congested_pacing = 0;
+  for(auto begin = std::chrono::steady_clock::now(); std::chrono::steady_clock::now() - begin < std::chrono::milliseconds(500);)
+  {
+    congested_pacing = std::max(congested_pacing, shared_state.current_pacing.load(std::memory_order_relaxed));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  shared_state.congested = false;
+  std::this_thread::sleep_for(std::chrono::seconds(2));
+  const auto recovered_pacing = shared_state.current_pacing.load(std::memory_order_relaxed);
+  tpg->stop().value();
+  auto r = tpg->wait();
+  if(!r && r.error() != llfio::errc::operation_canceled)
+  {
+    r.value();
+  }
+  BOOST_CHECK(uncongested_pacing == 0);
+  BOOST_CHECK(congested_pacing > 0);
+  BOOST_CHECK(recovered_pacing < congested_pacing);
+}
+
+static inline void TestDynamicThreadPoolGroupNumaWorks()
+{
+  static constexpr size_t WORKITEMS = 64;
+  static constexpr intptr_t WORK_PER_ITEM = 100;
+  static constexpr int NONEXISTENT_NODE = 9999;
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  const auto nodes = llfio::dynamic_thread_pool_group::numa_nodes();
+  const auto mynode = llfio::dynamic_thread_pool_group::current_numa_node();
+  std::cout << "  This system has " << nodes << " NUMA nodes, the calling thread is on NUMA node " << mynode << std::endl;
+  BOOST_REQUIRE(nodes >= 1);
+  BOOST_CHECK(mynode >= -1);
+  struct shared_state_t
+  {
+    std::atomic<size_t> executed{0}, on_hinted_node{0}, hinted{0};
+  } shared_state;
+  struct work_item final : public llfio::dynamic_thread_pool_group::work_item
+  {
+    using _base = llfio::dynamic_thread_pool_group::work_item;
+    shared_state_t *shared{nullptr};
+    std::atomic<intptr_t> count{0};
+
+    explicit work_item(shared_state_t *_shared)
+        : shared(_shared)
+    {
+    }
+    work_item(work_item &&o) noexcept
+        : _base(std::move(o))
+        , shared(o.shared)
+    {
+    }
+
+    virtual intptr_t next(llfio::deadline & /*unused*/) noexcept override
+    {
+      auto ret = count.fetch_add(1, std::memory_order_relaxed);
+      return (ret >= WORK_PER_ITEM) ? -1 : (ret + 1);
+    }
+    virtual llfio::result<void> operator()(intptr_t /*unused*/) noexcept override
+    {
+      shared->executed.fetch_add(1, std::memory_order_relaxed);
+      if(numa_node() >= 0 && numa_node() != NONEXISTENT_NODE)
+      {
+        shared->hinted.fetch_add(1, std::memory_order_relaxed);
+        if(llfio::dynamic_thread_pool_group::current_numa_node() == numa_node())
+        {
+          shared->on_hinted_node.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+      return llfio::success();
+    }
+  };
+  std::vector<work_item> workitems;
+  workitems.reserve(WORKITEMS);
+  for(size_t n = 0; n < WORKITEMS; n++)
+  {
+    workitems.emplace_back(&shared_state);
+    switch(n % 4)
+    {
+    case 0:
+      break;  // no preference
+    case 1:
+    case 2:
+      workitems.back().set_numa_node((mynode < 0) ? 0 : mynode);
+      break;
+    case 3:
+      workitems.back().set_numa_node(NONEXISTENT_NODE);  // a node which does not exist must still execute
+      break;
+    }
+  }
+  {
+    // The hint must survive relocation
+    work_item a(&shared_state);
+    a.set_numa_node(1);
+    work_item b(std::move(a));
+    BOOST_CHECK(b.numa_node() == 1);
+  }
+  auto tpg = llfio::make_dynamic_thread_pool_group().value();
+  tpg->submit(llfio::span<work_item>(workitems)).value();
+  tpg->wait().value();
+  BOOST_CHECK(shared_state.executed == WORKITEMS * WORK_PER_ITEM);
+  std::cout << "  " << shared_state.on_hinted_node << " of " << shared_state.hinted << " NUMA hinted work items executed on their hinted node." << std::endl;
+  if(nodes > 1)
+  {
+    // At least two thirds of the work items hinted with a real node ran on it, the rest
+    // having been stolen by otherwise idle kernel threads of other nodes
+    BOOST_CHECK(shared_state.on_hinted_node >= shared_state.hinted / 3 * 2);
+  }
+}
+
+static inline void TestDynamicThreadPoolGroupPriorityWorks()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  using priority_class = llfio::dynamic_thread_pool_group::priority_class;
+  const size_t concurrency = std::thread::hardware_concurrency();
+  struct shared_state_t
+  {
+    std::atomic<size_t> executed{0};
+    std::atomic<bool> cancelling{false};
+    std::atomic<int> nested_priority{-1};
+  };
+  struct work_item final : public llfio::dynamic_thread_pool_group::work_item
+  {
+    using _base = llfio::dynamic_thread_pool_group::work_item;
+    shared_state_t *shared{nullptr};
+    intptr_t remaining{-1};  // negative means until cancelled
+
+    explicit work_item(shared_state_t *_shared, intptr_t _remaining)
+        : shared(_shared)
+        , remaining(_remaining)
+    {
+    }
+    work_item(work_item &&o) noexcept
+        : _base(std::move(o))
+        , shared(o.shared)
+        , remaining(o.remaining)
+    {
+    }
+
+    virtual intptr_t next(llfio::deadline & /*unused*/) noexcept override
+    {
+      if(shared->cancelling.load(std::memory_order_relaxed))
+      {
+        return -1;
+      }
+      if(remaining < 0)
+      {
+        return 1;
+      }
+      return (remaining-- == 0) ? -1 : 1;
+    }
+    virtual llfio::result<void> operator()(intptr_t /*unused*/) noexcept override
+    {
+      if(shared->nested_priority.load(std::memory_order_relaxed) == -1)
+      {
+        // Nested groups inherit the priority class of their creator
+        auto nested = llfio::make_dynamic_thread_pool_group().value();
+        shared->nested_priority.store((int) nested->priority(), std::memory_order_relaxed);
+      }
+      auto begin = std::chrono::steady_clock::now();
+      while(std::chrono::steady_clock::now() - begin < std::chrono::microseconds(100))
+      {
+      }
+      shared->executed.fetch_add(1, std::memory_order_relaxed);
+      return llfio::success();
+    }
+  };
+  BOOST_CHECK(llfio::make_dynamic_thread_pool_group().value()->priority() == priority_class::normal);
+  shared_state_t background_state, latency_state;
+  auto background = llfio::make_dynamic_thread_pool_group(priority_class::background).value();
+  auto latency_critical = llfio::make_dynamic_thread_pool_group(priority_class::latency_critical).value();
+  BOOST_CHECK(background->priority() == priority_class::background);
+  BOOST_CHECK(latency_critical->priority() == priority_class::latency_critical);
+  std::vector<work_item> background_items, latency_items;
+  for(size_t n = 0; n < concurrency * 2; n++)
+  {
+    background_items.emplace_back(&background_state, -1);
+  }
+  for(size_t n = 0; n < concurrency * 4; n++)
+  {
+    latency_items.emplace_back(&latency_state, 100);
+  }
+  background->submit(llfio::span<work_item>(background_items)).value();
+  std::this_thread::sleep_for(std::chrono::milliseconds(250));
+  const auto background_before = background_state.executed.load(std::memory_order_relaxed);
+  latency_critical->submit(llfio::span<work_item>(latency_items)).value();
+  latency_critical->wait().value();
+  const auto background_during = background_state.executed.load(std::memory_order_relaxed) - background_before;
+  background_state.cancelling = true;
+  background->wait().value();
+  std::cout << "  While " << latency_state.executed << " latency critical work items executed, " << background_during
+            << " background work items executed." << std::endl;
+  BOOST_CHECK(background_before > 0);
+  BOOST_CHECK(latency_state.executed == concurrency * 4 * 100);
+  BOOST_CHECK(background_state.nested_priority == (int) priority_class::background);
+  BOOST_CHECK(latency_state.nested_priority == (int) priority_class::latency_critical);
+  if(llfio::string_view(llfio::dynamic_thread_pool_group::implementation_description()) == "Linux native")
+  {
+    // Latency critical work preempts background work, but starvation protection means background work still progresses
+    BOOST_CHECK(background_during > 0);
+    BOOST_CHECK(background_during < latency_state.executed / 4);
+  }
+}
+
+static inline void TestDynamicThreadPoolGroupSchedstatControllerWorks()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  using concurrency_controller_type = llfio::dynamic_thread_pool_group::concurrency_controller_type;
+  const bool is_linux_native = llfio::string_view(llfio::dynamic_thread_pool_group::implementation_description()) == "Linux native";
+  BOOST_CHECK(llfio::dynamic_thread_pool_group::concurrency_controller() ==
+              (is_linux_native ? concurrency_controller_type::proc_task_stat : concurrency_controller_type::system));
+  if(llfio::dynamic_thread_pool_group::concurrency_controller(concurrency_controller_type::schedstat_pressure) !=
+     concurrency_controller_type::schedstat_pressure)
+  {
+    std::cout << "  NOTE: The schedstat and pressure controller is not supported here, skipping." << std::endl;
+    return;
+  }
+  auto restore = llfio::make_scope_exit(
+  []() noexcept { llfio::dynamic_thread_pool_group::concurrency_controller(concurrency_controller_type::proc_task_stat); });
+  struct shared_state_t
+  {
+    std::atomic<unsigned> concurrency{0}, max_concurrency{0};
+    std::atomic<size_t> executed{0};
+  } shared_state;
+  struct work_item final : public llfio::dynamic_thread_pool_group::work_item
+  {
+    using _base = llfio::dynamic_thread_pool_group::work_item;
+    shared_state_t *shared{nullptr};
+    bool blocking{false};
+    std::atomic<intptr_t> remaining{50};
+
+    explicit work_item(shared_state_t *_shared, bool _blocking)
+        : shared(_shared)
+        , blocking(_blocking)
+    {
+    }
+    work_item(work_item &&o) noexcept
+        : _base(std::move(o))
+        , shared(o.shared)
+        , blocking(o.blocking)
+    {
+    }
+
+    virtual intptr_t next(llfio::deadline & /*unused*/) noexcept override { return (remaining.fetch_sub(1, std::memory_order_relaxed) <= 0) ? -1 : 1; }
+    virtual llfio::result<void> operator()(intptr_t /*unused*/) noexcept override
+    {
+      auto concurrency = shared->concurrency.fetch_add(1, std::memory_order_relaxed) + 1;
+      if(concurrency > shared->max_concurrency.load(std::memory_order_relaxed))
+      {
+        shared->max_concurrency.store(concurrency, std::memory_order_relaxed);
+      }
+      if(blocking)
+      {
+        // Simulate being blocked on i/o
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      }
+      else
+      {
+        auto begin = std::chrono::steady_clock::now();
+        while(std::chrono::steady_clock::now() - begin < std::chrono::milliseconds(2))
+        {
+        }
+      }
+      shared->executed.fetch_add(1, std::memory_order_relaxed);
+      shared->concurrency.fetch_sub(1, std::memory_order_relaxed);
+      return llfio::success();
+    }
+  };
+  const size_t concurrency = std::thread::hardware_concurrency();
+  for(bool blocking : {false, true})
+  {
+    shared_state.max_concurrency = 0;
+    shared_state.executed = 0;
+    std::vector<work_item> workitems;
+    for(size_t n = 0; n < concurrency * 4; n++)
+    {
+      workitems.emplace_back(&shared_state, blocking);
+    }
+    auto tpg = llfio::make_dynamic_thread_pool_group().value();
+    tpg->submit(llfio::span<work_item>(workitems)).value();
+    tpg->wait().value();
+    BOOST_CHECK(shared_state.executed == concurrency * 4 * 50);
+    BOOST_CHECK(shared_state.max_concurrency >= 1);
+    if(blocking)
+    {
+      // Blocked threads are replaced, so more work items run at once than there are CPUs
+      BOOST_CHECK(shared_state.max_concurrency > concurrency);
+    }
+  }
+}
+
 KERNELTEST_TEST_KERNEL(integration, llfio, dynamic_thread_pool_group, works, "Tests that llfio::dynamic_thread_pool_group works as expected",
                        TestDynamicThreadPoolGroupWorks())
 KERNELTEST_TEST_KERNEL(integration, llfio, dynamic_thread_pool_group, delay,
@@ -582,3 +923,13 @@ KERNELTEST_TEST_KERNEL(integration, llfio, dynamic_thread_pool_group, nested, "T
                        TestDynamicThreadPoolGroupNestingWorks())
 KERNELTEST_TEST_KERNEL(integration, llfio, dynamic_thread_pool_group, io_aware_work_item,
                        "Tests that llfio::dynamic_thread_pool_group::io_aware_work_item works as expected", TestDynamicThreadPoolGroupIoAwareWorks())
+KERNELTEST_TEST_KERNEL(integration, llfio, dynamic_thread_pool_group, io_aware_work_item_latency,
+                       "Tests that latency pacing of llfio::dynamic_thread_pool_group::io_aware_work_item works as expected",
+                       TestDynamicThreadPoolGroupIoAwareLatencyWorks())
+KERNELTEST_TEST_KERNEL(integration, llfio, dynamic_thread_pool_group, numa, "Tests that NUMA hints in llfio::dynamic_thread_pool_group work as expected",
+                       TestDynamicThreadPoolGroupNumaWorks())
+KERNELTEST_TEST_KERNEL(integration, llfio, dynamic_thread_pool_group, priority,
+                       "Tests that priority classes in llfio::dynamic_thread_pool_group work as expected", TestDynamicThreadPoolGroupPriorityWorks())
+KERNELTEST_TEST_KERNEL(integration, llfio, dynamic_thread_pool_group, schedstat_controller,
+                       "Tests that the schedstat and pressure controller of llfio::dynamic_thread_pool_group works as expected",
+                       TestDynamicThreadPoolGroupSchedstatControllerWorks())
@@ -0,0 +1,139 @@
+/* Integration test kernel for the block cache handle adapter
+(C) 2026 agent <agent@local> (2 commits)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#include "../test_kernel_decl.hpp"
+
+#include "quickcpplib/algorithm/small_prng.hpp"
+
+#include <vector>
+
+static inline void TestBlockCacheHandleAdapterWorks()
+{
+  static constexpr size_t testbytes = 1024 * 1024UL;
+  using namespace LLFIO_V2_NAMESPACE;
+  using LLFIO_V2_NAMESPACE::byte;
+  using QUICKCPPLIB_NAMESPACE::algorithm::small_prng::small_prng;
+
+  file_handle fh = file_handle::temp_inode().value();
+  // A cache of a quarter of the file
+  algorithm::block_cache_handle_adapter<file_handle> h(&fh, nullptr, file_handle::mode::write, file_handle::flag::none, nullptr, testbytes / 4, 4096, 4);
+  BOOST_CHECK(h.is_readable());
+  BOOST_CHECK(h.is_writable());
+  BOOST_REQUIRE(h.cache_capacity() == testbytes / 4);
+  const size_t bs = h.block_size();
+  BOOST_CHECK(bs >= 4096);
+
+  // Fill the file, keeping a shadow copy
+  std::vector<byte> shadow(testbytes);
+  small_prng rand;
+  for(auto &i : shadow)
+  {
+    i = (byte) rand();
+  }
+  BOOST_REQUIRE(h.write(0, {{shadow.data(), shadow.size()}}).value() == testbytes);
+  BOOST_CHECK(h.statistics().insertions == 0);
+
+  // Reading the same block twice must hit the second time
+  {
+    byte buffer[100];
+    BOOST_CHECK(h.read(bs + 10, {{buffer, 100}}).value() == 100);
+    BOOST_CHECK(!memcmp(buffer, shadow.data() + bs + 10, 100));
+    auto stats = h.statistics();
+    BOOST_CHECK(stats.misses == 1);
+    BOOST_CHECK(stats.insertions == 1);
+    BOOST_CHECK(h.read(bs + 20, {{buffer, 100}}).value() == 100);
+    BOOST_CHECK(!memcmp(buffer, shadow.data() + bs + 20, 100));
+    BOOST_CHECK(h.statistics().hits == 1);
+  }
+
+  // Random scatter reads and writes, mostly in a hot region
+  for(size_t i = 0; i < 5000; i++)
+  {
+    const bool hot = (rand() % 4) != 0;
+    const size_t range = hot ? testbytes / 16 : testbytes;
+    if(rand() % 8 == 0)
+    {
+      byte buffer[6000];
+      size_t offset = rand() % (range - 6000), length = rand() % 6000;
+      for(size_t n = 0; n < length; n++)
+      {
+        buffer[n] = (byte) rand();
+      }
+      BOOST_REQUIRE(h.write(offset, {{buffer, length}}).value() == length);
+      memcpy(shadow.data() + offset, buffer, length);
+    }
+    else
+    {
+      byte buffer1[5000], buffer2[5000];
+      size_t offset = rand() % range, length1 = rand() % 5000, length2 = rand() % 5000;
+      auto bytesread = h.read(offset, {{buffer1, length1}, {buffer2, length2}}).value();
+      BOOST_CHECK(bytesread == std::min(length1 + length2, testbytes - offset));
+      BOOST_CHECK(!memcmp(buffer1, shadow.data() + offset, std::min(length1, (size_t) bytesread)));
+      if(bytesread > length1)
+      {
+        BOOST_CHECK(!memcmp(buffer2, shadow.data() + offset + length1, bytesread - length1));
+      }
+    }
+  }
+  auto stats = h.statistics();
+  std::cout << "Block cache hits " << stats.hits << " misses " << stats.misses << " insertions " << stats.insertions << " evictions " << stats.evictions
+            << " invalidations " << stats.invalidations << std::endl;
+  BOOST_CHECK(stats.hits > stats.misses);
+  BOOST_CHECK(stats.evictions > 0);
+
+  // A sequential scan of the whole file must not flush out the hot region
+  h.reset_statistics();
+  {
+    std::vector<byte> buffer(testbytes);
+    BOOST_CHECK(h.read(0, {{buffer.data(), buffer.size()}}).value() == testbytes);
+    BOOST_CHECK(!memcmp(buffer.data(), shadow.data(), testbytes));
+    h.reset_statistics();
+    BOOST_CHECK(h.read(0, {{buffer.data(), testbytes / 32}}).value() == testbytes / 32);
+    BOOST_CHECK(!memcmp(buffer.data(), shadow.data(), testbytes / 32));
+    BOOST_CHECK(h.statistics().hits > h.statistics().misses);
+  }
+
+  // Modifying the file behind the adapter's back is visible after invalidation
+  {
+    byte b = (byte) ~(uint8_t) shadow[100];
+    fh.write(100, {{&b, 1}}).value();
+    shadow[100] = b;
+    h.invalidate({0, 4096});
+    byte buffer[16];
+    BOOST_CHECK(h.read(90, {{buffer, 16}}).value() == 16);
+    BOOST_CHECK(!memcmp(buffer, shadow.data() + 90, 16));
+  }
+
+  // Truncation drops blocks beyond the new end, and the partial last block is never cached
+  h.truncate(testbytes / 2 + 100).value();
+  h.truncate(testbytes).value();
+  memset(shadow.data() + testbytes / 2 + 100, 0, testbytes / 2 - 100);
+  {
+    std::vector<byte> buffer(testbytes);
+    BOOST_CHECK(h.read(0, {{buffer.data(), buffer.size()}}).value() == testbytes);
+    BOOST_CHECK(!memcmp(buffer.data(), shadow.data(), testbytes));
+  }
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, block_cache_handle_adapter, works, "Tests that the block cache handle adapter works as expected", TestBlockCacheHandleAdapterWorks())
@@ -0,0 +1,134 @@
+/* Integration test kernel for the checksum handle adapter
+(C) 2026 agent <agent@local> (3 commits)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#include "../test_kernel_decl.hpp"
+
+#include "quickcpplib/algorithm/small_prng.hpp"
+
+#include <vector>
+
+static inline void TestChecksumHandleAdapterWorks()
+{
+  static constexpr size_t testbytes = 1024 * 1024UL;
+  using namespace LLFIO_V2_NAMESPACE;
+  using LLFIO_V2_NAMESPACE::byte;
+  using QUICKCPPLIB_NAMESPACE::algorithm::small_prng::small_prng;
+
+  // Check the CRC32C implementation against the standard check value
+  BOOST_CHECK(algorithm::crc32c(0, reinterpret_cast<const byte *>("123456789"), 9) == 0xe3069283);
+
+  file_handle h1 = file_handle::temp_inode().value();
+  file_handle h2 = file_handle::temp_inode().value();
+  algorithm::checksum_handle_adapter<file_handle, file_handle> h(&h1, &h2);
+  BOOST_CHECK(h.is_readable());
+  BOOST_CHECK(h.is_writable());
+  BOOST_CHECK(h.block_size() == 4096);
+
+  // Write random lengths of random data at random offsets, keeping a shadow copy
+  std::vector<byte> shadow(testbytes);
+  small_prng rand;
+  for(size_t i = 0; i < 1000; i++)
+  {
+    byte buffer[8192];
+    size_t offset = rand() % (testbytes - 8192), length = rand() % 8192;
+    for(size_t n = 0; n < length; n++)
+    {
+      buffer[n] = (byte) rand();
+    }
+    BOOST_REQUIRE(h.write(offset, {{buffer, length}}).value() == length);
+    memcpy(shadow.data() + offset, buffer, length);
+  }
+  const auto maxextent = h.maximum_extent().value();
+  BOOST_CHECK(maxextent == h1.maximum_extent().value());
+  BOOST_CHECK(h2.maximum_extent().value() == (maxextent + 4095) / 4096 * 4);
+
+  // Read random scatter lists back, they should match and verify
+  for(size_t i = 0; i < 1000; i++)
+  {
+    byte buffer1[4096], buffer2[4096];
+    size_t offset = rand() % testbytes, length1 = rand() % 4096, length2 = rand() % 4096;
+    auto bytesread = h.read(offset, {{buffer1, length1}, {buffer2, length2}}).value();
+    if(offset + length1 + length2 > maxextent)
+    {
+      BOOST_CHECK(offset + bytesread == std::max((size_t) maxextent, offset));
+    }
+    else
+    {
+      BOOST_CHECK(bytesread == length1 + length2);
+    }
+    BOOST_CHECK(!memcmp(buffer1, shadow.data() + offset, std::min(length1, (size_t) bytesread)));
+    if(bytesread > length1)
+    {
+      BOOST_CHECK(!memcmp(buffer2, shadow.data() + offset + length1, bytesread - length1));
+    }
+  }
+
+  // Corrupt a byte behind the adapter's back, reading that block must now fail
+  {
+    byte corrupt = (byte) ~(uint8_t) shadow[5000];
+    h1.write(5000, {{&corrupt, 1}}).value();
+    byte buffer[16];
+    auto r = h.read(4990, {{buffer, 16}});
+    BOOST_CHECK(!r);
+    if(!r)
+    {
+      BOOST_CHECK(r.error() == errc::illegal_byte_sequence);
+    }
+    // Other blocks are unaffected
+    BOOST_CHECK(h.read(0, {{buffer, 16}}).value() == 16);
+    // Writes into the corrupted block are refused
+    BOOST_CHECK(!h.write(4090, {{buffer, 16}}));
+    // Adopting the corruption makes it readable again
+    h.rebuild_checksums({5000, 1}).value();
+    BOOST_CHECK(h.read(4990, {{buffer, 16}}).value() == 16);
+    shadow[5000] = corrupt;
+  }
+
+  // Truncation to mid block and extension must keep verifying
+  h.truncate(testbytes / 2 + 100).value();
+  h.truncate(testbytes).value();
+  memset(shadow.data() + testbytes / 2 + 100, 0, testbytes / 2 - 100);
+  {
+    std::vector<byte> buffer(testbytes);
+    BOOST_CHECK(h.read(0, {{buffer.data(), buffer.size()}}).value() == testbytes);
+    BOOST_CHECK(!memcmp(buffer.data(), shadow.data(), testbytes));
+  }
+
+  // Reads across the end of the file return only what was read
+  h.truncate(10000).value();
+  {
+    byte buffer1[500], buffer2[1000], buffer3[1000];
+    file_handle::buffer_type buffers[] = {{buffer1, sizeof(buffer1)}, {buffer2, sizeof(buffer2)}, {buffer3, sizeof(buffer3)}};
+    auto filled = h.read({buffers, 9000}).value();
+    BOOST_REQUIRE(filled.size() == 2);
+    BOOST_CHECK(filled[0].size() == 500);
+    BOOST_CHECK(filled[1].size() == 500);
+    BOOST_CHECK(!memcmp(filled[0].data(), shadow.data() + 9000, 500));
+    BOOST_CHECK(!memcmp(filled[1].data(), shadow.data() + 9500, 500));
+    BOOST_CHECK(h.read(10000, {{buffer1, sizeof(buffer1)}}).value() == 0);
+    BOOST_CHECK(h.read(20000, {{buffer1, sizeof(buffer1)}}).value() == 0);
+  }
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, checksum_handle_adapter, works, "Tests that the checksum handle adapter works as expected", TestChecksumHandleAdapterWorks())
@@ -0,0 +1,137 @@
+/* Integration test kernel for the striped handle adapter
+(C) 2026 agent <agent@local> (4 commits)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#include "../test_kernel_decl.hpp"
+
+#include "quickcpplib/algorithm/small_prng.hpp"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+static inline void TestStripedHandleAdapterWorks()
+{
+  static constexpr size_t testbytes = 1024 * 1024UL, stripe = 4096, members = 3;
+  using namespace LLFIO_V2_NAMESPACE;
+  using LLFIO_V2_NAMESPACE::byte;
+  using QUICKCPPLIB_NAMESPACE::algorithm::small_prng::small_prng;
+  file_handle hs[members] = {file_handle::temp_inode().value(), file_handle::temp_inode().value(), file_handle::temp_inode().value()};
+  file_handle *ptrs[members] = {&hs[0], &hs[1], &hs[2]};
+  algorithm::striped_handle_adapter<file_handle> h(ptrs, stripe);
+  BOOST_CHECK(h.is_readable());
+  BOOST_CHECK(h.is_writable());
+  BOOST_CHECK(h.members() == members);
+  BOOST_CHECK(h.stripe_size() == stripe);
+
+  // Write the whole file in one go
+  std::vector<byte> shadow(testbytes);
+  small_prng rand;
+  for(auto &i : shadow)
+  {
+    i = (byte) rand();
+  }
+  BOOST_REQUIRE(h.write(0, {{shadow.data(), shadow.size()}}).value() == testbytes);
+  BOOST_CHECK(h.maximum_extent().value() == testbytes);
+  for(size_t n = 0; n < members; n++)
+  {
+    // Each member has every third stripe
+    const auto extent = hs[n].maximum_extent().value();
+    BOOST_CHECK(extent >= (testbytes / stripe / members) * stripe);
+    BOOST_CHECK(extent <= (testbytes / stripe / members + 1) * stripe);
+    byte buffer[stripe];
+    BOOST_CHECK(hs[n].read(0, {{buffer, stripe}}).value() == stripe);
+    BOOST_CHECK(!memcmp(buffer, shadow.data() + n * stripe, stripe));
+    const auto stats = h.statistics(n);
+    BOOST_CHECK(stats.writes == 1);
+    BOOST_CHECK(stats.bytes_written == extent);
+    std::cout << "Member " << n << " wrote " << stats.bytes_written << " bytes at " << (stats.write_throughput() / 1024 / 1024) << " Mb/sec" << std::endl;
+  }
+
+  // Random scatter reads straddling stripes must match
+  for(size_t i = 0; i < 1000; i++)
+  {
+    byte buffer1[8192], buffer2[8192];
+    size_t offset = rand() % testbytes, length1 = rand() % 8192, length2 = rand() % 8192;
+    auto bytesread = h.read(offset, {{buffer1, length1}, {buffer2, length2}}).value();
+    if(offset + length1 + length2 > testbytes)
+    {
+      BOOST_CHECK(offset + bytesread == testbytes);
+    }
+    else
+    {
+      BOOST_CHECK(bytesread == length1 + length2);
+    }
+    BOOST_CHECK(!memcmp(buffer1, shadow.data() + offset, std::min(length1, (size_t) bytesread)));
+    if(bytesread > length1)
+    {
+      BOOST_CHECK(!memcmp(buffer2, shadow.data() + offset + length1, bytesread - length1));
+    }
+  }
+  for(size_t n = 0; n < members; n++)
+  {
+    BOOST_CHECK(h.statistics(n).reads > 0);
+  }
+
+  // Truncation mid stripe
+  h.truncate(testbytes / 2 + 100).value();
+  BOOST_CHECK(h.maximum_extent().value() == testbytes / 2 + 100);
+  h.reset_statistics();
+  BOOST_CHECK(h.statistics(0).reads == 0);
+}
+
+static inline void TestStripedHandleAdapterTimesMembersSeparately()
+{
+  static constexpr size_t stripe = 4096;
+  using namespace LLFIO_V2_NAMESPACE;
+  using LLFIO_V2_NAMESPACE::byte;
+  // A member whose reads take at least 100ms
+  struct slow_file_handle final : public file_handle
+  {
+    explicit slow_file_handle(file_handle &&o)
+        : file_handle(std::move(o))
+    {
+    }
+    virtual io_result<buffers_type> _do_read(io_request<buffers_type> reqs, deadline d) noexcept override
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      return file_handle::_do_read(reqs, d);
+    }
+  };
+  slow_file_handle slow(file_handle::temp_inode().value());
+  file_handle fast = file_handle::temp_inode().value();
+  file_handle *ptrs[] = {&slow, &fast};
+  // Without parallelism, the slow member is read before the fast one
+  algorithm::striped_handle_adapter<file_handle> h(ptrs, stripe, file_handle::mode::write, file_handle::flag::disable_parallelism);
+  std::vector<byte> buffer(stripe * 2, to_byte(78));
+  BOOST_REQUIRE(h.write(0, {{buffer.data(), buffer.size()}}).value() == buffer.size());
+  BOOST_REQUIRE(h.read(0, {{buffer.data(), buffer.size()}}).value() == buffer.size());
+  BOOST_CHECK(h.statistics(0).read_time >= std::chrono::milliseconds(100));
+  // The fast member's time must not include the slow member's
+  BOOST_CHECK(h.statistics(1).reads == 1);
+  BOOST_CHECK(h.statistics(1).read_time < std::chrono::milliseconds(50));
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, striped_handle_adapter, works, "Tests that the striped handle adapter works as expected", TestStripedHandleAdapterWorks())
+KERNELTEST_TEST_KERNEL(integration, llfio, striped_handle_adapter, member_times, "Tests that the striped handle adapter times each member separately",
+                       TestStripedHandleAdapterTimesMembersSeparately())
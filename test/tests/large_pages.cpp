@@ -112,6 +112,39 @@ static inline void TestLargeFileMappedPages()
 #endif
 }
 
+static inline void TestTransparentHugePages()
+{
+#ifdef __linux__
+  using namespace LLFIO_V2_NAMESPACE;
+  using LLFIO_V2_NAMESPACE::byte;
+  static constexpr size_t length = 64 * 1024 * 1024;
+  map_handle mh(map_handle::map(length, false, section_handle::flag::readwrite | section_handle::flag::transparent_huge_pages).value());
+  BOOST_REQUIRE(mh.address() != nullptr);
+  BOOST_CHECK(mh.page_size() == utils::page_size());
+  if(utils::page_size() == 4096)
+  {
+    BOOST_CHECK(((uintptr_t) mh.address() & (2 * 1024 * 1024 - 1)) == 0);
+  }
+  memset(mh.address(), 0x78, length);
+  auto collapsed = mh.collapse_to_huge_pages({mh.address(), length});
+  if(!collapsed)
+  {
+    BOOST_CHECK((collapsed.error() == errc::operation_not_supported || collapsed.error() == errc::resource_unavailable_try_again ||
+                 collapsed.error() == errc::not_enough_memory));
+  }
+  auto hugebytes = mh.huge_page_bytes().value();
+  std::cout << "After touching and collapsing " << (length / 1024 / 1024) << "Mb, " << (hugebytes / 1024 / 1024)
+            << "Mb is backed by transparent huge pages." << std::endl;
+  BOOST_CHECK(hugebytes <= length);
+  // A map not asking for huge pages still works
+  map_handle mh2(map_handle::map(4096, false, section_handle::flag::readwrite).value());
+  BOOST_CHECK(mh2.huge_page_bytes().value() == 0);
+#else
+  BOOST_TEST_MESSAGE("Transparent huge pages are only implemented on Linux. So skipping this test.");
+#endif
+}
+
 KERNELTEST_TEST_KERNEL(integration, llfio, map_handle, large_mem_mapped_pages, "Tests that large page support for allocating memory works as expected", TestLargeMemMappedPages())
 KERNELTEST_TEST_KERNEL(integration, llfio, map_handle, large_kernel_mapped_pages, "Tests that large page support for mapping kernel memory works as expected", TestLargeKernelMappedPages())
 KERNELTEST_TEST_KERNEL(integration, llfio, map_handle, large_file_mapped_pages, "Tests that large page support for mapping files works as expected", TestLargeFileMappedPages())
+KERNELTEST_TEST_KERNEL(integration, llfio, map_handle, transparent_huge_pages, "Tests that transparent huge page support works as expected", TestTransparentHugePages())
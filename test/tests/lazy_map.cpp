@@ -0,0 +1,114 @@
+/* Integration test kernel for lazy_map
+(C) 2026 agent <agent@local> (5 commits)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#include "../test_kernel_decl.hpp"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+static inline void TestLazyMap()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  using LLFIO_V2_NAMESPACE::byte;
+  const size_t pagesize = llfio::utils::page_size();
+  static constexpr size_t pages = 1000;
+  // The source is shorter than the map, so the tail should read as zeros
+  auto source = llfio::file_handle::temp_inode().value();
+  {
+    std::vector<byte> buffer((pages - 10) * pagesize);
+    for(size_t n = 0; n < buffer.size(); n += pagesize)
+    {
+      memset(buffer.data() + n, (int) ((n / pagesize) & 0xff) | 1, pagesize);
+    }
+    source.write(pagesize, {{buffer.data(), buffer.size()}}).value();
+  }
+  auto r = llfio::algorithm::lazy_map::map(source, pagesize, pages * pagesize);
+  if(!r && (r.error() == llfio::errc::operation_not_supported || r.error() == llfio::errc::operation_not_permitted ||
+            r.error() == llfio::errc::function_not_supported))
+  {
+    std::cout << "NOTE: lazy_map is not available on this system (" << r.error().message() << "), skipping test." << std::endl;
+    return;
+  }
+  auto lm = std::move(r).value();
+  BOOST_REQUIRE(lm.length() == pages * pagesize);
+  BOOST_CHECK(lm.statistics().pages_populated == 0);
+
+  // Touch every third page. Read ahead should need far fewer faults than pages touched.
+  size_t mismatches = 0;
+  for(size_t page = 0; page < pages; page += 3)
+  {
+    const auto expected = (page < pages - 10) ? (((int) page & 0xff) | 1) : 0;
+    if(lm.address()[page * pagesize + 7] != (byte) expected)
+    {
+      mismatches++;
+    }
+  }
+  BOOST_CHECK(mismatches == 0);
+  // Writes to populated pages stick, and are never written to the source
+  lm.address()[5] = (byte) 0xfe;
+  BOOST_CHECK(lm.address()[5] == (byte) 0xfe);
+  auto stats = lm.statistics();
+  std::cout << "Touching " << (pages / 3 + 1) << " pages took " << stats.faults << " faults, populating " << stats.pages_populated << " pages, reading "
+            << stats.bytes_read << " bytes." << std::endl;
+  BOOST_CHECK(stats.faults < pages / 3 / 4);
+  BOOST_CHECK(stats.pages_populated == pages);
+  BOOST_CHECK(lm.is_fully_populated());
+  BOOST_CHECK(stats.read_errors == 0);
+  BOOST_CHECK(lm.error());
+#ifdef __linux__
+  // Discarded pages fault again, and are read afresh from the source
+  BOOST_REQUIRE(-1 != ::madvise(lm.address() + 100 * pagesize, 10 * pagesize, MADV_DONTNEED));
+  for(size_t page = 100; page < 110; page++)
+  {
+    if(lm.address()[page * pagesize + 7] != (byte) (((int) page & 0xff) | 1))
+    {
+      mismatches++;
+    }
+  }
+  BOOST_CHECK(mismatches == 0);
+  BOOST_CHECK(lm.statistics().faults > stats.faults);
+  BOOST_CHECK(lm.statistics().pages_populated == pages);
+#endif
+  lm.close().value();
+  byte check[1];
+  source.read(pagesize + 5, {{check, 1}}).value();
+  BOOST_CHECK(check[0] == (byte) 1);
+
+  // Background population fills the whole map without any access
+  lm = llfio::algorithm::lazy_map::map(source, pagesize, pages * pagesize, {16, 256, true}).value();
+  for(size_t n = 0; n < 1000 && !lm.is_fully_populated(); n++)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  BOOST_CHECK(lm.is_fully_populated());
+  BOOST_CHECK(lm.statistics().background_pages == pages);
+  BOOST_CHECK(lm.address()[(pages - 11) * pagesize] == (byte) ((int) ((pages - 11) & 0xff) | 1));
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, lazy_map, works, "Tests that lazy_map works as expected", TestLazyMap())
@@ -120,8 +120,102 @@ static inline void TestMappedFileHandleSubsets()
   }
 }
 
+static inline void TestMappedFileHandleReadahead()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  static constexpr size_t length = 16 * DATA_SIZE, record = 4096;
+  auto mf = llfio::mapped_file_handle::mapped_temp_inode(length).value();
+  mf.truncate(length).value();
+  BOOST_CHECK(!mf.adaptive_readahead());
+  auto read = [&](size_t offset) {
+    llfio::mapped_file_handle::buffer_type b(nullptr, record);
+    llfio::mapped_file_handle::io_request<llfio::mapped_file_handle::buffers_type> req({&b, 1}, offset);
+    mf.read(req).value();
+    BOOST_CHECK(b.data() == mf.address() + offset);
+  };
+  read(0);
+  BOOST_CHECK(mf.readahead_stats().reads == 0);
+  mf.set_adaptive_readahead(true);
+
+  // Sequential scan
+  for(size_t offset = 0; offset < length / 2; offset += record)
+  {
+    read(offset);
+  }
+  auto stats = mf.readahead_stats();
+  BOOST_CHECK(stats.reads == length / 2 / record);
+  BOOST_CHECK(stats.sequential_reads == stats.reads - 1);
+  BOOST_CHECK(stats.misses == 1);
+  BOOST_CHECK(stats.hits == stats.reads - 2);
+  BOOST_CHECK(stats.window == 16 * 1024 * 1024);
+  BOOST_CHECK(stats.prefetches < stats.reads / 4);
+  BOOST_CHECK(stats.bytes_prefetched <= length);
+
+  // Jumping elsewhere ends the stream and shrinks the window
+  read(length - record);
+  stats = mf.readahead_stats();
+  BOOST_CHECK(stats.random_reads == 2);
+  BOOST_CHECK(stats.bytes_wasted > 0);
+  BOOST_CHECK(stats.window == 8 * 1024 * 1024);
+
+  // Strided scan
+  const auto before = stats;
+  for(size_t offset = length / 2; offset < length - record; offset += 16 * record)
+  {
+    read(offset);
+  }
+  stats = mf.readahead_stats();
+  BOOST_CHECK(stats.strided_reads - before.strided_reads == stats.reads - before.reads - 2);
+  BOOST_CHECK(stats.hits - before.hits == stats.reads - before.reads - 3);
+}
+static inline void TestMappedFileHandleWrittenPages()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  auto mf =
+  llfio::mapped_file_handle::mapped_temp_inode(DATA_SIZE, llfio::path_discovery::storage_backed_temporary_files_directory(), llfio::file_handle::mode::write,
+                                               llfio::file_handle::flag::none, llfio::section_handle::flag::track_written_pages)
+  .value();
+  mf.truncate(DATA_SIZE).value();
+  llfio::map_handle::buffer_type regions[16];
+  auto written = mf.map().written_regions(regions);
+  if(!written && written.error() == llfio::errc::operation_not_supported)
+  {
+    BOOST_TEST_MESSAGE("Written page tracking is not supported on this platform or kernel. So skipping this test.");
+    return;
+  }
+  BOOST_REQUIRE(written);
+  BOOST_CHECK(written.value().empty());
+  const auto pagesize = mf.page_size();
+  auto *addr = mf.address();
+  addr[3 * pagesize] = llfio::to_byte(1);
+  addr[4 * pagesize + 100] = llfio::to_byte(2);
+  addr[100 * pagesize] = llfio::to_byte(3);
+  written = mf.map().written_regions(regions);
+  BOOST_REQUIRE(written);
+  BOOST_REQUIRE(written.value().size() == 2);
+  BOOST_CHECK(written.value()[0].data() == addr + 3 * pagesize);
+  BOOST_CHECK(written.value()[0].size() == 2 * pagesize);
+  BOOST_CHECK(written.value()[1].data() == addr + 100 * pagesize);
+  BOOST_CHECK(written.value()[1].size() == pagesize);
+  // Reading does not count as writing, and a barrier resets tracking
+  BOOST_CHECK(addr[200 * pagesize] == llfio::to_byte(0));
+  mf.barrier().value();
+  BOOST_CHECK(mf.map().written_regions(regions).value().empty());
+  addr[7 * pagesize] = llfio::to_byte(4);
+  written = mf.map().written_regions(regions);
+  BOOST_REQUIRE(written.value().size() == 1);
+  BOOST_CHECK(written.value()[0].data() == addr + 7 * pagesize);
+  mf.barrier().value();
+  BOOST_CHECK(mf.map().written_regions(regions).value().empty());
+}
 
 KERNELTEST_TEST_KERNEL(integration, llfio, mapped_file_handle, cache, "Tests that the mapped_file_handle works as expected", TestMappedFileHandle())
 
 KERNELTEST_TEST_KERNEL(integration, llfio, mapped_file_handle, subsets, "Tests that the mapped_file_handle subsets works as expected",
                        TestMappedFileHandleSubsets())
+
+KERNELTEST_TEST_KERNEL(integration, llfio, mapped_file_handle, readahead, "Tests that the mapped_file_handle adaptive readahead works as expected",
+                       TestMappedFileHandleReadahead())
+
+KERNELTEST_TEST_KERNEL(integration, llfio, mapped_file_handle, written_pages, "Tests that the mapped_file_handle written page tracking works as expected",
+                       TestMappedFileHandleWrittenPages())
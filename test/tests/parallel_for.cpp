@@ -0,0 +1,141 @@
+/* Integration test kernel for parallel_for and parallel_reduce
+(C) 2026 agent <agent@local> (2 commits)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#include "../test_kernel_decl.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static inline void TestParallelFor()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  static constexpr size_t ITEMS = 1000000;
+  std::vector<std::atomic<unsigned>> seen(ITEMS);
+  for(size_t grain : {(size_t) 0, (size_t) 1, (size_t) 1000, ITEMS})
+  {
+    for(auto &i : seen)
+    {
+      i.store(0, std::memory_order_relaxed);
+    }
+    llfio::algorithm::parallel_for(0, ITEMS, grain,
+                                   [&](size_t begin, size_t end) {
+                                     for(size_t n = begin; n < end; n++)
+                                     {
+                                       seen[n].fetch_add(1, std::memory_order_relaxed);
+                                     }
+                                   })
+    .value();
+    size_t wrong = 0;
+    for(auto &i : seen)
+    {
+      wrong += (i.load(std::memory_order_relaxed) != 1);
+    }
+    std::cout << "With grain " << grain << ", " << wrong << " items were not executed exactly once." << std::endl;
+    BOOST_CHECK(wrong == 0);
+  }
+  // Empty ranges do nothing
+  llfio::algorithm::parallel_for(5, 5, 0, [](size_t, size_t) { abort(); }).value();
+
+  // Failures and exceptions are returned
+  auto r = llfio::algorithm::parallel_for(0, 1000, 1, [](size_t begin, size_t /*unused*/) -> llfio::result<void> {
+    if(begin == 500)
+    {
+      return llfio::errc::invalid_argument;
+    }
+    return llfio::success();
+  });
+  BOOST_REQUIRE(!r);
+  BOOST_CHECK(r.error() == llfio::errc::invalid_argument);
+  r = llfio::algorithm::parallel_for(0, 1000, 1, [](size_t begin, size_t /*unused*/) {
+    if(begin == 500)
+    {
+      throw std::runtime_error("boom");
+    }
+  });
+  BOOST_CHECK(!r);
+
+  // Stopping the group cancels the remainder
+  auto group = llfio::make_dynamic_thread_pool_group().value();
+  std::atomic<size_t> executed{0};
+  r = llfio::algorithm::parallel_for(*group, 0, ITEMS, 1, [&](size_t begin, size_t /*unused*/) {
+    if(begin == 100)
+    {
+      (void) group->stop();
+    }
+    executed.fetch_add(1, std::memory_order_relaxed);
+  });
+  std::cout << "After cancellation, " << executed << " of " << ITEMS << " items were executed." << std::endl;
+  BOOST_REQUIRE(!r);
+  BOOST_CHECK(r.error() == llfio::errc::operation_canceled);
+  BOOST_CHECK(executed < ITEMS);
+}
+
+static inline void TestParallelReduce()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  static constexpr size_t ITEMS = 100000;
+  for(size_t grain : {(size_t) 0, (size_t) 7, (size_t) 10000})
+  {
+    // The cost of each item grows with its index, so work must be rebalanced to finish promptly
+    auto sum = llfio::algorithm::parallel_reduce(
+               0, ITEMS, grain, (uint64_t) 0,
+               [](size_t begin, size_t end, uint64_t &accumulator) {
+                 for(size_t n = begin; n < end; n++)
+                 {
+                   volatile uint64_t x = 0;
+                   for(size_t i = 0; i < n / 1000; i++)
+                   {
+                     x = x + i;
+                   }
+                   accumulator += n;
+                 }
+               },
+               [](uint64_t a, uint64_t b) { return a + b; })
+               .value();
+    BOOST_CHECK(sum == (uint64_t) ITEMS * (ITEMS - 1) / 2);
+  }
+  // Accumulators need not be trivial
+  auto longest = llfio::algorithm::parallel_reduce(
+                 0, 1000, 0, std::string(),
+                 [](size_t begin, size_t end, std::string &accumulator) {
+                   for(size_t n = begin; n < end; n++)
+                   {
+                     auto s = std::to_string(n);
+                     if(s.size() > accumulator.size() || (s.size() == accumulator.size() && s > accumulator))
+                     {
+                       accumulator = std::move(s);
+                     }
+                   }
+                 },
+                 [](std::string a, std::string b) { return (b.size() > a.size() || (b.size() == a.size() && b > a)) ? b : a; })
+                 .value();
+  BOOST_CHECK(longest == "999");
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, algorithm, parallel_for, "Tests that llfio::algorithm::parallel_for() works as expected", TestParallelFor())
+KERNELTEST_TEST_KERNEL(integration, llfio, algorithm, parallel_reduce, "Tests that llfio::algorithm::parallel_reduce() works as expected", TestParallelReduce())
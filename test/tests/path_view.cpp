@@ -24,6 +24,9 @@ Distributed under the Boost Software License, Version 1.0.
 
 #include "../test_kernel_decl.hpp"
 
+#include <string>
+#include <vector>
+
 template <class U> inline void CheckPathView(const LLFIO_V2_NAMESPACE::filesystem::path &p, const char *desc, U &&c)
 {
   using LLFIO_V2_NAMESPACE::path_view;
@@ -332,3 +335,95 @@ static inline void TestPathView()
 }
 
 KERNELTEST_TEST_KERNEL(integration, llfio, path_view, path_view, "Tests that llfio::path_view() works as expected", TestPathView())
+
+static inline void TestPathViewSeparatorScanning()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  // Components of every length either side of a sixteen byte boundary, in narrow and wide encodings
+  std::string narrow;
+  std::wstring wide;
+  std::vector<std::string> components;
+  for(size_t n = 1; n < 40; n++)
+  {
+    components.push_back(std::string(n, (char) ('a' + (n % 26))));
+    narrow.append("/").append(components.back());
+    wide.append(L"/").append(components.back().begin(), components.back().end());
+  }
+  for(auto sv : {llfio::path_view(narrow), llfio::path_view(wide)})
+  {
+    size_t idx = 0;
+    for(auto it = sv.begin(); it != sv.end(); ++it, ++idx)
+    {
+      if(idx == 0)
+      {
+        BOOST_CHECK(0 == it->compare<>("/"));
+      }
+      else
+      {
+        BOOST_CHECK(0 == it->compare<>(llfio::path_view(components[idx - 1])));
+      }
+    }
+    BOOST_CHECK(idx == components.size() + 1);
+    for(auto it = sv.end(); it != sv.begin(); --idx)
+    {
+      --it;
+      if(idx > 1)
+      {
+        BOOST_CHECK(0 == it->compare<>(llfio::path_view(components[idx - 2])));
+      }
+    }
+    BOOST_CHECK(idx == 0);
+    BOOST_CHECK(0 == sv.filename().compare<>(llfio::path_view(components.back())));
+    BOOST_CHECK(sv.parent_path().native_size() == sv.native_size() - components.back().size() - 1);
+  }
+
+  // Identical views compare equal without iteration, equal but not identical views still compare equal
+  std::string narrow2(narrow);
+  BOOST_CHECK(llfio::path_view(narrow) == llfio::path_view(narrow2));
+  BOOST_CHECK(0 == llfio::path_view(narrow).compare<>(llfio::path_view(narrow2)));
+  BOOST_CHECK(0 == llfio::path_view(narrow).compare<>(llfio::path_view(wide)));
+  narrow2.back() = 'Z';
+  BOOST_CHECK(llfio::path_view(narrow) != llfio::path_view(narrow2));
+  BOOST_CHECK(0 > llfio::path_view(narrow2).compare<>(llfio::path_view(narrow)) || 0 < llfio::path_view(narrow2).compare<>(llfio::path_view(narrow)));
+
+}
+
+static inline void TestInternedPath()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  using llfio::interned_path;
+  const auto before = interned_path::interned_count();
+  const char buffer[] = "foo/bar/baz.txtXXX";
+  auto a = interned_path::intern(llfio::path_view(buffer, 15, llfio::path_view::not_zero_terminated));
+  auto b = interned_path::intern(std::string("foo/bar/baz.txt"));
+  BOOST_CHECK(a == b);
+  BOOST_CHECK(a.hash() == b.hash());
+  BOOST_CHECK(std::hash<interned_path>()(a) == a.hash());
+  BOOST_CHECK(a.size() == 15);
+  BOOST_CHECK(a.c_str()[15] == 0);
+  BOOST_CHECK(interned_path::intern("foo/bar/baz.tx") != a);
+  BOOST_CHECK(interned_path::interned_count() == before + 2);
+  BOOST_CHECK(interned_path::intern(llfio::path_view()).empty());
+  {
+    // Rendering the view must refer to the interned storage, not to a copy of it
+    llfio::path_view v(a);
+    llfio::path_view::zero_terminated_rendered_path<> zpath(v);
+    BOOST_CHECK(zpath.data() == a.c_str());
+    BOOST_CHECK(0 == v.filename().compare<>("baz.txt"));
+  }
+  // Lots of interning must grow the table without losing anything
+  std::vector<interned_path> interned;
+  for(size_t n = 0; n < 10000; n++)
+  {
+    interned.push_back(interned_path::intern(std::to_string(n)));
+  }
+  for(size_t n = 0; n < 10000; n++)
+  {
+    BOOST_CHECK(interned_path::intern(std::to_string(n)) == interned[n]);
+  }
+
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, path_view, separator_scanning, "Tests that llfio::path_view separator scanning and comparison work as expected",
+                       TestPathViewSeparatorScanning())
+KERNELTEST_TEST_KERNEL(integration, llfio, path_view, interned_path, "Tests that llfio::interned_path works as expected", TestInternedPath())
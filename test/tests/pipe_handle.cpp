@@ -26,6 +26,7 @@ Distributed under the Boost Software License, Version 1.0.
 
 #include <future>
 #include <unordered_set>
+#include <vector>
 
 static inline void TestBlockingPipeHandle()
 {
@@ -367,8 +368,84 @@ static inline void TestCoroutinedPipeHandle()
 #endif
 #endif
 
+static inline void TestSplicePipeHandle()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  static constexpr size_t length = 4 * 1024 * 1024;
+  auto pipes = llfio::pipe_handle::anonymous_pipe().value();
+#ifdef __linux__
+  BOOST_CHECK(pipes.first.buffer_size().value() > 0);
+  BOOST_CHECK(pipes.second.set_buffer_size(256 * 1024).value() >= 256 * 1024);
+  BOOST_CHECK(pipes.first.buffer_size().value() >= 256 * 1024);
+#endif
+
+  // file => pipe => file
+  auto src = llfio::file_handle::temp_inode().value();
+  auto dest = llfio::file_handle::temp_inode().value();
+#ifdef __linux__
+  {  // the pipe is empty, so a zero deadline must not block
+    auto r = pipes.first.splice_to(dest, 0, 64, std::chrono::seconds(0));
+    BOOST_REQUIRE(!r);
+    BOOST_CHECK(r.error() == llfio::errc::timed_out);
+  }
+#endif
+  {
+    std::vector<llfio::byte> contents(length);
+    for(size_t n = 0; n < length; n++)
+    {
+      contents[n] = (llfio::byte)(n * 7 + (n >> 12));
+    }
+    src.write(0, {{contents.data(), contents.size()}}).value();
+  }
+  auto writerthread = std::async([&] {
+    llfio::file_handle::extent_type offset = 0;
+    while(offset < length)
+    {
+      auto moved = pipes.second.splice_from(src, offset, length - (size_t) offset).value();
+      BOOST_REQUIRE(moved > 0);
+      offset += moved;
+    }
+    pipes.second.close().value();
+  });
+  llfio::file_handle::extent_type offset = 0;
+  for(;;)
+  {
+    auto moved = pipes.first.splice_to(dest, offset, 1024 * 1024).value();
+    if(moved == 0)
+    {
+      break;
+    }
+    offset += moved;
+  }
+  writerthread.get();
+  BOOST_REQUIRE(offset == length);
+  BOOST_REQUIRE(dest.maximum_extent().value() == length);
+  {
+    std::vector<llfio::byte> a(length), b(length);
+    src.read(0, {{a.data(), a.size()}}).value();
+    dest.read(0, {{b.data(), b.size()}}).value();
+    BOOST_CHECK(0 == memcmp(a.data(), b.data(), length));
+  }
+
+  // gift, then tee into a second pipe
+  auto first = llfio::pipe_handle::anonymous_pipe().value();
+  auto second = llfio::pipe_handle::anonymous_pipe().value();
+  static const char hello[] = "hello";
+  llfio::pipe_handle::const_buffer_type b((const llfio::byte *) hello, 5);
+  BOOST_REQUIRE(first.second.gift({&b, 1}).value() == 5);
+  llfio::byte buffer[64];
+#ifdef __linux__
+  BOOST_REQUIRE(first.first.tee_to(second.second, 64).value() == 5);
+  BOOST_REQUIRE(second.first.read(0, {{buffer, 64}}).value() == 5);
+  BOOST_CHECK(0 == memcmp(buffer, "hello", 5));
+#endif
+  BOOST_REQUIRE(first.first.read(0, {{buffer, 64}}).value() == 5);
+  BOOST_CHECK(0 == memcmp(buffer, "hello", 5));
+}
+
 KERNELTEST_TEST_KERNEL(integration, llfio, pipe_handle, blocking, "Tests that blocking llfio::pipe_handle works as expected", TestBlockingPipeHandle())
 KERNELTEST_TEST_KERNEL(integration, llfio, pipe_handle, nonblocking, "Tests that nonblocking llfio::pipe_handle works as expected", TestNonBlockingPipeHandle())
+KERNELTEST_TEST_KERNEL(integration, llfio, pipe_handle, splice, "Tests that llfio::pipe_handle splice transfers work as expected", TestSplicePipeHandle())
 #if LLFIO_ENABLE_TEST_IO_MULTIPLEXERS
 KERNELTEST_TEST_KERNEL(integration, llfio, pipe_handle, multiplexed, "Tests that multiplexed llfio::pipe_handle works as expected", TestMultiplexedPipeHandle())
 #if LLFIO_ENABLE_COROUTINES
@@ -86,10 +86,72 @@ static inline void TestProcessHandle(bool with_redirection)
   }
 }
 
+static inline void TestProcessHandleWaitForAny()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  auto myexepath = llfio::process_handle::current().current_path().value();
+  llfio::path_view_component arg("--testchild,4");
+  auto child = llfio::process_handle::launch_process(myexepath, {&arg, 1}, llfio::process_handle::flag::wait_on_close |
+                                                                           llfio::process_handle::flag::no_redirect)
+               .value();
+  const llfio::process_handle *processes[] = {&child};
+  bool ready[1] = {true};
+  // The child sleeps for three seconds before exiting
+  auto r = llfio::process_handle::wait_for_any(processes, {}, ready, std::chrono::milliseconds(100));
+  BOOST_REQUIRE(!r);
+  BOOST_CHECK(r.error() == llfio::errc::timed_out);
+  auto begin = std::chrono::steady_clock::now();
+  BOOST_CHECK(llfio::process_handle::wait_for_any(processes, {}, ready, std::chrono::seconds(30)).value() == 1);
+  BOOST_CHECK(ready[0]);
+  // Exited processes are not reaped, so the exit code is still available
+  auto exitcode = child.wait(std::chrono::seconds(30)).value();
+  auto end = std::chrono::steady_clock::now();
+  BOOST_CHECK(exitcode == 5);
+  std::cout << "Waiting for child process exit took " << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count() << " ms" << std::endl;
+  BOOST_CHECK(end - begin < std::chrono::seconds(10));
+}
+
+static inline void TestProcessHandleSpawnTemplate()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  auto myexepath = llfio::process_handle::current().current_path().value();
+  llfio::path_view_component arg("--testchild,5");
+  auto t = llfio::process_handle::make_spawn_template(myexepath, {&arg, 1}).value();
+  BOOST_CHECK(0 == t.path().compare<>(llfio::path_view(myexepath)));
+  BOOST_CHECK(t.args().size() == 1);
+  std::vector<llfio::process_handle> children;
+  for(size_t n = 0; n < 4; n++)
+  {
+    children.push_back(llfio::process_handle::launch_process(t).value());
+  }
+  for(size_t n = 0; n < 4; n++)
+  {
+    char _buffer[256];
+    llfio::pipe_handle::buffer_type buffer((llfio::byte *) _buffer, sizeof(_buffer));
+    children[n].in_pipe().read({{&buffer, 1}, 0}).value();
+    _buffer[buffer.size()] = 0;
+    BOOST_CHECK(0 == strncmp(_buffer, "I am child process 5", 20));
+  }
+  for(auto &child : children)
+  {
+    BOOST_CHECK(child.wait().value() == 6);
+  }
+#ifndef _WIN32
+  // A failure to exec is reported to the caller
+  auto bad = llfio::process_handle::make_spawn_template("/nonexistent/llfio_test_binary", {&arg, 1}).value();
+  auto r = llfio::process_handle::launch_process(bad);
+  BOOST_CHECK(!r);
+#endif
+}
+
 KERNELTEST_TEST_KERNEL(integration, llfio, process_handle, no_redirect, "Tests that llfio::process_handle without redirection works as expected",
                        TestProcessHandle(false))
 KERNELTEST_TEST_KERNEL(integration, llfio, process_handle, redirect, "Tests that llfio::process_handle with redirection works as expected",
                        TestProcessHandle(true))
+KERNELTEST_TEST_KERNEL(integration, llfio, process_handle, wait_for_any, "Tests that llfio::process_handle::wait_for_any() works as expected",
+                       TestProcessHandleWaitForAny())
+KERNELTEST_TEST_KERNEL(integration, llfio, process_handle, spawn_template, "Tests that llfio::process_handle::spawn_template works as expected",
+                       TestProcessHandleSpawnTemplate())
 
 int main(int argc, char *argv[])
 {
@@ -0,0 +1,91 @@
+/* Integration test kernel for the process memory and CPU sampler
+(C) 2026 agent <agent@local> (2 commits)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+
+#include "../test_kernel_decl.hpp"
+
+#include <thread>
+#include <vector>
+
+static inline void TestProcessSampler()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  using LLFIO_V2_NAMESPACE::byte;
+  auto sampler = llfio::algorithm::process_sampler::start(std::chrono::milliseconds(10), 1024).value();
+  BOOST_CHECK(sampler.is_sampling());
+  BOOST_CHECK(sampler.size() >= 1);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  // Dirty 64Mb in a phase of our own
+  static constexpr size_t bytes = 64 * 1024 * 1024;
+  BOOST_CHECK(sampler.set_phase(1) == 0);
+  {
+    auto mh = llfio::map_handle::map(bytes).value();
+    for(size_t n = 0; n < bytes; n += llfio::utils::page_size())
+    {
+      mh.address()[n] = (byte) 1;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  sampler.set_phase(2);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  sampler.stop().value();
+  BOOST_CHECK(!sampler.is_sampling());
+
+  std::vector<llfio::algorithm::process_sample> samples(sampler.size());
+  BOOST_REQUIRE(sampler.samples(samples) == samples.size());
+  BOOST_REQUIRE(samples.size() >= 10);
+  size_t phase1 = 0;
+  for(size_t n = 1; n < samples.size(); n++)
+  {
+    BOOST_CHECK(samples[n].when > samples[n - 1].when);
+    BOOST_CHECK(samples[n].delta.elapsed == samples[n].when - samples[n - 1].when);
+    BOOST_CHECK(samples[n].delta.total_address_space_paged_in ==
+                (int64_t) samples[n].memory.total_address_space_paged_in - (int64_t) samples[n - 1].memory.total_address_space_paged_in);
+    BOOST_CHECK(samples[n].phase >= samples[n - 1].phase);
+    phase1 += (samples[n].phase == 1);
+  }
+  BOOST_CHECK(phase1 > 0);
+
+  auto summary = sampler.summarise().value();
+  std::cout << "Summarised " << summary.samples << " samples over " << std::chrono::duration_cast<std::chrono::milliseconds>(summary.elapsed).count()
+            << " ms. Resident set size min " << summary.total_address_space_paged_in.min << " p50 " << summary.total_address_space_paged_in.p50 << " max "
+            << summary.total_address_space_paged_in.max << ". CPU utilisation p50 " << summary.cpu_utilisation.p50 << ". Resident set grew by "
+            << summary.paged_in_growth << " bytes, of which " << summary.paged_in_growth_map_cache << " matched map cache growth." << std::endl;
+  BOOST_CHECK(summary.samples == samples.size());
+  BOOST_CHECK(summary.total_address_space_paged_in.min <= summary.total_address_space_paged_in.p50);
+  BOOST_CHECK(summary.total_address_space_paged_in.p50 <= summary.total_address_space_paged_in.max);
+  BOOST_CHECK(summary.total_address_space_paged_in.max - summary.total_address_space_paged_in.min >= bytes / 2);
+  BOOST_CHECK(summary.paged_in_growth >= (int64_t) bytes / 2);
+  BOOST_CHECK(summary.paged_in_max_increase > 0);
+  BOOST_CHECK(summary.paged_in_growth_map_cache <= summary.paged_in_growth);
+
+  // A small ring keeps only the most recent samples
+  auto small = llfio::algorithm::process_sampler::start(std::chrono::milliseconds(1), 4).value();
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  small.stop().value();
+  BOOST_CHECK(small.size() == 4);
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, process_sampler, works, "Tests that the process memory and CPU sampler works as expected", TestProcessSampler())
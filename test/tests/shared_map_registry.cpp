@@ -0,0 +1,129 @@
+/* Integration test kernel for the shared map registry
+(C) 2026 agent <agent@local> (3 commits)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#include "../test_kernel_decl.hpp"
+
+static inline void TestSharedMapRegistry()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  using LLFIO_V2_NAMESPACE::byte;
+  auto &tempdir = llfio::path_discovery::storage_backed_temporary_files_directory();
+  auto cleanup = llfio::make_scope_exit([&]() noexcept {
+    for(auto *leaf : {"llfio_shared_map_registry_test.registry", "llfio_shared_map_registry_test.data"})
+    {
+      auto fh = llfio::file_handle::file(tempdir, leaf, llfio::file_handle::mode::write);
+      if(fh)
+      {
+        (void) fh.value().unlink();
+      }
+    }
+  });
+  {
+    auto fh = llfio::file_handle::file(tempdir, "llfio_shared_map_registry_test.data", llfio::file_handle::mode::write,
+                                       llfio::file_handle::creation::truncate_existing)
+              .value();
+    std::vector<byte> buffer(1024 * 1024, llfio::to_byte(78));
+    fh.write(0, {{buffer.data(), buffer.size()}}).value();
+  }
+  // Two opens of the registry stand in for two processes
+  auto registry1 = llfio::algorithm::shared_map_registry::open(tempdir, "llfio_shared_map_registry_test.registry", 16).value();
+  auto registry2 = llfio::algorithm::shared_map_registry::open(tempdir, "llfio_shared_map_registry_test.registry").value();
+  BOOST_CHECK(registry1.capacity() == 16);
+  BOOST_CHECK(registry2.capacity() == 16);
+
+  auto view1 = registry1.map(tempdir, "llfio_shared_map_registry_test.data").value();
+  BOOST_REQUIRE(view1.address() != nullptr);
+  BOOST_CHECK(view1.length() == 1024 * 1024);
+  BOOST_CHECK(view1.is_at_registered_address());
+  BOOST_CHECK(!view1.is_validated());
+  BOOST_CHECK(view1.address()[1000] == llfio::to_byte(78));
+  registry1.mark_validated(view1).value();
+  BOOST_CHECK(view1.is_validated());
+  auto *const address = view1.address();
+
+  // The registered address is taken in this process, so a second view goes elsewhere
+  auto view2 = registry2.map(tempdir, "llfio_shared_map_registry_test.data").value();
+  BOOST_CHECK(view2.address() != address);
+  BOOST_CHECK(!view2.is_at_registered_address());
+  BOOST_CHECK(view2.is_validated());
+  view2.close().value();
+
+  // Once free, the registered address is used. Unmapping the first view behind the registry's
+  // back stands in for it being mapped in another process.
+  view1.map().close().value();
+  view2 = registry2.map(tempdir, "llfio_shared_map_registry_test.data").value();
+  BOOST_CHECK(view2.address() == address);
+  BOOST_CHECK(view2.is_at_registered_address());
+  BOOST_CHECK(view2.is_validated());
+  BOOST_CHECK(view2.address()[1000] == llfio::to_byte(78));
+
+  // The registration outlives all but the last view at the registered address
+  view1.close().value();
+  view1 = registry1.map(tempdir, "llfio_shared_map_registry_test.data").value();
+  BOOST_CHECK(!view1.is_at_registered_address());
+  BOOST_CHECK(view1.is_validated());
+  view1.close().value();
+  view2.close().value();
+  view2 = registry2.map(tempdir, "llfio_shared_map_registry_test.data").value();
+  BOOST_CHECK(view2.is_at_registered_address());
+  BOOST_CHECK(!view2.is_validated());
+  registry2.mark_validated(view2).value();
+  auto *const address2 = view2.address();
+
+  // Changing the file invalidates the validation
+  {
+    auto fh = llfio::file_handle::file(tempdir, "llfio_shared_map_registry_test.data", llfio::file_handle::mode::write).value();
+    fh.truncate(2 * 1024 * 1024).value();
+  }
+  view2.map().close().value();
+  view1 = registry1.map(tempdir, "llfio_shared_map_registry_test.data", 1024 * 1024).value();
+  BOOST_CHECK(view1.address() == address2);
+  BOOST_CHECK(view1.is_at_registered_address());
+  BOOST_CHECK(!view1.is_validated());
+
+  // Forgetting the view removes its registration
+  registry1.forget(view1).value();
+  BOOST_CHECK(!view1.is_at_registered_address());
+  view1.close().value();
+  view2.close().value();
+  view1 = registry1.map(tempdir, "llfio_shared_map_registry_test.data", 1024 * 1024).value();
+  BOOST_CHECK(view1.is_at_registered_address());
+  BOOST_CHECK(!view1.is_validated());
+  view1.close().value();
+
+  // Views from within a page register the start of the page, and so can be mapped there again
+  view1 = registry1.map(tempdir, "llfio_shared_map_registry_test.data", 4096, 100).value();
+  BOOST_REQUIRE(view1.address() != nullptr);
+  BOOST_CHECK(view1.is_at_registered_address());
+  BOOST_CHECK(view1.address()[0] == llfio::to_byte(78));
+  auto *const address3 = view1.address();
+  view1.map().close().value();
+  view2 = registry2.map(tempdir, "llfio_shared_map_registry_test.data", 4096, 100).value();
+  BOOST_CHECK(view2.address() == address3);
+  BOOST_CHECK(view2.is_at_registered_address());
+  BOOST_CHECK(view2.address()[0] == llfio::to_byte(78));
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, algorithm, shared_map_registry, "Tests that algorithm::shared_map_registry works as expected",
+                       TestSharedMapRegistry())
@@ -0,0 +1,133 @@
+/* Integration test kernel for binary event tracing
+(C) 2026 agent <agent@local> (2 commits)
+File Created: Oct 2026
+
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License in the accompanying file
+Licence.txt or at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+
+Distributed under the Boost Software License, Version 1.0.
+    (See accompanying file Licence.txt or copy at
+          http://www.boost.org/LICENSE_1_0.txt)
+*/
+
+#include "../test_kernel_decl.hpp"
+
+#include <thread>
+#include <vector>
+
+static inline void TestTracing()
+{
+  namespace llfio = LLFIO_V2_NAMESPACE;
+  using LLFIO_V2_NAMESPACE::byte;
+#ifdef LLFIO_DISABLE_TRACING
+  return;
+#endif
+  std::vector<llfio::trace_event> events(65536);
+  // Discard anything left over from earlier tests
+  while(llfio::tracing::drain(events.data(), events.size()) > 0)
+  {
+  }
+
+  // Nothing is recorded when disabled
+  auto fh = llfio::file_handle::temp_inode().value();
+  byte buffer[64]{};
+  fh.write(0, {{buffer, 64}}).value();
+  BOOST_CHECK(llfio::tracing::drain(events.data(), events.size()) == 0);
+
+  // Record i/o from several threads
+  llfio::tracing::enable(true);
+  std::vector<std::thread> threads;
+  for(size_t n = 0; n < 4; n++)
+  {
+    threads.emplace_back([&, n] {
+      for(size_t i = 0; i < 100; i++)
+      {
+        fh.write(n * 64, {{buffer, 64}}).value();
+        fh.read(n * 64, {{buffer, 64}}).value();
+      }
+    });
+  }
+  for(auto &t : threads)
+  {
+    t.join();
+  }
+  {
+    auto mh = llfio::map_handle::map(4096).value();
+    (void) mh;
+  }
+  llfio::tracing::enable(false);
+  auto count = llfio::tracing::drain(events.data(), events.size());
+  std::cout << "Drained " << count << " events, " << llfio::tracing::dropped() << " dropped." << std::endl;
+  BOOST_CHECK(count == 4 * 100 * 4 + 4);
+  size_t reads = 0, writes = 0, maps = 0, unmaps = 0;
+  for(size_t n = 0; n < count; n++)
+  {
+    auto &ev = events[n];
+    BOOST_CHECK(ev.flags == 0);
+    if(ev.phase == llfio::trace_event_phase::end)
+    {
+      switch(ev.kind)
+      {
+      case llfio::trace_event_kind::read:
+        reads++;
+        BOOST_CHECK(ev.value == 64);
+        break;
+      case llfio::trace_event_kind::write:
+        writes++;
+        BOOST_CHECK(ev.value == 64);
+        break;
+      case llfio::trace_event_kind::map:
+        maps++;
+        break;
+      case llfio::trace_event_kind::unmap:
+        unmaps++;
+        break;
+      default:
+        break;
+      }
+    }
+  }
+  BOOST_CHECK(reads == 400);
+  BOOST_CHECK(writes == 400);
+  BOOST_CHECK(maps == 1);
+  BOOST_CHECK(unmaps == 1);
+  // The rings of the exited threads should now be freed, and draining again yields nothing
+  BOOST_CHECK(llfio::tracing::drain(events.data(), events.size()) == 0);
+
+  // Record into a file in the background, and check its contents
+  {
+    auto recorder = llfio::algorithm::trace_recorder::start(llfio::path_discovery::storage_backed_temporary_files_directory(), "llfio_tracing_test.trace",
+                                                              std::chrono::milliseconds(1))
+                    .value();
+    BOOST_CHECK(llfio::tracing::is_enabled());
+    for(size_t i = 0; i < 10000; i++)
+    {
+      fh.write(0, {{buffer, 64}}).value();
+    }
+    recorder.stop().value();
+    BOOST_CHECK(!llfio::tracing::is_enabled());
+  }
+  auto tracefile = llfio::mapped_file_handle::mapped_file(llfio::path_discovery::storage_backed_temporary_files_directory(), "llfio_tracing_test.trace",
+                                                                   llfio::mapped_file_handle::mode::write)
+                   .value();
+  auto *header = reinterpret_cast<const llfio::algorithm::trace_file_header *>(tracefile.address());
+  BOOST_REQUIRE(header != nullptr);
+  BOOST_CHECK(header->magic == llfio::algorithm::trace_file_header::magic_value);
+  BOOST_CHECK(header->events + header->dropped == 20000);
+  BOOST_CHECK(tracefile.maximum_extent().value() == sizeof(llfio::algorithm::trace_file_header) + header->events * sizeof(llfio::trace_event));
+  tracefile.unlink().value();
+}
+
+KERNELTEST_TEST_KERNEL(integration, llfio, tracing, works, "Tests that binary event tracing works as expected", TestTracing())
@@ -112,6 +112,48 @@ static inline void TestTrivialVector()
   BOOST_CHECK(it == v.end());
 }
 
+static inline void TestTrivialVectorPolicy()
+{
+  using namespace LLFIO_V2_NAMESPACE;
+  algorithm::trivial_vector_policy policy;
+  policy.large_page_threshold = 1024 * 1024;
+  policy.prefault = true;
+  algorithm::trivial_vector<uint64_t> v(policy);
+  BOOST_CHECK(v.policy().large_page_threshold == 1024 * 1024);
+  BOOST_CHECK(!v.uses_large_pages());
+  // Grow well past the threshold, the contents must survive the move into large pages
+  for(uint64_t n = 0; n < 1024 * 1024; n++)
+  {
+    v.push_back(n);
+  }
+  std::cout << "trivial_vector with a large page threshold of 1Mb uses large pages = " << v.uses_large_pages() << std::endl;
+  if(utils::page_sizes().size() < 2)
+  {
+    BOOST_CHECK(!v.uses_large_pages());
+  }
+  bool allgood = true;
+  for(uint64_t n = 0; n < 1024 * 1024; n++)
+  {
+    allgood &= (v[n] == n);
+  }
+  BOOST_CHECK(allgood);
+  // Moves and swaps must carry the storage with them
+  algorithm::trivial_vector<uint64_t> v2(std::move(v));
+  algorithm::trivial_vector<uint64_t> v3(3, 7);
+  v2.swap(v3);
+  BOOST_CHECK(v2.size() == 3);
+  BOOST_CHECK(v3.size() == 1024 * 1024);
+  v3.push_back(5);
+  v2.push_back(4);
+  BOOST_CHECK(v3[1024 * 1024 - 1] == 1024 * 1024 - 1);
+  BOOST_CHECK(v3.back() == 5);
+  BOOST_CHECK(v2[3] == 4);
+  v3.resize(10);
+  v3.shrink_to_fit();
+  BOOST_CHECK(v3.size() == 10);
+  BOOST_CHECK(v3[9] == 9);
+}
+
 inline std::string printKb(size_t bytes)
 {
   if(bytes >= 1024 * 1024 * 1024)
@@ -244,6 +286,51 @@ static inline void BenchmarkTrivialVector2()
   }
 }
 
+static inline void BenchmarkTrivialVector3()
+{
+  using namespace LLFIO_V2_NAMESPACE;
+  static constexpr size_t items = 32 * 1024 * 1024;  // 256Mb
+  static constexpr size_t lookups = 16 * 1024 * 1024;
+  std::ofstream csv("trivial_vector4.csv");
+  auto benchmark = [](const char *desc, algorithm::trivial_vector_policy policy) {
+    std::chrono::high_resolution_clock::time_point begin, end;
+    algorithm::trivial_vector<uint64_t> v(policy);
+    begin = std::chrono::high_resolution_clock::now();
+    for(size_t n = 0; n < items; n++)
+    {
+      v.push_back(n);
+    }
+    end = std::chrono::high_resolution_clock::now();
+    auto pushtime = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+    // Random access defeats the TLB unless pages are large
+    uint64_t x = 0, sum = 0;
+    begin = std::chrono::high_resolution_clock::now();
+    for(size_t n = 0; n < lookups; n++)
+    {
+      x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+      sum += v[(size_t)(x >> 32) % items];
+    }
+    end = std::chrono::high_resolution_clock::now();
+    auto lookuptime = std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count();
+    std::cout << desc << " (large pages = " << v.uses_large_pages() << "): push_back() " << printKb(items * sizeof(uint64_t)) << " in " << pushtime
+              << " microseconds, random lookups " << (1000.0 * lookuptime / lookups) << " nanoseconds each (" << sum << ")" << std::endl;
+    return std::make_pair(pushtime, lookuptime);
+  };
+  algorithm::trivial_vector_policy policy;
+  auto normal = benchmark("Normal pages            ", policy);
+  policy.prefault = true;
+  auto prefaulted = benchmark("Normal pages, prefaulted", policy);
+  policy.prefault = false;
+  policy.large_page_threshold = 4 * 1024 * 1024;
+  auto large = benchmark("Large pages             ", policy);
+  policy.prefault = true;
+  auto largeprefaulted = benchmark("Large pages, prefaulted ", policy);
+  csv << normal.first << "," << normal.second << "," << prefaulted.first << "," << prefaulted.second << "," << large.first << "," << large.second << ","
+      << largeprefaulted.first << "," << largeprefaulted.second << std::endl;
+}
+
 KERNELTEST_TEST_KERNEL(integration, llfio, algorithm, trivial_vector, "Tests that llfio::algorithm::trivial_vector works as expected", TestTrivialVector())
+KERNELTEST_TEST_KERNEL(integration, llfio, algorithm, trivial_vector_policy, "Tests that llfio::algorithm::trivial_vector_policy works as expected", TestTrivialVectorPolicy())
 KERNELTEST_TEST_KERNEL(integration, llfio, algorithm, trivial_vector2, "Benchmarks llfio::algorithm::trivial_vector against std::vector with push_back()", BenchmarkTrivialVector1())
 KERNELTEST_TEST_KERNEL(integration, llfio, algorithm, trivial_vector3, "Benchmarks llfio::algorithm::trivial_vector against std::vector with resize()", BenchmarkTrivialVector2())
+KERNELTEST_TEST_KERNEL(integration, llfio, algorithm, trivial_vector4, "Benchmarks llfio::algorithm::trivial_vector with large pages and prefaulting", BenchmarkTrivialVector3())